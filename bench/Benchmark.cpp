@@ -0,0 +1,80 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+
+#include <cstdio>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    static bool anyFailure = false;
+    static const void* volatile sink = nullptr;
+
+    void run(const std::string& name, const Work& workPerIteration, const std::function<void()>& function, std::chrono::milliseconds minimumDuration)
+    {
+        // Warm up caches and allocations before measuring
+        function();
+
+        std::uint64_t iterations = 0;
+        std::uint64_t batch = 1;
+        auto startTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+
+        do
+        {
+            for (std::uint64_t i = 0; i < batch; i++)
+            {
+                function();
+            }
+            iterations += batch;
+            batch *= 2;
+
+            elapsed = std::chrono::steady_clock::now() - startTime;
+        } while (elapsed < minimumDuration);
+
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        double nanosecondsPerIteration = seconds * 1e9 / iterations;
+
+        std::printf("%-48s %12.1f ns/op", name.c_str(), nanosecondsPerIteration);
+
+        if (workPerIteration.bytes > 0)
+        {
+            std::printf(" %10.1f MB/s", workPerIteration.bytes * iterations / seconds / 1e6);
+        }
+
+        if (workPerIteration.points > 0)
+        {
+            std::printf(" %14.0f points/s", workPerIteration.points * iterations / seconds);
+        }
+
+        if (workPerIteration.packets > 0)
+        {
+            std::printf(" %10.1f ns/packet", nanosecondsPerIteration / workPerIteration.packets);
+        }
+
+        std::printf("\n");
+    }
+
+    void fail(const std::string& message)
+    {
+        std::printf("FAILED: %s\n", message.c_str());
+        anyFailure = true;
+    }
+
+    bool succeeded()
+    {
+        return !anyFailure;
+    }
+
+    void doNotOptimize(const void* value)
+    {
+        sink = value;
+    }
+}
+}
+}
@@ -0,0 +1,50 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_BENCH_BENCHMARK_H
+#define PARAKEET_BENCH_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+/// \brief The work done by one call of a benchmarked function, used for the throughput columns (0 leaves a column out)
+struct Work
+{
+    Work(std::uint64_t bytes = 0, std::uint64_t points = 0, std::uint64_t packets = 0) : bytes(bytes), points(points), packets(packets)
+    {
+    }
+
+    std::uint64_t bytes;
+    std::uint64_t points;
+    std::uint64_t packets;
+};
+
+/// \brief Time a function, repeating it until at least minimumDuration has passed, and print a line of results
+/// \param[in] name - The name the results are printed under
+/// \param[in] workPerIteration - The bytes, points and packets processed by one call
+/// \param[in] function - The code to time
+void run(const std::string& name, const Work& workPerIteration, const std::function<void()>& function,
+    std::chrono::milliseconds minimumDuration = std::chrono::milliseconds(300));
+
+/// \brief Print a verification failure, and remember it for the exit code
+void fail(const std::string& message);
+
+/// \returns True if no verification has failed
+bool succeeded();
+
+/// \brief Keep the compiler from optimizing away a result
+void doNotOptimize(const void* value);
+}
+}
+}
+
+#endif
@@ -0,0 +1,23 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_BENCH_BENCHMARKS_H
+#define PARAKEET_BENCH_BENCHMARKS_H
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+void runParserBenchmarks();
+void runDriverBenchmarks();
+void runFilterBenchmarks();
+void runProtocolBenchmarks();
+void runScanCodecBenchmarks();
+}
+}
+}
+
+#endif
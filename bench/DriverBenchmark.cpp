@@ -0,0 +1,1445 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <parakeet/Driver.h>
+#include <parakeet/PolarTransform.h>
+#include <parakeet/util.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    const int SECTORS_PER_REVOLUTION = 10;
+    const int POINTS_PER_SECTOR = 200;
+
+    // A Driver with no sensor behind it, so sectors can be handed straight to the Driver's revolution assembly
+    class SectorFedDriver : public Driver
+    {
+        public:
+            void setScanningFrequency_Hz(ScanningFrequency) override {}
+            ScanningFrequency getScanningFrequency_Hz() override { return Frequency_10Hz; }
+            void enableIntensityData(bool) override {}
+            bool isIntensityDataEnabled() override { return true; }
+            void enableDataSmoothing(bool) override {}
+            bool isDataSmoothingEnabled() override { return false; }
+            void enableRemoveDragPoint(bool) override {}
+            bool isDragPointRemovalEnabled() override { return false; }
+
+            void feed(const ScanData& scanData)
+            {
+                onScanDataReceived(scanData);
+            }
+
+            void feedPartial(const ScanData& partialSector)
+            {
+                onPartialSectorReceived(partialSector);
+            }
+
+        protected:
+            bool isConnected() override { return true; }
+    };
+
+    static std::vector<internal::ScanData> createSectors()
+    {
+        std::vector<internal::ScanData> sectors(SECTORS_PER_REVOLUTION);
+
+        for (int sector = 0; sector < SECTORS_PER_REVOLUTION; sector++)
+        {
+            internal::ScanData& scanData = sectors[sector];
+            scanData.startAngle_deg = sector * 36.0;
+            scanData.endAngle_deg = scanData.startAngle_deg + 36.0;
+            scanData.count = POINTS_PER_SECTOR;
+
+            for (int i = 0; i < POINTS_PER_SECTOR; i++)
+            {
+                scanData.dist_mm[i] = static_cast<unsigned short>(2000 + (sector * POINTS_PER_SECTOR + i) % 3000);
+                scanData.intensity[i] = static_cast<unsigned char>(i);
+            }
+        }
+
+        return sectors;
+    }
+
+    static void runOnScanDataReceivedBenchmark()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        std::size_t revolutions = 0;
+        std::size_t points = 0;
+
+        driver.registerScanCallback([&](const ScanDataPolar& scanDataPolar)
+        {
+            revolutions++;
+            points += scanDataPolar.getPoints().size();
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        if (revolutions != 1 || points != SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR)
+        {
+            fail("Driver::onScanDataReceived did not publish one revolution per ten sectors");
+            return;
+        }
+
+        run("Driver::onScanDataReceived", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+    }
+
+    template <typename Point>
+    static void runBasicScanDataBenchmark(const std::string& name)
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        std::size_t revolutions = 0;
+        std::size_t points = 0;
+
+        driver.registerScanCallback<Point>([&](const BasicScanData<Point>& scanData)
+        {
+            revolutions++;
+            points += scanData.getPoints().size();
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        if (revolutions != 1 || points != SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR)
+        {
+            fail("Driver did not publish one BasicScanData revolution per ten sectors");
+            return;
+        }
+
+        run("Driver::onScanDataReceived " + name, Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+    }
+
+    static void runCompactScanDataBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        std::size_t revolutions = 0;
+        CompactScanData compactScanData;
+
+        driver.registerCompactScanCallback([&](const CompactScanData& scanData)
+        {
+            revolutions++;
+            compactScanData = scanData;
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        if (revolutions != 1 || compactScanData.getPointCount() != SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR)
+        {
+            fail("Driver did not publish one CompactScanData revolution per ten sectors");
+            return;
+        }
+
+        for (std::size_t i = 0; i < compactScanData.getPointCount(); i++)
+        {
+            const internal::ScanData& sector = sectors[i / POINTS_PER_SECTOR];
+            double angle_deg = sector.startAngle_deg + (36.0 / POINTS_PER_SECTOR) * (i % POINTS_PER_SECTOR);
+
+            if (compactScanData.getRange_mm(i) != sector.dist_mm[i % POINTS_PER_SECTOR] ||
+                compactScanData.getIntensity(i) != sector.intensity[i % POINTS_PER_SECTOR] ||
+                std::fabs(compactScanData.getAngle_deg(i) - angle_deg) > 0.005)
+            {
+                fail("CompactScanData does not hold the points of the sectors it was built from");
+                return;
+            }
+        }
+
+        run("Driver::onScanDataReceived CompactScanData", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+
+        ScanDataPolar scanDataPolar = compactScanData.toScanDataPolar();
+        ScanDataXY expected = util::transform(scanDataPolar);
+        ScanDataXY scanDataXY = util::transform(compactScanData);
+
+        for (std::size_t i = 0; i < compactScanData.getPointCount(); i++)
+        {
+            if (scanDataXY.getPoints()[i].getX_mm() != expected.getPoints()[i].getX_mm() ||
+                scanDataXY.getPoints()[i].getY_mm() != expected.getPoints()[i].getY_mm() ||
+                scanDataXY.getPoints()[i].getIntensity() != expected.getPoints()[i].getIntensity())
+            {
+                fail("util::transform(const CompactScanData&) does not match the widened scan's transform");
+                return;
+            }
+        }
+
+        run("util::transform compact to XY", Work(0, compactScanData.getPointCount()), [&]()
+        {
+            ScanDataXY result = util::transform(compactScanData);
+            doNotOptimize(result.getPoints().data());
+        });
+
+        PolarTransform<float> floatTransform;
+        PolarTransform<float>::Columns floatColumns;
+
+        run("PolarTransform<float> compact columns", Work(0, compactScanData.getPointCount()), [&]()
+        {
+            floatTransform.transform(compactScanData, floatColumns);
+            doNotOptimize(floatColumns.x_mm.data());
+        });
+    }
+
+    static void runCachedScanBenchmarks()
+    {
+        const int SUBSCRIBER_COUNT = 4;
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        std::size_t pointsSeen = 0;
+
+        // Every subscriber of the revolution asks for its cartesian coordinates
+        driver.registerScanCallback([&](const ScanDataPolar& scanDataPolar)
+        {
+            for (int subscriber = 0; subscriber < SUBSCRIBER_COUNT; subscriber++)
+            {
+                ScanDataXY scanDataXY = util::transform(scanDataPolar);
+                pointsSeen += scanDataXY.getPoints().size();
+            }
+        });
+
+        run("Driver ScanDataPolar, 4 subscribers transforming", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+
+        driver.registerScanCallback(nullptr);
+
+        ScanDataXY expected(std::vector<PointXY>(), std::chrono::system_clock::now());
+        bool matches = true;
+
+        driver.registerCachedScanCallback([&](const std::shared_ptr<const CachedScan>& cachedScan)
+        {
+            for (int subscriber = 0; subscriber < SUBSCRIBER_COUNT; subscriber++)
+            {
+                pointsSeen += cachedScan->getXY().getPoints().size();
+            }
+
+            expected = util::transform(cachedScan->getPolar());
+            matches = matches && cachedScan->getXY().getPoints().size() == expected.getPoints().size() &&
+                cachedScan->getXY().getPoints().back().getX_mm() == expected.getPoints().back().getX_mm();
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        if (!matches || expected.getPoints().size() != SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR)
+        {
+            fail("CachedScan.getXY() does not match util::transform");
+            return;
+        }
+
+        driver.registerCachedScanCallback([&](const std::shared_ptr<const CachedScan>& cachedScan)
+        {
+            for (int subscriber = 0; subscriber < SUBSCRIBER_COUNT; subscriber++)
+            {
+                pointsSeen += cachedScan->getXY().getPoints().size();
+            }
+        });
+
+        run("Driver CachedScan, 4 subscribers sharing", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+
+        std::shared_ptr<const CachedScan> lastScan;
+        driver.registerCachedScanCallback([&](const std::shared_ptr<const CachedScan>& cachedScan)
+        {
+            lastScan = cachedScan;
+        }, true);
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!lastScan->hasXY() && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (!lastScan->hasXY())
+        {
+            fail("Driver did not transform a CachedScan eagerly");
+        }
+
+        driver.registerCachedScanCallback(nullptr);
+        doNotOptimize(&pointsSeen);
+    }
+
+    static GridScanData resampleSectors(const std::vector<internal::ScanData>& sectors, const GridScanData::Settings& settings)
+    {
+        SectorFedDriver driver;
+        GridScanData gridScanData(settings);
+
+        driver.registerGridScanCallback([&](const GridScanData& scanData)
+        {
+            gridScanData = scanData;
+        }, settings);
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        return gridScanData;
+    }
+
+    static void runGridScanBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+        double anglePerPoint_deg = 36.0 / POINTS_PER_SECTOR;
+        int pointCount = SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR;
+
+        // createSectors() gives the point at each index a range of 2000mm plus its index
+        GridScanData::Settings settings;
+        settings.resolution_deg = 0.25;
+        GridScanData nearest = resampleSectors(sectors, settings);
+
+        for (std::size_t cell = 0; cell < nearest.getCellCount(); cell++)
+        {
+            double position = nearest.getAngle_deg(cell) / anglePerPoint_deg;
+            int index = static_cast<int>(position + 0.5) % pointCount;
+            int otherIndex = static_cast<int>(position + 0.499) % pointCount;
+
+            if (nearest.getRange_mm(cell) != 2000 + index && nearest.getRange_mm(cell) != 2000 + otherIndex)
+            {
+                fail("GridScanData nearest resampling did not take the range of the nearest point");
+                return;
+            }
+        }
+
+        if (nearest.getCellCount() != 1440 || nearest.getRangeAt_mm(90) != nearest.getRange_mm(360) || nearest.getRangeAt_mm(-0.1) != nearest.getRange_mm(0))
+        {
+            fail("GridScanData did not find the cell of a bearing");
+        }
+
+        settings.resampling = GridScanData::InterpolatedResampling;
+        GridScanData interpolated = resampleSectors(sectors, settings);
+
+        for (std::size_t cell = 0; cell < interpolated.getCellCount(); cell++)
+        {
+            double position = interpolated.getAngle_deg(cell) / anglePerPoint_deg;
+            double expected_mm = position < pointCount - 1 ? 2000 + position : 2000 + (position - pointCount < -0.5 ? pointCount - 1 : 0);
+
+            if (std::fabs(interpolated.getRange_mm(cell) - expected_mm) > 0.5)
+            {
+                fail("GridScanData interpolated resampling did not interpolate between points on one surface only");
+                return;
+            }
+        }
+
+        settings.resampling = GridScanData::MinimumResampling;
+        settings.resolution_deg = 0.5;
+        GridScanData closest = resampleSectors(sectors, settings);
+
+        for (std::size_t cell = 0; cell < closest.getCellCount(); cell++)
+        {
+            int expected_mm = 65535;
+            for (int i = 0; i < pointCount; i++)
+            {
+                if (closest.getCell(i * anglePerPoint_deg) == cell)
+                {
+                    expected_mm = std::min(expected_mm, 2000 + i);
+                }
+            }
+
+            if (closest.getRange_mm(cell) != expected_mm)
+            {
+                fail("GridScanData minimum resampling did not take the closest return in each cell");
+                return;
+            }
+        }
+
+        // Points without a return, a missing sector, and cells finer than the points are all invalid
+        std::vector<internal::ScanData> gappedSectors = sectors;
+        std::fill(gappedSectors[1].dist_mm, gappedSectors[1].dist_mm + POINTS_PER_SECTOR, 0);
+        gappedSectors.erase(gappedSectors.begin() + 3);
+
+        settings.resampling = GridScanData::InterpolatedResampling;
+        settings.resolution_deg = 0.25;
+        settings.invalidRange_mm = 65535;
+        GridScanData gapped = resampleSectors(gappedSectors, settings);
+
+        if (gapped.isValid(gapped.getCell(50)) || !gapped.isValid(gapped.getCell(80)) || gapped.isValid(gapped.getCell(110)) ||
+            gapped.isValid(gapped.getCell(143)) || !gapped.isValid(gapped.getCell(144)) || gapped.getRangeAt_mm(110) != 65535)
+        {
+            fail("GridScanData did not mark the cells without a return invalid");
+        }
+
+        settings.resampling = GridScanData::MinimumResampling;
+        settings.resolution_deg = 0.1;
+        GridScanData fine = resampleSectors(sectors, settings);
+
+        if (fine.isValid(fine.getCell(0.1)) || !fine.isValid(fine.getCell(0.2)))
+        {
+            fail("GridScanData minimum resampling filled a cell no point was nearest to");
+        }
+
+        const GridScanData::Resampling resamplings[] = {GridScanData::NearestResampling, GridScanData::InterpolatedResampling, GridScanData::MinimumResampling};
+        const char* names[] = {"nearest", "interpolated", "minimum"};
+
+        for (int i = 0; i < 3; i++)
+        {
+            settings = GridScanData::Settings();
+            settings.resampling = resamplings[i];
+
+            SectorFedDriver driver;
+            const std::uint16_t* cells = nullptr;
+            bool reallocated = false;
+
+            driver.registerGridScanCallback([&](const GridScanData& scanData)
+            {
+                reallocated |= cells != nullptr && cells != scanData.getRanges_mm();
+                cells = scanData.getRanges_mm();
+            }, settings);
+
+            run(std::string("Driver::onScanDataReceived GridScanData ") + names[i] + " 0.25 deg", Work(0, pointCount, SECTORS_PER_REVOLUTION), [&]()
+            {
+                for (const internal::ScanData& sector : sectors)
+                {
+                    driver.feed(sector);
+                }
+            });
+
+            if (reallocated)
+            {
+                fail("GridScanData reallocated its cells between revolutions");
+            }
+        }
+
+        // The range at a bearing, from the grid and by searching the points of a CompactScanData
+        CompactScanData compactScanData;
+        for (int i = 0; i < pointCount; i++)
+        {
+            compactScanData.addPoint(2000.0 + i, i * anglePerPoint_deg, 0);
+        }
+
+        const int lookupCount = 1000;
+        std::uint32_t sum = 0;
+
+        run("GridScanData range at bearing", Work(0, lookupCount), [&]()
+        {
+            for (int i = 0; i < lookupCount; i++)
+            {
+                sum += nearest.getRangeAt_mm(i * 0.36);
+            }
+        });
+
+        run("CompactScanData range at bearing by search", Work(0, lookupCount), [&]()
+        {
+            const std::uint16_t* angles_cdeg = compactScanData.getAngles_cdeg();
+            const std::uint16_t* end = angles_cdeg + compactScanData.getPointCount();
+
+            for (int i = 0; i < lookupCount; i++)
+            {
+                const std::uint16_t* found = std::lower_bound(angles_cdeg, end, CompactScanData::toCentidegrees(i * 0.36));
+                sum += compactScanData.getRanges_mm()[found == end ? 0 : found - angles_cdeg];
+            }
+        });
+
+        doNotOptimize(&sum);
+    }
+
+    // The closest and farthest return within an arc, by looking at every point
+    static void findByScanning(const CompactScanData& scan, double startAngle_deg, double endAngle_deg, int& closest_mm, int& farthest_mm)
+    {
+        int startAngle_cdeg = CompactScanData::toCentidegrees(startAngle_deg);
+        int endAngle_cdeg = CompactScanData::toCentidegrees(endAngle_deg);
+
+        closest_mm = 0;
+        farthest_mm = 0;
+
+        for (std::size_t i = 0; i < scan.getPointCount(); i++)
+        {
+            int angle_cdeg = scan.getAngles_cdeg()[i];
+            int range_mm = scan.getRanges_mm()[i];
+            bool inside = startAngle_cdeg <= endAngle_cdeg ? (angle_cdeg >= startAngle_cdeg && angle_cdeg <= endAngle_cdeg) : (angle_cdeg >= startAngle_cdeg || angle_cdeg <= endAngle_cdeg);
+
+            if (inside && range_mm != 0)
+            {
+                closest_mm = closest_mm == 0 ? range_mm : std::min(closest_mm, range_mm);
+                farthest_mm = std::max(farthest_mm, range_mm);
+            }
+        }
+    }
+
+    static void runRangeIndexBenchmarks()
+    {
+        int pointCount = SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR;
+        double anglePerPoint_deg = 360.0 / pointCount;
+
+        // A revolution which starts half way round, with a few points without a return
+        CompactScanData scan;
+        std::srand(45);
+        for (int i = 0; i < pointCount; i++)
+        {
+            int range_mm = std::rand() % 10 == 0 ? 0 : 100 + std::rand() % 20000;
+            scan.addPoint(static_cast<double>(range_mm), std::fmod(180 + i * anglePerPoint_deg, 360.0), 0);
+        }
+
+        RangeIndex rangeIndex(scan);
+
+        for (int query = 0; query < 2000; query++)
+        {
+            double startAngle_deg = (std::rand() % 36000) / 100.0;
+            double endAngle_deg = query % 4 == 0 ? startAngle_deg : (std::rand() % 36000) / 100.0;
+
+            int closest_mm;
+            int farthest_mm;
+            findByScanning(scan, startAngle_deg, endAngle_deg, closest_mm, farthest_mm);
+
+            std::size_t closest = rangeIndex.findClosest(startAngle_deg, endAngle_deg);
+            std::size_t farthest = rangeIndex.findFarthest(startAngle_deg, endAngle_deg);
+
+            int foundClosest_mm = closest == RangeIndex::NO_POINT ? 0 : static_cast<int>(rangeIndex.getScan().getRange_mm(closest));
+            int foundFarthest_mm = farthest == RangeIndex::NO_POINT ? 0 : static_cast<int>(rangeIndex.getScan().getRange_mm(farthest));
+
+            if (foundClosest_mm != closest_mm || foundFarthest_mm != farthest_mm)
+            {
+                fail("RangeIndex did not find the closest and farthest returns of an arc");
+                return;
+            }
+        }
+
+        int closest_mm;
+        int farthest_mm;
+        findByScanning(scan, 0, 359.99, closest_mm, farthest_mm);
+
+        if (rangeIndex.getScan().getRange_mm(rangeIndex.findClosest()) != closest_mm || rangeIndex.getScan().getRange_mm(rangeIndex.findFarthest()) != farthest_mm)
+        {
+            fail("RangeIndex did not find the closest and farthest returns of the revolution");
+        }
+
+        // Arcs of a whole revolution, which would wrap round to a single bearing once quantized
+        if (rangeIndex.findClosest(0, 360) != rangeIndex.findClosest() || rangeIndex.findClosest(10, 370) != rangeIndex.findClosest() ||
+            rangeIndex.findFarthest(-90, 270) != rangeIndex.findFarthest())
+        {
+            fail("RangeIndex did not take an arc of 360 degrees as the whole revolution");
+        }
+
+        CompactScanData noReturns;
+        noReturns.addPoint(0.0, 10.0, 0);
+        noReturns.addPoint(0.0, 20.0, 0);
+
+        if (RangeIndex(noReturns).findClosest(0, 30) != RangeIndex::NO_POINT || RangeIndex(noReturns).findFarthest() != RangeIndex::NO_POINT ||
+            rangeIndex.findClosest(0.05, 0.1) != RangeIndex::NO_POINT)
+        {
+            fail("RangeIndex found a point where there is no return");
+        }
+
+        // The nearest obstacle in each of 36 sectors, from the index and by scanning every point
+        const int sectorCount = 36;
+        std::uint32_t sum = 0;
+
+        run("RangeIndex::build", Work(0, pointCount), [&]()
+        {
+            rangeIndex.build(scan);
+        });
+
+        run("RangeIndex closest in 36 sectors", Work(0, 0, sectorCount), [&]()
+        {
+            for (int sector = 0; sector < sectorCount; sector++)
+            {
+                sum += static_cast<std::uint32_t>(rangeIndex.findClosest(sector * 10.0 - 5, sector * 10.0 + 5));
+            }
+        });
+
+        run("Scanning for closest in 36 sectors", Work(0, 0, sectorCount), [&]()
+        {
+            for (int sector = 0; sector < sectorCount; sector++)
+            {
+                findByScanning(scan, std::fmod(sector * 10.0 + 355, 360.0), sector * 10.0 + 5, closest_mm, farthest_mm);
+                sum += closest_mm;
+            }
+        });
+
+        doNotOptimize(&sum);
+
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        std::size_t revolutions = 0;
+        std::size_t closest = RangeIndex::NO_POINT;
+        double closestAngle_deg = 0;
+
+        driver.registerRangeIndexCallback([&](const RangeIndex& index)
+        {
+            revolutions++;
+            closest = index.findClosest(10, 350);
+            closestAngle_deg = closest == RangeIndex::NO_POINT ? 0 : index.getScan().getAngle_deg(closest);
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        // createSectors() gives each point a range of 2000mm plus its index
+        if (revolutions != 1 || std::fabs(closestAngle_deg - 10.08) > 0.005)
+        {
+            fail("Driver did not publish a RangeIndex over each revolution");
+        }
+
+        run("Driver::onScanDataReceived RangeIndex", Work(0, pointCount, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+    }
+
+    static ProtectiveFieldMonitor::Zone createRectangle(double minimumX_mm, double minimumY_mm, double maximumX_mm, double maximumY_mm)
+    {
+        ProtectiveFieldMonitor::Zone zone;
+        zone.vertices.push_back(PointXY(minimumX_mm, minimumY_mm, 0));
+        zone.vertices.push_back(PointXY(maximumX_mm, minimumY_mm, 0));
+        zone.vertices.push_back(PointXY(maximumX_mm, maximumY_mm, 0));
+        zone.vertices.push_back(PointXY(minimumX_mm, maximumY_mm, 0));
+
+        return zone;
+    }
+
+    static void runProtectiveFieldBenchmarks()
+    {
+        ProtectiveFieldMonitor::Settings settings;
+        settings.zones.push_back(createRectangle(-1000, -1000, 1000, 1000));
+        settings.zones.push_back(createRectangle(2000, -500, 3000, 500));
+
+        ProtectiveFieldMonitor monitor(settings, nullptr);
+
+        if (monitor.getNearestRange_mm(0, 0) != 0 || monitor.getFarthestRange_mm(0, 0) != 1000 || monitor.getFarthestRange_mm(0, 45) != 1415 ||
+            monitor.getNearestRange_mm(1, 0) != 2000 || monitor.getFarthestRange_mm(1, 0) != 3000 ||
+            monitor.getNearestRange_mm(1, 90) <= monitor.getFarthestRange_mm(1, 90))
+        {
+            fail("ProtectiveFieldMonitor did not compile its zones into the ranges they cover along each bearing");
+        }
+
+        // A clear revolution, and one with an object 1500mm away at 90 degrees, in the third sector
+        std::vector<internal::ScanData> clearSectors = createSectors();
+        for (internal::ScanData& sector : clearSectors)
+        {
+            std::fill(sector.dist_mm, sector.dist_mm + POINTS_PER_SECTOR, 5000);
+        }
+
+        std::vector<internal::ScanData> intrudedSectors = clearSectors;
+        std::fill(intrudedSectors[2].dist_mm + 95, intrudedSectors[2].dist_mm + 105, 1500);
+
+        settings.zones.clear();
+        settings.zones.push_back(createRectangle(-500, 1000, 500, 2000));
+        settings.intrusionRevolutionCount = 2;
+        settings.clearRevolutionCount = 2;
+
+        SectorFedDriver driver;
+        int sectorsFed = 0;
+        std::vector<int> intrusionSectors;
+        std::vector<int> clearSectorsFed;
+        ProtectiveFieldMonitor::Event lastIntrusion;
+
+        driver.registerProtectiveFieldCallback(settings, [&](const ProtectiveFieldMonitor::Event& event)
+        {
+            if (event.intruded)
+            {
+                intrusionSectors.push_back(sectorsFed);
+                lastIntrusion = event;
+            }
+            else
+            {
+                clearSectorsFed.push_back(sectorsFed);
+            }
+        });
+
+        const std::vector<internal::ScanData>* revolutions[] = {&intrudedSectors, &intrudedSectors, &clearSectors, &clearSectors, &clearSectors};
+        for (const std::vector<internal::ScanData>* revolution : revolutions)
+        {
+            for (const internal::ScanData& sector : *revolution)
+            {
+                sectorsFed++;
+                driver.feed(sector);
+            }
+        }
+
+        // Reported as the third sector of the second intruded revolution is decoded, and cleared after two clear revolutions
+        if (intrusionSectors.size() != 1 || intrusionSectors[0] != SECTORS_PER_REVOLUTION + 3 ||
+            lastIntrusion.range_mm != 1500 || std::fabs(lastIntrusion.angle_deg - 89.1) > 0.01)
+        {
+            fail("ProtectiveFieldMonitor did not report an intrusion from the sector which completed it");
+        }
+
+        if (clearSectorsFed.size() != 1 || clearSectorsFed[0] != 4 * SECTORS_PER_REVOLUTION)
+        {
+            fail("ProtectiveFieldMonitor did not report a zone clear after clearRevolutionCount revolutions");
+        }
+
+        // Two points are taken for noise
+        std::vector<internal::ScanData> noisySectors = clearSectors;
+        std::fill(noisySectors[2].dist_mm + 95, noisySectors[2].dist_mm + 97, 1500);
+        intrusionSectors.clear();
+
+        for (int revolution = 0; revolution < 3; revolution++)
+        {
+            for (const internal::ScanData& sector : noisySectors)
+            {
+                driver.feed(sector);
+            }
+        }
+
+        if (!intrusionSectors.empty())
+        {
+            fail("ProtectiveFieldMonitor reported fewer than minimumPointCount points as an intrusion");
+        }
+
+        settings.intrusionRevolutionCount = 1;
+
+        // The zones see the sector as it was received, so neither a region of interest leaving the object out nor a filter
+        // removing its points hides it, and a zone which asks for no points is not intruded by none
+        settings.zones.push_back(createRectangle(-500, 1000, 500, 2000));
+        settings.zones.back().minimumPointCount = 0;
+        std::fill(noisySectors[2].dist_mm + 95, noisySectors[2].dist_mm + 97, 5000);
+
+        SectorFedDriver filteredDriver;
+        std::vector<std::size_t> intrudedZones;
+
+        RegionOfInterest rear;
+        rear.addArc(180, 360);
+        filteredDriver.setRegionOfInterest(rear);
+
+        FilterPipeline::Settings filterSettings;
+        filterSettings.minimumIntensity = 255;
+        filteredDriver.setFilterSettings(filterSettings);
+
+        filteredDriver.registerProtectiveFieldCallback(settings, [&](const ProtectiveFieldMonitor::Event& event)
+        {
+            if (event.intruded)
+            {
+                intrudedZones.push_back(event.zoneIndex);
+            }
+        });
+
+        for (const internal::ScanData& sector : noisySectors)
+        {
+            filteredDriver.feed(sector);
+        }
+
+        if (!intrudedZones.empty())
+        {
+            fail("ProtectiveFieldMonitor reported a zone which asks for no points intruded by a clear revolution");
+        }
+
+        for (const internal::ScanData& sector : intrudedSectors)
+        {
+            filteredDriver.feed(sector);
+        }
+
+        if (intrudedZones.size() != 2)
+        {
+            fail("ProtectiveFieldMonitor was hidden from an intrusion by the region of interest or the filters");
+        }
+
+        settings.zones.clear();
+        settings.zones.push_back(createRectangle(-1000, -1000, 1000, 1000));
+        settings.zones.push_back(createRectangle(-500, 1000, 500, 2000));
+
+        ProtectiveFieldMonitor benchmarkMonitor(settings, nullptr);
+        const internal::ScanData& sector = intrudedSectors[2];
+        double anglePerPoint_deg = (sector.endAngle_deg - sector.startAngle_deg) / sector.count;
+
+        run("ProtectiveFieldMonitor::checkSector 2 zones", Work(0, POINTS_PER_SECTOR, 1), [&]()
+        {
+            benchmarkMonitor.checkSector(sector.count, sector.startAngle_deg, anglePerPoint_deg, sector.dist_mm, sector.timestamp);
+        });
+
+        if (benchmarkMonitor.getLayoutBuildCount() != 1)
+        {
+            fail("ProtectiveFieldMonitor laid out its thresholds again for a layout it had already seen");
+        }
+    }
+
+    static void runSectorCallbackBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        int revolutions = 0;
+        std::vector<int> revolutionsBeforeSector;
+        std::vector<SectorView> views;
+        int mismatchedSectors = 0;
+
+        driver.registerCompactScanCallback([&](const CompactScanData&)
+        {
+            revolutions++;
+        });
+
+        driver.registerSectorCallback([&](const SectorView& sectorView)
+        {
+            const internal::ScanData& sector = sectors[views.size() % SECTORS_PER_REVOLUTION];
+            mismatchedSectors += sectorView.getRanges_mm() != sector.dist_mm || sectorView.getStartAngle_deg() != sector.startAngle_deg ||
+                sectorView.getPointCount() != sector.count || sectorView.getAngle_deg(100) != sector.startAngle_deg + 18;
+
+            revolutionsBeforeSector.push_back(revolutions);
+            views.push_back(sectorView);
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        // Every sector, the last included, is delivered before the revolution is published
+        if (views.size() != SECTORS_PER_REVOLUTION || mismatchedSectors != 0 || revolutions != 1 ||
+            revolutionsBeforeSector.back() != 0 || views.front().isLastOfRevolution() || !views.back().isLastOfRevolution() || views.back().isPartial())
+        {
+            fail("Driver did not deliver each sector to the sector callback as it was decoded");
+        }
+
+        // Partial sectors are delivered instead of the complete sectors they make up
+        SectorFedDriver partialDriver;
+        int partialSectors = 0;
+        int completeSectors = 0;
+
+        partialDriver.registerSectorCallback([&](const SectorView& sectorView)
+        {
+            (sectorView.isPartial() ? partialSectors : completeSectors)++;
+        });
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            internal::ScanData partialSector = sector;
+            partialSector.count = POINTS_PER_SECTOR / 2;
+            partialSector.endAngle_deg = sector.startAngle_deg + 18;
+
+            partialDriver.feedPartial(partialSector);
+            partialDriver.feed(sector);
+        }
+
+        if (partialSectors != SECTORS_PER_REVOLUTION || completeSectors != 0)
+        {
+            fail("Driver delivered a complete sector to the sector callback after its partial sectors");
+        }
+
+        SectorFedDriver benchmarkDriver;
+        std::size_t points = 0;
+
+        benchmarkDriver.registerSectorCallback([&](const SectorView& sectorView)
+        {
+            points += sectorView.getPointCount();
+        });
+
+        run("Driver::onScanDataReceived sector callback", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                benchmarkDriver.feed(sector);
+            }
+        });
+
+        doNotOptimize(&points);
+    }
+
+    static void runSeamBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        driver.setSeamAngle_deg(-270);
+
+        std::vector<CompactScanData> scans;
+        std::vector<std::size_t> polarPointCounts;
+
+        driver.registerCompactScanCallback([&](const CompactScanData& scan)
+        {
+            scans.push_back(scan);
+        });
+
+        driver.registerScanCallback([&](const ScanDataPolar& scanDataPolar)
+        {
+            polarPointCounts.push_back(scanDataPolar.getPoints().size());
+        });
+
+        for (int revolution = 0; revolution < 3; revolution++)
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        }
+
+        // The sector from 72 to 108 degrees is split, the first revolution only runs up to the seam
+        const std::size_t revolutionPointCount = SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR;
+        bool seamed = driver.getSeamAngle_deg() == 90 && scans.size() == 3 && polarPointCounts.size() == 3 &&
+            scans[0].getPointCount() == 2 * POINTS_PER_SECTOR + POINTS_PER_SECTOR / 2 && polarPointCounts[0] == scans[0].getPointCount();
+
+        for (std::size_t i = 1; seamed && i < scans.size(); i++)
+        {
+            const std::uint16_t* angles_cdeg = scans[i].getAngles_cdeg();
+
+            seamed = scans[i].getPointCount() == revolutionPointCount && polarPointCounts[i] == revolutionPointCount &&
+                angles_cdeg[0] == 9000 && angles_cdeg[revolutionPointCount - 1] == 8982 &&
+                scans[i].getRanges_mm()[0] == sectors[2].dist_mm[POINTS_PER_SECTOR / 2];
+        }
+
+        if (!seamed)
+        {
+            fail("Driver did not start and end revolutions at the seam angle");
+        }
+    }
+
+    static void runRollingScanBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        RollingScan empty;
+        if (empty.getTimestamp() != std::chrono::system_clock::time_point() || empty.getNewestTimestamp() != std::chrono::system_clock::time_point() ||
+            empty.getSpan_deg() != 0 || !empty.toScanDataPolar().getPoints().empty())
+        {
+            fail("An empty RollingScan did not report an empty window");
+        }
+
+        SectorFedDriver driver;
+        int windows = 0;
+        int mismatchedWindows = 0;
+
+        driver.registerRollingScanCallback([&](const RollingScan& rollingScan)
+        {
+            // A window grows to a revolution of sectors, and then moves on by a sector every sector
+            std::size_t expectedSectorCount = std::min(windows + 1, SECTORS_PER_REVOLUTION);
+            const internal::ScanData& newest = sectors[windows % SECTORS_PER_REVOLUTION];
+            const internal::ScanData& oldest = sectors[(windows + 1 - expectedSectorCount) % SECTORS_PER_REVOLUTION];
+
+            mismatchedWindows += rollingScan.getSectorCount() != expectedSectorCount ||
+                rollingScan.getPointCount() != expectedSectorCount * POINTS_PER_SECTOR ||
+                std::fabs(rollingScan.getSpan_deg() - expectedSectorCount * 36.0) > 1e-9 ||
+                rollingScan.getSector(expectedSectorCount - 1).getStartAngle_deg() != newest.startAngle_deg ||
+                rollingScan.getSector(expectedSectorCount - 1).getRange_mm(7) != newest.dist_mm[7] ||
+                rollingScan.getSector(0).getStartAngle_deg() != oldest.startAngle_deg;
+
+            windows++;
+        });
+
+        for (int revolution = 0; revolution < 3; revolution++)
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        }
+
+        if (windows != 3 * SECTORS_PER_REVOLUTION || mismatchedWindows != 0)
+        {
+            fail("Driver did not publish the most recent 360 degrees on every sector");
+        }
+
+        // A lost sector leaves a gap, rather than a window which covers the same angles twice
+        RollingScan rollingScan;
+        for (int i = 0; i < SECTORS_PER_REVOLUTION + 7; i++)
+        {
+            const internal::ScanData& sector = sectors[i % SECTORS_PER_REVOLUTION];
+
+            if (i != SECTORS_PER_REVOLUTION + 5)
+            {
+                rollingScan.addSector(SectorView(sector.timestamp, sector.startAngle_deg, sector.endAngle_deg, sector.count, sector.dist_mm, sector.intensity, false));
+            }
+        }
+
+        if (rollingScan.getSectorCount() != SECTORS_PER_REVOLUTION - 1 || std::fabs(rollingScan.getSpan_deg() - 360) > 1e-9 ||
+            rollingScan.getSector(0).getStartAngle_deg() != 252 || rollingScan.toScanDataPolar().getPoints().size() != rollingScan.getPointCount())
+        {
+            fail("RollingScan did not drop the sectors covered again after a lost sector");
+        }
+
+        std::size_t points = 0;
+        driver.registerRollingScanCallback([&](const RollingScan& window)
+        {
+            points += window.getPointCount();
+        });
+
+        run("Driver::onScanDataReceived rolling scan", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+
+        doNotOptimize(&points);
+    }
+
+    static void runRegionOfInterestBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        // The front 120 degrees, across 0 degrees
+        RegionOfInterest front;
+        front.addArc(300, 60);
+
+        std::size_t firstIndices[RegionOfInterest::MAX_RUN_COUNT];
+        std::size_t endIndices[RegionOfInterest::MAX_RUN_COUNT];
+        int runCount = front.findRuns(POINTS_PER_SECTOR, 288, 0.18, firstIndices, endIndices);
+
+        if (runCount != 1 || firstIndices[0] != 67 || endIndices[0] != POINTS_PER_SECTOR ||
+            front.findRuns(POINTS_PER_SECTOR, 72, 0.18, firstIndices, endIndices) != 0 || !front.contains(359) || front.contains(60))
+        {
+            fail("RegionOfInterest did not find the points of a sector inside its arcs");
+        }
+
+        RegionOfInterest everything;
+        everything.addArc(0, 360);
+
+        if (!everything.isWholeRevolution() || !everything.contains(90) ||
+            everything.findRuns(POINTS_PER_SECTOR, 72, 0.18, firstIndices, endIndices) != 1 || endIndices[0] != POINTS_PER_SECTOR)
+        {
+            fail("RegionOfInterest did not take an arc from 0 to 360 degrees as the whole revolution");
+        }
+
+        SectorFedDriver driver;
+        driver.setRegionOfInterest(front);
+
+        std::vector<CompactScanData> scans;
+        std::size_t polarPointCount = 0;
+        std::size_t sectorViewPointCount = 0;
+        int sectorViewsOutside = 0;
+
+        driver.registerCompactScanCallback([&](const CompactScanData& scan)
+        {
+            scans.push_back(scan);
+        });
+
+        driver.registerScanCallback([&](const ScanDataPolar& scanDataPolar)
+        {
+            polarPointCount += scanDataPolar.getPoints().size();
+        });
+
+        driver.registerSectorCallback([&](const SectorView& sectorView)
+        {
+            sectorViewPointCount += sectorView.getPointCount();
+            sectorViewsOutside += !front.contains(sectorView.getAngle_deg(0)) || !front.contains(sectorView.getAngle_deg(sectorView.getPointCount() - 1));
+        });
+
+        for (int revolution = 0; revolution < 2; revolution++)
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        }
+
+        // 133 points from 300 degrees, two whole sectors, and 134 points up to 60 degrees
+        const std::size_t roiPointCount = 133 + 2 * POINTS_PER_SECTOR + 134;
+        bool masked = scans.size() == 2 && polarPointCount == 2 * roiPointCount && sectorViewPointCount == 2 * roiPointCount && sectorViewsOutside == 0;
+
+        for (std::size_t i = 0; masked && i < scans.size(); i++)
+        {
+            masked = scans[i].getPointCount() == roiPointCount;
+
+            for (std::size_t point = 0; masked && point < scans[i].getPointCount(); point++)
+            {
+                masked = front.contains(scans[i].getAngle_deg(point));
+            }
+        }
+
+        if (!masked)
+        {
+            fail("Driver published points outside the region of interest");
+        }
+
+        // Revolutions still end at the seam when the sector which ends them is outside the region
+        RegionOfInterest side;
+        side.addArc(90, 180);
+        driver.setRegionOfInterest(side);
+
+        scans.clear();
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        if (scans.size() != 1 || scans[0].getPointCount() != 500)
+        {
+            fail("Driver did not end a revolution at a sector outside the region of interest");
+        }
+
+        SectorFedDriver benchmarkDriver;
+        std::size_t points = 0;
+
+        benchmarkDriver.registerScanCallback([&](const ScanDataPolar& scanDataPolar)
+        {
+            points += scanDataPolar.getPoints().size();
+        });
+
+        RegionOfInterest half;
+        half.addArc(270, 90);
+        benchmarkDriver.setRegionOfInterest(half);
+
+        run("Driver::onScanDataReceived region of interest 180 deg", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR / 2, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                benchmarkDriver.feed(sector);
+            }
+        });
+
+        doNotOptimize(&points);
+    }
+
+    static void runDerivedScanStreamBenchmarks()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        // Revolutions 100ms apart, as at 10Hz, so the rate limit is measured on the sectors' own timestamps
+        std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+        auto feedRevolution = [&](SectorFedDriver& driver, int revolution)
+        {
+            for (int sector = 0; sector < SECTORS_PER_REVOLUTION; sector++)
+            {
+                sectors[sector].timestamp = start + std::chrono::milliseconds(100 * revolution + 10 * sector);
+                driver.feed(sectors[sector]);
+            }
+        };
+
+        // A group of points without a return, and a close point in the middle of another group
+        sectors[1].dist_mm[40] = sectors[1].dist_mm[41] = sectors[1].dist_mm[42] = sectors[1].dist_mm[43] = 0;
+        sectors[2].dist_mm[101] = 500;
+
+        SectorFedDriver driver;
+
+        DerivedScanStream::Settings strideSettings;
+        strideSettings.revolutionInterval = 3;
+        strideSettings.decimation = 4;
+
+        std::vector<CompactScanData> strideScans;
+        int strideStream = driver.addDerivedScanStream(strideSettings, [&](const CompactScanData& scan)
+        {
+            strideScans.push_back(scan);
+        });
+
+        DerivedScanStream::Settings closestSettings;
+        closestSettings.minimumPeriod = std::chrono::milliseconds(250);
+        closestSettings.decimation = 4;
+        closestSettings.decimationMode = DerivedScanStream::MinimumRangeDecimation;
+
+        std::vector<CompactScanData> closestScans;
+        driver.addDerivedScanStream(closestSettings, [&](const CompactScanData& scan)
+        {
+            closestScans.push_back(scan);
+        });
+
+        // The streams start with the first revolution after they were added, whichever sector it would have been
+        for (int revolution = 0; revolution < 10; revolution++)
+        {
+            feedRevolution(driver, revolution);
+        }
+
+        const std::size_t decimatedPointCount = SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR / 4;
+
+        if (strideScans.size() != 3 || strideScans[1].getTimestamp() != start + std::chrono::milliseconds(400) ||
+            closestScans.size() != 3 || closestScans[1].getTimestamp() != start + std::chrono::milliseconds(400))
+        {
+            fail("DerivedScanStream did not publish every third revolution, or one revolution per 250ms");
+            return;
+        }
+
+        for (std::size_t i = 0; i < decimatedPointCount; i++)
+        {
+            const internal::ScanData& sector = sectors[(i * 4) / POINTS_PER_SECTOR];
+            std::size_t index = (i * 4) % POINTS_PER_SECTOR;
+
+            if (strideScans[0].getPointCount() != decimatedPointCount || strideScans[0].getRange_mm(i) != sector.dist_mm[index] ||
+                std::fabs(strideScans[0].getAngle_deg(i) - (sector.startAngle_deg + 0.18 * index)) > 0.005)
+            {
+                fail("DerivedScanStream stride decimation did not keep every fourth point");
+                return;
+            }
+        }
+
+        // The close point is kept at its own angle, and the group without a return is still one point
+        const CompactScanData& closest = closestScans[0];
+        std::size_t closeGroup = (2 * POINTS_PER_SECTOR + 101) / 4;
+        std::size_t emptyGroup = (POINTS_PER_SECTOR + 40) / 4;
+
+        if (closest.getPointCount() != decimatedPointCount || closest.getRange_mm(closeGroup) != 500 ||
+            std::fabs(closest.getAngle_deg(closeGroup) - (72 + 0.18 * 101)) > 0.005 || closest.getRange_mm(emptyGroup) != 0 ||
+            closest.getRange_mm(0) != sectors[0].dist_mm[0])
+        {
+            fail("DerivedScanStream minimum range decimation did not keep the closest point of each group");
+            return;
+        }
+
+        // Removing a stream stops its callback and leaves the other stream's revolutions counting on
+        driver.removeDerivedScanStream(strideStream);
+
+        for (int revolution = 10; revolution < 13; revolution++)
+        {
+            feedRevolution(driver, revolution);
+        }
+
+        if (strideScans.size() != 3 || closestScans.size() != 4 || closestScans[3].getTimestamp() != start + std::chrono::milliseconds(1000))
+        {
+            fail("DerivedScanStream was not removed, or the remaining stream lost its state");
+            return;
+        }
+
+        // A stream added part way through a revolution leaves the rest of it out, rather than publishing it as a whole one
+        for (int sector = 0; sector < SECTORS_PER_REVOLUTION / 2; sector++)
+        {
+            driver.feed(sectors[sector]);
+        }
+
+        std::vector<std::size_t> joinedPointCounts;
+        driver.addDerivedScanStream(DerivedScanStream::Settings(), [&](const CompactScanData& scan)
+        {
+            joinedPointCounts.push_back(scan.getPointCount());
+        });
+
+        for (int sector = SECTORS_PER_REVOLUTION / 2; sector < SECTORS_PER_REVOLUTION; sector++)
+        {
+            driver.feed(sectors[sector]);
+        }
+
+        feedRevolution(driver, 14);
+
+        if (joinedPointCounts.size() != 1 || joinedPointCounts[0] != SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR)
+        {
+            fail("DerivedScanStream added part way through a revolution published a partial revolution");
+            return;
+        }
+
+        std::vector<internal::ScanData> benchmarkSectors = createSectors();
+
+        SectorFedDriver compactDriver;
+        compactDriver.registerCompactScanCallback([](const CompactScanData& scan)
+        {
+            doNotOptimize(&scan);
+        });
+
+        run("Driver::onScanDataReceived CompactScanData every revolution", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : benchmarkSectors)
+            {
+                compactDriver.feed(sector);
+            }
+        });
+
+        SectorFedDriver derivedDriver;
+        DerivedScanStream::Settings settings;
+        settings.revolutionInterval = 5;
+        settings.decimation = 4;
+        settings.decimationMode = DerivedScanStream::MinimumRangeDecimation;
+
+        derivedDriver.addDerivedScanStream(settings, [](const CompactScanData& scan)
+        {
+            doNotOptimize(&scan);
+        });
+
+        run("Driver::onScanDataReceived derived stream every 5th revolution, 1 in 4 points", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : benchmarkSectors)
+            {
+                derivedDriver.feed(sector);
+            }
+        });
+    }
+
+    static void runFilteredDriverBenchmark()
+    {
+        std::vector<internal::ScanData> sectors = createSectors();
+
+        SectorFedDriver driver;
+        CompactScanData compactScanData;
+
+        driver.registerCompactScanCallback([&](const CompactScanData& scanData)
+        {
+            compactScanData = scanData;
+        });
+
+        FilterPipeline::Settings settings;
+        settings.rangeMaskEnabled = true;
+        settings.maximumRange_mm = 3000;
+        settings.smoothing = FilterPipeline::MedianSmoothing;
+        driver.setFilterSettings(settings);
+
+        for (const internal::ScanData& sector : sectors)
+        {
+            driver.feed(sector);
+        }
+
+        for (std::size_t i = 0; i < compactScanData.getPointCount(); i++)
+        {
+            if (compactScanData.getRange_mm(i) > 3000 || (compactScanData.getRange_mm(i) == 0 && compactScanData.getIntensity(i) != 0))
+            {
+                fail("Driver did not filter the sectors before publishing them");
+                return;
+            }
+        }
+
+        run("Driver::onScanDataReceived filtered CompactScanData", Work(0, SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR, SECTORS_PER_REVOLUTION), [&]()
+        {
+            for (const internal::ScanData& sector : sectors)
+            {
+                driver.feed(sector);
+            }
+        });
+    }
+
+    static void runTransformBenchmarks()
+    {
+        std::vector<PointPolar> points;
+        int pointCount = SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR;
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            points.push_back(PointPolar(2000 + i % 3000, 360.0 * i / pointCount, static_cast<std::uint16_t>(i % 256)));
+        }
+
+        ScanDataPolar scanDataPolar(points, std::chrono::system_clock::now());
+        ScanDataXY scanDataXY = util::transform(scanDataPolar);
+        ScanDataPolar roundTrip = util::transform(scanDataXY);
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            if (std::fabs(roundTrip.getPoints()[i].getRange_mm() - points[i].getRange_mm()) > 1)
+            {
+                fail("util::transform did not round trip a polar scan through XY");
+                return;
+            }
+        }
+
+        run("util::transform polar to XY", Work(0, pointCount), [&]()
+        {
+            ScanDataXY result = util::transform(scanDataPolar);
+            doNotOptimize(result.getPoints().data());
+        });
+
+        PolarTransform<double> doubleTransform;
+        PolarTransform<double>::Columns doubleColumns;
+        doubleTransform.transform(scanDataPolar, doubleColumns);
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            if (doubleColumns.x_mm[i] != util::transform(points[i]).getX_mm() || doubleColumns.y_mm[i] != util::transform(points[i]).getY_mm())
+            {
+                fail("PolarTransform<double> does not match util::transform(const PointPolar&)");
+                return;
+            }
+        }
+
+        run("PolarTransform<double> columns", Work(0, pointCount), [&]()
+        {
+            doubleTransform.transform(scanDataPolar, doubleColumns);
+            doNotOptimize(doubleColumns.x_mm.data());
+        });
+
+        PolarTransform<float> floatTransform;
+        PolarTransform<float>::Columns floatColumns;
+        floatTransform.transform(scanDataPolar, floatColumns);
+
+        run("PolarTransform<float> columns", Work(0, pointCount), [&]()
+        {
+            floatTransform.transform(scanDataPolar, floatColumns);
+            doNotOptimize(floatColumns.x_mm.data());
+        });
+
+        std::vector<float> ranges_mm(floatColumns.x_mm.size());
+        std::vector<float> angles_deg(floatColumns.x_mm.size());
+        for (int i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = static_cast<float>(points[i].getRange_mm());
+            angles_deg[i] = static_cast<float>(points[i].getAngle_deg());
+        }
+
+        run("PolarTransform<float> kernel", Work(0, pointCount), [&]()
+        {
+            floatTransform.transform(pointCount, ranges_mm.data(), angles_deg.data(), floatColumns.x_mm.data(), floatColumns.y_mm.data());
+            doNotOptimize(floatColumns.x_mm.data());
+        });
+
+        run("PolarTransform<double> pooled", Work(0, pointCount), [&]()
+        {
+            std::shared_ptr<const PolarTransform<double>::Columns> columns = doubleTransform.transform(scanDataPolar);
+            doNotOptimize(columns->x_mm.data());
+        });
+
+        if (doubleTransform.getLayoutBuildCount() != 1 || floatTransform.getLayoutBuildCount() != 1)
+        {
+            fail("PolarTransform rebuilt the tables of a layout it had already seen");
+        }
+
+        run("util::transform XY to polar", Work(0, pointCount), [&]()
+        {
+            ScanDataPolar result = util::transform(scanDataXY);
+            doNotOptimize(result.getPoints().data());
+        });
+    }
+
+    void runDriverBenchmarks()
+    {
+        runOnScanDataReceivedBenchmark();
+        runBasicScanDataBenchmark<BasicPointPolar<double>>("BasicPointPolar<double>");
+        runBasicScanDataBenchmark<BasicPointPolar<float, false>>("BasicPointPolar<float, false>");
+        runBasicScanDataBenchmark<BasicPointPolar<Fixed16>>("BasicPointPolar<Fixed16>");
+        runCompactScanDataBenchmarks();
+        runCachedScanBenchmarks();
+        runGridScanBenchmarks();
+        runRangeIndexBenchmarks();
+        runProtectiveFieldBenchmarks();
+        runSectorCallbackBenchmarks();
+        runSeamBenchmarks();
+        runRollingScanBenchmarks();
+        runRegionOfInterestBenchmarks();
+        runDerivedScanStreamBenchmarks();
+        runFilteredDriverBenchmark();
+        runTransformBenchmarks();
+    }
+}
+}
+}
@@ -0,0 +1,333 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <parakeet/FilterPipeline.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    const int FILTER_POINT_COUNT = 1000;
+    const double FILTER_START_ANGLE_DEG = 324;
+    const double FILTER_ANGLE_PER_POINT_DEG = 0.072;
+
+    static void createSector(std::vector<std::uint16_t>& ranges_mm, std::vector<std::uint8_t>& intensities)
+    {
+        ranges_mm.resize(FILTER_POINT_COUNT);
+        intensities.resize(FILTER_POINT_COUNT);
+
+        for (int i = 0; i < FILTER_POINT_COUNT; i++)
+        {
+            // A wall with a little noise, and a step every 100 points
+            ranges_mm[i] = static_cast<std::uint16_t>(2000 + (i / 100) * 500 + (i * 7919) % 11);
+            intensities[i] = static_cast<std::uint8_t>(50 + i % 150);
+        }
+    }
+
+    // A static wall measured over several revolutions with +-20mm of noise, then moved 1m away
+    static bool verifyTemporalFilter(FilterPipeline::TemporalFiltering temporalFiltering, const std::string& name)
+    {
+        const int REVOLUTION_COUNT = 20;
+
+        FilterPipeline filterPipeline;
+        FilterPipeline::Settings settings;
+        settings.temporalFiltering = temporalFiltering;
+        settings.temporalBinWidth_deg = 0.05;
+        settings.temporalRevolutionCount = 5;
+        settings.temporalResetDistance_mm = 100;
+        filterPipeline.setSettings(settings);
+
+        std::vector<std::uint16_t> ranges_mm(FILTER_POINT_COUNT);
+        std::vector<std::uint8_t> intensities(FILTER_POINT_COUNT, 100);
+        std::uint32_t noise = 12345;
+        double rawError = 0;
+        double filteredError = 0;
+
+        for (int revolution = 0; revolution <= REVOLUTION_COUNT; revolution++)
+        {
+            int wall_mm = revolution < REVOLUTION_COUNT ? 2000 : 3000;
+
+            for (int i = 0; i < FILTER_POINT_COUNT; i++)
+            {
+                noise = noise * 1664525 + 1013904223;
+                ranges_mm[i] = static_cast<std::uint16_t>(wall_mm - 20 + static_cast<int>((noise >> 16) % 41));
+            }
+
+            if (revolution >= 5 && revolution < REVOLUTION_COUNT)
+            {
+                for (int i = 0; i < FILTER_POINT_COUNT; i++)
+                {
+                    rawError += std::abs(ranges_mm[i] - wall_mm);
+                }
+            }
+
+            filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+            if (revolution >= 5 && revolution < REVOLUTION_COUNT)
+            {
+                for (int i = 0; i < FILTER_POINT_COUNT; i++)
+                {
+                    filteredError += std::abs(ranges_mm[i] - wall_mm);
+                }
+            }
+        }
+
+        if (filteredError > rawError * 0.7)
+        {
+            fail("FilterPipeline " + name + " temporal filtering did not reduce the noise of a static wall");
+            return false;
+        }
+
+        for (int i = 0; i < FILTER_POINT_COUNT; i++)
+        {
+            if (std::abs(ranges_mm[i] - 3000) > 20)
+            {
+                fail("FilterPipeline " + name + " temporal filtering smeared a wall which moved");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool verifyFilters()
+    {
+        FilterPipeline filterPipeline;
+        std::vector<std::uint16_t> ranges_mm;
+        std::vector<std::uint8_t> intensities;
+
+        FilterPipeline::Settings settings;
+        settings.rangeMaskEnabled = true;
+        settings.minimumRange_mm = 2100;
+        settings.maximumRange_mm = 6000;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+        if (ranges_mm[0] != 0 || intensities[0] != 0 || ranges_mm[500] == 0 || ranges_mm[999] != 0)
+        {
+            fail("FilterPipeline range mask kept or removed the wrong points");
+            return false;
+        }
+
+        // An arc across 0 degrees, the sector runs from 324 to 36 degrees so points 500 to 555 are masked
+        settings = FilterPipeline::Settings();
+        settings.angleMaskCount = 1;
+        settings.angleMasks[0].startAngle_deg = 359.99;
+        settings.angleMasks[0].endAngle_deg = 4;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+        if (ranges_mm[499] == 0 || ranges_mm[500] != 0 || ranges_mm[555] != 0 || ranges_mm[556] == 0)
+        {
+            fail("FilterPipeline angle mask across 0 degrees kept or removed the wrong points");
+            return false;
+        }
+
+        settings = FilterPipeline::Settings();
+        settings.minimumIntensity = 100;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+        if (ranges_mm[0] != 0 || ranges_mm[50] == 0)
+        {
+            fail("FilterPipeline intensity threshold kept or removed the wrong points");
+            return false;
+        }
+
+        // A wall at 1m in front of a wall at 3m, with mixed returns trailing between the two
+        settings = FilterPipeline::Settings();
+        settings.veilingPointRemovalEnabled = true;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        for (int i = 0; i < FILTER_POINT_COUNT; i++)
+        {
+            ranges_mm[i] = static_cast<std::uint16_t>(i < 500 ? 1000 + i % 7 : (i < 505 ? 1000 + (i - 499) * 333 : 3000 + i % 7));
+        }
+
+        FilterPipeline::Statistics statisticsBefore = filterPipeline.getStatistics();
+        std::size_t removedCount = filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+        FilterPipeline::Statistics statisticsAfter = filterPipeline.getStatistics();
+
+        // The veil, and the first point of the far wall, which is seen past the veil at the same grazing angle
+        bool veilRemoved = true;
+        for (int i = 500; i <= 505; i++)
+        {
+            veilRemoved = veilRemoved && ranges_mm[i] == 0;
+        }
+
+        if (!veilRemoved || ranges_mm[499] == 0 || ranges_mm[506] == 0 || removedCount != 6 ||
+            statisticsAfter.veilingPointsRemoved - statisticsBefore.veilingPointsRemoved != 6 || statisticsAfter.pointsRemoved - statisticsBefore.pointsRemoved != 6)
+        {
+            fail("FilterPipeline veiling point removal kept or removed the wrong points");
+            return false;
+        }
+
+        settings = FilterPipeline::Settings();
+        settings.isolatedPointRemovalEnabled = true;
+        settings.isolationRadius = 2;
+        settings.isolationDistance_mm = 50;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        ranges_mm[300] = 9000;
+        ranges_mm[651] = 0;
+        ranges_mm[652] = 0;
+        ranges_mm[653] = 0;
+        ranges_mm[654] = 0;
+        filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+        if (ranges_mm[300] != 0 || ranges_mm[299] == 0 || ranges_mm[650] == 0 || ranges_mm[0] == 0)
+        {
+            fail("FilterPipeline isolated point removal kept or removed the wrong points");
+            return false;
+        }
+
+        for (int radius = 1; radius <= FilterPipeline::MAX_SMOOTHING_RADIUS; radius++)
+        {
+            settings = FilterPipeline::Settings();
+            settings.smoothing = FilterPipeline::MedianSmoothing;
+            settings.smoothingRadius = radius;
+            filterPipeline.setSettings(settings);
+
+            createSector(ranges_mm, intensities);
+            std::uint16_t neighbor_mm = ranges_mm[349];
+            ranges_mm[350] = 9000;
+            ranges_mm[700] = 0;
+            filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+            if (ranges_mm[350] > neighbor_mm + 20 || ranges_mm[700] != 0 || ranges_mm[400] < 4000)
+            {
+                fail("FilterPipeline median smoothing did not remove a spike, or moved an edge");
+                return false;
+            }
+        }
+
+        if (!verifyTemporalFilter(FilterPipeline::ExponentialTemporalFiltering, "exponential") ||
+            !verifyTemporalFilter(FilterPipeline::MedianTemporalFiltering, "median"))
+        {
+            return false;
+        }
+
+        settings = FilterPipeline::Settings();
+        settings.smoothing = FilterPipeline::BilateralSmoothing;
+        settings.smoothingRadius = 2;
+        settings.bilateralRangeSigma_mm = 30;
+        filterPipeline.setSettings(settings);
+
+        createSector(ranges_mm, intensities);
+        filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+
+        // The step between points 99 and 100 is 500mm, far outside the range sigma, so it stays sharp
+        if (ranges_mm[99] > 2011 || ranges_mm[100] < 2500)
+        {
+            fail("FilterPipeline bilateral smoothing blurred across an edge");
+            return false;
+        }
+
+        return true;
+    }
+
+    static void runStageBenchmark(const std::string& name, const FilterPipeline::Settings& settings)
+    {
+        FilterPipeline filterPipeline;
+        filterPipeline.setSettings(settings);
+
+        std::vector<std::uint16_t> sourceRanges_mm;
+        std::vector<std::uint8_t> sourceIntensities;
+        createSector(sourceRanges_mm, sourceIntensities);
+
+        std::vector<std::uint16_t> ranges_mm(sourceRanges_mm);
+        std::vector<std::uint8_t> intensities(sourceIntensities);
+
+        run("FilterPipeline " + name, Work(0, FILTER_POINT_COUNT, 1), [&]()
+        {
+            std::memcpy(ranges_mm.data(), sourceRanges_mm.data(), ranges_mm.size() * sizeof(std::uint16_t));
+            std::memcpy(intensities.data(), sourceIntensities.data(), intensities.size());
+
+            filterPipeline.apply(ranges_mm.size(), FILTER_START_ANGLE_DEG, FILTER_ANGLE_PER_POINT_DEG, ranges_mm.data(), intensities.data());
+            doNotOptimize(ranges_mm.data());
+        });
+    }
+
+    void runFilterBenchmarks()
+    {
+        if (!verifyFilters())
+        {
+            return;
+        }
+
+        FilterPipeline::Settings settings;
+        settings.rangeMaskEnabled = true;
+        settings.minimumRange_mm = 2100;
+        settings.maximumRange_mm = 6000;
+        runStageBenchmark("range mask", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.angleMaskCount = 2;
+        settings.angleMasks[0].startAngle_deg = 350;
+        settings.angleMasks[0].endAngle_deg = 10;
+        settings.angleMasks[1].startAngle_deg = 20;
+        settings.angleMasks[1].endAngle_deg = 25;
+        runStageBenchmark("2 angle masks", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.minimumIntensity = 100;
+        runStageBenchmark("intensity threshold", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.veilingPointRemovalEnabled = true;
+        settings.veilingRadius = 2;
+        runStageBenchmark("veiling points, radius 2", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.isolatedPointRemovalEnabled = true;
+        settings.isolationRadius = 2;
+        runStageBenchmark("isolated points, radius 2", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.temporalFiltering = FilterPipeline::ExponentialTemporalFiltering;
+        runStageBenchmark("temporal exponential", settings);
+
+        settings.temporalFiltering = FilterPipeline::MedianTemporalFiltering;
+        settings.temporalRevolutionCount = 5;
+        runStageBenchmark("temporal median of 5", settings);
+
+        settings = FilterPipeline::Settings();
+        settings.smoothing = FilterPipeline::MedianSmoothing;
+        settings.smoothingRadius = 1;
+        runStageBenchmark("median of 3", settings);
+
+        settings.smoothingRadius = 2;
+        runStageBenchmark("median of 5", settings);
+
+        settings.smoothing = FilterPipeline::BilateralSmoothing;
+        runStageBenchmark("bilateral, radius 2", settings);
+
+        settings.rangeMaskEnabled = true;
+        settings.minimumRange_mm = 100;
+        settings.minimumIntensity = 10;
+        settings.isolatedPointRemovalEnabled = true;
+        settings.veilingPointRemovalEnabled = true;
+        runStageBenchmark("all stages", settings);
+    }
+}
+}
+}
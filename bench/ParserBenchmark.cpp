@@ -0,0 +1,249 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <parakeet/Pro/internal/Parser.h>
+#include <parakeet/Pro/internal/Protocol.h>
+#include <parakeet/ProE/internal/Parser.h>
+#include <parakeet/ProE/internal/Protocol.h>
+
+#include <cmath>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    const int POINTS_PER_SECTOR = 200;
+    const int PROE_POINTS_PER_REVOLUTION = 2000;
+    const int PROE_SECTORS_PER_REVOLUTION = 10;
+    const int PROE_POINTS_PER_DATAGRAM = 100;
+
+    static std::uint16_t roomDistance_mm(double angle_deg)
+    {
+        double offset_rad = (std::fmod(angle_deg, 90) - 45) * 3.14159265358979323846 / 180;
+        return static_cast<std::uint16_t>(3000 / std::cos(offset_rad));
+    }
+
+    // One revolution of a Parakeet Pro: ten 36 degree sectors back to back, as they arrive from the serial port
+    static std::vector<unsigned char> createProRevolution(bool intensity)
+    {
+        std::vector<unsigned char> stream;
+        std::vector<unsigned short> distances(POINTS_PER_SECTOR);
+        std::vector<unsigned char> intensities(POINTS_PER_SECTOR);
+
+        for (int sector = 0; sector < Pro::internal::SECTORS_PER_REVOLUTION; sector++)
+        {
+            double startAngle_deg = sector * Pro::internal::SECTOR_SIZE_DEG;
+
+            for (int i = 0; i < POINTS_PER_SECTOR; i++)
+            {
+                distances[i] = roomDistance_mm(startAngle_deg + Pro::internal::SECTOR_SIZE_DEG * i / double(POINTS_PER_SECTOR));
+                intensities[i] = static_cast<unsigned char>(i);
+            }
+
+            std::size_t position = stream.size();
+            stream.resize(position + Pro::internal::getSectorLength(POINTS_PER_SECTOR, intensity));
+            Pro::internal::buildSector(static_cast<unsigned short>(sector * Pro::internal::SECTOR_SIZE_DEG * 10), POINTS_PER_SECTOR,
+                distances.data(), intensity ? intensities.data() : nullptr, stream.data() + position);
+        }
+
+        return stream;
+    }
+
+    // One revolution of a Parakeet ProE: each sector split over several datagrams, as they arrive from the UDP socket
+    static std::vector<std::vector<unsigned char>> createProERevolution()
+    {
+        std::vector<std::vector<unsigned char>> datagrams;
+
+        int pointsPerSector = PROE_POINTS_PER_REVOLUTION / PROE_SECTORS_PER_REVOLUTION;
+        std::uint32_t sectorSize_mdeg = 360000 / PROE_SECTORS_PER_REVOLUTION;
+
+        std::vector<std::uint16_t> distances(PROE_POINTS_PER_DATAGRAM);
+        std::vector<std::uint16_t> relativeStartAngles(PROE_POINTS_PER_DATAGRAM);
+        std::vector<std::uint8_t> intensities(PROE_POINTS_PER_DATAGRAM);
+
+        for (int sector = 0; sector < PROE_SECTORS_PER_REVOLUTION; sector++)
+        {
+            for (int offset = 0; offset < pointsPerSector; offset += PROE_POINTS_PER_DATAGRAM)
+            {
+                ProE::internal::LidarMessage message = {};
+                message.numPoints = PROE_POINTS_PER_DATAGRAM;
+                message.numPointsInSector = static_cast<std::uint16_t>(pointsPerSector);
+                message.sectorDataOffset = static_cast<std::uint16_t>(offset);
+                message.startAngle = sector * sectorSize_mdeg;
+                message.endAngle = (sector + 1) * sectorSize_mdeg;
+                message.propertyFlags = 0x2;
+
+                for (int i = 0; i < PROE_POINTS_PER_DATAGRAM; i++)
+                {
+                    // Relative angles are in hundredths of a degree from the start of the sector
+                    std::uint32_t relativeAngle_cdeg = (offset + i) * (sectorSize_mdeg / 10) / pointsPerSector;
+
+                    distances[i] = roomDistance_mm((message.startAngle + relativeAngle_cdeg * 10) / 1000.0);
+                    relativeStartAngles[i] = static_cast<std::uint16_t>(relativeAngle_cdeg);
+                    intensities[i] = static_cast<std::uint8_t>(i);
+                }
+
+                message.distances = distances.data();
+                message.relativeStartAngles = relativeStartAngles.data();
+                message.intensities = intensities.data();
+
+                std::vector<unsigned char> datagram(ProE::internal::getLidarMessageLength(message.numPoints));
+                ProE::internal::buildLidarMessage(message, datagram.data());
+                datagrams.push_back(datagram);
+            }
+        }
+
+        return datagrams;
+    }
+
+    static void runProParserBenchmark(bool intensity)
+    {
+        std::vector<unsigned char> stream = createProRevolution(intensity);
+
+        int sectors = 0;
+        Pro::internal::MessageParser parser([&](const mechaspin::parakeet::internal::ScanData& scanData)
+        {
+            sectors++;
+            doNotOptimize(scanData.dist_mm);
+        },
+        [](const std::string&) {});
+        parser.setIntensityDataEnabled(intensity);
+
+        parser.parse(mechaspin::parakeet::internal::BufferData(stream.data(), static_cast<unsigned int>(stream.size())));
+        if (sectors != Pro::internal::SECTORS_PER_REVOLUTION || parser.getChecksumFailureCount() != 0)
+        {
+            fail("Pro::internal::MessageParser did not parse every sector of a revolution");
+            return;
+        }
+
+        std::uint64_t points = Pro::internal::SECTORS_PER_REVOLUTION * POINTS_PER_SECTOR;
+
+        run(std::string("Pro::MessageParser::parse ") + (intensity ? "3 byte points" : "2 byte points"),
+            Work(stream.size(), points, Pro::internal::SECTORS_PER_REVOLUTION), [&]()
+        {
+            parser.parse(mechaspin::parakeet::internal::BufferData(stream.data(), static_cast<unsigned int>(stream.size())));
+        });
+    }
+
+    static void runProEParserBenchmark()
+    {
+        std::vector<std::vector<unsigned char>> datagrams = createProERevolution();
+
+        int scans = 0;
+        std::size_t points = 0;
+        ProE::internal::MessageParser parser([&](const ProE::internal::MessageParser::CompleteLidarMessage& message)
+        {
+            scans++;
+            points += message.lidarPoints.size();
+        });
+
+        std::uint64_t bytes = 0;
+        for (std::vector<unsigned char>& datagram : datagrams)
+        {
+            bytes += datagram.size();
+        }
+
+        // The first revolution has no timestamp to interpolate from and is dropped, so parse two before checking
+        for (int revolution = 0; revolution < 2; revolution++)
+        {
+            for (std::vector<unsigned char>& datagram : datagrams)
+            {
+                parser.parse(mechaspin::parakeet::internal::BufferData(datagram.data(), static_cast<unsigned int>(datagram.size())));
+            }
+        }
+
+        if (scans == 0 || points != static_cast<std::size_t>(scans) * (PROE_POINTS_PER_REVOLUTION / PROE_SECTORS_PER_REVOLUTION))
+        {
+            fail("ProE::internal::MessageParser did not parse every point of a revolution");
+            return;
+        }
+
+        run("ProE::MessageParser::parse", Work(bytes, PROE_POINTS_PER_REVOLUTION, datagrams.size()), [&]()
+        {
+            for (std::vector<unsigned char>& datagram : datagrams)
+            {
+                parser.parse(mechaspin::parakeet::internal::BufferData(datagram.data(), static_cast<unsigned int>(datagram.size())));
+            }
+        });
+    }
+
+    static void runProEPartialSectorBenchmark()
+    {
+        std::vector<std::vector<unsigned char>> datagrams = createProERevolution();
+
+        int scans = 0;
+        int mismatchedScans = 0;
+        std::vector<std::uint16_t> partialDistances;
+
+        ProE::internal::MessageParser parser([&](const ProE::internal::MessageParser::CompleteLidarMessage& message)
+        {
+            scans++;
+
+            // Every point of the sector has already been handed over, in order
+            bool matches = partialDistances.size() == message.lidarPoints.size();
+            for (std::size_t i = 0; matches && i < partialDistances.size(); i++)
+            {
+                matches = partialDistances[i] == message.lidarPoints[i].distance;
+            }
+
+            mismatchedScans += !matches;
+        });
+
+        int partialSectors = 0;
+        parser.registerPartialSectorCallback([&](const ProE::internal::MessageParser::PartialSector& partialSector)
+        {
+            partialSectors++;
+
+            if (partialSector.sectorDataOffset == 0)
+            {
+                partialDistances.clear();
+            }
+
+            for (int i = 0; i < partialSector.numPoints; i++)
+            {
+                partialDistances.push_back(partialSector.lidarPoints[i].distance);
+            }
+        });
+
+        for (int revolution = 0; revolution < 2; revolution++)
+        {
+            for (std::vector<unsigned char>& datagram : datagrams)
+            {
+                parser.parse(mechaspin::parakeet::internal::BufferData(datagram.data(), static_cast<unsigned int>(datagram.size())));
+            }
+        }
+
+        // Only the very first datagram, and the sector it starts, have no timestamp
+        int datagramCount = static_cast<int>(datagrams.size());
+        if (partialSectors != 2 * datagramCount - 1 || scans != 2 * PROE_SECTORS_PER_REVOLUTION - 1 || mismatchedScans != 0)
+        {
+            fail("ProE::internal::MessageParser did not hand over each datagram of a sector before the complete sector");
+            return;
+        }
+
+        run("ProE::MessageParser::parse with partial sectors", Work(0, PROE_POINTS_PER_REVOLUTION, datagrams.size()), [&]()
+        {
+            for (std::vector<unsigned char>& datagram : datagrams)
+            {
+                parser.parse(mechaspin::parakeet::internal::BufferData(datagram.data(), static_cast<unsigned int>(datagram.size())));
+            }
+        });
+    }
+
+    void runParserBenchmarks()
+    {
+        runProParserBenchmark(false);
+        runProParserBenchmark(true);
+        runProEParserBenchmark();
+        runProEPartialSectorBenchmark();
+    }
+}
+}
+}
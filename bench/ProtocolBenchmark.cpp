@@ -0,0 +1,96 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <parakeet/Pro/internal/Protocol.h>
+#include <parakeet/ProE/internal/Protocol.h>
+
+#include <cstring>
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    static void runCommandMessageBenchmarks()
+    {
+        unsigned char buffer[256];
+        const std::string command = ProE::internal::SW_SET_SPEED(600);
+
+        unsigned int length = ProE::internal::buildCommandMessage(command, ProE::internal::UDP_MESSAGE_CMD, 7, buffer);
+
+        ProE::internal::CmdHeader header;
+        std::string message;
+        if (!ProE::internal::parseCommandMessage(buffer, length, header, message) || message != command || header.sn != 7)
+        {
+            fail("ProE::internal::buildCommandMessage did not build a command parseCommandMessage accepts");
+            return;
+        }
+
+        unsigned int words = (length - sizeof(unsigned int)) / sizeof(unsigned int);
+        unsigned int aligned[64];
+        std::memcpy(aligned, buffer, length);
+
+        run("ProE::calculateEndOfMessageCRC", Work(words * sizeof(unsigned int), 0, 1), [&]()
+        {
+            unsigned int crc = ProE::internal::calculateEndOfMessageCRC(aligned, words);
+            doNotOptimize(&crc);
+        });
+
+        run("ProE::buildCommandMessage", Work(length, 0, 1), [&]()
+        {
+            ProE::internal::buildCommandMessage(command, ProE::internal::UDP_MESSAGE_CMD, 7, buffer);
+            doNotOptimize(buffer);
+        });
+    }
+
+    static void runCommandStringBenchmarks()
+    {
+        if (Pro::internal::SW_SET_SPEED(600) != "LSRPM:600H" || ProE::internal::SW_SET_SPEED(900) != "LSRPM:900H")
+        {
+            fail("The speed commands are not built as LSRPM:<rpm>H");
+            return;
+        }
+
+        run("Pro::SW_SET_SPEED", Work(0, 0, 1), [&]()
+        {
+            std::string command = Pro::internal::SW_SET_SPEED(600);
+            doNotOptimize(command.data());
+        });
+
+        run("Pro::SW_SET_BAUD_RATE", Work(0, 0, 1), [&]()
+        {
+            std::string command = Pro::internal::SW_SET_BAUD_RATE(768000);
+            doNotOptimize(command.data());
+        });
+
+        run("ProE::SW_SET_DATA_SMOOTHING", Work(0, 0, 1), [&]()
+        {
+            std::string command = ProE::internal::SW_SET_DATA_SMOOTHING(true);
+            doNotOptimize(command.data());
+        });
+
+        const unsigned char ipAddress[] = { 192, 168, 158, 98 };
+        const unsigned char subnetMask[] = { 255, 255, 255, 0 };
+        const unsigned char gateway[] = { 192, 168, 158, 1 };
+
+        run("ProE::SW_SET_SRC_IPV4_PROPERTIES", Work(0, 0, 1), [&]()
+        {
+            std::string command = ProE::internal::SW_SET_SRC_IPV4_PROPERTIES(ipAddress, subnetMask, gateway, 6543);
+            doNotOptimize(command.data());
+        });
+    }
+
+    void runProtocolBenchmarks()
+    {
+        runCommandMessageBenchmarks();
+        runCommandStringBenchmarks();
+    }
+}
+}
+}
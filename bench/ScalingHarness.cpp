@@ -0,0 +1,552 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "ProEEmulator.h"
+
+#include <parakeet/ProE/Driver.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every allocation made by the process is counted, so the allocations made by the drivers per scan can be reported
+static std::atomic<std::uint64_t> allocationCount{0};
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    using mechaspin::parakeet::emulators::ProEEmulator;
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // A revolution whose scan has not arrived this long after it was sent is counted as dropped
+    const std::chrono::seconds DROP_TIMEOUT(1);
+    const std::chrono::seconds WARM_UP_TIMEOUT(10);
+    const int WARM_UP_SCANS = 3;
+
+    // Revolutions which have been sent but not yet received, per sensor
+    const std::size_t MAXIMUM_PENDING_REVOLUTIONS = 64;
+
+    struct Settings
+    {
+        std::vector<int> sensorCounts = { 1, 2, 4, 8, 16, 32, 64 };
+        double duration_s = 5;
+        int pointsPerRevolution = 2000;
+        int pointsPerDatagram = 100;
+        double lossRate = 0;
+        unsigned short sensorPort = 6543;
+        unsigned short driverPort = 6668;
+        std::string reportPath = "parakeet_scaling_report.json";
+    };
+
+    // Matches the revolutions one emulated sensor sends to the scans its driver publishes
+    class SensorProbe
+    {
+        public:
+            void onRevolutionSent(TimePoint sentTime)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                if (pendingCount == MAXIMUM_PENDING_REVOLUTIONS)
+                {
+                    popPending();
+                    dropped++;
+                }
+
+                pending[(pendingFirst + pendingCount) % MAXIMUM_PENDING_REVOLUTIONS] = sentTime;
+                pendingCount++;
+                sent++;
+            }
+
+            void onScanReceived(std::size_t pointCount)
+            {
+                TimePoint receivedTime = std::chrono::steady_clock::now();
+
+                std::lock_guard<std::mutex> lock(mutex);
+
+                // The scan belongs to the latest revolution sent before it arrived, earlier ones never made it
+                bool matched = false;
+                TimePoint sentTime;
+
+                while (pendingCount > 0 && pending[pendingFirst] <= receivedTime)
+                {
+                    if (matched)
+                    {
+                        dropped++;
+                    }
+
+                    sentTime = popPending();
+                    matched = true;
+                }
+
+                if (!matched)
+                {
+                    unmatched++;
+                    return;
+                }
+
+                received++;
+                points += pointCount;
+
+                if (latencies_us.size() < latencies_us.capacity())
+                {
+                    latencies_us.push_back(std::chrono::duration<double, std::micro>(receivedTime - sentTime).count());
+                }
+            }
+
+            void reset(std::size_t expectedScans)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                latencies_us.clear();
+                latencies_us.reserve(expectedScans);
+                pendingCount = 0;
+                sent = received = dropped = unmatched = points = 0;
+            }
+
+            struct Result
+            {
+                std::uint64_t sent;
+                std::uint64_t received;
+                std::uint64_t dropped;
+                std::uint64_t points;
+                std::vector<double> latencies_us;
+            };
+
+            Result collect()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                TimePoint now = std::chrono::steady_clock::now();
+                std::uint64_t expired = 0;
+
+                for (std::size_t i = 0; i < pendingCount; i++)
+                {
+                    expired += now - pending[(pendingFirst + i) % MAXIMUM_PENDING_REVOLUTIONS] > DROP_TIMEOUT ? 1 : 0;
+                }
+
+                Result result;
+                result.sent = sent;
+                result.received = received;
+                result.dropped = dropped + expired;
+                result.points = points;
+                result.latencies_us = latencies_us;
+
+                return result;
+            }
+
+            std::uint64_t getReceivedCount()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return received;
+            }
+
+        private:
+            TimePoint popPending()
+            {
+                TimePoint first = pending[pendingFirst];
+                pendingFirst = (pendingFirst + 1) % MAXIMUM_PENDING_REVOLUTIONS;
+                pendingCount--;
+
+                return first;
+            }
+
+            std::mutex mutex;
+            TimePoint pending[MAXIMUM_PENDING_REVOLUTIONS];
+            std::size_t pendingFirst = 0;
+            std::size_t pendingCount = 0;
+
+            std::uint64_t sent = 0;
+            std::uint64_t received = 0;
+            std::uint64_t dropped = 0;
+            std::uint64_t unmatched = 0;
+            std::uint64_t points = 0;
+            std::vector<double> latencies_us;
+    };
+
+    struct StepResult
+    {
+        int sensorCount;
+        int respondingSensorCount;
+        double duration_s;
+        std::uint64_t revolutionsSent;
+        std::uint64_t scansReceived;
+        std::uint64_t scansDropped;
+        double pointsPerSecond;
+        double latencyP50_us;
+        double latencyP99_us;
+        double latencyP999_us;
+        double latencyMaximum_us;
+        double cpuPercentPerSensor;
+        double allocationsPerScan;
+    };
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+        {
+            return 0;
+        }
+
+        std::size_t index = static_cast<std::size_t>(fraction * sorted.size());
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    // The processor time used by the whole process, std::clock measures wall time on Windows
+    double getProcessCpuTime_s()
+    {
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    }
+
+    double getEmulatorCpuTime_s(const std::vector<std::unique_ptr<ProEEmulator>>& emulators)
+    {
+        double cpuTime_s = 0;
+
+        for (const std::unique_ptr<ProEEmulator>& emulator : emulators)
+        {
+            cpuTime_s += emulator->getStatistics().dataThreadCpuTime.count() / 1e6;
+        }
+
+        return cpuTime_s;
+    }
+
+    StepResult runStep(const Settings& settings, int sensorCount)
+    {
+        using namespace mechaspin::parakeet;
+
+        std::vector<std::unique_ptr<SensorProbe>> probes;
+        std::vector<std::unique_ptr<ProEEmulator>> emulators;
+        std::vector<std::unique_ptr<ProE::Driver>> drivers;
+
+        for (int i = 0; i < sensorCount; i++)
+        {
+            probes.emplace_back(new SensorProbe());
+            SensorProbe* probe = probes.back().get();
+
+            ProEEmulator::Configuration configuration;
+            configuration.sensorPort = static_cast<unsigned short>(settings.sensorPort + i);
+            configuration.destinationPort = static_cast<unsigned short>(settings.driverPort + i);
+            configuration.pointsPerRevolution = settings.pointsPerRevolution;
+            configuration.maximumPointsPerDatagram = settings.pointsPerDatagram;
+            configuration.lossRate = settings.lossRate;
+            configuration.seed = i + 1;
+
+            emulators.emplace_back(new ProEEmulator(configuration));
+            emulators.back()->registerRevolutionCallback([probe](TimePoint sentTime)
+            {
+                probe->onRevolutionSent(sentTime);
+            });
+            emulators.back()->start();
+
+            drivers.emplace_back(new ProE::Driver());
+            drivers.back()->registerScanCallback([probe](const ScanDataPolar& scanDataPolar)
+            {
+                probe->onScanReceived(scanDataPolar.getPoints().size());
+            });
+            drivers.back()->connect(ProE::Driver::SensorConfiguration("127.0.0.1", configuration.sensorPort, configuration.destinationPort,
+                true, Driver::ScanningFrequency::Frequency_10Hz, false, false, false));
+        }
+
+        for (std::unique_ptr<ProE::Driver>& driver : drivers)
+        {
+            driver->start();
+        }
+
+        // Wait for every sensor to stream, so start up is not measured
+        TimePoint warmUpEndTime = std::chrono::steady_clock::now() + WARM_UP_TIMEOUT;
+        int respondingSensorCount = 0;
+
+        while (std::chrono::steady_clock::now() < warmUpEndTime)
+        {
+            respondingSensorCount = 0;
+            for (std::unique_ptr<SensorProbe>& probe : probes)
+            {
+                respondingSensorCount += probe->getReceivedCount() >= WARM_UP_SCANS ? 1 : 0;
+            }
+
+            if (respondingSensorCount == sensorCount)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        std::size_t expectedScans = static_cast<std::size_t>(settings.duration_s * Driver::ScanningFrequency::Frequency_10Hz * 2) + 16;
+        for (std::unique_ptr<SensorProbe>& probe : probes)
+        {
+            probe->reset(expectedScans);
+        }
+
+        double processCpuTimeAtStart_s = getProcessCpuTime_s();
+        double emulatorCpuTimeAtStart_s = getEmulatorCpuTime_s(emulators);
+        std::uint64_t allocationsAtStart = allocationCount;
+        TimePoint startTime = std::chrono::steady_clock::now();
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(settings.duration_s));
+
+        std::vector<SensorProbe::Result> results;
+        for (std::unique_ptr<SensorProbe>& probe : probes)
+        {
+            results.push_back(probe->collect());
+        }
+
+        double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        double driverCpuTime_s = (getProcessCpuTime_s() - processCpuTimeAtStart_s) - (getEmulatorCpuTime_s(emulators) - emulatorCpuTimeAtStart_s);
+        std::uint64_t allocations = allocationCount - allocationsAtStart;
+
+        for (std::unique_ptr<ProE::Driver>& driver : drivers)
+        {
+            driver->stop();
+        }
+
+        for (std::unique_ptr<ProEEmulator>& emulator : emulators)
+        {
+            emulator->requestStop();
+        }
+
+        for (std::unique_ptr<ProEEmulator>& emulator : emulators)
+        {
+            emulator->stop();
+        }
+
+        for (std::unique_ptr<ProE::Driver>& driver : drivers)
+        {
+            driver->close();
+        }
+
+        StepResult stepResult = {};
+        stepResult.sensorCount = sensorCount;
+        stepResult.respondingSensorCount = respondingSensorCount;
+        stepResult.duration_s = elapsed_s;
+
+        std::vector<double> latencies_us;
+        std::uint64_t points = 0;
+
+        for (SensorProbe::Result& result : results)
+        {
+            stepResult.revolutionsSent += result.sent;
+            stepResult.scansReceived += result.received;
+            stepResult.scansDropped += result.dropped;
+            points += result.points;
+
+            latencies_us.insert(latencies_us.end(), result.latencies_us.begin(), result.latencies_us.end());
+        }
+
+        std::sort(latencies_us.begin(), latencies_us.end());
+
+        stepResult.pointsPerSecond = points / elapsed_s;
+        stepResult.latencyP50_us = percentile(latencies_us, 0.5);
+        stepResult.latencyP99_us = percentile(latencies_us, 0.99);
+        stepResult.latencyP999_us = percentile(latencies_us, 0.999);
+        stepResult.latencyMaximum_us = latencies_us.empty() ? 0 : latencies_us.back();
+        stepResult.cpuPercentPerSensor = 100 * std::max(driverCpuTime_s, 0.0) / elapsed_s / sensorCount;
+        stepResult.allocationsPerScan = stepResult.scansReceived > 0 ? static_cast<double>(allocations) / stepResult.scansReceived : 0;
+
+        return stepResult;
+    }
+
+    std::string toJson(const Settings& settings, const std::vector<StepResult>& stepResults)
+    {
+        std::ostringstream json;
+
+        json << "{\n"
+             << "  \"sensor\": \"ProE\",\n"
+             << "  \"transport\": \"udp loopback\",\n"
+             << "  \"scanning_frequency_hz\": " << static_cast<int>(mechaspin::parakeet::Driver::ScanningFrequency::Frequency_10Hz) << ",\n"
+             << "  \"points_per_revolution\": " << settings.pointsPerRevolution << ",\n"
+             << "  \"points_per_datagram\": " << settings.pointsPerDatagram << ",\n"
+             << "  \"loss_rate\": " << settings.lossRate << ",\n"
+             << "  \"steps\": [\n";
+
+        for (std::size_t i = 0; i < stepResults.size(); i++)
+        {
+            const StepResult& step = stepResults[i];
+
+            json << "    {"
+                 << "\"sensors\": " << step.sensorCount
+                 << ", \"responding_sensors\": " << step.respondingSensorCount
+                 << ", \"duration_s\": " << step.duration_s
+                 << ", \"revolutions_sent\": " << step.revolutionsSent
+                 << ", \"scans_received\": " << step.scansReceived
+                 << ", \"scans_dropped\": " << step.scansDropped
+                 << ", \"points_per_s\": " << step.pointsPerSecond
+                 << ", \"latency_us\": {\"p50\": " << step.latencyP50_us
+                 << ", \"p99\": " << step.latencyP99_us
+                 << ", \"p999\": " << step.latencyP999_us
+                 << ", \"max\": " << step.latencyMaximum_us << "}"
+                 << ", \"cpu_percent_per_sensor\": " << step.cpuPercentPerSensor
+                 << ", \"allocations_per_scan\": " << step.allocationsPerScan
+                 << "}" << (i + 1 < stepResults.size() ? "," : "") << "\n";
+        }
+
+        json << "  ]\n"
+             << "}\n";
+
+        return json.str();
+    }
+
+    std::vector<int> parseSensorCounts(const std::string& list)
+    {
+        std::vector<int> sensorCounts;
+        std::stringstream stream(list);
+        std::string item;
+
+        while (std::getline(stream, item, ','))
+        {
+            int sensorCount = atoi(item.c_str());
+            if (sensorCount > 0)
+            {
+                sensorCounts.push_back(sensorCount);
+            }
+        }
+
+        return sensorCounts;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Run this app via:" << std::endl
+                  << "./parakeet_scaling [options]" << std::endl
+                  << std::endl
+                  << "Runs emulated Parakeet ProE sensors against ProE::Driver over loopback, for each sensor count in turn" << std::endl
+                  << std::endl
+                  << "  --sensors N,N,...           Sensor counts to measure (1,2,4,8,16,32,64)" << std::endl
+                  << "  --duration SECONDS          Measurement time for each sensor count (5)" << std::endl
+                  << "  --points N                  Points per revolution (2000)" << std::endl
+                  << "  --points-per-datagram N     Most points in one datagram (100)" << std::endl
+                  << "  --loss RATE                 Chance of dropping each datagram, 0 to 1 (0)" << std::endl
+                  << "  --sensor-port PORT          Port the first emulated sensor receives commands on (6543)" << std::endl
+                  << "  --driver-port PORT          Port the first driver receives data on (6668)" << std::endl
+                  << "  --report FILE               Where the JSON report is written (parakeet_scaling_report.json)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (value == nullptr)
+        {
+            printUsage();
+            return -1;
+        }
+
+        if (argument == "--sensors")
+        {
+            settings.sensorCounts = parseSensorCounts(value);
+        }
+        else if (argument == "--duration")
+        {
+            settings.duration_s = atof(value);
+        }
+        else if (argument == "--points")
+        {
+            settings.pointsPerRevolution = atoi(value);
+        }
+        else if (argument == "--points-per-datagram")
+        {
+            settings.pointsPerDatagram = atoi(value);
+        }
+        else if (argument == "--loss")
+        {
+            settings.lossRate = atof(value);
+        }
+        else if (argument == "--sensor-port")
+        {
+            settings.sensorPort = static_cast<unsigned short>(atoi(value));
+        }
+        else if (argument == "--driver-port")
+        {
+            settings.driverPort = static_cast<unsigned short>(atoi(value));
+        }
+        else if (argument == "--report")
+        {
+            settings.reportPath = value;
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+    }
+
+    std::vector<StepResult> stepResults;
+
+    std::printf("%8s %10s %10s %8s %14s %10s %10s %10s %10s %12s\n",
+        "sensors", "responding", "scans", "dropped", "points/s", "p50 us", "p99 us", "p99.9 us", "cpu %", "allocs/scan");
+
+    for (int sensorCount : settings.sensorCounts)
+    {
+        StepResult step;
+
+        try
+        {
+            step = runStep(settings, sensorCount);
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cout << "Unable to run " << sensorCount << " sensors: " << error.what() << std::endl;
+            return -1;
+        }
+
+        stepResults.push_back(step);
+
+        std::printf("%8d %10d %10llu %8llu %14.0f %10.1f %10.1f %10.1f %10.2f %12.1f\n",
+            step.sensorCount, step.respondingSensorCount, static_cast<unsigned long long>(step.scansReceived), static_cast<unsigned long long>(step.scansDropped),
+            step.pointsPerSecond, step.latencyP50_us, step.latencyP99_us, step.latencyP999_us, step.cpuPercentPerSensor, step.allocationsPerScan);
+        std::fflush(stdout);
+    }
+
+    std::FILE* report = std::fopen(settings.reportPath.c_str(), "w");
+    if (report == nullptr)
+    {
+        std::cout << "Unable to write the report to " << settings.reportPath << std::endl;
+        return -1;
+    }
+
+    std::string json = toJson(settings, stepResults);
+    std::fwrite(json.data(), 1, json.size(), report);
+    std::fclose(report);
+
+    std::cout << "Report written to " << settings.reportPath << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <parakeet/ScanDecoder.h>
+#include <parakeet/ScanEncoder.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace bench
+{
+    const double PI = 3.14159265358979323846;
+    const int POINTS_PER_REVOLUTION = 1000;
+    const int SECTORS_PER_REVOLUTION = 10;
+    const int REVOLUTIONS = 16;
+
+    // A room seen by a sensor at 10Hz: smooth walls, a few range jumps at doorways, and a little noise between revolutions
+    static std::vector<ScanDataPolar> createRevolutions()
+    {
+        std::mt19937 random(42);
+        std::normal_distribution<double> noise(0, 4);
+
+        std::vector<ScanDataPolar> revolutions;
+        auto timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(1600000000));
+
+        for (int revolution = 0; revolution < REVOLUTIONS; revolution++)
+        {
+            std::vector<PointPolar> points;
+            int pointsPerSector = POINTS_PER_REVOLUTION / SECTORS_PER_REVOLUTION;
+
+            for (int sector = 0; sector < SECTORS_PER_REVOLUTION; sector++)
+            {
+                double startAngle_deg = sector * 36.0;
+                double anglePerPoint_deg = 36.0 / pointsPerSector;
+
+                for (int i = 0; i < pointsPerSector; i++)
+                {
+                    double angle_deg = startAngle_deg + anglePerPoint_deg * i;
+                    double wall_mm = 3000 / std::max(0.2, std::fabs(std::cos((std::fmod(angle_deg, 90) - 45) * PI / 180)));
+                    if (std::fmod(angle_deg, 120) < 10)
+                    {
+                        wall_mm = 9000;
+                    }
+
+                    double range_mm = std::max(0.0, std::round(wall_mm + noise(random)));
+                    std::uint16_t intensity = static_cast<std::uint16_t>(std::min(255.0, 60000 / (range_mm + 1)));
+
+                    points.push_back(PointPolar(range_mm, angle_deg, intensity));
+                }
+            }
+
+            revolutions.push_back(ScanDataPolar(points, timestamp));
+            timestamp += std::chrono::milliseconds(100);
+        }
+
+        return revolutions;
+    }
+
+    // Ranges and intensities come back exactly, angles to the codec's thousandth of a degree
+    static bool isRoundTripWithinResolution(const ScanDataPolar& original, const std::vector<PointPolar>& decoded, const std::chrono::system_clock::time_point& timestamp)
+    {
+        const std::vector<PointPolar>& points = original.getPoints();
+
+        if (points.size() != decoded.size() || original.getTimestamp() != timestamp)
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < points.size(); i++)
+        {
+            if (points[i].getRange_mm() != decoded[i].getRange_mm() ||
+                std::fabs(points[i].getAngle_deg() - decoded[i].getAngle_deg()) > 0.0005 ||
+                points[i].getIntensity() != decoded[i].getIntensity())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static void runCodec(const std::vector<ScanDataPolar>& revolutions, bool interScanDelta)
+    {
+        std::string mode = interScanDelta ? "inter-scan" : "intra-scan";
+
+        ScanEncoder encoder(interScanDelta);
+        std::vector<unsigned char> encoded;
+        for (const ScanDataPolar& revolution : revolutions)
+        {
+            encoder.encode(revolution, encoded);
+        }
+
+        // Round trip: every scan must decode to the points it was encoded from, to the codec's resolution
+        ScanDecoder decoder;
+        std::vector<PointPolar> points;
+        std::chrono::system_clock::time_point timestamp;
+        std::size_t offset = 0;
+
+        for (const ScanDataPolar& revolution : revolutions)
+        {
+            std::size_t read = decoder.decode(encoded.data() + offset, encoded.size() - offset, points, timestamp);
+            if (read == 0 || !isRoundTripWithinResolution(revolution, points, timestamp))
+            {
+                fail("ScanCodec " + mode + " round trip");
+                return;
+            }
+            offset += read;
+        }
+
+        if (offset != encoded.size())
+        {
+            fail("ScanCodec " + mode + " did not consume the whole stream");
+            return;
+        }
+
+        // Malformed input must be rejected rather than read past its end
+        decoder.reset();
+        for (std::size_t length = 0; length < encoded.size() / REVOLUTIONS; length += 97)
+        {
+            if (decoder.decode(encoded.data(), length, points, timestamp) != 0)
+            {
+                fail("ScanCodec " + mode + " accepted a truncated scan");
+                return;
+            }
+        }
+
+        // Throughput is counted in the encoded bytes written or read, not the ScanDataPolars they stand for
+        std::size_t pointCount = revolutions.size() * POINTS_PER_REVOLUTION;
+        std::uint64_t encodedBytes = encoded.size();
+
+        std::printf("ScanCodec %s: %zu points, %zu bytes encoded, %.2f bytes/point (ScanDataPolar: %zu bytes/point)\n",
+            mode.c_str(), pointCount, encoded.size(), static_cast<double>(encoded.size()) / pointCount, sizeof(PointPolar));
+
+        std::vector<unsigned char> output;
+        output.reserve(encoded.size());
+
+        run("ScanEncoder::encode " + mode, Work(encodedBytes, pointCount, revolutions.size()), [&]()
+        {
+            encoder.reset();
+            output.clear();
+            for (const ScanDataPolar& revolution : revolutions)
+            {
+                encoder.encode(revolution, output);
+            }
+            doNotOptimize(output.data());
+        });
+
+        run("ScanDecoder::decode " + mode, Work(encodedBytes, pointCount, revolutions.size()), [&]()
+        {
+            decoder.reset();
+            std::size_t position = 0;
+            for (std::size_t i = 0; i < revolutions.size(); i++)
+            {
+                position += decoder.decode(encoded.data() + position, encoded.size() - position, points, timestamp);
+            }
+            doNotOptimize(points.data());
+        });
+    }
+
+    void runScanCodecBenchmarks()
+    {
+        std::vector<ScanDataPolar> revolutions = createRevolutions();
+
+        runCodec(revolutions, false);
+        runCodec(revolutions, true);
+    }
+}
+}
+}
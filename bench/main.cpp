@@ -0,0 +1,27 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <cstdio>
+
+int main()
+{
+    using namespace mechaspin::parakeet;
+
+    bench::runParserBenchmarks();
+    bench::runDriverBenchmarks();
+    bench::runFilterBenchmarks();
+    bench::runProtocolBenchmarks();
+    bench::runScanCodecBenchmarks();
+
+    if (!bench::succeeded())
+    {
+        std::printf("Some verifications failed\n");
+        return 1;
+    }
+
+    return 0;
+}
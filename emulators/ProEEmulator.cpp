@@ -0,0 +1,388 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "ProEEmulator.h"
+
+#include <parakeet/ProE/internal/Protocol.h>
+#include <parakeet/exceptions/UnableToOpenPortException.h>
+#include <parakeet/util.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__linux) || defined(linux) || defined(__linux__) || defined(__APPLE__)
+    #include <time.h>
+#endif
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace emulators
+{
+    namespace protocol = mechaspin::parakeet::ProE::internal;
+
+    const int COMMAND_BUFFER_SIZE = 2048;
+    const std::chrono::milliseconds COMMAND_READ_TIMEOUT(100);
+    const std::chrono::milliseconds MAX_DATA_SLEEP(10);
+
+    // ProE::Driver publishes each sector as one ScanData, which holds at most this many points
+    const int MAXIMUM_POINTS_PER_SECTOR = 1000;
+
+    // Keeps datagrams within ProE::Driver's receive buffer
+    const int MAXIMUM_POINTS_PER_DATAGRAM = 1600;
+
+    const std::uint32_t PROPERTY_FLAG_INTENSITY = 0x2;
+
+    const std::string CW_STOP_ROTATING = "LSTOPH";
+    const std::string CW_START_NORMALLY = "LSTARH";
+    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
+    const std::string SW_SET_DST_IPV4_PROPERTIES_PREFIX = "LSDST:";
+    const std::string RESPONSE_OK = "OK";
+
+    const double PI = 3.14159265358979323846;
+
+    // The processor time used by the calling thread, or 0 where it can not be measured
+    static std::int64_t getThreadCpuTime_us()
+    {
+#if defined(__linux) || defined(linux) || defined(__linux__) || defined(__APPLE__)
+        timespec time;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+        {
+            return static_cast<std::int64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+        }
+#endif
+        return 0;
+    }
+
+    ProEEmulator::ProEEmulator(const Configuration& configuration) :
+        configuration(configuration),
+        destination(configuration.destinationAddress, configuration.destinationPort),
+        random(configuration.seed),
+        chance(0, 1)
+    {
+        this->configuration.rpm = std::max(this->configuration.rpm, 1);
+        this->configuration.sectorsPerRevolution = std::max(this->configuration.sectorsPerRevolution, 1);
+        this->configuration.pointsPerRevolution = std::max(std::min(this->configuration.pointsPerRevolution, this->configuration.sectorsPerRevolution * MAXIMUM_POINTS_PER_SECTOR), this->configuration.sectorsPerRevolution);
+        this->configuration.maximumPointsPerDatagram = std::max(std::min(this->configuration.maximumPointsPerDatagram, MAXIMUM_POINTS_PER_DATAGRAM), 1);
+
+        rpm = this->configuration.rpm;
+
+        buildRevolution();
+    }
+
+    ProEEmulator::~ProEEmulator()
+    {
+        stop();
+    }
+
+    void ProEEmulator::buildRevolution()
+    {
+        int pointCount = configuration.pointsPerRevolution;
+
+        distances.resize(pointCount);
+        relativeStartAngles.resize(pointCount);
+        intensities.resize(pointCount);
+
+        double halfWidth_mm = configuration.roomWidth_mm / 2;
+        double halfLength_mm = configuration.roomLength_mm / 2;
+
+        for (int sector = 0; sector < configuration.sectorsPerRevolution; sector++)
+        {
+            int firstPoint = sector * pointCount / configuration.sectorsPerRevolution;
+            int lastPoint = (sector + 1) * pointCount / configuration.sectorsPerRevolution;
+
+            for (int i = firstPoint; i < lastPoint; i++)
+            {
+                double angle_rad = 2 * PI * i / pointCount;
+
+                // The distance to the nearest wall of a room centered on the sensor
+                double toSideWall_mm = std::abs(std::cos(angle_rad)) > 1e-9 ? halfWidth_mm / std::abs(std::cos(angle_rad)) : 65535;
+                double toEndWall_mm = std::abs(std::sin(angle_rad)) > 1e-9 ? halfLength_mm / std::abs(std::sin(angle_rad)) : 65535;
+                double distance_mm = std::min(std::min(toSideWall_mm, toEndWall_mm), 65535.0);
+
+                distances[i] = static_cast<std::uint16_t>(distance_mm);
+                relativeStartAngles[i] = static_cast<std::uint16_t>(std::min<long long>(360000LL * (i - firstPoint) / pointCount, 0xFFFF));
+                intensities[i] = configuration.intensity ? static_cast<std::uint8_t>(255 - std::min(distance_mm / 50, 200.0)) : 0;
+            }
+        }
+    }
+
+    void ProEEmulator::start()
+    {
+        if (running)
+        {
+            return;
+        }
+
+        if (!socket.open(configuration.sensorPort))
+        {
+            socket.close();
+            throw exceptions::UnableToOpenPortException();
+        }
+
+        socket.setReadTimeout(COMMAND_READ_TIMEOUT);
+
+        streaming = configuration.streamOnStart;
+        running = true;
+
+        commandThread = std::thread(&ProEEmulator::commandThreadFunction, this);
+        dataThread = std::thread(&ProEEmulator::dataThreadFunction, this);
+    }
+
+    void ProEEmulator::requestStop()
+    {
+        running = false;
+    }
+
+    void ProEEmulator::stop()
+    {
+        requestStop();
+
+        if (commandThread.joinable())
+        {
+            commandThread.join();
+        }
+
+        if (dataThread.joinable())
+        {
+            dataThread.join();
+        }
+
+        socket.close();
+        streaming = false;
+    }
+
+    bool ProEEmulator::isStreaming() const
+    {
+        return streaming;
+    }
+
+    int ProEEmulator::getRpm() const
+    {
+        return rpm;
+    }
+
+    ProEEmulator::Statistics ProEEmulator::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.commandsReceived = commandsReceived;
+        statistics.invalidCommandsReceived = invalidCommandsReceived;
+        statistics.revolutionsSent = revolutionsSent;
+        statistics.datagramsSent = datagramsSent;
+        statistics.datagramsDropped = datagramsDropped;
+        statistics.datagramsReordered = datagramsReordered;
+        statistics.datagramsCorrupted = datagramsCorrupted;
+        statistics.dataThreadCpuTime = std::chrono::microseconds(dataThreadCpuTime_us);
+
+        return statistics;
+    }
+
+    void ProEEmulator::registerRevolutionCallback(std::function<void(std::chrono::steady_clock::time_point)> callback)
+    {
+        revolutionCallback = callback;
+    }
+
+    mechaspin::parakeet::internal::InetAddress ProEEmulator::getDestination()
+    {
+        std::lock_guard<std::mutex> lock(destinationMutex);
+
+        return destination;
+    }
+
+    void ProEEmulator::commandThreadFunction()
+    {
+        unsigned char buffer[COMMAND_BUFFER_SIZE];
+
+        while (running)
+        {
+            int charsRead = socket.read(mechaspin::parakeet::internal::BufferData(buffer, 0), COMMAND_BUFFER_SIZE);
+            if (charsRead <= 0)
+            {
+                continue;
+            }
+
+            protocol::CmdHeader header;
+            std::string message;
+
+            if (!protocol::parseCommandMessage(buffer, charsRead, header, message))
+            {
+                invalidCommandsReceived++;
+                continue;
+            }
+
+            commandsReceived++;
+            handleCommand(header.cmd, header.sn, message);
+        }
+    }
+
+    void ProEEmulator::handleCommand(unsigned short cmd, unsigned short sn, const std::string& message)
+    {
+        if (message == CW_START_NORMALLY)
+        {
+            streaming = true;
+        }
+        else if (message == CW_STOP_ROTATING)
+        {
+            streaming = false;
+        }
+        else if (message.compare(0, SW_SET_SPEED_PREFIX.length(), SW_SET_SPEED_PREFIX) == 0)
+        {
+            int requestedRpm = atoi(message.c_str() + SW_SET_SPEED_PREFIX.length());
+            if (requestedRpm > 0)
+            {
+                rpm = requestedRpm;
+            }
+        }
+        else if (cmd == protocol::UDP_MESSAGE_SET_PROPERTIES_CMD && message.compare(0, SW_SET_DST_IPV4_PROPERTIES_PREFIX.length(), SW_SET_DST_IPV4_PROPERTIES_PREFIX) == 0)
+        {
+            // "LSDST:192.168.001.100 06668H", the address is zero padded which inet_pton will not accept
+            std::string settings = message.substr(SW_SET_DST_IPV4_PROPERTIES_PREFIX.length());
+            std::size_t delimiter = settings.find(' ');
+            std::vector<std::uint8_t> address = util::addressToByteArray(settings.substr(0, delimiter));
+
+            if (address.size() == 4 && delimiter != std::string::npos)
+            {
+                std::lock_guard<std::mutex> lock(destinationMutex);
+
+                destination.ipAddress = std::to_string(address[0]) + "." + std::to_string(address[1]) + "." + std::to_string(address[2]) + "." + std::to_string(address[3]);
+                destination.port = static_cast<unsigned short>(atoi(settings.c_str() + delimiter + 1));
+            }
+        }
+
+        sendResponse(cmd, sn, RESPONSE_OK);
+    }
+
+    void ProEEmulator::sendResponse(unsigned short cmd, unsigned short sn, const std::string& response)
+    {
+        unsigned char buffer[COMMAND_BUFFER_SIZE] = { 0 };
+
+        unsigned int length = protocol::buildCommandMessage(response, cmd, sn, buffer);
+
+        socket.write(getDestination(), mechaspin::parakeet::internal::BufferData(buffer, length));
+    }
+
+    void ProEEmulator::dataThreadFunction()
+    {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point nextSectorTime = startTime;
+        int sector = 0;
+
+        while (running)
+        {
+            if (!streaming)
+            {
+                heldDatagram.clear();
+                sector = 0;
+
+                std::this_thread::sleep_for(MAX_DATA_SLEEP);
+                nextSectorTime = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now < nextSectorTime)
+            {
+                // Sleep in short steps, so requestStop() is not held up at low speeds
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(nextSectorTime - now, MAX_DATA_SLEEP));
+                continue;
+            }
+
+            if (revolutionCallback != nullptr && sector == configuration.sectorsPerRevolution - 1)
+            {
+                revolutionCallback(std::chrono::steady_clock::now());
+            }
+
+            std::uint32_t timestamp_us = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(nextSectorTime - startTime).count());
+            sendSector(sector, timestamp_us);
+            dataThreadCpuTime_us = getThreadCpuTime_us();
+
+            if (++sector == configuration.sectorsPerRevolution)
+            {
+                sector = 0;
+                revolutionsSent++;
+            }
+
+            std::chrono::duration<double> sectorDuration(60.0 / rpm / configuration.sectorsPerRevolution);
+            nextSectorTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(sectorDuration);
+
+            // Catch up by skipping sectors, rather than sending a burst of them, once far behind
+            if (std::chrono::steady_clock::now() - nextSectorTime > std::chrono::seconds(1))
+            {
+                nextSectorTime = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    void ProEEmulator::sendSector(int sector, std::uint32_t timestamp_us)
+    {
+        int pointCount = configuration.pointsPerRevolution;
+        int firstPoint = sector * pointCount / configuration.sectorsPerRevolution;
+        int lastPoint = (sector + 1) * pointCount / configuration.sectorsPerRevolution;
+
+        protocol::LidarMessage lidarMessage;
+        lidarMessage.numPointsInSector = static_cast<std::uint16_t>(lastPoint - firstPoint);
+        lidarMessage.startAngle = static_cast<std::uint32_t>(360000LL * firstPoint / pointCount);
+        lidarMessage.endAngle = static_cast<std::uint32_t>(360000LL * lastPoint / pointCount);
+        lidarMessage.propertyFlags = configuration.intensity ? PROPERTY_FLAG_INTENSITY : 0;
+        lidarMessage.timestamp = timestamp_us;
+        lidarMessage.deviceNumber = configuration.deviceNumber;
+
+        for (int offset = 0; offset < lidarMessage.numPointsInSector; offset += configuration.maximumPointsPerDatagram)
+        {
+            int point = firstPoint + offset;
+
+            lidarMessage.numPoints = static_cast<std::uint16_t>(std::min(configuration.maximumPointsPerDatagram, lidarMessage.numPointsInSector - offset));
+            lidarMessage.sectorDataOffset = static_cast<std::uint16_t>(offset);
+            lidarMessage.distances = distances.data() + point;
+            lidarMessage.relativeStartAngles = relativeStartAngles.data() + point;
+            lidarMessage.intensities = intensities.data() + point;
+
+            datagram.resize(protocol::getLidarMessageLength(lidarMessage.numPoints));
+            protocol::buildLidarMessage(lidarMessage, datagram.data());
+
+            sendDatagram(datagram);
+        }
+    }
+
+    void ProEEmulator::sendDatagram(std::vector<unsigned char>& datagram)
+    {
+        if (chance(random) < configuration.lossRate)
+        {
+            datagramsDropped++;
+            return;
+        }
+
+        if (chance(random) < configuration.corruptionRate)
+        {
+            // Any change to a single point byte breaks the checksum
+            std::uniform_int_distribution<std::size_t> position(protocol::BUFFER_POS_POINT_DATA, datagram.size() - protocol::SIZE_OF_CHECKSUM - 1);
+            datagram[position(random)] ^= 0xA5;
+
+            datagramsCorrupted++;
+        }
+
+        mechaspin::parakeet::internal::InetAddress currentDestination = getDestination();
+
+        if (heldDatagram.empty() && chance(random) < configuration.reorderRate)
+        {
+            heldDatagram = datagram;
+            datagramsReordered++;
+            return;
+        }
+
+        socket.write(currentDestination, mechaspin::parakeet::internal::BufferData(datagram.data(), static_cast<unsigned int>(datagram.size())));
+        datagramsSent++;
+
+        if (!heldDatagram.empty())
+        {
+            socket.write(currentDestination, mechaspin::parakeet::internal::BufferData(heldDatagram.data(), static_cast<unsigned int>(heldDatagram.size())));
+            datagramsSent++;
+
+            heldDatagram.clear();
+        }
+    }
+}
+}
+}
@@ -0,0 +1,157 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_EMULATORS_PROEEMULATOR_H
+#define PARAKEET_EMULATORS_PROEEMULATOR_H
+
+#include <parakeet/UdpSocket.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace emulators
+{
+/// \brief Emulates a Parakeet ProE over UDP, answering the commands sent by ProE::Driver and streaming
+/// lidar data datagrams of a rectangular room, optionally dropping, reordering and corrupting them
+class ProEEmulator
+{
+    public:
+        struct Configuration
+        {
+            /// \brief The port the emulated sensor receives commands on, ProE::Driver's dstPort
+            unsigned short sensorPort = 6543;
+
+            /// \brief Where responses and data are sent, ProE::Driver's address and srcPort
+            std::string destinationAddress = "127.0.0.1";
+            unsigned short destinationPort = 6668;
+
+            int rpm = 600;
+            int pointsPerRevolution = 2000;
+
+            /// \brief The number of sectors a revolution is split into, each is published by ProE::Driver as one ScanData
+            int sectorsPerRevolution = 10;
+
+            /// \brief The most points sent in one datagram, sectors with more points are split over several datagrams
+            int maximumPointsPerDatagram = 100;
+
+            bool intensity = true;
+            std::uint32_t deviceNumber = 0;
+
+            /// \brief Stream data as soon as the emulator starts, rather than waiting for a start command
+            bool streamOnStart = false;
+
+            /// \brief The chance of each datagram being dropped, reordered with the one after it, or having a byte flipped
+            double lossRate = 0;
+            double reorderRate = 0;
+            double corruptionRate = 0;
+
+            unsigned int seed = 1;
+
+            /// \brief The size of the emulated room, in millimeters
+            double roomWidth_mm = 8000;
+            double roomLength_mm = 5000;
+        };
+
+        struct Statistics
+        {
+            std::uint64_t commandsReceived;
+            std::uint64_t invalidCommandsReceived;
+            std::uint64_t revolutionsSent;
+            std::uint64_t datagramsSent;
+            std::uint64_t datagramsDropped;
+            std::uint64_t datagramsReordered;
+            std::uint64_t datagramsCorrupted;
+
+            /// \brief The processor time used by the thread sending lidar data, where the platform can measure it
+            std::chrono::microseconds dataThreadCpuTime;
+        };
+
+        /// \param[in] configuration - The behaviour of the emulated sensor
+        ProEEmulator(const Configuration& configuration);
+
+        /// \brief A deconstructor responsible for stopping the emulator
+        ~ProEEmulator();
+
+        /// \brief Open the sensor port and start answering commands
+        /// \throws UnableToOpenPortException if the sensor port can not be opened
+        void start();
+
+        /// \brief Ask the emulator's threads to finish, without waiting for them
+        void requestStop();
+
+        /// \brief Stop the emulator and close the sensor port
+        void stop();
+
+        /// \returns True while the emulator is sending lidar data
+        bool isStreaming() const;
+
+        /// \returns The current rotation speed, as last set by a speed command
+        int getRpm() const;
+
+        Statistics getStatistics() const;
+
+        /// \brief Set a function to be called just before the last sector of each revolution is sent, must be set before start()
+        /// \param[in] callback - The function to be called, from the emulator's data thread, with the time the sector is sent
+        void registerRevolutionCallback(std::function<void(std::chrono::steady_clock::time_point)> callback);
+
+    private:
+        void commandThreadFunction();
+        void dataThreadFunction();
+
+        void handleCommand(unsigned short cmd, unsigned short sn, const std::string& message);
+        void sendResponse(unsigned short cmd, unsigned short sn, const std::string& response);
+        void sendSector(int sector, std::uint32_t timestamp_us);
+        void sendDatagram(std::vector<unsigned char>& datagram);
+        void buildRevolution();
+
+        mechaspin::parakeet::internal::InetAddress getDestination();
+
+        Configuration configuration;
+
+        UdpSocket socket;
+        std::mutex destinationMutex;
+        mechaspin::parakeet::internal::InetAddress destination;
+
+        std::thread commandThread;
+        std::thread dataThread;
+        std::atomic<bool> running{false};
+        std::atomic<bool> streaming{false};
+        std::atomic<int> rpm;
+
+        std::mt19937 random;
+        std::uniform_real_distribution<double> chance;
+        std::vector<unsigned char> datagram;
+        std::vector<unsigned char> heldDatagram;
+
+        std::vector<std::uint16_t> distances;
+        std::vector<std::uint16_t> relativeStartAngles;
+        std::vector<std::uint8_t> intensities;
+
+        std::atomic<std::uint64_t> commandsReceived{0};
+        std::atomic<std::uint64_t> invalidCommandsReceived{0};
+        std::atomic<std::uint64_t> revolutionsSent{0};
+        std::atomic<std::uint64_t> datagramsSent{0};
+        std::atomic<std::uint64_t> datagramsDropped{0};
+        std::atomic<std::uint64_t> datagramsReordered{0};
+        std::atomic<std::uint64_t> datagramsCorrupted{0};
+        std::atomic<std::int64_t> dataThreadCpuTime_us{0};
+
+        std::function<void(std::chrono::steady_clock::time_point)> revolutionCallback = nullptr;
+};
+}
+}
+}
+
+#endif
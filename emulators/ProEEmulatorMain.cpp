@@ -0,0 +1,226 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "ProEEmulator.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int)
+    {
+        stopRequested = 1;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Run this app via:" << std::endl
+                  << "./parakeet_proe_emulator [options]" << std::endl
+                  << std::endl
+                  << "  --sensors N                 Number of emulated sensors, each uses the next sensor and destination port (1)" << std::endl
+                  << "  --sensor-port PORT          Port the first sensor receives commands on (6543)" << std::endl
+                  << "  --destination IP:PORT       Where the first sensor sends responses and data (127.0.0.1:6668)" << std::endl
+                  << "  --rpm RPM                   Rotation speed until a speed command is received (600)" << std::endl
+                  << "  --points N                  Points per revolution (2000)" << std::endl
+                  << "  --sectors N                 Sectors per revolution (10)" << std::endl
+                  << "  --points-per-datagram N     Most points in one datagram (100)" << std::endl
+                  << "  --loss RATE                 Chance of dropping each datagram, 0 to 1 (0)" << std::endl
+                  << "  --reorder RATE              Chance of swapping each datagram with the next (0)" << std::endl
+                  << "  --corrupt RATE              Chance of corrupting each datagram (0)" << std::endl
+                  << "  --seed N                    Seed of the first sensor's impairments (1)" << std::endl
+                  << "  --no-intensity              Send zero intensities" << std::endl
+                  << "  --stream                    Stream without waiting for a start command" << std::endl
+                  << "  --duration SECONDS          Stop after this long, rather than on Ctrl+C" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using mechaspin::parakeet::emulators::ProEEmulator;
+
+    ProEEmulator::Configuration configuration;
+    int sensorCount = 1;
+    double duration_s = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (argument == "--no-intensity")
+        {
+            configuration.intensity = false;
+            continue;
+        }
+        else if (argument == "--stream")
+        {
+            configuration.streamOnStart = true;
+            continue;
+        }
+        else if (value == nullptr)
+        {
+            printUsage();
+            return -1;
+        }
+
+        if (argument == "--sensors")
+        {
+            sensorCount = atoi(value);
+        }
+        else if (argument == "--sensor-port")
+        {
+            configuration.sensorPort = static_cast<unsigned short>(atoi(value));
+        }
+        else if (argument == "--destination")
+        {
+            std::string destination = value;
+            std::size_t delimiter = destination.find(':');
+
+            configuration.destinationAddress = destination.substr(0, delimiter);
+            if (delimiter != std::string::npos)
+            {
+                configuration.destinationPort = static_cast<unsigned short>(atoi(destination.c_str() + delimiter + 1));
+            }
+        }
+        else if (argument == "--rpm")
+        {
+            configuration.rpm = atoi(value);
+        }
+        else if (argument == "--points")
+        {
+            configuration.pointsPerRevolution = atoi(value);
+        }
+        else if (argument == "--sectors")
+        {
+            configuration.sectorsPerRevolution = atoi(value);
+        }
+        else if (argument == "--points-per-datagram")
+        {
+            configuration.maximumPointsPerDatagram = atoi(value);
+        }
+        else if (argument == "--loss")
+        {
+            configuration.lossRate = atof(value);
+        }
+        else if (argument == "--reorder")
+        {
+            configuration.reorderRate = atof(value);
+        }
+        else if (argument == "--corrupt")
+        {
+            configuration.corruptionRate = atof(value);
+        }
+        else if (argument == "--seed")
+        {
+            configuration.seed = static_cast<unsigned int>(atoi(value));
+        }
+        else if (argument == "--duration")
+        {
+            duration_s = atof(value);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+
+        i++;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::vector<std::unique_ptr<ProEEmulator>> emulators;
+
+    try
+    {
+        for (int i = 0; i < sensorCount; i++)
+        {
+            ProEEmulator::Configuration sensorConfiguration = configuration;
+            sensorConfiguration.sensorPort = static_cast<unsigned short>(configuration.sensorPort + i);
+            sensorConfiguration.destinationPort = static_cast<unsigned short>(configuration.destinationPort + i);
+            sensorConfiguration.deviceNumber = static_cast<std::uint32_t>(i);
+            sensorConfiguration.seed = configuration.seed + i;
+
+            emulators.emplace_back(new ProEEmulator(sensorConfiguration));
+            emulators.back()->start();
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << "Unable to start the emulated sensors: " << error.what() << std::endl;
+        return -1;
+    }
+
+    std::cout << "Emulating " << sensorCount << " Parakeet ProE sensor(s) on ports " << configuration.sensorPort
+              << "-" << configuration.sensorPort + sensorCount - 1 << std::endl;
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto nextReportTime = startTime + std::chrono::seconds(1);
+
+    while (!stopRequested)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto now = std::chrono::steady_clock::now();
+        if (duration_s > 0 && now - startTime >= std::chrono::duration<double>(duration_s))
+        {
+            break;
+        }
+
+        if (now < nextReportTime)
+        {
+            continue;
+        }
+        nextReportTime += std::chrono::seconds(1);
+
+        ProEEmulator::Statistics total = {};
+        int streamingCount = 0;
+
+        for (const std::unique_ptr<ProEEmulator>& emulator : emulators)
+        {
+            ProEEmulator::Statistics statistics = emulator->getStatistics();
+
+            total.commandsReceived += statistics.commandsReceived;
+            total.revolutionsSent += statistics.revolutionsSent;
+            total.datagramsSent += statistics.datagramsSent;
+            total.datagramsDropped += statistics.datagramsDropped;
+            total.datagramsReordered += statistics.datagramsReordered;
+            total.datagramsCorrupted += statistics.datagramsCorrupted;
+
+            streamingCount += emulator->isStreaming() ? 1 : 0;
+        }
+
+        std::cout << "streaming " << streamingCount << "/" << sensorCount
+                  << ", commands " << total.commandsReceived
+                  << ", revolutions " << total.revolutionsSent
+                  << ", datagrams sent " << total.datagramsSent
+                  << " dropped " << total.datagramsDropped
+                  << " reordered " << total.datagramsReordered
+                  << " corrupted " << total.datagramsCorrupted << std::endl;
+    }
+
+    // Let every emulator wind down at once, rather than one after another
+    for (std::unique_ptr<ProEEmulator>& emulator : emulators)
+    {
+        emulator->requestStop();
+    }
+
+    for (std::unique_ptr<ProEEmulator>& emulator : emulators)
+    {
+        emulator->stop();
+    }
+
+    std::cout << "Shutting down" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,505 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "ProEmulator.h"
+
+#include <parakeet/Pro/internal/Protocol.h>
+#include <parakeet/exceptions/UnableToOpenPortException.h>
+#include <parakeet/internal/SerialPortHelper.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace emulators
+{
+    namespace protocol = mechaspin::parakeet::Pro::internal;
+
+    const int COMMAND_READ_SIZE = 256;
+    const std::size_t MAXIMUM_COMMAND_LENGTH = 64;
+
+    // Pro::MessageParser rejects sectors holding more points than a ScanData can
+    const int MAXIMUM_POINTS_PER_SECTOR = 1000;
+
+    // Sectors are dropped, as the sensor would, once the line falls this far behind
+    const std::size_t MAXIMUM_OUTPUT_BACKLOG = 64 * 1024;
+
+    // The line may burst at most this much of its capacity after being idle
+    const double MAXIMUM_LINE_BURST_S = 0.005;
+
+    const int ACTIVE_POLL_TIMEOUT_MS = 1;
+    const int IDLE_POLL_TIMEOUT_MS = 10;
+
+    const int BITS_PER_BYTE_ON_LINE = 10;
+
+    const std::string CW_STOP_ROTATING = "LSTOPH";
+    const std::string CW_START_NORMALLY = "LSTARH";
+    const std::string CW_VERSION_NUMBER = "LVERSH";
+    const std::string CW_DATA_SMOOTHING_PREFIX = "LSSS";
+    const std::string CW_DRAG_POINT_REMOVAL_PREFIX = "LFFF";
+    const std::string SW_START_WITH_INTENSITY = "LOCONH";
+    const std::string SW_START_WITHOUT_INTENSITY = "LNCONH";
+    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
+    const std::string SW_SET_BAUD_RATE_PREFIX = "LSBPS:";
+
+    const std::string RESPONSE_STOP = "LiDAR STOP";
+    const std::string RESPONSE_START = "LiDAR START";
+    const std::string RESPONSE_VERSION = "LiDAR EMULATOR";
+    const std::string RESPONSE_DATA_SMOOTHING = "LiDAR set smooth ok";
+    const std::string RESPONSE_DRAG_POINT_REMOVAL = "LiDAR set filter ok";
+    const std::string RESPONSE_WITH_INTENSITY = "LiDAR CONFID";
+    const std::string RESPONSE_WITHOUT_INTENSITY = "LiDAR NO CONFID";
+    const std::string RESPONSE_SPEED = "Set RPM: OK";
+    const std::string RESPONSE_BAUD_RATE = "Error: OK";
+    const std::string RESPONSE_POSTFIX = "\r\n";
+
+    const double PI = 3.14159265358979323846;
+
+    ProEmulator::ProEmulator(const Configuration& configuration) :
+        configuration(configuration),
+        random(configuration.seed),
+        chance(0, 1)
+    {
+        this->configuration.rpm = std::max(this->configuration.rpm, 1);
+        this->configuration.pointsPerRevolution = std::max(std::min(this->configuration.pointsPerRevolution, protocol::SECTORS_PER_REVOLUTION * MAXIMUM_POINTS_PER_SECTOR), protocol::SECTORS_PER_REVOLUTION);
+
+        intensity = this->configuration.intensity;
+        rpm = this->configuration.rpm;
+        baudRate = this->configuration.baudRate;
+
+        buildRevolution();
+    }
+
+    ProEmulator::~ProEmulator()
+    {
+        stop();
+    }
+
+    void ProEmulator::buildRevolution()
+    {
+        int pointCount = configuration.pointsPerRevolution;
+
+        distances.resize(pointCount);
+        intensities.resize(pointCount);
+
+        double halfWidth_mm = configuration.roomWidth_mm / 2;
+        double halfLength_mm = configuration.roomLength_mm / 2;
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            double angle_rad = 2 * PI * i / pointCount;
+
+            // The distance to the nearest wall of a room centered on the sensor
+            double toSideWall_mm = std::abs(std::cos(angle_rad)) > 1e-9 ? halfWidth_mm / std::abs(std::cos(angle_rad)) : 65535;
+            double toEndWall_mm = std::abs(std::sin(angle_rad)) > 1e-9 ? halfLength_mm / std::abs(std::sin(angle_rad)) : 65535;
+            double distance_mm = std::min(std::min(toSideWall_mm, toEndWall_mm), 65535.0);
+
+            distances[i] = static_cast<unsigned short>(distance_mm);
+            intensities[i] = static_cast<unsigned char>(255 - std::min(distance_mm / 50, 200.0));
+        }
+    }
+
+    void ProEmulator::start()
+    {
+        if (running)
+        {
+            return;
+        }
+
+        masterFileDescriptor = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+        char slaveName[256];
+        if (masterFileDescriptor < 0
+            || grantpt(masterFileDescriptor) != 0
+            || unlockpt(masterFileDescriptor) != 0
+            || ptsname_r(masterFileDescriptor, slaveName, sizeof(slaveName)) != 0)
+        {
+            stop();
+            throw exceptions::UnableToOpenPortException();
+        }
+
+        slavePath = slaveName;
+
+        // Held open so the pseudo-terminal survives Pro::Driver closing and reopening it, and to follow its baud rate
+        slaveFileDescriptor = ::open(slaveName, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (slaveFileDescriptor < 0)
+        {
+            stop();
+            throw exceptions::UnableToOpenPortException();
+        }
+
+        struct termios tty;
+        tcgetattr(slaveFileDescriptor, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(slaveFileDescriptor, TCSANOW, &tty);
+
+        mechaspin::parakeet::internal::SerialPortHelper::setCustomBaudRate(slaveFileDescriptor, baudRate);
+
+        if (!configuration.linkPath.empty())
+        {
+            unlink(configuration.linkPath.c_str());
+
+            if (symlink(slaveName, configuration.linkPath.c_str()) != 0)
+            {
+                stop();
+                throw exceptions::UnableToOpenPortException();
+            }
+        }
+
+        streaming = configuration.streamOnStart;
+        running = true;
+
+        emulatorThread = std::thread(&ProEmulator::emulatorThreadFunction, this);
+    }
+
+    void ProEmulator::requestStop()
+    {
+        running = false;
+    }
+
+    void ProEmulator::stop()
+    {
+        requestStop();
+
+        if (emulatorThread.joinable())
+        {
+            emulatorThread.join();
+        }
+
+        if (!configuration.linkPath.empty() && !slavePath.empty())
+        {
+            unlink(configuration.linkPath.c_str());
+        }
+
+        if (slaveFileDescriptor >= 0)
+        {
+            ::close(slaveFileDescriptor);
+            slaveFileDescriptor = -1;
+        }
+
+        if (masterFileDescriptor >= 0)
+        {
+            ::close(masterFileDescriptor);
+            masterFileDescriptor = -1;
+        }
+
+        slavePath.clear();
+        streaming = false;
+    }
+
+    std::string ProEmulator::getPortName() const
+    {
+        return configuration.linkPath.empty() ? slavePath : configuration.linkPath;
+    }
+
+    bool ProEmulator::isStreaming() const
+    {
+        return streaming;
+    }
+
+    int ProEmulator::getRpm() const
+    {
+        return rpm;
+    }
+
+    int ProEmulator::getBaudRate() const
+    {
+        return baudRate;
+    }
+
+    ProEmulator::Statistics ProEmulator::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.commandsReceived = commandsReceived;
+        statistics.revolutionsSent = revolutionsSent;
+        statistics.sectorsSent = sectorsSent;
+        statistics.sectorsDropped = sectorsDropped;
+        statistics.sectorsCorrupted = sectorsCorrupted;
+        statistics.bytesSent = bytesSent;
+        statistics.bytesOverflowed = bytesOverflowed;
+        statistics.bytesGarbled = bytesGarbled;
+
+        return statistics;
+    }
+
+    void ProEmulator::emulatorThreadFunction()
+    {
+        std::chrono::steady_clock::time_point nextSectorTime = std::chrono::steady_clock::now();
+        lastWriteTime = nextSectorTime;
+        int sectorIndex = 0;
+
+        while (running)
+        {
+            readCommands();
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (!streaming)
+            {
+                sectorIndex = 0;
+                nextSectorTime = now;
+            }
+            else if (now >= nextSectorTime)
+            {
+                queueSector(sectorIndex);
+
+                if (++sectorIndex == protocol::SECTORS_PER_REVOLUTION)
+                {
+                    sectorIndex = 0;
+                    revolutionsSent++;
+                }
+
+                std::chrono::duration<double> sectorDuration(60.0 / rpm / protocol::SECTORS_PER_REVOLUTION);
+                nextSectorTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(sectorDuration);
+
+                // Catch up by skipping sectors, rather than sending a burst of them, once far behind
+                if (now - nextSectorTime > std::chrono::seconds(1))
+                {
+                    nextSectorTime = now;
+                }
+            }
+
+            writeOutput(now);
+
+            pollfd masterPoll = { masterFileDescriptor, POLLIN, 0 };
+            poll(&masterPoll, 1, streaming || outputPosition < output.size() ? ACTIVE_POLL_TIMEOUT_MS : IDLE_POLL_TIMEOUT_MS);
+        }
+    }
+
+    bool ProEmulator::isLineMismatched()
+    {
+        if (!configuration.emulateLine)
+        {
+            return false;
+        }
+
+        int portBaudRate = mechaspin::parakeet::internal::SerialPortHelper::getCustomBaudRate(slaveFileDescriptor);
+
+        return portBaudRate != 0 && portBaudRate != baudRate;
+    }
+
+    void ProEmulator::readCommands()
+    {
+        char buffer[COMMAND_READ_SIZE];
+
+        ssize_t charsRead = ::read(masterFileDescriptor, buffer, sizeof(buffer));
+        if (charsRead <= 0)
+        {
+            return;
+        }
+
+        // Commands sent at another baud rate never reach the sensor intact
+        if (isLineMismatched())
+        {
+            bytesGarbled += charsRead;
+            return;
+        }
+
+        commandBuffer.append(buffer, charsRead);
+
+        while (true)
+        {
+            std::size_t commandStart = commandBuffer.find('L');
+            if (commandStart == std::string::npos)
+            {
+                commandBuffer.clear();
+                break;
+            }
+
+            std::size_t commandEnd = commandBuffer.find('H', commandStart);
+            if (commandEnd == std::string::npos)
+            {
+                commandBuffer.erase(0, commandStart);
+
+                if (commandBuffer.length() > MAXIMUM_COMMAND_LENGTH)
+                {
+                    commandBuffer.clear();
+                }
+                break;
+            }
+
+            std::string command = commandBuffer.substr(commandStart, commandEnd - commandStart + 1);
+            commandBuffer.erase(0, commandEnd + 1);
+
+            commandsReceived++;
+            handleCommand(command);
+        }
+    }
+
+    void ProEmulator::handleCommand(const std::string& command)
+    {
+        if (command == CW_STOP_ROTATING)
+        {
+            streaming = false;
+
+            // Whatever was still waiting for the line is never sent
+            output.erase(output.begin() + outputPosition, output.end());
+            queueResponse(RESPONSE_STOP);
+        }
+        else if (command == CW_START_NORMALLY)
+        {
+            streaming = true;
+            queueResponse(RESPONSE_START);
+        }
+        else if (command == CW_VERSION_NUMBER)
+        {
+            queueResponse(RESPONSE_VERSION);
+        }
+        else if (command == SW_START_WITH_INTENSITY)
+        {
+            intensity = true;
+            queueResponse(RESPONSE_WITH_INTENSITY);
+        }
+        else if (command == SW_START_WITHOUT_INTENSITY)
+        {
+            intensity = false;
+            queueResponse(RESPONSE_WITHOUT_INTENSITY);
+        }
+        else if (command.compare(0, CW_DATA_SMOOTHING_PREFIX.length(), CW_DATA_SMOOTHING_PREFIX) == 0)
+        {
+            queueResponse(RESPONSE_DATA_SMOOTHING);
+        }
+        else if (command.compare(0, CW_DRAG_POINT_REMOVAL_PREFIX.length(), CW_DRAG_POINT_REMOVAL_PREFIX) == 0)
+        {
+            queueResponse(RESPONSE_DRAG_POINT_REMOVAL);
+        }
+        else if (command.compare(0, SW_SET_SPEED_PREFIX.length(), SW_SET_SPEED_PREFIX) == 0)
+        {
+            int requestedRpm = atoi(command.c_str() + SW_SET_SPEED_PREFIX.length());
+            if (requestedRpm > 0)
+            {
+                rpm = requestedRpm;
+            }
+
+            queueResponse(RESPONSE_SPEED);
+        }
+        else if (command.compare(0, SW_SET_BAUD_RATE_PREFIX.length(), SW_SET_BAUD_RATE_PREFIX) == 0)
+        {
+            int requestedBaudRate = atoi(command.c_str() + SW_SET_BAUD_RATE_PREFIX.length());
+            if (requestedBaudRate > 0)
+            {
+                pendingBaudRate = requestedBaudRate;
+            }
+
+            queueResponse(RESPONSE_BAUD_RATE);
+        }
+    }
+
+    void ProEmulator::queueResponse(const std::string& response)
+    {
+        output.insert(output.end(), response.begin(), response.end());
+        output.insert(output.end(), RESPONSE_POSTFIX.begin(), RESPONSE_POSTFIX.end());
+    }
+
+    void ProEmulator::queueSector(int sectorIndex)
+    {
+        if (chance(random) < configuration.lossRate || output.size() - outputPosition > MAXIMUM_OUTPUT_BACKLOG)
+        {
+            sectorsDropped++;
+            return;
+        }
+
+        int firstPoint = sectorIndex * configuration.pointsPerRevolution / protocol::SECTORS_PER_REVOLUTION;
+        int lastPoint = (sectorIndex + 1) * configuration.pointsPerRevolution / protocol::SECTORS_PER_REVOLUTION;
+        unsigned short pointCount = static_cast<unsigned short>(lastPoint - firstPoint);
+        unsigned short startAngle = static_cast<unsigned short>(sectorIndex * protocol::SECTOR_SIZE_DEG * 10);
+
+        sector.resize(protocol::getSectorLength(pointCount, intensity));
+        protocol::buildSector(startAngle, pointCount, distances.data() + firstPoint, intensity ? intensities.data() + firstPoint : nullptr, sector.data());
+
+        if (chance(random) < configuration.corruptionRate)
+        {
+            // Any change to a single point byte breaks the checksum
+            std::uniform_int_distribution<std::size_t> position(protocol::SECTOR_HEADER_SIZE, sector.size() - protocol::SECTOR_CHECKSUM_SIZE - 1);
+            sector[position(random)] ^= 0xA5;
+
+            sectorsCorrupted++;
+        }
+
+        output.insert(output.end(), sector.begin(), sector.end());
+        sectorsSent++;
+    }
+
+    void ProEmulator::writeOutput(std::chrono::steady_clock::time_point now)
+    {
+        double lineRate_Bps = static_cast<double>(baudRate) / BITS_PER_BYTE_ON_LINE;
+
+        lineAllowance += std::chrono::duration<double>(now - lastWriteTime).count() * lineRate_Bps;
+        lineAllowance = std::min(lineAllowance, lineRate_Bps * MAXIMUM_LINE_BURST_S);
+        lastWriteTime = now;
+
+        std::size_t pending = output.size() - outputPosition;
+        if (pending == 0)
+        {
+            output.clear();
+            outputPosition = 0;
+            return;
+        }
+
+        std::size_t length = configuration.emulateLine ? std::min(pending, static_cast<std::size_t>(lineAllowance)) : pending;
+        if (length == 0)
+        {
+            return;
+        }
+
+        const unsigned char* data = output.data() + outputPosition;
+
+        // Bytes sent at another baud rate arrive as noise
+        std::vector<unsigned char> garbled;
+        if (isLineMismatched())
+        {
+            garbled.assign(data, data + length);
+            for (unsigned char& byte : garbled)
+            {
+                byte = static_cast<unsigned char>((byte << 3) | (byte >> 5)) ^ 0x5A;
+            }
+
+            data = garbled.data();
+            bytesGarbled += length;
+        }
+
+        ssize_t written = ::write(masterFileDescriptor, data, length);
+
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Nobody is reading the pseudo-terminal and its buffer is full
+                bytesOverflowed += pending;
+                output.clear();
+                outputPosition = 0;
+            }
+            return;
+        }
+
+        outputPosition += written;
+        bytesSent += written;
+        lineAllowance -= written;
+
+        if (outputPosition == output.size())
+        {
+            output.clear();
+            outputPosition = 0;
+
+            // The sensor switches once the acknowledgement has left at the old baud rate
+            if (pendingBaudRate != 0)
+            {
+                baudRate = pendingBaudRate;
+                pendingBaudRate = 0;
+            }
+        }
+    }
+}
+}
+}
@@ -0,0 +1,160 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_EMULATORS_PROEMULATOR_H
+#define PARAKEET_EMULATORS_PROEMULATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace emulators
+{
+/// \brief Emulates a Parakeet Pro behind a pseudo-terminal, answering the commands sent by Pro::Driver and streaming
+/// 0xCE 0xFA sectors of a rectangular room at the pace of the emulated serial line
+class ProEmulator
+{
+    public:
+        struct Configuration
+        {
+            /// \brief The baud rate the emulated sensor starts at, changed by baud rate commands
+            int baudRate = 768000;
+
+            int rpm = 600;
+
+            /// \brief Points per revolution, split over ten 36 degree sectors
+            int pointsPerRevolution = 2000;
+
+            /// \brief Start with the 3 byte per point layout, changed by the intensity commands
+            bool intensity = false;
+
+            /// \brief Stream data as soon as the emulator starts, rather than waiting for a start command
+            bool streamOnStart = false;
+
+            /// \brief Limit the data rate to what the baud rate can carry, and garble data while the port is set to another baud rate
+            bool emulateLine = true;
+
+            /// \brief The chance of each sector being dropped, or having a byte flipped
+            double lossRate = 0;
+            double corruptionRate = 0;
+
+            unsigned int seed = 1;
+
+            /// \brief If not empty, a symbolic link to the pseudo-terminal is created at this path, ie: "/tmp/ttyPARAKEET0"
+            std::string linkPath;
+
+            /// \brief The size of the emulated room, in millimeters
+            double roomWidth_mm = 8000;
+            double roomLength_mm = 5000;
+        };
+
+        struct Statistics
+        {
+            std::uint64_t commandsReceived;
+            std::uint64_t revolutionsSent;
+            std::uint64_t sectorsSent;
+            std::uint64_t sectorsDropped;
+            std::uint64_t sectorsCorrupted;
+            std::uint64_t bytesSent;
+
+            /// \brief Bytes thrown away because nobody was reading the pseudo-terminal
+            std::uint64_t bytesOverflowed;
+
+            /// \brief Bytes sent or received while the port was set to another baud rate
+            std::uint64_t bytesGarbled;
+        };
+
+        /// \param[in] configuration - The behaviour of the emulated sensor
+        ProEmulator(const Configuration& configuration);
+
+        /// \brief A deconstructor responsible for stopping the emulator
+        ~ProEmulator();
+
+        /// \brief Create the pseudo-terminal and start answering commands
+        /// \throws UnableToOpenPortException if the pseudo-terminal can not be created
+        void start();
+
+        /// \brief Ask the emulator's thread to finish, without waiting for it
+        void requestStop();
+
+        /// \brief Stop the emulator and remove the pseudo-terminal
+        void stop();
+
+        /// \returns The path Pro::Driver should open, the link path if one was configured
+        std::string getPortName() const;
+
+        /// \returns True while the emulator is sending sectors
+        bool isStreaming() const;
+
+        /// \returns The current rotation speed, as last set by a speed command
+        int getRpm() const;
+
+        /// \returns The current baud rate, as last set by a baud rate command
+        int getBaudRate() const;
+
+        Statistics getStatistics() const;
+
+    private:
+        void emulatorThreadFunction();
+
+        void readCommands();
+        void handleCommand(const std::string& command);
+        void queueResponse(const std::string& response);
+        void queueSector(int sector);
+        void writeOutput(std::chrono::steady_clock::time_point now);
+        bool isLineMismatched();
+        void buildRevolution();
+
+        Configuration configuration;
+
+        int masterFileDescriptor = -1;
+        int slaveFileDescriptor = -1;
+        std::string slavePath;
+
+        std::thread emulatorThread;
+        std::atomic<bool> running{false};
+        std::atomic<bool> streaming{false};
+        std::atomic<bool> intensity;
+        std::atomic<int> rpm;
+        std::atomic<int> baudRate;
+
+        // A baud rate change is applied once the acknowledgement has been sent at the old baud rate
+        int pendingBaudRate = 0;
+
+        std::string commandBuffer;
+        std::vector<unsigned char> output;
+        std::size_t outputPosition = 0;
+        double lineAllowance = 0;
+        std::chrono::steady_clock::time_point lastWriteTime;
+
+        std::mt19937 random;
+        std::uniform_real_distribution<double> chance;
+        std::vector<unsigned char> sector;
+
+        std::vector<unsigned short> distances;
+        std::vector<unsigned char> intensities;
+
+        std::atomic<std::uint64_t> commandsReceived{0};
+        std::atomic<std::uint64_t> revolutionsSent{0};
+        std::atomic<std::uint64_t> sectorsSent{0};
+        std::atomic<std::uint64_t> sectorsDropped{0};
+        std::atomic<std::uint64_t> sectorsCorrupted{0};
+        std::atomic<std::uint64_t> bytesSent{0};
+        std::atomic<std::uint64_t> bytesOverflowed{0};
+        std::atomic<std::uint64_t> bytesGarbled{0};
+};
+}
+}
+}
+
+#endif
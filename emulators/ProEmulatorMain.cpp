@@ -0,0 +1,214 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include "ProEmulator.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int)
+    {
+        stopRequested = 1;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Run this app via:" << std::endl
+                  << "./parakeet_pro_emulator [options]" << std::endl
+                  << std::endl
+                  << "  --sensors N                 Number of emulated sensors, each on its own pseudo-terminal (1)" << std::endl
+                  << "  --link PATH                 Create a symbolic link to the pseudo-terminal, suffixed with the sensor number if there are several" << std::endl
+                  << "  --baud BAUD                 Baud rate until a baud rate command is received (768000)" << std::endl
+                  << "  --rpm RPM                   Rotation speed until a speed command is received (600)" << std::endl
+                  << "  --points N                  Points per revolution (2000)" << std::endl
+                  << "  --intensity                 Start with the 3 byte per point layout" << std::endl
+                  << "  --loss RATE                 Chance of dropping each sector, 0 to 1 (0)" << std::endl
+                  << "  --corrupt RATE              Chance of corrupting each sector (0)" << std::endl
+                  << "  --seed N                    Seed of the first sensor's impairments (1)" << std::endl
+                  << "  --unlimited                 Do not limit the data rate to the baud rate, or garble data at the wrong baud rate" << std::endl
+                  << "  --stream                    Stream without waiting for a start command" << std::endl
+                  << "  --duration SECONDS          Stop after this long, rather than on Ctrl+C" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using mechaspin::parakeet::emulators::ProEmulator;
+
+    ProEmulator::Configuration configuration;
+    int sensorCount = 1;
+    double duration_s = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (argument == "--intensity")
+        {
+            configuration.intensity = true;
+            continue;
+        }
+        else if (argument == "--unlimited")
+        {
+            configuration.emulateLine = false;
+            continue;
+        }
+        else if (argument == "--stream")
+        {
+            configuration.streamOnStart = true;
+            continue;
+        }
+        else if (value == nullptr)
+        {
+            printUsage();
+            return -1;
+        }
+
+        if (argument == "--sensors")
+        {
+            sensorCount = atoi(value);
+        }
+        else if (argument == "--link")
+        {
+            configuration.linkPath = value;
+        }
+        else if (argument == "--baud")
+        {
+            configuration.baudRate = atoi(value);
+        }
+        else if (argument == "--rpm")
+        {
+            configuration.rpm = atoi(value);
+        }
+        else if (argument == "--points")
+        {
+            configuration.pointsPerRevolution = atoi(value);
+        }
+        else if (argument == "--loss")
+        {
+            configuration.lossRate = atof(value);
+        }
+        else if (argument == "--corrupt")
+        {
+            configuration.corruptionRate = atof(value);
+        }
+        else if (argument == "--seed")
+        {
+            configuration.seed = static_cast<unsigned int>(atoi(value));
+        }
+        else if (argument == "--duration")
+        {
+            duration_s = atof(value);
+        }
+        else
+        {
+            printUsage();
+            return -1;
+        }
+
+        i++;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::vector<std::unique_ptr<ProEmulator>> emulators;
+
+    try
+    {
+        for (int i = 0; i < sensorCount; i++)
+        {
+            ProEmulator::Configuration sensorConfiguration = configuration;
+            sensorConfiguration.seed = configuration.seed + i;
+
+            if (!configuration.linkPath.empty() && sensorCount > 1)
+            {
+                sensorConfiguration.linkPath = configuration.linkPath + std::to_string(i);
+            }
+
+            emulators.emplace_back(new ProEmulator(sensorConfiguration));
+            emulators.back()->start();
+
+            std::cout << "Emulating a Parakeet Pro on " << emulators.back()->getPortName() << std::endl;
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << "Unable to start the emulated sensors: " << error.what() << std::endl;
+        return -1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto nextReportTime = startTime + std::chrono::seconds(1);
+
+    while (!stopRequested)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto now = std::chrono::steady_clock::now();
+        if (duration_s > 0 && now - startTime >= std::chrono::duration<double>(duration_s))
+        {
+            break;
+        }
+
+        if (now < nextReportTime)
+        {
+            continue;
+        }
+        nextReportTime += std::chrono::seconds(1);
+
+        ProEmulator::Statistics total = {};
+        int streamingCount = 0;
+
+        for (const std::unique_ptr<ProEmulator>& emulator : emulators)
+        {
+            ProEmulator::Statistics statistics = emulator->getStatistics();
+
+            total.commandsReceived += statistics.commandsReceived;
+            total.revolutionsSent += statistics.revolutionsSent;
+            total.sectorsSent += statistics.sectorsSent;
+            total.sectorsDropped += statistics.sectorsDropped;
+            total.sectorsCorrupted += statistics.sectorsCorrupted;
+            total.bytesSent += statistics.bytesSent;
+            total.bytesOverflowed += statistics.bytesOverflowed;
+            total.bytesGarbled += statistics.bytesGarbled;
+
+            streamingCount += emulator->isStreaming() ? 1 : 0;
+        }
+
+        std::cout << "streaming " << streamingCount << "/" << sensorCount
+                  << ", commands " << total.commandsReceived
+                  << ", revolutions " << total.revolutionsSent
+                  << ", sectors sent " << total.sectorsSent
+                  << " dropped " << total.sectorsDropped
+                  << " corrupted " << total.sectorsCorrupted
+                  << ", bytes sent " << total.bytesSent
+                  << " overflowed " << total.bytesOverflowed
+                  << " garbled " << total.bytesGarbled << std::endl;
+    }
+
+    // Let every emulator wind down at once, rather than one after another
+    for (std::unique_ptr<ProEmulator>& emulator : emulators)
+    {
+        emulator->requestStop();
+    }
+
+    for (std::unique_ptr<ProEmulator>& emulator : emulators)
+    {
+        emulator->stop();
+    }
+
+    std::cout << "Shutting down" << std::endl;
+
+    return 0;
+}
@@ -3,6 +3,7 @@
 */
 
 #include <iostream>
+#include <mutex>
 
 #include <parakeet/Pro/Driver.h>
 #include <parakeet/ProE/Driver.h>
@@ -10,35 +11,27 @@
 
 const char versionNumber[] = "2.0.0";
 
-std::shared_ptr<mechaspin::parakeet::PointPolar> minPoint;
-std::shared_ptr<mechaspin::parakeet::PointPolar> maxPoint;
-std::shared_ptr<mechaspin::parakeet::ScanDataPolar> mostRecentScanData;
+std::mutex minMaxPointMutex;
+bool minMaxPointsValid = false;
+mechaspin::parakeet::PointPolar minPoint(0, 0, 0);
+mechaspin::parakeet::PointPolar maxPoint(0, 0, 0);
 std::chrono::system_clock::time_point timestamp;
 
-void onScanComplete(const mechaspin::parakeet::ScanDataPolar& scanData)
+void onScanComplete(const mechaspin::parakeet::RangeIndex& rangeIndex)
 {
-    mostRecentScanData = std::make_shared<mechaspin::parakeet::ScanDataPolar>(scanData);
-    minPoint.reset();
-    maxPoint.reset();
+    // The index has already found the closest and farthest returns, so the revolution is neither searched nor copied here
+    std::size_t minIndex = rangeIndex.findClosest();
+    std::size_t maxIndex = rangeIndex.findFarthest();
 
-    minPoint = nullptr;
-    maxPoint = nullptr;
+    std::lock_guard<std::mutex> lock(minMaxPointMutex);
 
-    timestamp = scanData.getTimestamp();
+    minMaxPointsValid = minIndex != mechaspin::parakeet::RangeIndex::NO_POINT;
+    timestamp = rangeIndex.getScan().getTimestamp();
 
-    auto pointList = mostRecentScanData->getPoints();
-
-    for (size_t i = 0; i < pointList.size(); i++)
+    if (minMaxPointsValid)
     {
-        if (minPoint == nullptr || pointList[i].getRange_mm() < minPoint->getRange_mm())
-        {
-            minPoint = std::make_shared<mechaspin::parakeet::PointPolar>(pointList[i]);
-        }
-
-        if (maxPoint == nullptr || pointList[i].getRange_mm() > maxPoint->getRange_mm())
-        {
-            maxPoint = std::make_shared<mechaspin::parakeet::PointPolar>(pointList[i]);
-        }
+        minPoint = rangeIndex.getScan().getPoint(minIndex);
+        maxPoint = rangeIndex.getScan().getPoint(maxIndex);
     }
 }
 
@@ -57,7 +50,7 @@ void printOptionsMenu()
 
 void startAndRunSensor(mechaspin::parakeet::Driver* parakeetSensorDriver)
 {
-    parakeetSensorDriver->registerScanCallback(onScanComplete);
+    parakeetSensorDriver->registerRangeIndexCallback(onScanComplete);
 
     mechaspin::parakeet::Pro::Driver* proDriver = dynamic_cast<mechaspin::parakeet::Pro::Driver*>(parakeetSensorDriver);
     mechaspin::parakeet::ProE::Driver* proEDriver = dynamic_cast<mechaspin::parakeet::ProE::Driver*>(parakeetSensorDriver);
@@ -95,14 +88,16 @@ void startAndRunSensor(mechaspin::parakeet::Driver* parakeetSensorDriver)
             break;
         case 'z':
         {
-            if (minPoint == nullptr || maxPoint == nullptr)
+            std::lock_guard<std::mutex> lock(minMaxPointMutex);
+
+            if (!minMaxPointsValid)
             {
                 std::cout << "No valid min/max points." << std::endl;
                 continue;
             }
 
-            std::cout << "Min point: (" << minPoint->getRange_mm() << ", " << minPoint->getAngle_deg() << ") Intensity: " << minPoint->getIntensity() << std::endl;
-            std::cout << "Max point: (" << maxPoint->getRange_mm() << ", " << maxPoint->getAngle_deg() << ") Intensity: " << maxPoint->getIntensity() << std::endl;
+            std::cout << "Min point: (" << minPoint.getRange_mm() << ", " << minPoint.getAngle_deg() << ") Intensity: " << minPoint.getIntensity() << std::endl;
+            std::cout << "Max point: (" << maxPoint.getRange_mm() << ", " << maxPoint.getAngle_deg() << ") Intensity: " << maxPoint.getIntensity() << std::endl;
 
             auto currentTime = std::chrono::system_clock::now();
             std::cout << "From " << std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - timestamp).count() << "ms ago." << std::endl;
@@ -111,14 +106,16 @@ void startAndRunSensor(mechaspin::parakeet::Driver* parakeetSensorDriver)
         }
         case 'x':
         {
-            if (minPoint == nullptr || maxPoint == nullptr)
+            std::lock_guard<std::mutex> lock(minMaxPointMutex);
+
+            if (!minMaxPointsValid)
             {
                 std::cout << "No valid min/max points." << std::endl;
                 continue;
             }
 
-            mechaspin::parakeet::PointXY minPointXY = mechaspin::parakeet::util::transform(*minPoint);
-            mechaspin::parakeet::PointXY maxPointXY = mechaspin::parakeet::util::transform(*maxPoint);
+            mechaspin::parakeet::PointXY minPointXY = mechaspin::parakeet::util::transform(minPoint);
+            mechaspin::parakeet::PointXY maxPointXY = mechaspin::parakeet::util::transform(maxPoint);
 
             std::cout << "Min point: (" << minPointXY.getX_mm() << ", " << minPointXY.getY_mm() << ") Intensity: " << minPointXY.getIntensity() << std::endl;
             std::cout << "Max point: (" << maxPointXY.getX_mm() << ", " << maxPointXY.getY_mm() << ") Intensity: " << maxPointXY.getIntensity() << std::endl;
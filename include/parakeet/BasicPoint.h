@@ -0,0 +1,240 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_BASICPOINT_H
+#define PARAKEET_BASICPOINT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief The scalar type of points stored in the sensor's own units: uint16 millimeter ranges, uint16 centidegree angles,
+/// and int16 millimeter cartesian coordinates
+struct Fixed16
+{
+};
+
+/// \brief How each scalar type stores ranges, angles, cartesian coordinates and intensities, and converts them to and from
+/// millimeters and degrees
+template <typename Scalar>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<float>
+{
+    typedef float Range;
+    typedef float Angle;
+    typedef float Coordinate;
+    typedef std::uint16_t Intensity;
+
+    /// \brief The type transforms are calculated in
+    typedef float Compute;
+
+    static Range toRange(double range_mm) { return static_cast<float>(range_mm); }
+    static double fromRange(Range range) { return range; }
+    static Angle toAngle(double angle_deg) { return static_cast<float>(angle_deg); }
+    static double fromAngle(Angle angle) { return angle; }
+    static Coordinate toCoordinate(double coordinate_mm) { return static_cast<float>(coordinate_mm); }
+    static double fromCoordinate(Coordinate coordinate) { return coordinate; }
+};
+
+template <>
+struct ScalarTraits<double>
+{
+    typedef double Range;
+    typedef double Angle;
+    typedef double Coordinate;
+    typedef std::uint16_t Intensity;
+    typedef double Compute;
+
+    static Range toRange(double range_mm) { return range_mm; }
+    static double fromRange(Range range) { return range; }
+    static Angle toAngle(double angle_deg) { return angle_deg; }
+    static double fromAngle(Angle angle) { return angle; }
+    static Coordinate toCoordinate(double coordinate_mm) { return coordinate_mm; }
+    static double fromCoordinate(Coordinate coordinate) { return coordinate; }
+};
+
+template <>
+struct ScalarTraits<Fixed16>
+{
+    typedef std::uint16_t Range;
+
+    /// \brief In hundredths of a degree, from 0 to 35999
+    typedef std::uint16_t Angle;
+
+    typedef std::int16_t Coordinate;
+    typedef std::uint8_t Intensity;
+    typedef float Compute;
+
+    static Range toRange(double range_mm)
+    {
+        return static_cast<Range>(std::min(std::max(range_mm + 0.5, 0.0), 65535.0));
+    }
+
+    static double fromRange(Range range) { return range; }
+
+    static Angle toAngle(double angle_deg)
+    {
+        // Angles within a revolution only need truncating, without the division
+        double shifted = angle_deg * 100 + 0.5;
+        if (shifted >= 0 && shifted < 36000)
+        {
+            return static_cast<Angle>(shifted);
+        }
+
+        long angle_cdeg = round(angle_deg * 100) % 36000;
+        return static_cast<Angle>(angle_cdeg < 0 ? angle_cdeg + 36000 : angle_cdeg);
+    }
+
+    static double fromAngle(Angle angle) { return angle / 100.0; }
+
+    static Coordinate toCoordinate(double coordinate_mm)
+    {
+        return static_cast<Coordinate>(round(std::min(std::max(coordinate_mm, -32768.0), 32767.0)));
+    }
+
+    static double fromCoordinate(Coordinate coordinate) { return coordinate; }
+
+    /// \brief Round half up, without the library call std::lround makes on some targets
+    static long round(double value)
+    {
+        double shifted = value + 0.5;
+        long rounded = static_cast<long>(shifted);
+
+        return rounded > shifted ? rounded - 1 : rounded;
+    }
+};
+
+namespace internal
+{
+    // The optional fields of a point, which take no space when they are left out
+    template <typename Intensity, bool Enabled>
+    class IntensityField
+    {
+        public:
+            Intensity getIntensity() const { return 0; }
+            void setIntensity(Intensity) {}
+    };
+
+    template <typename Intensity>
+    class IntensityField<Intensity, true>
+    {
+        public:
+            Intensity getIntensity() const { return intensity; }
+            void setIntensity(Intensity intensity) { this->intensity = intensity; }
+
+        private:
+            Intensity intensity = 0;
+    };
+
+    template <bool Enabled>
+    class TimestampField
+    {
+        public:
+            std::chrono::microseconds getTimeOffset() const { return std::chrono::microseconds(0); }
+            void setTimeOffset(std::chrono::microseconds) {}
+    };
+
+    template <>
+    class TimestampField<true>
+    {
+        public:
+            std::chrono::microseconds getTimeOffset() const { return std::chrono::microseconds(timeOffset_us); }
+            void setTimeOffset(std::chrono::microseconds timeOffset) { timeOffset_us = static_cast<std::int32_t>(timeOffset.count()); }
+
+        private:
+            std::int32_t timeOffset_us = 0;
+    };
+}
+
+/// \brief A point in polar coordinates, stored in the precision of Scalar (float, double or Fixed16)
+/// \tparam HasIntensity - Should the point hold the intensity measured by the sensor
+/// \tparam HasTimestamp - Should the point hold the time it was measured, as an offset from the scan's timestamp
+template <typename Scalar, bool HasIntensity = true, bool HasTimestamp = false>
+class BasicPointPolar :
+    public internal::IntensityField<typename ScalarTraits<Scalar>::Intensity, HasIntensity>,
+    public internal::TimestampField<HasTimestamp>
+{
+    public:
+        typedef ScalarTraits<Scalar> Traits;
+        typedef Scalar ScalarType;
+        static const bool hasIntensity = HasIntensity;
+        static const bool hasTimestamp = HasTimestamp;
+
+        BasicPointPolar() = default;
+
+        /// \param[in] range_mm - Distance, in millimeters, from the origin
+        /// \param[in] angle_deg - Polar angle in degree form
+        BasicPointPolar(double range_mm, double angle_deg) : range(Traits::toRange(range_mm)), angle(Traits::toAngle(angle_deg))
+        {
+        }
+
+        /// \param[in] intensity - The intensity value of the point, ignored if the point has no intensity
+        BasicPointPolar(double range_mm, double angle_deg, typename Traits::Intensity intensity) : BasicPointPolar(range_mm, angle_deg)
+        {
+            this->setIntensity(intensity);
+        }
+
+        double getRange_mm() const { return Traits::fromRange(range); }
+        double getAngle_deg() const { return Traits::fromAngle(angle); }
+
+        /// \returns The range as stored, ie: uint16 millimeters for Fixed16
+        typename Traits::Range getRange() const { return range; }
+
+        /// \returns The angle as stored, ie: uint16 centidegrees for Fixed16
+        typename Traits::Angle getAngle() const { return angle; }
+
+    private:
+        typename Traits::Range range = 0;
+        typename Traits::Angle angle = 0;
+};
+
+/// \brief A point in cartesian coordinates, stored in the precision of Scalar (float, double or Fixed16)
+/// \tparam HasIntensity - Should the point hold the intensity measured by the sensor
+/// \tparam HasTimestamp - Should the point hold the time it was measured, as an offset from the scan's timestamp
+template <typename Scalar, bool HasIntensity = true, bool HasTimestamp = false>
+class BasicPointXY :
+    public internal::IntensityField<typename ScalarTraits<Scalar>::Intensity, HasIntensity>,
+    public internal::TimestampField<HasTimestamp>
+{
+    public:
+        typedef ScalarTraits<Scalar> Traits;
+        typedef Scalar ScalarType;
+        static const bool hasIntensity = HasIntensity;
+        static const bool hasTimestamp = HasTimestamp;
+
+        BasicPointXY() = default;
+
+        /// \param[in] x_mm - Distance, in millimeters, from the origin in the X direction
+        /// \param[in] y_mm - Distance, in millimeters, from the origin in the Y direction
+        BasicPointXY(double x_mm, double y_mm) : x(Traits::toCoordinate(x_mm)), y(Traits::toCoordinate(y_mm))
+        {
+        }
+
+        /// \param[in] intensity - The intensity value of the point, ignored if the point has no intensity
+        BasicPointXY(double x_mm, double y_mm, typename Traits::Intensity intensity) : BasicPointXY(x_mm, y_mm)
+        {
+            this->setIntensity(intensity);
+        }
+
+        double getX_mm() const { return Traits::fromCoordinate(x); }
+        double getY_mm() const { return Traits::fromCoordinate(y); }
+
+        /// \returns The coordinates as stored, ie: int16 millimeters for Fixed16
+        typename Traits::Coordinate getX() const { return x; }
+        typename Traits::Coordinate getY() const { return y; }
+
+    private:
+        typename Traits::Coordinate x = 0;
+        typename Traits::Coordinate y = 0;
+};
+}
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_BASICSCANDATA_H
+#define PARAKEET_BASICSCANDATA_H
+
+#include <parakeet/BasicPoint.h>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A scan of any point type, ie: BasicScanData<BasicPointPolar<float, false>> holds float points without intensity
+template <typename Point>
+class BasicScanData
+{
+    public:
+        typedef Point PointType;
+
+        BasicScanData() = default;
+
+        /// \param[in] points - The points of the scan, which are taken over rather than copied
+        /// \param[in] timestampOfFirstPoint - A time point which holds the time the first point was received
+        BasicScanData(std::vector<Point>&& points, const std::chrono::system_clock::time_point& timestampOfFirstPoint) :
+            points(std::move(points)),
+            timestampOfFirstPoint(timestampOfFirstPoint)
+        {
+        }
+
+        BasicScanData(const std::vector<Point>& points, const std::chrono::system_clock::time_point& timestampOfFirstPoint) :
+            points(points),
+            timestampOfFirstPoint(timestampOfFirstPoint)
+        {
+        }
+
+        /// \brief Returns the vector of points this object is holding onto
+        const std::vector<Point>& getPoints() const { return points; }
+        std::vector<Point>& getPoints() { return points; }
+
+        /// \brief Returns the timestamp which signals when the first point was received
+        const std::chrono::system_clock::time_point& getTimestamp() const { return timestampOfFirstPoint; }
+
+    private:
+        std::vector<Point> points;
+        std::chrono::system_clock::time_point timestampOfFirstPoint;
+};
+}
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_CACHEDSCAN_H
+#define PARAKEET_CACHEDSCAN_H
+
+#include <parakeet/ScanDataPolar.h>
+#include <parakeet/ScanDataXY.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A revolution in polar coordinates, whose cartesian coordinates are calculated the first time they are asked for and
+/// then kept. A CachedScan is shared between every consumer of a revolution, and may be read from any number of threads:
+/// the first call to getXY() does the transform, and concurrent callers wait for it rather than repeating it.
+class CachedScan
+{
+    public:
+        /// \param[in] polarScanData - The revolution, which is taken over rather than copied
+        CachedScan(ScanDataPolar&& polarScanData);
+        CachedScan(const ScanDataPolar& polarScanData);
+
+        CachedScan(const CachedScan&) = delete;
+        CachedScan& operator=(const CachedScan&) = delete;
+
+        /// \brief Returns the revolution in polar coordinates
+        const ScanDataPolar& getPolar() const;
+
+        /// \brief Returns the revolution in cartesian coordinates, transforming it if no one has yet
+        const ScanDataXY& getXY() const;
+
+        /// \returns True if the cartesian coordinates have already been calculated, so getXY() will not block
+        bool hasXY() const;
+
+        /// \brief Returns the timestamp which signals when the first point was received
+        const std::chrono::time_point<std::chrono::system_clock>& getTimestamp() const;
+
+    private:
+        ScanDataPolar polarScanData;
+
+        mutable std::once_flag transformFlag;
+        mutable std::unique_ptr<ScanDataXY> xyScanData;
+        mutable std::atomic<bool> transformed{false};
+};
+}
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_CAPTURERECORDER_H
+#define PARAKEET_CAPTURERECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <parakeet/internal/MappedFile.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Records the raw bytes received from one or more sensors into segmented, memory-mapped, append-only capture files.
+/// Data handed to record() is copied into an in-memory ring and written to disk by a background thread, so the
+/// caller never waits on the disk. Records which do not fit into the ring are dropped and counted.
+class CaptureRecorder
+{
+    public:
+        /// \brief The file format of the capture segments
+        enum Format
+        {
+            /// \brief Native capture format (*.pkcap), holding any kind of stream
+            Native,
+
+            /// \brief pcap format (*.pcap) with synthesized IPv4/UDP headers, holding only UDP datagram streams
+            Pcap
+        };
+
+        /// \brief The kind of data a stream carries
+        enum StreamType
+        {
+            /// \brief A continuous stream of bytes, ie: from a serial port
+            SerialByteStream = 1,
+
+            /// \brief Individual UDP datagrams
+            UdpDatagrams = 2
+        };
+
+        /// \brief Describes where the data of a stream comes from
+        struct StreamInfo
+        {
+            StreamType streamType = SerialByteStream;
+
+            /// \brief The address the data is sent from, ie: the sensor's IP address or serial port
+            std::string sourceAddress;
+            unsigned short sourcePort = 0;
+            unsigned short destinationPort = 0;
+
+            std::string description;
+        };
+
+        static const int INVALID_STREAM_ID = -1;
+        static const std::size_t MAX_STREAM_INFO_STRING_LENGTH = 65535;
+
+        /// \brief Create a recorder writing to segments named basePath.000000.pkcap, basePath.000001.pkcap, ...
+        /// \param[in] basePath - The path and file name prefix of the capture segments
+        /// \param[in] format - The file format of the capture segments
+        /// \param[in] segmentSize_bytes - The size at which a new segment is started
+        /// \param[in] bufferSize_bytes - The size of the in-memory ring between the sensors and the writer thread
+        CaptureRecorder(const std::string& basePath, Format format = Native, std::size_t segmentSize_bytes = 64 * 1024 * 1024, std::size_t bufferSize_bytes = 16 * 1024 * 1024);
+
+        /// \brief Writes out all buffered data and closes the current segment
+        ~CaptureRecorder();
+
+        /// \brief Register a stream of data to be recorded
+        /// \param[in] streamInfo - Describes the source of the stream, sourceAddress and description are cut to MAX_STREAM_INFO_STRING_LENGTH characters
+        /// \returns The id to pass to record(), or INVALID_STREAM_ID if the format can not hold this kind of stream
+        int openStream(const StreamInfo& streamInfo);
+
+        /// \brief Queue data for recording, never blocks on disk access
+        /// \param[in] streamId - The id returned by openStream()
+        /// \param[in] data - The bytes or datagram received
+        /// \param[in] length - The number of bytes in data
+        /// \param[in] timestamp - When the data was received
+        /// \param[in] kernelTimestamp - True if the timestamp was taken by the OS kernel rather than the host application
+        /// \returns False if the data was dropped because the ring was full
+        bool record(int streamId, const unsigned char* data, unsigned int length, const std::chrono::system_clock::time_point& timestamp, bool kernelTimestamp = false);
+
+        /// \brief Write out all buffered data, close the current segment and stop the writer thread
+        void close();
+
+        /// \returns The number of records which were written to disk
+        std::uint64_t getRecordedCount() const;
+
+        /// \returns The number of records which were dropped because the ring was full, or no segment could be started to hold them
+        std::uint64_t getDroppedCount() const;
+
+        /// \returns The number of times a segment could not be created, or could not be truncated or closed cleanly and may be left zero padded on disk
+        std::uint64_t getFailedSegmentCount() const;
+
+        /// \returns The paths of all segments which have been started
+        std::vector<std::string> getSegmentPaths();
+
+    private:
+        struct Stream
+        {
+            StreamInfo streamInfo;
+            std::uint32_t sourceAddress;
+        };
+
+        void writerThreadMainLoop();
+        void writePendingRecords();
+        bool writeRecord(const unsigned char* header, const unsigned char* payload, std::uint32_t payloadLength);
+        void writeStreamInfoRecord(int streamId);
+        std::size_t getStreamInfoRecordLength(int streamId);
+        void startSegment(std::size_t minimumFreeSpace);
+        void finishSegment();
+        bool reserveSegmentSpace(std::size_t length);
+        void writeToRing(const unsigned char* source, std::size_t length);
+        void copyFromRing(std::size_t offset, unsigned char* destination, std::size_t length);
+
+        std::string basePath;
+        Format format;
+        std::size_t segmentSize;
+
+        std::mutex streamMutex;
+        std::vector<Stream> streams;
+        std::vector<std::string> segmentPaths;
+
+        std::mutex ringMutex;
+        std::vector<unsigned char> ring;
+        std::size_t ringHead = 0;
+        std::size_t ringTail = 0;
+        std::size_t ringUsed = 0;
+
+        internal::MappedFile segment;
+        std::size_t segmentUsed = 0;
+        std::uint32_t segmentIndex = 0;
+        int announcedStreamCount = 0;
+        std::vector<unsigned char> recordScratch;
+
+        std::atomic<std::uint64_t> recordedCount{0};
+        std::atomic<std::uint64_t> droppedCount{0};
+        std::atomic<std::uint64_t> failedSegmentCount{0};
+
+        std::mutex writerMutex;
+        std::condition_variable writerWakeup;
+        std::atomic<bool> runWriterThread{false};
+        std::thread writerThread;
+};
+}
+}
+
+#endif
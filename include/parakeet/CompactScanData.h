@@ -0,0 +1,90 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_COMPACTSCANDATA_H
+#define PARAKEET_COMPACTSCANDATA_H
+
+#include <parakeet/ScanDataPolar.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A scan stored the way the sensor measures it, as columns of uint16 millimeter ranges, uint16 centidegree angles
+/// and uint8 intensities: 5 bytes per point, where a ScanDataPolar takes 24. Values are converted when they are read.
+class CompactScanData
+{
+    public:
+        /// \brief The number of hundredths of a degree in a revolution, angles are stored from 0 to 35999
+        static const std::uint16_t CENTIDEGREES_PER_REVOLUTION = 36000;
+
+        CompactScanData() = default;
+
+        /// \param[in] timestampOfFirstPoint - A time point which holds the time the first point was received
+        CompactScanData(const std::chrono::system_clock::time_point& timestampOfFirstPoint);
+
+        /// \brief Converts a ScanDataPolar, rounding ranges to millimeters and angles to hundredths of a degree
+        CompactScanData(const ScanDataPolar& polarScanData);
+
+        /// \brief Returns the timestamp which signals when the first point was received
+        const std::chrono::system_clock::time_point& getTimestamp() const;
+        void setTimestamp(const std::chrono::system_clock::time_point& timestampOfFirstPoint);
+
+        std::size_t getPointCount() const;
+        bool empty() const;
+
+        double getRange_mm(std::size_t index) const;
+        double getAngle_deg(std::size_t index) const;
+        std::uint8_t getIntensity(std::size_t index) const;
+
+        /// \brief Widen one point into a PointPolar
+        PointPolar getPoint(std::size_t index) const;
+
+        /// \brief The columns as stored, each holding getPointCount() values
+        const std::uint16_t* getRanges_mm() const;
+        const std::uint16_t* getAngles_cdeg() const;
+        const std::uint8_t* getIntensities() const;
+
+        /// \brief Add a point in stored units
+        /// \param[in] range_mm - Distance, in millimeters, from the origin
+        /// \param[in] angle_cdeg - Polar angle in hundredths of a degree, from 0 to 35999
+        /// \param[in] intensity - The intensity value of the point
+        void addPoint(std::uint16_t range_mm, std::uint16_t angle_cdeg, std::uint8_t intensity);
+
+        /// \brief Add a point, rounding the range to millimeters and the angle to hundredths of a degree
+        void addPoint(double range_mm, double angle_deg, std::uint8_t intensity);
+
+        /// \brief Add points in stored units, copied column by column
+        /// \param[in] pointCount - The number of values in each column
+        void addPoints(std::size_t pointCount, const std::uint16_t* ranges_mm, const std::uint16_t* angles_cdeg, const std::uint8_t* intensities);
+
+        void reserve(std::size_t pointCount);
+
+        /// \brief Remove every point, keeping the capacity for the next scan
+        void clear();
+
+        /// \brief Widen every point into a ScanDataPolar
+        ScanDataPolar toScanDataPolar() const;
+
+        /// \returns The number of bytes the points take
+        std::size_t getMemoryUsage() const;
+
+        /// \brief Round an angle in degrees to hundredths of a degree, from 0 to 35999
+        static std::uint16_t toCentidegrees(double angle_deg);
+
+    private:
+        std::vector<std::uint16_t> ranges_mm;
+        std::vector<std::uint16_t> angles_cdeg;
+        std::vector<std::uint8_t> intensities;
+        std::chrono::system_clock::time_point timestampOfFirstPoint;
+};
+}
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_DERIVEDSCANSTREAM_H
+#define PARAKEET_DERIVEDSCANSTREAM_H
+
+#include <parakeet/CompactScanData.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A reduced stream of revolutions for consumers which need far less than the sensor measures, ie: visualization or
+/// telemetry at 2Hz and every fourth point. Whether a revolution is published is decided as its first sector arrives, so a
+/// revolution which is not published costs nothing more, and a published one is decimated straight from the sectors into a
+/// CompactScanData, without building the full revolution first.
+/// A DerivedScanStream is not thread safe, its callback is called from the thread which adds the sectors.
+class DerivedScanStream
+{
+    public:
+        /// \brief How the points of each group of decimation consecutive points are reduced to one
+        enum Decimation
+        {
+            /// \brief The first point of each group is kept
+            StrideDecimation,
+
+            /// \brief The closest point of each group with a return is kept, so no obstacle is lost
+            MinimumRangeDecimation
+        };
+
+        struct Settings
+        {
+            /// \brief Publish every revolutionInterval-th revolution
+            int revolutionInterval = 1;
+
+            /// \brief Publish at most one revolution per minimumPeriod, ie: 500ms for 2Hz
+            std::chrono::milliseconds minimumPeriod = std::chrono::milliseconds(0);
+
+            /// \brief Keep one point of each group of decimation consecutive points of a sector, 1 keeps every point
+            int decimation = 1;
+            Decimation decimationMode = StrideDecimation;
+        };
+
+        /// \param[in] settings - Which revolutions are published, and how they are decimated
+        /// \param[in] callback - The function to be called with each published revolution
+        DerivedScanStream(const Settings& settings, std::function<void(const CompactScanData&)> callback);
+
+        const Settings& getSettings() const;
+
+        /// \brief Add a sector's points to the revolution in progress, if it is to be published
+        /// \param[in] pointCount - The number of points
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] anglePerPoint_deg - The angle between consecutive points
+        /// \param[in] ranges_mm - The range of each point, 0 for a point without a return
+        /// \param[in] intensities - The intensity of each point
+        /// \param[in] timestamp - When the sector was received
+        void addSector(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, const std::uint16_t* ranges_mm,
+            const std::uint8_t* intensities, const std::chrono::system_clock::time_point& timestamp);
+
+        /// \brief Finish the revolution in progress, publishing it if it was chosen
+        void endRevolution();
+
+        /// \brief Leave out the rest of the revolution in progress, ie: for a stream added part way through one, so it never
+        /// publishes a partial revolution. The stream starts with the next revolution, and the one left out is not counted.
+        void waitForNextRevolution();
+
+        /// \returns The number of revolutions published, and the number left out
+        std::uint64_t getPublishedRevolutionCount() const;
+        std::uint64_t getSkippedRevolutionCount() const;
+
+    private:
+        bool isDue(const std::chrono::system_clock::time_point& timestamp) const;
+
+        Settings settings;
+        std::function<void(const CompactScanData&)> callback;
+
+        bool revolutionStarted = false;
+        bool waitingForNextRevolution = false;
+        bool publishing = false;
+        std::uint64_t revolutionCount = 0;
+        std::uint64_t publishedRevolutionCount = 0;
+
+        bool published = false;
+        std::chrono::system_clock::time_point timestampOfLastPublished;
+
+        CompactScanData scan;
+        std::vector<std::uint16_t> ranges_mm;
+        std::vector<std::uint16_t> angles_cdeg;
+        std::vector<std::uint8_t> intensities;
+};
+}
+}
+
+#endif
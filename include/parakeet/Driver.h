@@ -4,11 +4,31 @@
 
 #include <parakeet/macros.h>
 
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
-
+#include <typeindex>
+#include <vector>
+
+#include <parakeet/BasicScanData.h>
+#include <parakeet/CachedScan.h>
+#include <parakeet/CaptureRecorder.h>
+#include <parakeet/CompactScanData.h>
+#include <parakeet/DerivedScanStream.h>
+#include <parakeet/FilterPipeline.h>
+#include <parakeet/GridScanData.h>
+#include <parakeet/ProtectiveFieldMonitor.h>
+#include <parakeet/RangeIndex.h>
+#include <parakeet/RegionOfInterest.h>
+#include <parakeet/RollingScan.h>
 #include <parakeet/ScanDataPolar.h>
+#include <parakeet/SectorView.h>
+#include <parakeet/internal/CartesianWorker.h>
+#include <parakeet/internal/ScanData.h>
+#include <parakeet/internal/ScanEmitter.h>
 
 #ifndef PARAKEET_DRIVER_H
 #define PARAKEET_DRIVER_H
@@ -28,6 +48,34 @@ class Driver
             Frequency_15Hz = 15
         };
 
+        /// \brief The states a Driver's connection to the sensor can be in
+        enum ConnectionState
+        {
+            Stopped,
+            Running,
+            Stalled,
+            Reconnecting
+        };
+
+        /// \brief Settings for detecting a stalled data stream and reconnecting to the sensor
+        struct ReconnectPolicy
+        {
+            /// \brief Should the Driver watch the data stream and reconnect when it stalls
+            bool enabled = false;
+
+            /// \brief How many revolutions, at the configured scanning frequency, can be missed before the stream is considered stalled
+            int missedRevolutionsBeforeStall = 3;
+
+            /// \brief The shortest time without a revolution which is considered a stall
+            std::chrono::milliseconds minimumStallTimeout = std::chrono::milliseconds(500);
+
+            /// \brief The time to wait after the first failed reconnection attempt, doubled after every further failure
+            std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(100);
+
+            /// \brief The longest time to wait between reconnection attempts
+            std::chrono::milliseconds maximumBackoff = std::chrono::milliseconds(5000);
+        };
+
         /// \brief Deconstructor to shut down any open connections
         virtual ~Driver() = default;
 
@@ -35,6 +83,10 @@ class Driver
         /// \returns The scan rate
         double getScanRate_Hz();
 
+        /// \brief Gets how long the most recent call to start() took to bring the sensor up
+        /// \returns The time spent starting and configuring the sensor
+        std::chrono::milliseconds getStartupDuration();
+
         /// \brief Set the scanning frequency on the sensor
         /// \param[in] Hz - The scanning frequency to be set
         virtual void setScanningFrequency_Hz(ScanningFrequency Hz) = 0;
@@ -80,29 +132,131 @@ class Driver
         /// \param[in] callback - The function to be called when data is received
         void registerScanCallback(std::function<void(const ScanDataPolar&)> callback);
 
-    protected:
-        static const int MAX_NUMBER_OF_POINTS_FROM_SENSOR = 1000;          // Arbitrary size
-        struct ScanData
+        /// \brief Set a function to be called with each revolution as a BasicScanData of the given point type, ie:
+        /// registerScanCallback<BasicPointPolar<float, false>>(callback) for float points without intensity.
+        /// Each point type has its own callback, and the points are built straight from the sensor data.
+        /// \tparam Point - A BasicPointPolar instantiation
+        /// \param[in] callback - The function to be called when data is received, or nullptr to stop building this point type
+        template <typename Point>
+        void registerScanCallback(std::function<void(const BasicScanData<Point>&)> callback)
         {
-            ScanData()
-            {
-                this->timestamp = std::chrono::system_clock::now();
-            }
-
-            ScanData(const std::chrono::system_clock::time_point& timestamp)
+            std::shared_ptr<internal::ScanEmitter> scanEmitter;
+            if (callback != nullptr)
             {
-                this->timestamp = timestamp;
+                scanEmitter.reset(new internal::BasicScanEmitter<Point>(callback));
             }
 
-            double startAngle_deg;
-            double endAngle_deg;
-            unsigned short count;
-            unsigned short reserved;
-            unsigned short dist_mm[MAX_NUMBER_OF_POINTS_FROM_SENSOR];
-            unsigned char intensity[MAX_NUMBER_OF_POINTS_FROM_SENSOR];
+            setScanEmitter(std::type_index(typeid(Point)), scanEmitter);
+        }
+
+        /// \brief Set a function to be called with each revolution as a CachedScan, which can be handed to every consumer of the
+        /// revolution so its cartesian coordinates are calculated once, by whichever consumer asks for them first
+        /// \param[in] callback - The function to be called when data is received, or nullptr to stop building CachedScans
+        /// \param[in] transformEagerly - Start calculating the cartesian coordinates on a worker thread as soon as each revolution
+        /// is complete, so they are ready, or nearly so, when a consumer asks for them
+        void registerCachedScanCallback(std::function<void(const std::shared_ptr<const CachedScan>&)> callback, bool transformEagerly = false);
+
+        /// \brief Set a function to be called with each revolution as a CompactScanData, which keeps the sensor's 16 bit ranges
+        /// and 8 bit intensities, and stores angles in hundredths of a degree
+        /// \param[in] callback - The function to be called when data is received, or nullptr to stop building CompactScanData
+        void registerCompactScanCallback(std::function<void(const CompactScanData&)> callback);
+
+        /// \brief Set a function to be called with each revolution resampled onto a fixed angular grid, see GridScanData
+        /// \param[in] callback - The function to be called when data is received, or nullptr to stop building GridScanData
+        /// \param[in] settings - The resolution of the grid, how the points are resampled, and the range of a cell with no return
+        void registerGridScanCallback(std::function<void(const GridScanData&)> callback, const GridScanData::Settings& settings = GridScanData::Settings());
+
+        /// \brief Set a function to be called with a RangeIndex over each revolution, to find the closest or farthest return
+        /// between any two bearings in constant time
+        /// \param[in] callback - The function to be called when data is received, or nullptr to stop building RangeIndexes
+        void registerRangeIndexCallback(std::function<void(const RangeIndex&)> callback);
+
+        /// \brief Watch protective field zones, checking each sector as soon as it is decoded and before any scan is built
+        /// from it, so an intrusion is reported one sector after it is measured rather than after the revolution, see
+        /// ProtectiveFieldMonitor. Each sector is checked as the sensor sent it, once its checksum has been validated: the
+        /// region of interest and the filters are not applied, so they can neither hide nor delay a return inside a zone.
+        /// \param[in] settings - The zones and how intrusions are debounced, the zones are compiled here once
+        /// \param[in] callback - The function to be called when a zone is intruded or cleared, or nullptr to stop watching
+        void registerProtectiveFieldCallback(const ProtectiveFieldMonitor::Settings& settings, std::function<void(const ProtectiveFieldMonitor::Event&)> callback);
+
+        /// \brief Set a function to be called with each sector as soon as it is decoded, up to a revolution before the scan
+        /// it belongs to is published, ie: for checks which can work through a revolution as it arrives. On the Pro each 36
+        /// degree sector is delivered once the filters have run over it. On the ProE each datagram of a sector is delivered
+        /// as soon as its checksum is validated, before the rest of the sector arrives, and so before the filters.
+        /// \param[in] callback - The function to be called with each sector, or nullptr to stop delivering sectors
+        void registerSectorCallback(std::function<void(const SectorView&)> callback);
+
+        /// \brief Set a function to be called with the most recent 360 degrees of sectors every time a sector is decoded,
+        /// rather than once per revolution, see RollingScan
+        /// \param[in] callback - The function to be called with the window, or nullptr to stop building it
+        void registerRollingScanCallback(std::function<void(const RollingScan&)> callback);
+
+        /// \brief Set the angle revolutions start and end at, ie: behind a sensor mounted rotated, so no revolution splits the
+        /// region in front of it. A sector which spans the seam is split between two revolutions. Takes effect from the next
+        /// sector, and may be called while the Driver is running.
+        /// \param[in] seamAngle_deg - The angle each revolution starts at, 0 by default
+        void setSeamAngle_deg(double seamAngle_deg);
+
+        /// \brief Gets the angle revolutions start and end at
+        /// \returns The seam angle, from 0 to 360 degrees
+        double getSeamAngle_deg();
+
+        /// \brief Add a reduced stream of revolutions for a low priority consumer, ie: every 5th revolution with every 4th
+        /// point, see DerivedScanStream. A revolution the stream leaves out costs it nothing, and the revolutions it publishes
+        /// are decimated straight from the sectors. The stream starts with the first whole revolution after it is added.
+        /// \param[in] settings - Which revolutions are published, and how they are decimated
+        /// \param[in] callback - The function to be called with each published revolution
+        /// \returns The id of the stream, to remove it
+        int addDerivedScanStream(const DerivedScanStream::Settings& settings, std::function<void(const CompactScanData&)> callback);
+
+        /// \brief Remove a stream added by addDerivedScanStream()
+        /// \param[in] streamId - The id of the stream
+        void removeDerivedScanStream(int streamId);
+
+        /// \brief Set the bearings points are decoded for, ie: to leave out the part of the revolution a vehicle body blocks.
+        /// Points outside the region are dropped as each sector arrives, once the sector's checksum has been validated, so
+        /// they are never filtered, stored or published to any callback. Revolutions still start and end at the seam angle.
+        /// Takes effect from the next sector, and may be called while the Driver is running.
+        /// \param[in] regionOfInterest - The region, the default region covers the whole revolution
+        void setRegionOfInterest(const RegionOfInterest& regionOfInterest);
+
+        /// \brief Gets the bearings points are decoded for
+        /// \returns The region of interest
+        RegionOfInterest getRegionOfInterest();
+
+        /// \brief Set the filters run on the sensor data before scans are built from it, see FilterPipeline.
+        /// Takes effect from the next sector, and may be called while the Driver is running.
+        /// \param[in] settings - The filter settings, the default settings filter nothing
+        void setFilterSettings(const FilterPipeline::Settings& settings);
+
+        /// \brief Gets the filters run on the sensor data
+        /// \returns The filter settings
+        FilterPipeline::Settings getFilterSettings();
+
+        /// \brief Gets how many points the filters have removed, ie: to tune the veiling point filter
+        /// \returns The filter statistics
+        FilterPipeline::Statistics getFilterStatistics();
+
+        /// \brief Set how a stalled data stream is detected and recovered from. Takes effect on the next call to start().
+        /// \param[in] reconnectPolicy - The watchdog and reconnection settings
+        void setReconnectPolicy(const ReconnectPolicy& reconnectPolicy);
+
+        /// \brief Gets the current state of the connection to the sensor
+        /// \returns The connection state
+        ConnectionState getConnectionState();
+
+        /// \brief Set a function to be called when the connection state changes, ie: when the data stream stalls or is recovered
+        /// \param[in] callback - The function to be called with the new connection state
+        void registerConnectionStateCallback(std::function<void(ConnectionState)> callback);
+
+        /// \brief Record every byte received from the sensor, before it is parsed
+        /// \param[in] captureRecorder - The recorder to write to, or nullptr to stop recording
+        /// \returns False if the recorder's format can not hold this sensor's data stream
+        bool setCaptureRecorder(std::shared_ptr<CaptureRecorder> captureRecorder);
 
-            std::chrono::system_clock::time_point timestamp;
-        };
+    protected:
+        static const int MAX_NUMBER_OF_POINTS_FROM_SENSOR = internal::ScanData::MAX_NUMBER_OF_POINTS_FROM_SENSOR;
+        typedef internal::ScanData ScanData;
 
         struct DataPoint
         {
@@ -119,19 +273,111 @@ class Driver
 
         bool isRunning();
 
+        void setStartupDuration(std::chrono::steady_clock::duration duration);
+
+        /// \brief Re-establish the link to the sensor and resume scanning, called from the watchdog thread
+        /// \param[in] warmRestart - True if settings the sensor acknowledged before the stall can be trusted to still be applied
+        /// \returns True if the sensor is scanning again
+        virtual bool reconnect(bool warmRestart);
+
+        /// \brief Report that reading from the sensor failed, so the watchdog can reconnect without waiting for the stall timeout
+        void onLinkError();
+
         void onScanDataReceived(const ScanData& scanData);
+
+        /// \brief Hand one datagram of a sector to the sector callback, ahead of the complete sector, which is then handed to
+        /// onScanDataReceived() without being delivered to the sector callback again
+        void onPartialSectorReceived(const ScanData& partialSector);
+
+        /// \brief Describes the data stream received from the sensor, for capture recordings
+        virtual CaptureRecorder::StreamInfo getCaptureStreamInfo();
+
+        /// \brief Hand raw data received from the sensor to the capture recorder, if one is set
+        /// \param[in] data - The bytes received
+        /// \param[in] length - The number of bytes received
+        /// \param[in] timestamp - When the data was received
+        /// \param[in] kernelTimestamp - True if the timestamp was taken by the OS kernel
+        void captureRawData(const unsigned char* data, unsigned int length, const std::chrono::system_clock::time_point& timestamp, bool kernelTimestamp);
     private:
+        struct CaptureTarget
+        {
+            std::shared_ptr<CaptureRecorder> captureRecorder;
+            int streamId;
+        };
+
+        struct CachedScanTarget
+        {
+            std::function<void(const std::shared_ptr<const CachedScan>&)> callback;
+            std::shared_ptr<internal::CartesianWorker> cartesianWorker;
+        };
+
         void updateThreadMainLoop();
+        void watchdogThreadMainLoop();
+        bool isStreamStalled();
+        bool waitForBackoff(std::chrono::milliseconds backoff);
+        void setConnectionState(ConnectionState connectionState);
+        void setScanEmitter(std::type_index pointType, std::shared_ptr<internal::ScanEmitter> scanEmitter, bool first = false);
+        void updateDerivedScanEmitter();
+        // The runs of a sector's points inside the region of interest
+        struct SectorRuns
+        {
+            std::size_t firstIndices[RegionOfInterest::MAX_RUN_COUNT];
+            std::size_t endIndices[RegionOfInterest::MAX_RUN_COUNT];
+            int count;
+        };
+
+        void findRuns(const ScanData& scanData, SectorRuns& runs);
+        void publishScanData(const ScanData& scanData, const SectorRuns& runs);
+        void publishSector(const ScanData& scanData, const SectorRuns& runs, bool partial);
+        void addToRevolution(const ScanData& scanData, const SectorRuns& runs, std::size_t firstIndex, std::size_t endIndex);
+        void addSectorToRevolution(const ScanData& scanData);
+        void publishRevolution(const std::chrono::system_clock::time_point& timestamp);
 
         std::chrono::milliseconds updateThreadStartTime;
         int updateThreadFrameCount = 0;
+        std::chrono::milliseconds startupDuration = std::chrono::milliseconds(0);
         std::function<void ()> updateThreadCallbackFunction;
         std::thread updateThread;
-        bool runUpdateThread;
+        std::atomic<bool> runUpdateThread{false};
+
+        ReconnectPolicy reconnectPolicy;
+        std::thread watchdogThread;
+        std::atomic<bool> linkErrorOccurred{false};
+        std::atomic<bool> revolutionReceivedSinceReconnect{false};
+        std::atomic<std::chrono::steady_clock::rep> timeOfLastRevolution{0};
+        std::atomic<ConnectionState> connectionState{Stopped};
+        std::mutex connectionStateCallbackMutex;
+        std::function<void(ConnectionState)> connectionStateCallbackFunction = nullptr;
+
+        std::shared_ptr<const CaptureTarget> captureTarget;
 
         std::chrono::time_point<std::chrono::system_clock> timeOfFirstPoint;
         std::vector<PointPolar> pointHoldingList;
         std::function<void(const ScanDataPolar&)> scanCallbackFunction = nullptr;
+        std::shared_ptr<const CachedScanTarget> cachedScanTarget;
+
+        typedef std::function<void(const SectorView&)> SectorCallback;
+        std::shared_ptr<const SectorCallback> sectorCallback;
+        std::atomic<bool> partialSectorsReceived{false};
+
+        std::atomic<double> seamAngle_deg{0};
+        ScanData pieceScanData;
+
+        std::shared_ptr<const RegionOfInterest> regionOfInterest;
+
+        // Also in the scan emitters, which end its revolutions
+        std::shared_ptr<internal::ProtectiveFieldEmitter> protectiveFieldEmitter;
+
+        std::mutex derivedScanStreamMutex;
+        int nextDerivedScanStreamId = 0;
+        std::vector<std::pair<int, std::shared_ptr<DerivedScanStream>>> derivedScanStreams;
+
+        FilterPipeline filterPipeline;
+        ScanData filteredScanData;
+
+        typedef std::vector<std::shared_ptr<internal::ScanEmitter>> ScanEmitterList;
+        std::mutex scanEmitterMutex;
+        std::shared_ptr<const ScanEmitterList> scanEmitters;
 
 };
 }
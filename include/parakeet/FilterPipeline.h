@@ -0,0 +1,179 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_FILTERPIPELINE_H
+#define PARAKEET_FILTERPIPELINE_H
+
+#include <parakeet/internal/TemporalFilter.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Filters the points of each sector as it is decoded, before the Driver builds scans from it.
+/// The stages run in a fixed order: range mask, angle masks, intensity threshold, veiling point removal, isolated point removal,
+/// temporal filtering, then smoothing.
+/// A removed point is given a range and intensity of 0, as the sensors report points without a return, so every scan keeps
+/// the angular layout the sensor measured. Neighborhoods stop at the edges of a sector.
+/// The settings may be changed from any thread, changing them does not allocate.
+class FilterPipeline
+{
+    public:
+        static const int MAX_ANGLE_MASK_COUNT = 8;
+        static const int MAX_SMOOTHING_RADIUS = 2;
+        static const int MAX_ISOLATION_RADIUS = 4;
+        static const int MAX_VEILING_RADIUS = 4;
+
+        /// \brief How ranges are smoothed
+        enum Smoothing
+        {
+            /// \brief Ranges are left as measured
+            NoSmoothing,
+
+            /// \brief Each range is replaced by the median of its neighborhood, which removes spikes and keeps edges
+            MedianSmoothing,
+
+            /// \brief Each range is averaged with the neighbors whose range is within bilateralRangeSigma_mm of its own,
+            /// which smooths surfaces without blurring across edges
+            BilateralSmoothing
+        };
+
+        /// \brief How the range of each bearing is filtered over consecutive revolutions
+        enum TemporalFiltering
+        {
+            /// \brief Each revolution is filtered on its own
+            NoTemporalFiltering,
+
+            /// \brief Each range is replaced by an exponential moving average of its bearing's ranges
+            ExponentialTemporalFiltering,
+
+            /// \brief Each range is replaced by the median of its bearing's ranges over the last temporalRevolutionCount revolutions
+            MedianTemporalFiltering
+        };
+
+        /// \brief An arc of the revolution, from startAngle_deg counter-clockwise to endAngle_deg, which may cross 0 degrees
+        struct AngleMask
+        {
+            double startAngle_deg = 0;
+            double endAngle_deg = 0;
+        };
+
+        struct Settings
+        {
+            /// \brief Remove points closer than minimumRange_mm or further than maximumRange_mm
+            bool rangeMaskEnabled = false;
+            std::uint16_t minimumRange_mm = 0;
+            std::uint16_t maximumRange_mm = 65535;
+
+            /// \brief Remove points inside any of the first angleMaskCount arcs
+            AngleMask angleMasks[MAX_ANGLE_MASK_COUNT];
+            int angleMaskCount = 0;
+
+            /// \brief Remove points with an intensity below minimumIntensity, 0 keeps every point
+            std::uint8_t minimumIntensity = 0;
+
+            /// \brief Remove veiling points, the mixed returns which trail off the edge of an object towards the background.
+            /// A point is removed when, for a neighbor within veilingRadius points on either side, it is more than
+            /// veilingMinimumDiscontinuity_mm further away and the line joining them meets its beam at less than
+            /// veilingMinimumAngle_deg, as a point on a real surface is only seen at such a grazing angle from far away
+            bool veilingPointRemovalEnabled = false;
+            int veilingRadius = 1;
+            double veilingMinimumAngle_deg = 10;
+            std::uint16_t veilingMinimumDiscontinuity_mm = 50;
+
+            /// \brief Remove points with no neighbor, within isolationRadius points on either side, whose range is within
+            /// isolationDistance_mm of their own
+            bool isolatedPointRemovalEnabled = false;
+            int isolationRadius = 1;
+            std::uint16_t isolationDistance_mm = 100;
+
+            /// \brief Filter the range of each bearing over consecutive revolutions. Bearings are grouped into bins of
+            /// temporalBinWidth_deg, which should be no wider than the sensor's angular resolution. A bearing whose range moves
+            /// more than temporalResetDistance_mm forgets its earlier ranges, so moving objects are not smeared.
+            /// Points without a return are left as they are, and do not reset their bearing.
+            TemporalFiltering temporalFiltering = NoTemporalFiltering;
+            double temporalBinWidth_deg = 0.1;
+            int temporalRevolutionCount = 3;
+            double temporalSmoothingFactor = 0.3;
+            std::uint16_t temporalResetDistance_mm = 150;
+
+            /// \brief Smooth ranges over smoothingRadius points on either side, from 1 to MAX_SMOOTHING_RADIUS
+            Smoothing smoothing = NoSmoothing;
+            int smoothingRadius = 1;
+            std::uint16_t bilateralRangeSigma_mm = 50;
+        };
+
+        /// \brief How many points the filters have removed
+        struct Statistics
+        {
+            /// \brief Points removed by the veiling point filter
+            std::uint64_t veilingPointsRemoved = 0;
+
+            /// \brief Points removed by every stage, not counting points which already had no return
+            std::uint64_t pointsRemoved = 0;
+        };
+
+        FilterPipeline() = default;
+
+        FilterPipeline(const FilterPipeline&) = delete;
+        FilterPipeline& operator=(const FilterPipeline&) = delete;
+
+        /// \brief Replace the settings, which take effect from the next sector
+        void setSettings(const Settings& settings);
+        Settings getSettings();
+
+        /// \returns True if any stage is enabled
+        bool isEnabled() const;
+
+        /// \returns How many points have been removed since the pipeline was created
+        Statistics getStatistics() const;
+
+        /// \brief Filter the columns of one sector in place
+        /// \param[in] pointCount - The number of values in each column
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] anglePerPoint_deg - The angle between consecutive points
+        /// \param[in,out] ranges_mm - The range of each point, 0 for a removed point
+        /// \param[in,out] intensities - The intensity of each point, 0 for a removed point
+        /// \returns The number of points removed from the sector
+        std::size_t apply(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm, std::uint8_t* intensities);
+
+    private:
+        static bool isEnabled(const Settings& settings);
+
+        void applyRangeMask(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm);
+        void applyAngleMasks(const Settings& settings, std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm);
+        void applyIntensityThreshold(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm, const std::uint8_t* intensities);
+        std::size_t removeVeilingPoints(const Settings& settings, std::size_t pointCount, double anglePerPoint_deg, std::uint16_t* ranges_mm);
+        void removeIsolatedPoints(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm);
+        void applyMedian(int radius, std::size_t pointCount, std::uint16_t* ranges_mm);
+        void applyBilateral(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm);
+
+        /// \brief Copy the ranges into the padded scratch column, repeating the edge values radius times on either side
+        const std::uint16_t* pad(int radius, std::size_t pointCount, const std::uint16_t* ranges_mm);
+
+        std::mutex settingsMutex;
+        Settings settings;
+        std::atomic<bool> enabled{false};
+
+        std::atomic<std::uint64_t> veilingPointsRemoved{0};
+        std::atomic<std::uint64_t> pointsRemoved{0};
+
+        std::vector<std::uint16_t> paddedRanges;
+        std::vector<float> angles_deg;
+        std::vector<float> weightedSums;
+        std::vector<std::int32_t> weights;
+        std::vector<std::uint8_t> flags;
+
+        internal::TemporalFilter temporalFilter;
+};
+}
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_GRIDSCANDATA_H
+#define PARAKEET_GRIDSCANDATA_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A revolution resampled onto a fixed angular grid: cell i holds the range, in millimeters, at i times the
+/// resolution, so the range at any bearing is found without searching the points. The number of cells is set by the
+/// resolution alone, so the grid is allocated once and every revolution is written into the same cells.
+class GridScanData
+{
+    public:
+        /// \brief The most cells a grid can have, a resolution of 0.01 degrees
+        static const int MAX_CELL_COUNT = 36000;
+
+        /// \brief How the points of a revolution are turned into the range of each cell
+        enum Resampling
+        {
+            /// \brief Each cell holds the closest return among the points whose nearest cell it is, and a cell which is the
+            /// nearest cell of no point is invalid, so the grid should be no finer than the sensor's resolution
+            MinimumResampling,
+
+            /// \brief Each cell holds the range of the point nearest to its bearing
+            NearestResampling,
+
+            /// \brief Each cell holds the range interpolated between the two points either side of its bearing
+            InterpolatedResampling
+        };
+
+        struct Settings
+        {
+            /// \brief The angle between cells, rounded so a whole number of cells fill the revolution
+            double resolution_deg = 0.25;
+
+            Resampling resampling = NearestResampling;
+
+            /// \brief The range of a cell with no return
+            std::uint16_t invalidRange_mm = 0;
+
+            /// \brief InterpolatedResampling only interpolates between points whose ranges are within this of each other, and
+            /// otherwise takes the nearest point, so no cell lands in the empty space between an object and its background
+            std::uint16_t maximumInterpolationStep_mm = 100;
+        };
+
+        GridScanData();
+        GridScanData(const Settings& settings);
+
+        const Settings& getSettings() const;
+
+        /// \brief Returns the timestamp which signals when the first point was received
+        const std::chrono::system_clock::time_point& getTimestamp() const;
+        void setTimestamp(const std::chrono::system_clock::time_point& timestampOfFirstPoint);
+
+        std::size_t getCellCount() const;
+
+        /// \returns The angle between cells, which divides 360 degrees evenly
+        double getResolution_deg() const;
+
+        /// \returns The bearing of a cell
+        double getAngle_deg(std::size_t cell) const;
+
+        /// \returns The cell nearest to a bearing, which may be any angle
+        std::size_t getCell(double angle_deg) const;
+
+        /// \returns The range of a cell, or the invalid range if it has no return
+        std::uint16_t getRange_mm(std::size_t cell) const;
+
+        /// \returns The range of the cell nearest to a bearing
+        std::uint16_t getRangeAt_mm(double angle_deg) const;
+
+        bool isValid(std::size_t cell) const;
+
+        /// \brief The range of every cell, getCellCount() values
+        const std::uint16_t* getRanges_mm() const;
+        std::uint16_t* getRanges_mm();
+
+    private:
+        Settings settings;
+        double cellsPerDegree;
+        std::vector<std::uint16_t> ranges_mm;
+        std::chrono::system_clock::time_point timestampOfFirstPoint;
+};
+}
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_POLARTRANSFORM_H
+#define PARAKEET_POLARTRANSFORM_H
+
+#include <parakeet/CompactScanData.h>
+#include <parakeet/ScanDataPolar.h>
+#include <parakeet/ScanDataXY.h>
+#include <parakeet/ScanView.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Transforms whole scans from polar to cartesian coordinates. A sensor's angles repeat every revolution, so the sine
+/// and cosine of every angle are cached per angular layout, and once a layout has been seen each point costs two multiplications.
+/// A PolarTransform is not thread safe, use one per thread.
+/// \tparam T - float or double, the precision of the cached tables and the cartesian coordinates
+template <typename T>
+class PolarTransform
+{
+    public:
+        static const std::size_t DEFAULT_MAXIMUM_LAYOUT_COUNT = 4;
+        static const std::size_t DEFAULT_MAXIMUM_POOLED_BUFFER_COUNT = 8;
+
+        /// \brief A scan in cartesian coordinates, stored as columns
+        struct Columns
+        {
+            std::vector<T> x_mm;
+            std::vector<T> y_mm;
+            std::vector<std::uint16_t> intensities;
+            std::chrono::system_clock::time_point timestamp;
+        };
+
+        /// \param[in] maximumLayoutCount - How many angular layouts are cached before the least recently used one is replaced
+        /// \param[in] maximumPooledBufferCount - How many released Columns are kept for reuse by the pooled transform
+        PolarTransform(std::size_t maximumLayoutCount = DEFAULT_MAXIMUM_LAYOUT_COUNT, std::size_t maximumPooledBufferCount = DEFAULT_MAXIMUM_POOLED_BUFFER_COUNT);
+
+        /// \brief Transform columns of polar coordinates into caller provided columns
+        /// \param[in] pointCount - The number of points in each column
+        /// \param[in] ranges_mm - The distance of each point from the origin, in millimeters
+        /// \param[in] angles_deg - The polar angle of each point, in degrees, which selects the cached layout
+        /// \param[out] x_mm - Where the X coordinates are written, which must hold pointCount values
+        /// \param[out] y_mm - Where the Y coordinates are written, which must hold pointCount values
+        void transform(std::size_t pointCount, const T* ranges_mm, const T* angles_deg, T* x_mm, T* y_mm);
+
+        /// \brief Transform a scan into caller provided columns, which are resized but keep their capacity between scans
+        void transform(const ScanDataPolar& polarScanData, Columns& output);
+        void transform(const ScanView& scanView, Columns& output);
+        void transform(const CompactScanData& compactScanData, Columns& output);
+
+        /// \brief Transform a scan into a caller provided vector of PointXYs, which keeps its capacity between scans
+        void transform(const ScanDataPolar& polarScanData, std::vector<PointXY>& output);
+
+        /// \brief Transform a scan into Columns taken from this transform's pool
+        /// \returns The transformed scan, whose Columns return to the pool once every copy of the pointer is released
+        std::shared_ptr<const Columns> transform(const ScanDataPolar& polarScanData);
+        std::shared_ptr<const Columns> transform(const CompactScanData& compactScanData);
+
+        /// \returns The number of times a table has been built, ie: how often a new angular layout has been seen
+        std::uint64_t getLayoutBuildCount() const;
+
+        /// \brief Forget every cached layout
+        void clearLayouts();
+
+    private:
+        struct Layout
+        {
+            std::vector<T> angles_deg;
+            std::vector<T> cosines;
+            std::vector<T> sines;
+            std::uint64_t lastUsed;
+        };
+
+        struct Pool
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Columns>> buffers;
+            std::size_t maximumBufferCount;
+        };
+
+        const Layout& findLayout(std::size_t pointCount, const T* angles_deg);
+        void gather(const ScanDataPolar& polarScanData, Columns& output);
+        std::unique_ptr<Columns> takePooledColumns();
+        std::shared_ptr<const Columns> sharePooledColumns(std::unique_ptr<Columns> columns);
+
+        std::size_t maximumLayoutCount;
+        std::vector<Layout> layouts;
+        std::uint64_t useCount = 0;
+        std::uint64_t layoutBuildCount = 0;
+
+        std::vector<T> ranges_mm;
+        std::vector<T> angles_deg;
+
+        std::shared_ptr<Pool> pool;
+};
+
+extern template class PolarTransform<float>;
+extern template class PolarTransform<double>;
+}
+}
+
+#endif
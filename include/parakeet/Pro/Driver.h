@@ -9,14 +9,20 @@
 #include <parakeet/Driver.h>
 #include <parakeet/macros.h>
 #include <parakeet/SerialPort.h>
+#include <parakeet/Pro/internal/Parser.h>
+#include <parakeet/internal/AcknowledgedSetting.h>
 #include <parakeet/internal/SensorResponseParser.h>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <thread>
 #include <iostream>
 #include <string>
 
 #include <stdio.h>
 #include <functional>
+#include <vector>
 
 namespace mechaspin
 {
@@ -115,30 +121,50 @@ class Driver : public mechaspin::parakeet::Driver
         /// \returns The current baud rate
         BaudRate getBaudRate();
 
+        /// \returns The number of packets from the sensor which were discarded because their checksum did not match
+        std::uint64_t getChecksumFailureCount();
+
     private:
         static const int SERIAL_MESSAGE_DATA_BUFFER_SIZE = 8192;// Arbitrary size
 
-        struct MessageData;
+        struct PendingMessage
+        {
+            mechaspin::parakeet::internal::SensorResponse::MessageType messageType;
+            std::string message;
+        };
 
-        void onMessageDataReceived(MessageData* messageData);
+        void onResponseMessageReceived(const std::string& message);
+        void onChecksumFailure();
         int parseSensorDataFromBuffer(int length, unsigned char* buf);
 
         void open();
+        bool reconnect(bool warmRestart) override;
         void autoFindBaudRate();
         void serialUpdateThreadFunction();
-        bool sendMessageWaitForResponseOrTimeout(internal::SensorResponse::MessageType messageType, const std::string& message, std::chrono::milliseconds timeout);
+        void applySensorConfiguration();
+        void invalidateAcknowledgedSettings();
+        bool sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::MessageType messageType, const std::string& message, std::chrono::milliseconds timeout);
+        bool sendMessagesWaitForResponsesOrTimeout(const std::vector<PendingMessage>& messages, std::chrono::milliseconds timeout);
 
         bool isConnected();
+        CaptureRecorder::StreamInfo getCaptureStreamInfo() override;
 
-        bool isAutoConnecting;
         SensorConfiguration sensorConfiguration;
 
-        bool sensorReturnMessageState[internal::SensorResponse::MessageType::NA - 1];
+        std::atomic<bool> sensorReturnMessageState[mechaspin::parakeet::internal::SensorResponse::MessageType::NA];
+
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedIntensity;
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedDataSmoothing;
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedDragPointRemoval;
+        mechaspin::parakeet::internal::AcknowledgedSetting<ScanningFrequency> acknowledgedScanningFrequency;
         
         SerialPort serialPort;
+        std::mutex serialPortMutex;
         unsigned char serialPortDataBuffer[SERIAL_MESSAGE_DATA_BUFFER_SIZE];;
         unsigned int serialPortDataBufferLength;
-        internal::SensorResponseParser sensorResponseParser;
+        mechaspin::parakeet::internal::SensorResponseParser sensorResponseParser;
+        internal::MessageParser parser;
+        std::atomic<std::uint64_t> checksumFailureCount{0};
 };
 }
 }
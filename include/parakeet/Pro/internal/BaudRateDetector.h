@@ -0,0 +1,63 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_PRO_BAUDRATEDETECTOR_H
+#define PARAKEET_PRO_BAUDRATEDETECTOR_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <parakeet/BaudRate.h>
+#include <parakeet/SerialPort.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+/// \brief Determines the baud rate of a Parakeet Pro by first listening to what the sensor is already sending
+/// at each candidate baud rate, and then confirming the most promising candidates with a command.
+class BaudRateDetector
+{
+	public:
+		/// \param[in] serialPort - The (closed) serial port to detect the baud rate on, it is left closed afterwards
+		BaudRateDetector(SerialPort& serialPort);
+
+		/// \brief Determine the baud rate a sensor is communicating at
+		/// \param[in] comPort - The OS location of the serial port ie: ("COM3" | "/dev/ttyUSB0")
+		/// \param[in] candidates - The baud rates which the sensor could be set to
+		/// \param[out] detectedBaudRate - The baud rate the sensor responded at
+		/// \returns True if the sensor responded at one of the candidate baud rates
+		bool detect(const std::string& comPort, const std::vector<BaudRate>& candidates, BaudRate& detectedBaudRate);
+
+		/// \brief Record the baud rate a device is known to be using, so the next detection on it tries that rate first
+		/// \param[in] comPort - The OS location of the serial port
+		/// \param[in] baudRate - The baud rate the device is using
+		static void rememberBaudRate(const std::string& comPort, const BaudRate& baudRate);
+
+	private:
+		struct Candidate
+		{
+			BaudRate baudRate;
+			int score;
+		};
+
+		int listen(std::chrono::milliseconds window);
+		bool confirm(std::chrono::milliseconds timeout);
+		bool open(const std::string& comPort, const BaudRate& baudRate);
+
+		static bool findRememberedBaudRate(const std::string& comPort, BaudRate& baudRate);
+
+		SerialPort& serialPort;
+};
+}
+}
+}
+}
+
+#endif
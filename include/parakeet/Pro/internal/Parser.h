@@ -0,0 +1,69 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_PRO_PARSER_H
+#define PARAKEET_PRO_PARSER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include <parakeet/internal/BufferData.h>
+#include <parakeet/internal/ScanData.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+class MessageParser
+{
+	public:
+		MessageParser(std::function<void(const mechaspin::parakeet::internal::ScanData&)> onScanDataCallback,
+			std::function<void(const std::string&)> onResponseMessageCallback,
+			std::function<void()> onChecksumFailureCallback = nullptr);
+
+		/// \brief Parse every complete sector and response message out of a buffer
+		/// \param[in] bufferData - The bytes read from the serial port
+		/// \returns The number of bytes which were consumed, any remaining bytes belong to an incomplete message
+		int parse(const mechaspin::parakeet::internal::BufferData& bufferData);
+
+		/// \brief Set if sectors carry intensity data (3 bytes per point) or not (2 bytes per point)
+		/// \param[in] enable - The state of intensity data on the sensor
+		void setIntensityDataEnabled(bool enable);
+
+		/// \returns The number of sectors which passed their checksum since the last resetStatistics()
+		int getValidSectorCount() const;
+
+		/// \returns The number of sectors which failed their checksum since the last resetStatistics()
+		int getChecksumFailureCount() const;
+
+		void resetStatistics();
+
+		/// \brief Set where sectors get their timestamps from, ie: a virtual clock when replaying recorded data
+		/// \param[in] clock - The function returning the current time
+		void setClock(std::function<std::chrono::system_clock::time_point()> clock);
+
+	private:
+		int parseSector(const unsigned char* buf, int idx, int length);
+
+		bool intensityDataEnabled = false;
+		int validSectorCount = 0;
+		int checksumFailureCount = 0;
+
+		std::function<void(const mechaspin::parakeet::internal::ScanData&)> onScanDataCallback;
+		std::function<void(const std::string&)> onResponseMessageCallback;
+		std::function<void()> onChecksumFailureCallback;
+
+		std::function<std::chrono::system_clock::time_point()> clock;
+};
+}
+}
+}
+}
+
+#endif
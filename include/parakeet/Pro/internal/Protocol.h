@@ -0,0 +1,54 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_PRO_PROTOCOL_H
+#define PARAKEET_PRO_PROTOCOL_H
+
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+    const unsigned char SECTOR_SYNC_FIRST_BYTE = 0xce;
+    const unsigned char SECTOR_SYNC_SECOND_BYTE = 0xfa;
+
+    const int SECTOR_HEADER_SIZE = 6;
+    const int SECTOR_CHECKSUM_SIZE = 2;
+    const int SECTOR_OVERHEAD_SIZE = SECTOR_HEADER_SIZE + SECTOR_CHECKSUM_SIZE;
+
+    const int BYTES_PER_POINT_WITHOUT_INTENSITY = 2;
+    const int BYTES_PER_POINT_WITH_INTENSITY = 3;
+
+    const double SECTOR_SIZE_DEG = 36;
+    const int SECTORS_PER_REVOLUTION = 10;
+
+    /// \brief Build the setting commands, ie: SW_SET_SPEED(600) returns "LSRPM:600H"
+    const std::string SW_SET_SPEED(int speed);
+    const std::string SW_SET_BAUD_RATE(int baudRate);
+    const std::string SW_SET_BIAS(int bias);
+
+    /// \param[in] pointCount - The number of points in a sector
+    /// \param[in] intensity - True for the 3 byte per point layout
+    /// \returns The size of the sector in bytes
+    int getSectorLength(unsigned short pointCount, bool intensity);
+
+    /// \brief Build a sector in the layout sent by the sensor
+    /// \param[in] startAngle - The angle of the first point, in tenths of a degree
+    /// \param[in] pointCount - The number of points in the sector
+    /// \param[in] distances - The distance of each point
+    /// \param[in] intensities - The intensity of each point, or nullptr for the 2 byte per point layout
+    /// \param[out] buffer - Where the sector is written, which must hold getSectorLength bytes
+    /// \returns The length of the sector in bytes
+    int buildSector(unsigned short startAngle, unsigned short pointCount, const unsigned short* distances, const unsigned char* intensities, unsigned char* buffer);
+}
+}
+}
+}
+
+#endif
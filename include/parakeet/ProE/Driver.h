@@ -8,13 +8,16 @@
 #include <parakeet/Driver.h>
 #include <parakeet/UdpSocket.h>
 #include <parakeet/ProE/internal/Parser.h>
+#include <parakeet/internal/AcknowledgedSetting.h>
 
 #include <thread>
 #include <iostream>
 #include <string>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <functional>
+#include <vector>
 
 #include <mutex>
 
@@ -133,24 +136,40 @@ class Driver : public mechaspin::parakeet::Driver
         static const int ETHERNET_MESSAGE_DATA_BUFFER_SIZE = 8192;// Arbitrary size
 
         void open();
+        bool reconnect(bool warmRestart) override;
+        void applySensorConfiguration();
+        void invalidateAcknowledgedSettings();
         void ethernetUpdateThreadFunction();
         bool isConnected();
+        CaptureRecorder::StreamInfo getCaptureStreamInfo() override;
 
         void onCompleteLidarMessage(const internal::MessageParser::CompleteLidarMessage& lidarMessage);
-
-        unsigned int calculateEndOfMessageCRC(unsigned int* ptr, unsigned int len);
+        void onPartialSector(const internal::MessageParser::PartialSector& partialSector);
 
         bool sendMessageWaitForResponseOrTimeout(const std::string& message, int millisecondsTilTimeout);
         bool sendMessageWaitForResponseOrTimeout(const std::string& message, int millisecondsTilTimeout, unsigned short cmd);
         bool sendUdpMessageWaitForResponseOrTimeout(const std::string& message, const std::string& response, std::chrono::milliseconds timeout, unsigned short cmd);
+        std::vector<bool> sendMessagesWaitForResponsesOrTimeout(const std::vector<std::string>& messages, int millisecondsTilTimeout);
+        unsigned short takeSequenceNumber();
 
         unsigned char ethernetPortDataBuffer[ETHERNET_MESSAGE_DATA_BUFFER_SIZE];
         mechaspin::parakeet::internal::BufferData bufferData;
 
         SensorConfiguration sensorConfiguration;
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedDataSmoothing;
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedDragPointRemoval;
+        mechaspin::parakeet::internal::AcknowledgedSetting<bool> acknowledgedResampleFilter;
+        mechaspin::parakeet::internal::AcknowledgedSetting<ScanningFrequency> acknowledgedScanningFrequency;
+
         UdpSocket ethernetPort;
         internal::MessageParser parser;
         std::mutex readWriteMutex;
+
+        // Guarded by readWriteMutex. Each command gets the next number, so no two commands awaiting an "OK" share one
+        unsigned short nextSequenceNumber = static_cast<unsigned short>(rand());
+
+        // Guarded by readWriteMutex. Set by reconnect() so the update thread drops its buffered bytes and parser state before it next reads
+        bool parserResetRequested = false;
 };
 }
 }
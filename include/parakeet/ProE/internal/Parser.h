@@ -54,12 +54,38 @@ class MessageParser
 			std::vector<LidarPoint> lidarPoints;
 		};
 
+		/// \brief One validated datagram of a sector, handed on before the rest of the sector arrives
+		struct PartialSector
+		{
+			/// \brief The index of the first point within the sector, and the number of points in the whole sector
+			uint16_t sectorDataOffset;
+			uint16_t numPointsInSector;
+
+			/// \brief The angles of the whole sector, as in CompleteLidarMessage
+			uint32_t startAngle;
+			uint32_t endAngle;
+
+			std::chrono::system_clock::time_point timestamp;
+			uint32_t deviceNumber;
+
+			uint16_t numPoints;
+			const LidarPoint* lidarPoints;
+		};
+
 		MessageParser(std::function<void(const CompleteLidarMessage&)> onCompleteLidarMessageCallback);
 
 		int parse(const mechaspin::parakeet::internal::BufferData& bufferData);
 
 		void reset();
 
+		/// \brief Set a function to be called with each datagram of a sector as soon as its checksum is validated
+		/// \param[in] callback - The function to be called, or nullptr to only publish complete sectors
+		void registerPartialSectorCallback(std::function<void(const PartialSector&)> callback);
+
+		/// \brief Set where scans get their timestamps from, ie: a virtual clock when replaying recorded data
+		/// \param[in] clock - The function returning the current time
+		void setClock(std::function<std::chrono::system_clock::time_point()> clock);
+
 	private:
 		struct LastGeneratedTimestamp
 		{
@@ -109,6 +135,7 @@ class MessageParser
 		bool doesChecksumMatch();
 
 		bool isLidarMessage();
+		bool isLidarMessageComplete();
 		bool isLidarResponse();
 		bool isAlarmMessage();
 
@@ -117,6 +144,7 @@ class MessageParser
 		bool isScanCorrupt();
 		bool isScanComplete();
 		void createAndPublishCompleteScan();
+		void publishPartialSector();
 
 		uint16_t header;
 		std::shared_ptr<PartialLidarMessage> currentLidarMessage;
@@ -126,6 +154,8 @@ class MessageParser
 		LastGeneratedTimestamp lastGeneratedTimestamp;
 
 		std::function<void(const CompleteLidarMessage&)> onCompleteLidarMessageCallback;
+		std::function<void(const PartialSector&)> onPartialSectorCallback;
+		std::function<std::chrono::system_clock::time_point()> clock;
 };
 }
 }
@@ -0,0 +1,133 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_PROE_PROTOCOL_H
+#define PARAKEET_PROE_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace ProE
+{
+namespace internal
+{
+    const unsigned short UDP_MESSAGE_SIGN = 0x484C;
+    const unsigned short UDP_MESSAGE_CMD = 0x0043;
+    const unsigned short UDP_MESSAGE_SET_PROPERTIES_CMD = 0x0053;
+
+    const std::uint16_t LIDAR_MESSAGE_HEADER = 0xFAC7;
+    const std::uint16_t LIDAR_RESPONSE_HEADER = UDP_MESSAGE_SIGN;
+    const std::uint16_t ALARM_MESSAGE_HEADER = 0xCECE;
+
+    const std::uint8_t BUFFER_POS_HEADER = 0;
+    const std::uint8_t BUFFER_POS_TOTAL_POINTS = 2;
+    const std::uint8_t BUFFER_POS_NUM_POINTS_IN_SECTOR = 4;
+    const std::uint8_t BUFFER_POS_SECTOR_DATA_OFFSET = 6;
+    const std::uint8_t BUFFER_POS_START_ANGLE = 8;
+    const std::uint8_t BUFFER_POS_END_ANGLE = 12;
+    const std::uint8_t BUFFER_POS_PROPERTY_FLAGS = 16;
+    const std::uint8_t BUFFER_POS_TIMESTAMP = 20;
+    const std::uint8_t BUFFER_POS_DEVICE_NUMBER = 24;
+    const std::uint8_t BUFFER_POS_POINT_DATA = 28;
+
+    const std::uint8_t SIZE_OF_DISTANCE = 2;
+    const std::uint8_t SIZE_OF_RELATIVE_START_ANGLE = 2;
+    const std::uint8_t SIZE_OF_INTENSITY = 1;
+    const std::uint8_t SIZE_OF_LIDAR_POINT = SIZE_OF_DISTANCE + SIZE_OF_RELATIVE_START_ANGLE + SIZE_OF_INTENSITY;
+    const std::uint8_t SIZE_OF_CHECKSUM = 2;
+
+    /// \brief The header in front of every command sent to, and every response sent from, a Parakeet ProE
+    struct CmdHeader
+    {
+        unsigned short sign;
+        unsigned short cmd;
+        unsigned short sn;
+        unsigned short len;
+    };
+
+    /// \brief The fields of a single lidar data datagram, the points are laid out as columns of distances, relative angles and intensities
+    struct LidarMessage
+    {
+        std::uint16_t numPoints;
+        std::uint16_t numPointsInSector;
+        std::uint16_t sectorDataOffset;
+
+        /// \brief In thousandths of a degree
+        std::uint32_t startAngle;
+        std::uint32_t endAngle;
+
+        std::uint32_t propertyFlags;
+        std::uint32_t timestamp;
+        std::uint32_t deviceNumber;
+
+        const std::uint16_t* distances;
+        const std::uint16_t* relativeStartAngles;
+        const std::uint8_t* intensities;
+    };
+
+    /// \brief Build the setting commands, ie: SW_SET_SPEED(600) returns "LSRPM:600H"
+    const std::string SW_SET_SPEED(int speed);
+    const std::string SW_SET_BIAS(int bias);
+    const std::string SW_SET_DATA_SMOOTHING(bool enable);
+    const std::string SW_SET_DRAG_POINT_REMOVAL(bool enable);
+    const std::string SW_SET_OUTPUT_UNIT_OF_MEASURE(bool mm);
+    const std::string SW_SET_SMOOTH(bool enable);
+    const std::string SW_SET_RESAMPLE_FILTER(bool enable);
+
+    /// \brief Build the network setting commands, which are sent with UDP_MESSAGE_SET_PROPERTIES_CMD
+    const std::string SW_SET_SRC_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned char* subnetMask, const unsigned char* gateway, const unsigned short port);
+    const std::string SW_SET_DST_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned short port);
+
+    /// \returns The value as a zero padded string of size digits, ie: numberToFixedSizeString(7, 3) returns "007"
+    std::string numberToFixedSizeString(unsigned int value, int size);
+
+    /// \returns The bytes as zero padded numbers delimited by periods, ie: "192.168.001.010"
+    std::string unsignedCharArrayToString(const unsigned char* charArray, int size);
+
+    /// \brief Calculate the CRC which ends every command
+    /// \param[in] ptr - The command, header included, as 32 bit words
+    /// \param[in] len - The number of words to include
+    /// \returns The CRC32 of the words
+    unsigned int calculateEndOfMessageCRC(const unsigned int* ptr, unsigned int len);
+
+    /// \brief Build a command, padded to a multiple of four bytes and followed by its CRC
+    /// \param[in] message - The ASCII command, ie: "LSTARH"
+    /// \param[in] cmd - UDP_MESSAGE_CMD, or UDP_MESSAGE_SET_PROPERTIES_CMD for network settings
+    /// \param[in] sn - The sequence number the sensor echoes in its response
+    /// \param[out] buffer - Where the command is written, which must hold the message plus 16 bytes
+    /// \returns The length of the command in bytes
+    unsigned int buildCommandMessage(const std::string& message, unsigned short cmd, unsigned short sn, unsigned char* buffer);
+
+    /// \brief Check and unpack a command built by buildCommandMessage
+    /// \param[in] buffer - The received command
+    /// \param[in] length - The length of the received command
+    /// \param[out] header - The header of the command
+    /// \param[out] message - The ASCII command, with the padding removed
+    /// \returns False if the command is truncated, not signed, or fails its CRC
+    bool parseCommandMessage(const unsigned char* buffer, unsigned int length, CmdHeader& header, std::string& message);
+
+    /// \brief Calculate the checksum which ends every lidar data datagram
+    /// \param[in] lidarMessage - The datagram's fields
+    /// \returns The sum of every 16 bit field, every point's distance, relative angle and intensity
+    std::uint16_t calculateLidarMessageChecksum(const LidarMessage& lidarMessage);
+
+    /// \param[in] numPoints - The number of points in a datagram
+    /// \returns The size of the datagram in bytes
+    unsigned int getLidarMessageLength(std::uint16_t numPoints);
+
+    /// \brief Build a lidar data datagram in the layout sent by the sensor
+    /// \param[in] lidarMessage - The datagram's fields
+    /// \param[out] buffer - Where the datagram is written, which must hold getLidarMessageLength bytes
+    /// \returns The length of the datagram in bytes
+    unsigned int buildLidarMessage(const LidarMessage& lidarMessage, unsigned char* buffer);
+}
+}
+}
+}
+
+#endif
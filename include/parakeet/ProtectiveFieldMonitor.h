@@ -0,0 +1,151 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_PROTECTIVEFIELDMONITOR_H
+#define PARAKEET_PROTECTIVEFIELDMONITOR_H
+
+#include <parakeet/PointXY.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Watches polygonal zones around the sensor, and reports an intrusion as soon as the sector which completes it is
+/// decoded, rather than once the revolution is complete. Each zone is compiled once into the range of distances it covers
+/// along each bearing, and those thresholds are laid out to match each angular layout of sector the sensor sends, so a
+/// sector is checked by comparing its ranges against two columns.
+/// A ProtectiveFieldMonitor is not thread safe, its callback is called from the thread which checks the sectors.
+class ProtectiveFieldMonitor
+{
+    public:
+        static const std::size_t DEFAULT_MAXIMUM_LAYOUT_COUNT = 16;
+
+        /// \brief A polygon in the sensor's frame, which the sensor may be inside of
+        struct Zone
+        {
+            /// \brief The corners of the zone, in millimeters, in order round its edge
+            std::vector<PointXY> vertices;
+
+            /// \brief How many points must fall in the zone within one revolution to count as an intrusion, so single noisy
+            /// points are ignored. At least 1.
+            int minimumPointCount = 3;
+        };
+
+        struct Settings
+        {
+            std::vector<Zone> zones;
+
+            /// \brief The angle between the bearings the zones are compiled at, which should be no coarser than the sensor's
+            /// angular resolution
+            double resolution_deg = 0.1;
+
+            /// \brief How many consecutive revolutions a zone must be intruded before the intrusion is reported, including
+            /// the revolution in progress
+            int intrusionRevolutionCount = 1;
+
+            /// \brief How many consecutive complete revolutions a zone must be clear before it is reported clear
+            int clearRevolutionCount = 2;
+
+            /// \brief How many angular layouts of sector are cached before the least recently used one is replaced
+            std::size_t maximumLayoutCount = DEFAULT_MAXIMUM_LAYOUT_COUNT;
+        };
+
+        /// \brief A change in the state of a zone
+        struct Event
+        {
+            /// \brief The index of the zone in Settings::zones
+            std::size_t zoneIndex = 0;
+
+            /// \brief True if the zone has been intruded, false if it has been clear for clearRevolutionCount revolutions
+            bool intruded = false;
+
+            /// \brief The timestamp of the sector which changed the zone's state
+            std::chrono::system_clock::time_point timestamp;
+
+            /// \brief The closest point of the sector inside the zone, for an intrusion
+            double angle_deg = 0;
+            double range_mm = 0;
+        };
+
+        /// \param[in] settings - The zones, which are compiled here once
+        /// \param[in] callback - The function to be called when a zone is intruded or cleared
+        ProtectiveFieldMonitor(const Settings& settings, std::function<void(const Event&)> callback);
+
+        /// \brief Check a sector's points against every zone
+        /// \param[in] pointCount - The number of ranges
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] anglePerPoint_deg - The angle between consecutive points
+        /// \param[in] ranges_mm - The range of each point, 0 for a point without a return
+        /// \param[in] timestamp - When the sector was received
+        void checkSector(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, const std::uint16_t* ranges_mm,
+            const std::chrono::system_clock::time_point& timestamp);
+
+        /// \brief Finish the revolution in progress, which may report zones which have been clear long enough
+        void endRevolution(const std::chrono::system_clock::time_point& timestamp);
+
+        /// \returns True if the zone's last reported event was an intrusion
+        bool isIntruded(std::size_t zoneIndex) const;
+
+        std::size_t getZoneCount() const;
+
+        /// \returns The shortest and longest range, in millimeters, a zone covers along a bearing. The shortest is greater
+        /// than the longest along a bearing which misses the zone.
+        std::uint16_t getNearestRange_mm(std::size_t zoneIndex, double angle_deg) const;
+        std::uint16_t getFarthestRange_mm(std::size_t zoneIndex, double angle_deg) const;
+
+        /// \returns The number of times the thresholds have been laid out for a sector, ie: how often a new angular layout of
+        /// sector has been seen
+        std::uint64_t getLayoutBuildCount() const;
+
+    private:
+        struct ZoneState
+        {
+            int pointCount = 0;
+            bool intrudedThisRevolution = false;
+            int intrudedRevolutionCount = 0;
+            int clearRevolutionCount = 0;
+            bool intruded = false;
+        };
+
+        // The thresholds of every zone for each point of one angular layout of sector, a row of pointCount values per zone
+        struct Layout
+        {
+            double startAngle_deg;
+            double anglePerPoint_deg;
+            std::size_t pointCount;
+            std::vector<std::uint16_t> nearestRanges_mm;
+            std::vector<std::uint16_t> farthestRanges_mm;
+            std::uint64_t lastUsed;
+        };
+
+        void compileZone(const Zone& zone, std::uint16_t* nearestRanges_mm, std::uint16_t* farthestRanges_mm);
+        std::size_t findBearing(double angle_deg) const;
+        const Layout& findLayout(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg);
+        void reportIntrusion(std::size_t zoneIndex, std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg,
+            const std::uint16_t* ranges_mm, const Layout& layout, const std::chrono::system_clock::time_point& timestamp);
+
+        Settings settings;
+        std::function<void(const Event&)> callback;
+
+        // A row of bearingCount values per zone
+        std::size_t bearingCount;
+        std::vector<std::uint16_t> nearestRanges_mm;
+        std::vector<std::uint16_t> farthestRanges_mm;
+
+        std::vector<ZoneState> zoneStates;
+
+        std::vector<Layout> layouts;
+        std::uint64_t useCount = 0;
+        std::uint64_t layoutBuildCount = 0;
+};
+}
+}
+
+#endif
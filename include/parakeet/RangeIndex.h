@@ -0,0 +1,102 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_RANGEINDEX_H
+#define PARAKEET_RANGEINDEX_H
+
+#include <parakeet/CompactScanData.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Finds the closest and farthest return between two bearings of a revolution in constant time, ie: the nearest
+/// obstacle in each of many sectors. The points are split into blocks, and a sparse table holds the closest and farthest
+/// point of every run of a power of two blocks, so any run of whole blocks is covered by two entries and at most two
+/// partial blocks are searched. Finding the bearings among the points takes O(log n).
+/// Points without a return are never found.
+class RangeIndex
+{
+    public:
+        /// \brief Returned when no point between the bearings has a return
+        static const std::size_t NO_POINT = static_cast<std::size_t>(-1);
+
+        /// \brief The most points a revolution can have, the points past it are left out of the index
+        static const std::size_t MAX_POINT_COUNT = 65536;
+
+        RangeIndex() = default;
+
+        /// \brief Index a revolution
+        RangeIndex(const CompactScanData& scan);
+
+        /// \brief Index a revolution, replacing the one indexed before and reusing its memory
+        void build(const CompactScanData& scan);
+
+        /// \brief The indexed revolution, with its points in order of angle from the smallest angle
+        const CompactScanData& getScan() const;
+
+        /// \brief Find the closest return from startAngle_deg counter-clockwise to endAngle_deg, both included, which may
+        /// cross 0 degrees. An arc of 360 degrees or more, ie: from 0 to 360, is the whole revolution.
+        /// \returns The index of the point in getScan(), or NO_POINT
+        std::size_t findClosest(double startAngle_deg, double endAngle_deg) const;
+
+        /// \brief Find the farthest return from startAngle_deg counter-clockwise to endAngle_deg, both included, which may
+        /// cross 0 degrees. An arc of 360 degrees or more, ie: from 0 to 360, is the whole revolution.
+        /// \returns The index of the point in getScan(), or NO_POINT
+        std::size_t findFarthest(double startAngle_deg, double endAngle_deg) const;
+
+        /// \brief Find the closest return of the revolution
+        /// \returns The index of the point in getScan(), or NO_POINT
+        std::size_t findClosest() const;
+
+        /// \brief Find the farthest return of the revolution
+        /// \returns The index of the point in getScan(), or NO_POINT
+        std::size_t findFarthest() const;
+
+    private:
+        /// \brief Convert an arc into at most two runs of points, [first, end) in order of angle
+        /// \returns The number of runs
+        int findRuns(double startAngle_deg, double endAngle_deg, std::size_t* firstIndices, std::size_t* endIndices) const;
+
+        // Each key holds a point's range in its high 16 bits and the point's index in its low 16 bits, so the smallest key
+        // is the point to find
+        struct Table
+        {
+            std::vector<std::uint32_t> keys;
+
+            // Row k holds the smallest key of the 2^k blocks from each block
+            std::vector<std::uint32_t> blockKeys;
+        };
+
+        /// \brief Find the point with the smallest key in one of the tables, from startAngle_deg to endAngle_deg
+        std::size_t find(const Table& table, double startAngle_deg, double endAngle_deg) const;
+
+        /// \brief The smallest key of the points [first, end) in one of the tables
+        std::uint32_t findMinimumKey(const Table& table, std::size_t firstIndex, std::size_t endIndex) const;
+
+        /// \returns The index of the point a key belongs to, or NO_POINT if it has no return
+        std::size_t toPoint(std::uint32_t key) const;
+
+        void buildTable(Table& table);
+
+        CompactScanData scan;
+
+        Table closestTable;
+        Table farthestTable;
+
+        std::size_t pointCount = 0;
+        std::size_t blockCount = 0;
+        int levelCount = 0;
+
+        // The largest k with 2^k no more than each number of blocks
+        std::vector<std::uint8_t> levels;
+};
+}
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_REGIONOFINTEREST_H
+#define PARAKEET_REGIONOFINTEREST_H
+
+#include <cstddef>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief The bearings of the revolution a Driver decodes points for, ie: to leave out the part of the revolution a vehicle
+/// body blocks. A region with no arcs covers the whole revolution.
+/// Points outside the region are dropped as each sector is decoded, so they are never filtered, stored or published.
+class RegionOfInterest
+{
+    public:
+        static const int MAX_ARC_COUNT = 8;
+
+        /// \brief The most runs of points a sector can be split into, each arc can cross a sector's start once
+        static const int MAX_RUN_COUNT = 2 * MAX_ARC_COUNT;
+
+        /// \brief An arc of the revolution, from startAngle_deg counter-clockwise up to endAngle_deg, which may cross 0 degrees.
+        /// An arc which ends where it starts, ie: from 0 to 360 degrees, is the whole revolution.
+        struct Arc
+        {
+            double startAngle_deg = 0;
+            double endAngle_deg = 0;
+        };
+
+        /// \brief A region covering the whole revolution
+        RegionOfInterest() = default;
+
+        /// \brief Add an arc to the region
+        /// \returns False if the region already has MAX_ARC_COUNT arcs
+        bool addArc(double startAngle_deg, double endAngle_deg);
+
+        int getArcCount() const;
+        const Arc& getArc(int index) const;
+
+        /// \returns True if the region has no arcs, or an arc which is the whole revolution
+        bool isWholeRevolution() const;
+
+        /// \returns True if a bearing is inside the region
+        bool contains(double angle_deg) const;
+
+        /// \brief Find the runs of a sector's points which are inside the region
+        /// \param[in] pointCount - The number of points in the sector
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] anglePerPoint_deg - The angle between consecutive points
+        /// \param[out] firstIndices - The first point of each run, room for MAX_RUN_COUNT runs
+        /// \param[out] endIndices - One past the last point of each run, room for MAX_RUN_COUNT runs
+        /// \returns The number of runs, in order and without overlaps
+        int findRuns(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::size_t* firstIndices, std::size_t* endIndices) const;
+
+    private:
+        Arc arcs[MAX_ARC_COUNT];
+        int arcCount = 0;
+        bool hasWholeRevolutionArc = false;
+};
+}
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_REPLAY_DRIVER_H
+#define PARAKEET_REPLAY_DRIVER_H
+
+#include <parakeet/Driver.h>
+#include <parakeet/Pro/internal/Parser.h>
+#include <parakeet/ProE/internal/Parser.h>
+#include <parakeet/internal/CaptureReader.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Replay
+{
+/// \brief Plays back a capture recorded with CaptureRecorder (or a pcap of a Parakeet ProE), pushing the recorded
+/// data through the same parsers a live sensor's data goes through. Scans are timestamped with the recorded time.
+class Driver : public mechaspin::parakeet::Driver
+{
+    public:
+        /// \brief How fast recorded data is played back
+        enum Pacing
+        {
+            /// \brief At the speed it was recorded
+            RealTime,
+
+            /// \brief At the recorded speed multiplied by SensorConfiguration::speed
+            Scaled,
+
+            /// \brief Without waiting between records
+            AsFastAsPossible
+        };
+
+        struct SensorConfiguration
+        {
+            SensorConfiguration() = default;
+
+            /// \brief Create a SensorConfiguration object with the following settings
+            /// \param[in] capturePath - A capture segment file, or the base path which was given to CaptureRecorder
+            /// \param[in] pacing - How fast the capture should be played back
+            /// \param[in] speed - The playback speed multiplier used with Pacing::Scaled, ie: 50 to play back at 50x, a speed of 0 or below plays back as fast as possible
+            SensorConfiguration(const std::string& capturePath, Pacing pacing, double speed = 1)
+            {
+                this->capturePath = capturePath;
+                this->pacing = pacing;
+                this->speed = speed;
+            }
+
+            std::string capturePath;
+            Pacing pacing = RealTime;
+            double speed = 1;
+
+            /// \brief The recorded stream to play back, or -1 for the first stream holding data
+            int streamId = -1;
+
+            /// \brief Start again from the beginning when the end of the capture is reached
+            bool loop = false;
+        };
+
+        /// \brief A constructor responsible for intializing default variable states
+        Driver();
+
+        /// \brief A deconstructor responsible for closing the capture
+        virtual ~Driver();
+
+        /// \brief Open a capture for playback
+        /// \param[in] sensorConfiguration - The capture and playback settings
+        void connect(const SensorConfiguration& sensorConfiguration);
+
+        /// \brief Start playing back the capture
+        void start() override;
+
+        /// \brief Stop playing back the capture
+        void stop() override;
+
+        /// \brief Close the capture
+        void close() override;
+
+        /// \brief Recorded data can not be changed, the value is only stored
+        /// \param[in] Hz - The scanning frequency to be reported
+        void setScanningFrequency_Hz(ScanningFrequency Hz);
+
+        /// \brief Gets the scanning frequency
+        /// \returns The scanning frequency
+        ScanningFrequency getScanningFrequency_Hz();
+
+        /// \brief Recorded data can not be changed, the value is only stored
+        /// \param[in] enable - The state of intensity data to be reported
+        void enableIntensityData(bool enable);
+
+        /// \brief Gets the state of intensity data
+        /// \returns True if the recorded Parakeet Pro data carries intensity, otherwise the stored value
+        bool isIntensityDataEnabled();
+
+        /// \brief Recorded data can not be changed, the value is only stored
+        /// \param[in] enable - The state of data smoothing to be reported
+        void enableDataSmoothing(bool enable);
+
+        /// \brief Gets the state of data smoothing
+        /// \returns The stored state of data smoothing
+        bool isDataSmoothingEnabled();
+
+        /// \brief Recorded data can not be changed, the value is only stored
+        /// \param[in] enable - The state of drag point removal to be reported
+        void enableRemoveDragPoint(bool enable);
+
+        /// \brief Gets the state of drag point removal
+        /// \returns The stored state of drag point removal
+        bool isDragPointRemovalEnabled();
+
+        /// \brief Gets the virtual clock, the recorded time of the data most recently played back
+        /// \returns The current playback time
+        std::chrono::system_clock::time_point getVirtualTime();
+
+        /// \returns True once every record of the capture has been played back
+        bool isEndOfCapture();
+
+        /// \brief Block until the end of the capture is reached or the Driver is stopped
+        void waitForEndOfCapture();
+
+        /// \returns The number of records played back since start()
+        std::uint64_t getReplayedRecordCount();
+
+        /// \returns True if a segment of the capture could not be unmapped or closed
+        bool hasCloseError();
+
+    protected:
+        CaptureRecorder::StreamInfo getCaptureStreamInfo() override;
+
+    private:
+        void replayUpdateThreadFunction();
+        void selectStream();
+        void detectIntensityLayout();
+        void resetPlayback();
+        void replayRecord(const internal::CaptureReader::Record& record);
+        void onCompleteLidarMessage(const ProE::internal::MessageParser::CompleteLidarMessage& lidarMessage);
+        void onPartialSector(const ProE::internal::MessageParser::PartialSector& partialSector);
+        void setEndOfCapture(bool endOfCapture);
+
+        bool isConnected();
+
+        SensorConfiguration sensorConfiguration;
+        internal::CaptureReader captureReader;
+        CaptureRecorder::StreamInfo streamInfo;
+        int streamId = -1;
+
+        Pro::internal::MessageParser proParser;
+        ProE::internal::MessageParser proEParser;
+        std::vector<unsigned char> proBuffer;
+
+        internal::CaptureReader::Record pendingRecord;
+        bool hasPendingRecord = false;
+        std::chrono::system_clock::time_point firstRecordTime;
+        std::chrono::steady_clock::time_point playbackStartTime;
+        bool playbackStarted = false;
+
+        std::atomic<std::chrono::system_clock::rep> virtualTime{0};
+        std::atomic<std::uint64_t> replayedRecordCount{0};
+        std::atomic<bool> closeError{false};
+
+        std::mutex endOfCaptureMutex;
+        std::condition_variable endOfCaptureCondition;
+        bool endOfCapture = false;
+
+        ScanningFrequency scanningFrequency_Hz = Frequency_10Hz;
+        bool intensity = false;
+        bool dataSmoothing = false;
+        bool dragPointRemoval = false;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_ROLLINGSCAN_H
+#define PARAKEET_ROLLINGSCAN_H
+
+#include <parakeet/ScanDataPolar.h>
+#include <parakeet/SectorView.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief The most recent 360 degrees of sectors, updated on every sector rather than once per revolution, so the newest
+/// points of any bearing are never more than a sector old. The sectors are kept in a ring: each sector's points are copied
+/// in once when it arrives, and the oldest sectors are dropped as the newest ones cover their angles again.
+class RollingScan
+{
+    public:
+        /// \brief The most sectors the window holds, however little of a revolution they cover
+        static const std::size_t MAX_SECTOR_COUNT = 256;
+
+        RollingScan() = default;
+
+        /// \brief Add the newest sector, dropping the oldest sectors which are no longer needed to cover 360 degrees
+        void addSector(const SectorView& sectorView);
+
+        /// \brief Remove every sector, keeping the memory for the next ones
+        void clear();
+
+        /// \returns The number of sectors in the window
+        std::size_t getSectorCount() const;
+
+        /// \brief A view of one of the sectors, valid until the next sector is added
+        /// \param[in] index - The sector, from 0 for the oldest to getSectorCount() - 1 for the newest
+        SectorView getSector(std::size_t index) const;
+
+        std::size_t getPointCount() const;
+
+        /// \returns The angle from the start of the oldest sector to the end of the newest: 360 degrees once a revolution has
+        /// arrived, a little more where the oldest sector overlaps the newest, or less where sectors were lost
+        double getSpan_deg() const;
+
+        /// \brief Returns the timestamp which signals when the oldest sector was received, the epoch when the window is empty
+        const std::chrono::system_clock::time_point& getTimestamp() const;
+
+        /// \brief Returns the timestamp which signals when the newest sector was received, the epoch when the window is empty
+        const std::chrono::system_clock::time_point& getNewestTimestamp() const;
+
+        /// \brief Copy every point of the window, oldest first, into a ScanDataPolar
+        ScanDataPolar toScanDataPolar() const;
+
+    private:
+        struct Slot
+        {
+            std::chrono::system_clock::time_point timestamp;
+            double startAngle_deg;
+            double endAngle_deg;
+            bool partial;
+
+            // The start angle counted on round the revolutions since the window was last rebased, so the window's span is
+            // a subtraction
+            double unwrappedStartAngle_deg;
+
+            std::vector<std::uint16_t> ranges_mm;
+            std::vector<std::uint8_t> intensities;
+        };
+
+        const Slot& getSlot(std::size_t index) const;
+        double getUnwrappedEndAngle_deg(const Slot& slot) const;
+
+        std::vector<Slot> slots;
+        std::size_t firstSlot = 0;
+        std::size_t sectorCount = 0;
+        std::size_t pointCount = 0;
+};
+}
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANARCHIVEREADER_H
+#define PARAKEET_SCANARCHIVEREADER_H
+
+#include <parakeet/ScanView.h>
+#include <parakeet/internal/MappedFile.h>
+#include <parakeet/internal/ScanArchiveFormat.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Memory-maps a scan archive written by ScanArchiveWriter and finds scans by sensor and timestamp in O(log n).
+/// Returned ScanViews point directly into the mapped file and stay valid until the reader is closed.
+/// Every index entry is checked to lie within the file when it is opened; an archive whose index does not is scanned through
+/// instead, as one which was not closed is.
+class ScanArchiveReader
+{
+    public:
+        /// \brief Open an archive
+        /// \param[in] path - The location of the archive file
+        ScanArchiveReader(const std::string& path);
+
+        ScanArchiveReader(const ScanArchiveReader&) = delete;
+        ScanArchiveReader& operator=(const ScanArchiveReader&) = delete;
+
+        /// \returns The number of scans in the archive
+        std::size_t getScanCount() const;
+
+        /// \returns The ids of all sensors with scans in the archive, in ascending order
+        std::vector<std::uint32_t> getSensorIds() const;
+
+        /// \brief Get a scan by its position in the index, which is ordered by sensor and then by timestamp
+        /// \param[in] position - A position below getScanCount()
+        ScanView getScan(std::size_t position) const;
+
+        /// \brief Find the scan of a sensor which was being received at a moment, ie: the last scan starting at or before it
+        /// \param[in] sensorId - The sensor the scan came from
+        /// \param[in] timestamp - The moment to look up
+        /// \param[out] scanView - The scan which was found
+        /// \returns False if the sensor has no scan starting at or before the timestamp
+        bool findScan(std::uint32_t sensorId, const std::chrono::system_clock::time_point& timestamp, ScanView& scanView) const;
+
+        /// \brief Find every scan of a sensor which starts within a time range
+        /// \param[in] sensorId - The sensor the scans came from
+        /// \param[in] from - The start of the time range, inclusive
+        /// \param[in] to - The end of the time range, exclusive
+        /// \returns The scans, ordered by timestamp
+        std::vector<ScanView> findScans(std::uint32_t sensorId, const std::chrono::system_clock::time_point& from, const std::chrono::system_clock::time_point& to) const;
+
+    private:
+        void loadIndex();
+        bool isIndexValid(std::uint64_t indexOffset) const;
+        void rebuildIndex(std::size_t scansEnd);
+        std::size_t lowerBound(std::uint32_t sensorId, std::int64_t timestamp_ns) const;
+
+        internal::MappedFile file;
+
+        const internal::ScanArchiveFormat::IndexEntry* index = nullptr;
+        std::size_t indexSize = 0;
+
+        // Only used for archives which were not closed, and so have no index on disk
+        std::vector<internal::ScanArchiveFormat::IndexEntry> rebuiltIndex;
+};
+}
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANARCHIVEWRITER_H
+#define PARAKEET_SCANARCHIVEWRITER_H
+
+#include <parakeet/ScanDataPolar.h>
+#include <parakeet/internal/ScanArchiveFormat.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Appends decoded scans to an archive file, which ScanArchiveReader can search by sensor and timestamp.
+/// Points are stored as single precision ranges and angles. The index is written when the archive is closed;
+/// an archive which was not closed is still readable, but has to be scanned through once when it is opened.
+class ScanArchiveWriter
+{
+    public:
+        /// \brief Create (or replace) an archive
+        /// \param[in] path - The location of the archive file
+        ScanArchiveWriter(const std::string& path);
+
+        ScanArchiveWriter(const ScanArchiveWriter&) = delete;
+        ScanArchiveWriter& operator=(const ScanArchiveWriter&) = delete;
+
+        /// \brief Closes the archive
+        ~ScanArchiveWriter();
+
+        /// \brief Append a scan to the archive
+        /// \param[in] scanDataPolar - The scan to store
+        /// \param[in] sensorId - The sensor the scan came from
+        /// \returns False if the scan could not be written, ie: the disk is full. No scan is written after a failure.
+        bool write(const ScanDataPolar& scanDataPolar, std::uint32_t sensorId = 0);
+
+        /// \brief Write the index and close the archive file. The index is left out after a failed write, so the reader
+        /// scans through the file and finds every scan which was written whole.
+        /// \returns False if any write failed
+        bool close();
+
+        /// \returns The number of scans written
+        std::size_t getScanCount() const;
+
+        /// \returns True if a write has failed
+        bool hasWriteError() const;
+
+    private:
+        std::FILE* file = nullptr;
+        std::uint64_t offset = 0;
+        bool writeError = false;
+        std::vector<internal::ScanArchiveFormat::IndexEntry> index;
+
+        std::vector<unsigned char> scanBuffer;
+};
+}
+}
+
+#endif
@@ -22,6 +22,9 @@ class ScanDataXY
         /// \param[in] timestampOfFirstPoint - A time point which holds the time the first point was received
         /// \returns A ScanDataXY object which holds a vector of PointXY(s) and a timestamp
         ScanDataXY(const std::vector<PointXY>& vectorOfCartesianPoints, const std::chrono::time_point<std::chrono::system_clock>& timestampOfFirstPoint);
+
+        /// \brief Create a ScanDataXY which takes over a vector of PointXYs, rather than copying it
+        ScanDataXY(std::vector<PointXY>&& vectorOfCartesianPoints, const std::chrono::time_point<std::chrono::system_clock>& timestampOfFirstPoint);
         
         /// \brief Returns the vector of points this object is holding onto
         const std::vector<PointXY>& getPoints() const;
@@ -0,0 +1,53 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANDECODER_H
+#define PARAKEET_SCANDECODER_H
+
+#include <parakeet/PointPolar.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Restores scans encoded by ScanEncoder
+class ScanDecoder
+{
+    public:
+        /// \brief Decode one scan
+        /// \param[in] data - The encoded data
+        /// \param[in] length - The number of bytes available
+        /// \param[out] points - The decoded points, replacing any previous contents
+        /// \param[out] timestamp - The time the first point was received
+        /// \returns The number of bytes the scan took up, or 0 if the data is malformed or incomplete
+        std::size_t decode(const unsigned char* data, std::size_t length, std::vector<PointPolar>& points, std::chrono::system_clock::time_point& timestamp);
+
+        /// \brief Forget the previous scan, ie: before decoding a stream from its start again
+        void reset();
+
+    private:
+        std::size_t decodeChannel(const unsigned char* data, std::size_t length, std::size_t count, std::vector<std::int32_t>& values, std::vector<std::int32_t>& previousValues, bool useInterScanDelta, bool secondOrder);
+
+        bool hasPreviousScan = false;
+        std::int64_t previousTimestamp_ns = 0;
+
+        std::vector<std::int32_t> ranges;
+        std::vector<std::int32_t> angles;
+        std::vector<std::int32_t> intensities;
+
+        std::vector<std::int32_t> previousRanges;
+        std::vector<std::int32_t> previousAngles;
+        std::vector<std::int32_t> previousIntensities;
+
+        std::vector<std::uint32_t> residuals;
+};
+}
+}
+
+#endif
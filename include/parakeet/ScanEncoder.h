@@ -0,0 +1,58 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANENCODER_H
+#define PARAKEET_SCANENCODER_H
+
+#include <parakeet/ScanDataPolar.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief Compresses scans for storage or transport, to be restored with ScanDecoder.
+/// Ranges are stored in whole millimeters and angles in thousandths of a degree, the resolution the sensors report at, and
+/// intensities exactly. Only that rounding is lossy: the ranges the sensors measure are whole millimeters and come back
+/// unchanged, but angles interpolated across a sector, as the Driver's are, come back up to 0.0005 degrees from where they
+/// were. Each value is stored as a zigzag coded delta, bit-packed in blocks.
+class ScanEncoder
+{
+    public:
+        /// \brief Create an encoder
+        /// \param[in] interScanDelta - Code each scan against the previous scan rather than on its own, which compresses
+        /// static scenes better, but requires every scan to be decoded in order, by a single ScanDecoder
+        ScanEncoder(bool interScanDelta = false);
+
+        /// \brief Encode a scan
+        /// \param[in] scanDataPolar - The scan to encode
+        /// \param[out] output - The buffer the encoded scan is appended to
+        void encode(const ScanDataPolar& scanDataPolar, std::vector<unsigned char>& output);
+
+        /// \brief Forget the previous scan, so the next scan is encoded on its own
+        void reset();
+
+    private:
+        void encodeChannel(const std::vector<std::int32_t>& values, const std::vector<std::int32_t>& previousValues, bool useInterScanDelta, bool secondOrder, std::vector<unsigned char>& output);
+
+        bool interScanDelta;
+        bool hasPreviousScan = false;
+        std::int64_t previousTimestamp_ns = 0;
+
+        std::vector<std::int32_t> ranges;
+        std::vector<std::int32_t> angles;
+        std::vector<std::int32_t> intensities;
+
+        std::vector<std::int32_t> previousRanges;
+        std::vector<std::int32_t> previousAngles;
+        std::vector<std::int32_t> previousIntensities;
+
+        std::vector<std::uint32_t> residuals;
+};
+}
+}
+
+#endif
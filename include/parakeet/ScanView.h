@@ -0,0 +1,65 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANVIEW_H
+#define PARAKEET_SCANVIEW_H
+
+#include <parakeet/ScanDataPolar.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A read-only view of a scan stored as columns of ranges, angles and intensities, ie: in a memory-mapped ScanArchive.
+/// The view does not own its data, which must outlive it.
+class ScanView
+{
+    public:
+        ScanView() = default;
+
+        /// \brief Create a view over columns of point data
+        /// \param[in] sensorId - The sensor the scan came from
+        /// \param[in] timestamp - The time the first point was received
+        /// \param[in] pointCount - The number of points in each column
+        /// \param[in] ranges_mm - The distance of each point from the origin, in millimeters
+        /// \param[in] angles_deg - The polar angle of each point, in degrees
+        /// \param[in] intensities - The intensity of each point
+        ScanView(std::uint32_t sensorId, const std::chrono::system_clock::time_point& timestamp, std::size_t pointCount,
+            const float* ranges_mm, const float* angles_deg, const std::uint16_t* intensities);
+
+        std::uint32_t getSensorId() const;
+
+        /// \brief Returns the timestamp which signals when the first point was received
+        const std::chrono::system_clock::time_point& getTimestamp() const;
+
+        std::size_t getPointCount() const;
+
+        float getRange_mm(std::size_t index) const;
+        float getAngle_deg(std::size_t index) const;
+        std::uint16_t getIntensity(std::size_t index) const;
+
+        const float* getRanges_mm() const;
+        const float* getAngles_deg() const;
+        const std::uint16_t* getIntensities() const;
+
+        /// \brief Copy the viewed points into a ScanDataPolar
+        ScanDataPolar toScanDataPolar() const;
+
+    private:
+        std::uint32_t sensorId = 0;
+        std::chrono::system_clock::time_point timestamp;
+        std::size_t pointCount = 0;
+
+        const float* ranges_mm = nullptr;
+        const float* angles_deg = nullptr;
+        const std::uint16_t* intensities = nullptr;
+};
+}
+}
+
+#endif
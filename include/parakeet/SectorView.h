@@ -0,0 +1,74 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SECTORVIEW_H
+#define PARAKEET_SECTORVIEW_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+/// \brief A read-only view of one decoded sector of points, in the sensor's units, handed to a Driver's sector callback
+/// before the revolution it belongs to is complete. The points are evenly spread from the start angle to the end angle.
+/// The view does not own its data, which is only valid until the callback returns.
+class SectorView
+{
+    public:
+        SectorView() = default;
+
+        /// \brief Create a view over a sector's columns
+        /// \param[in] timestamp - The time the sector was received
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] endAngle_deg - The angle the sector ends at, one point past the last point
+        /// \param[in] pointCount - The number of points in each column
+        /// \param[in] ranges_mm - The distance of each point from the origin, in millimeters, 0 for a point without a return
+        /// \param[in] intensities - The intensity of each point
+        /// \param[in] partial - True if the sector is one datagram of a larger sector, as on the ProE
+        SectorView(const std::chrono::system_clock::time_point& timestamp, double startAngle_deg, double endAngle_deg, std::size_t pointCount,
+            const std::uint16_t* ranges_mm, const std::uint8_t* intensities, bool partial);
+
+        /// \brief Returns the timestamp which signals when the sector was received
+        const std::chrono::system_clock::time_point& getTimestamp() const;
+
+        double getStartAngle_deg() const;
+        double getEndAngle_deg() const;
+        double getAnglePerPoint_deg() const;
+
+        std::size_t getPointCount() const;
+
+        std::uint16_t getRange_mm(std::size_t index) const;
+
+        /// \returns The angle of a point, counted on from the start angle, so it may pass 360 degrees
+        double getAngle_deg(std::size_t index) const;
+
+        std::uint8_t getIntensity(std::size_t index) const;
+
+        const std::uint16_t* getRanges_mm() const;
+        const std::uint8_t* getIntensities() const;
+
+        /// \returns True if the sector is one datagram of a larger sector, and the rest of that sector is still to come
+        bool isPartial() const;
+
+        /// \returns True if the sector completes a revolution, the next sector starts the next revolution
+        bool isLastOfRevolution() const;
+
+    private:
+        std::chrono::system_clock::time_point timestamp;
+        double startAngle_deg = 0;
+        double endAngle_deg = 0;
+        std::size_t pointCount = 0;
+
+        const std::uint16_t* ranges_mm = nullptr;
+        const std::uint8_t* intensities = nullptr;
+
+        bool partial = false;
+};
+}
+}
+
+#endif
@@ -44,8 +44,19 @@ class SerialPort
         /// \returns A boolean containing the connection state
         bool isConnected() const;
 
+        /// \brief Check if the most recent read from the serial port failed, ie: because the device was unplugged
+        /// \returns True if the last read failed
+        bool hasReadError() const;
+
 	private:
         std::string lastUsedPort;
+        bool readError = false;
+
+        #if defined(_WIN32)
+            void* hPort = 0;
+        #elif defined(__linux) || defined(linux) || defined(__linux__)
+            int hPort = 0;
+        #endif
 };
 }
 }
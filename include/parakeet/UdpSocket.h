@@ -51,7 +51,27 @@ public:
 
 	/// \returns The current connection state
 	bool isConnected();
+
+	/// \brief Check if the most recent read from the socket failed
+	/// \returns True if the last read failed
+	bool hasReadError() const;
+
+	/// \brief Gets when the datagram returned by the most recent read arrived
+	/// \returns The kernel receive timestamp where the OS provides one, otherwise the time read() returned it
+	std::chrono::system_clock::time_point getLastReadTimestamp() const;
+
+	/// \brief Check where the timestamp of the most recent read came from
+	/// \returns True if the timestamp was taken by the OS kernel when the datagram arrived
+	bool isLastReadTimestampFromKernel() const;
+
+	/// \brief Set how long a read waits for a datagram before returning empty handed
+	/// \param[in] timeout - The longest time a read may block, one second by default
+	void setReadTimeout(std::chrono::milliseconds timeout);
 private:
+	bool readError = false;
+	std::chrono::milliseconds readTimeout = std::chrono::milliseconds(1000);
+	std::chrono::system_clock::time_point lastReadTimestamp;
+	bool lastReadTimestampFromKernel = false;
 
 	#if defined(_WIN32)
 		unsigned long long socket = 0;
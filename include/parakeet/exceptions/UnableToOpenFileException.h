@@ -0,0 +1,26 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_UNABLETOOPENFILEEXCEPTION_H
+#define PARAKEET_UNABLETOOPENFILEEXCEPTION_H
+
+#include <stdexcept>
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace exceptions
+{
+class UnableToOpenFileException : public std::runtime_error
+{
+    public:
+        UnableToOpenFileException(const std::string& path);
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_ACKNOWLEDGEDSETTING_H
+#define PARAKEET_ACKNOWLEDGEDSETTING_H
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Tracks the last value of a setting which the sensor has acknowledged, so that
+/// commands which would not change the sensor's state can be skipped.
+template <typename T>
+class AcknowledgedSetting
+{
+    public:
+        /// \brief Check if the sensor is known to already hold a value
+        /// \param[in] value - The value to compare against the acknowledged value
+        /// \returns True if the sensor has acknowledged this exact value
+        bool matches(const T& value) const
+        {
+            return known && acknowledgedValue == value;
+        }
+
+        /// \brief Record that the sensor has acknowledged a value
+        /// \param[in] value - The value the sensor acknowledged
+        void acknowledge(const T& value)
+        {
+            acknowledgedValue = value;
+            known = true;
+        }
+
+        /// \brief Forget the acknowledged value, ie: after the connection to the sensor was re-established
+        void invalidate()
+        {
+            known = false;
+        }
+
+    private:
+        bool known = false;
+        T acknowledgedValue = T();
+};
+}
+}
+}
+
+#endif
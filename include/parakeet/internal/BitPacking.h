@@ -0,0 +1,69 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_BITPACKING_H
+#define PARAKEET_BITPACKING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Integer coding helpers used by the scan codec.
+/// Values are packed in blocks of BLOCK_SIZE, each block prefixed by one byte holding the bit width of its largest value.
+namespace BitPacking
+{
+    const std::size_t BLOCK_SIZE = 128;
+
+    inline std::uint32_t zigzagEncode(std::int32_t value)
+    {
+        return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+    }
+
+    inline std::int32_t zigzagDecode(std::uint32_t value)
+    {
+        return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+    }
+
+    inline std::uint64_t zigzagEncode64(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    inline std::int64_t zigzagDecode64(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    /// \brief Append a variable length integer, 7 bits per byte
+    void writeVarint(std::uint64_t value, std::vector<unsigned char>& output);
+
+    /// \brief Read a variable length integer
+    /// \returns The number of bytes read, or 0 if the data ended or the value is too long
+    std::size_t readVarint(const unsigned char* data, std::size_t length, std::uint64_t& value);
+
+    /// \brief Append values packed in blocks
+    /// \param[in] values - The values to pack
+    /// \param[in] count - The number of values
+    /// \param[out] output - The buffer the packed blocks are appended to
+    void pack(const std::uint32_t* values, std::size_t count, std::vector<unsigned char>& output);
+
+    /// \brief Unpack values written by pack()
+    /// \param[in] data - The packed blocks
+    /// \param[in] length - The number of bytes available
+    /// \param[out] values - Space for count values
+    /// \param[in] count - The number of values which were packed
+    /// \returns The number of bytes read, or 0 if the data is malformed
+    std::size_t unpack(const unsigned char* data, std::size_t length, std::uint32_t* values, std::size_t count);
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_CAPTUREFORMAT_H
+#define PARAKEET_CAPTUREFORMAT_H
+
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief The on-disk layout of native capture segments (*.pkcap).
+/// A segment is a FileHeader followed by records, each a RecordHeader and its payload padded to RECORD_ALIGNMENT.
+/// Every segment starts with a StreamInfo record for each stream, so segments can be read on their own.
+/// A record type of zero marks the end of the data.
+namespace CaptureFormat
+{
+    const char MAGIC[8] = { 'P', 'K', 'C', 'A', 'P', 'T', 'R', 'E' };
+    const std::uint32_t VERSION = 1;
+    const std::uint32_t RECORD_ALIGNMENT = 8;
+
+    const char SEGMENT_EXTENSION[] = ".pkcap";
+    const char PCAP_SEGMENT_EXTENSION[] = ".pcap";
+
+    enum RecordType : std::uint16_t
+    {
+        END_OF_DATA = 0,
+        STREAM_INFO = 1,
+        DATA = 2
+    };
+
+    enum RecordFlags : std::uint16_t
+    {
+        KERNEL_TIMESTAMP = 0x1
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t segmentIndex;
+        std::int64_t creationTime_ns;
+        std::uint64_t reserved;
+    };
+
+    struct RecordHeader
+    {
+        std::uint16_t type;
+        std::uint16_t streamId;
+        std::uint16_t flags;
+        std::uint16_t reserved;
+        std::uint32_t payloadLength;
+        std::uint32_t reserved2;
+        std::int64_t timestamp_ns;
+    };
+
+    struct StreamInfoPayload
+    {
+        std::uint16_t streamType;
+        std::uint16_t sourcePort;
+        std::uint16_t destinationPort;
+        std::uint16_t sourceAddressLength;
+        std::uint16_t descriptionLength;
+        std::uint16_t reserved[3];
+        // Followed by the source address and description characters
+    };
+
+    inline std::uint32_t alignedLength(std::uint32_t length)
+    {
+        return (length + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+    }
+}
+}
+}
+}
+
+#endif
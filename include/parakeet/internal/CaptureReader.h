@@ -0,0 +1,101 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_CAPTUREREADER_H
+#define PARAKEET_CAPTUREREADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <parakeet/CaptureRecorder.h>
+#include <parakeet/internal/MappedFile.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Reads back the data records of a capture written by CaptureRecorder, or of a pcap file holding UDP datagrams.
+/// Record data points directly into the memory-mapped segment, and stays valid until the reader moves to the next segment.
+class CaptureReader
+{
+    public:
+        struct Record
+        {
+            int streamId;
+            std::chrono::system_clock::time_point timestamp;
+            bool kernelTimestamp;
+
+            const unsigned char* data;
+            unsigned int length;
+        };
+
+        /// \brief Open a capture
+        /// \param[in] path - A single segment file, or the base path which was given to CaptureRecorder
+        /// \returns The success state of the operation
+        bool open(const std::string& path);
+
+        /// \brief Close the capture
+        /// \returns False if any segment could not be unmapped or closed since the capture was opened
+        bool close();
+
+        /// \brief Read the next data record, moving on to the next segment as needed
+        /// \param[out] record - The record which was read
+        /// \returns False at the end of the capture
+        bool next(Record& record);
+
+        /// \brief Go back to the first record of the capture
+        void rewind();
+
+        /// \param[in] streamId - The streamId of a record
+        /// \returns The description of a stream, or nullptr if the stream has not been described yet
+        const CaptureRecorder::StreamInfo* getStreamInfo(int streamId) const;
+
+        /// \returns True if a capture is open, even once all of its records have been read
+        bool isOpen() const;
+
+    private:
+        enum SegmentFormat
+        {
+            Native,
+            Pcap
+        };
+
+        bool openSegment(std::size_t index);
+        void closeSegment();
+        bool nextNativeRecord(Record& record);
+        bool nextPcapRecord(Record& record);
+        bool parseUdpDatagram(const unsigned char* packet, std::size_t length, Record& record);
+        std::uint32_t readPcap32(const unsigned char* data) const;
+
+        std::vector<std::string> segmentPaths;
+        std::size_t segmentIndex = 0;
+        MappedFile segment;
+        bool closeError = false;
+        SegmentFormat segmentFormat = Native;
+        std::size_t offset = 0;
+
+        bool pcapSwapped = false;
+        bool pcapNanosecond = false;
+        std::uint32_t pcapLinkType = 0;
+
+        struct UdpStreamKey
+        {
+            std::uint32_t sourceAddress;
+            std::uint16_t sourcePort;
+            std::uint16_t destinationPort;
+        };
+
+        std::vector<UdpStreamKey> udpStreamKeys;
+        std::vector<CaptureRecorder::StreamInfo> streams;
+        std::vector<bool> streamDescribed;
+};
+}
+}
+}
+
+#endif
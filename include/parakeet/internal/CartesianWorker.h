@@ -0,0 +1,49 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_CARTESIANWORKER_H
+#define PARAKEET_CARTESIANWORKER_H
+
+#include <parakeet/CachedScan.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief A thread which calculates the cartesian coordinates of CachedScans ahead of their consumers. Only the latest scan
+/// is kept waiting, a scan which is replaced before the worker reaches it is transformed by whoever asks for it first.
+class CartesianWorker
+{
+    public:
+        CartesianWorker();
+        ~CartesianWorker();
+
+        CartesianWorker(const CartesianWorker&) = delete;
+        CartesianWorker& operator=(const CartesianWorker&) = delete;
+
+        /// \brief Queue a scan to be transformed, replacing any scan still waiting
+        void post(const std::shared_ptr<const CachedScan>& cachedScan);
+
+    private:
+        void threadMainLoop();
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::shared_ptr<const CachedScan> pendingScan;
+        bool running = true;
+
+        std::thread thread;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_GRIDRESAMPLER_H
+#define PARAKEET_GRIDRESAMPLER_H
+
+#include <parakeet/GridScanData.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Collects the sectors of a revolution and resamples them onto a GridScanData. Within a sector the points are evenly
+/// spaced, so the points either side of a cell are found from its bearing rather than by a search.
+class GridResampler
+{
+    public:
+        /// \brief Add a sector's ranges to the revolution
+        /// \param[in] pointCount - The number of ranges
+        /// \param[in] startAngle_deg - The angle of the first point
+        /// \param[in] endAngle_deg - The angle one point past the last point
+        /// \param[in] ranges_mm - The range of each point, 0 for a point without a return
+        void addSector(std::size_t pointCount, double startAngle_deg, double endAngle_deg, const std::uint16_t* ranges_mm);
+
+        /// \brief Write the revolution into every cell of the grid, and start the next revolution
+        void resample(GridScanData& grid);
+
+        bool empty() const;
+
+    private:
+        struct Sector
+        {
+            double startAngle_deg;
+            double anglePerPoint_deg;
+            std::size_t offset;
+            std::size_t pointCount;
+        };
+
+        void resampleMinimum(GridScanData& grid);
+        void resampleSector(GridScanData& grid, std::size_t sectorIndex);
+
+        std::vector<Sector> sectors;
+
+        // The ranges of every sector, one after another
+        std::vector<std::uint16_t> ranges_mm;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_MAPPEDFILE_H
+#define PARAKEET_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief A file mapped into memory, either writable with a fixed reserved size, or read-only
+class MappedFile
+{
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        /// \brief Create (or replace) a file, allocate size bytes of disk space for it and map it for writing
+        /// \param[in] path - The location of the file
+        /// \param[in] size - The number of bytes to reserve
+        /// \returns False if the file could not be created or its disk space allocated
+        bool create(const std::string& path, std::size_t size);
+
+        /// \brief Map an existing file for reading
+        /// \param[in] path - The location of the file
+        /// \returns The success state of the operation
+        bool openReadOnly(const std::string& path);
+
+        /// \brief Unmap the file, and truncate a writable file to the number of bytes actually used
+        /// \param[in] usedSize - The number of bytes at the start of the file to keep
+        /// \returns False if the file could not be unmapped, truncated or closed, it is closed regardless
+        bool close(std::size_t usedSize);
+
+        /// \brief Unmap the file, keeping its full size
+        /// \returns False if the file could not be unmapped or closed, it is closed regardless
+        bool close();
+
+        unsigned char* data() const;
+        std::size_t size() const;
+        bool isOpen() const;
+
+    private:
+        unsigned char* mapping = nullptr;
+        std::size_t mappingSize = 0;
+        bool writable = false;
+
+        #if defined(_WIN32)
+            void* fileHandle = nullptr;
+            void* mappingHandle = nullptr;
+        #elif defined(__linux) || defined(linux) || defined(__linux__)
+            int fileDescriptor = -1;
+        #endif
+};
+}
+}
+}
+
+#endif
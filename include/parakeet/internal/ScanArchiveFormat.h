@@ -0,0 +1,66 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANARCHIVEFORMAT_H
+#define PARAKEET_SCANARCHIVEFORMAT_H
+
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief The on-disk layout of scan archives.
+/// An archive is a FileHeader followed by scans, each a ScanHeader and the point columns
+/// (float range_mm[pointCount], float angle_deg[pointCount], uint16 intensity[pointCount]) padded to ALIGNMENT.
+/// Closing the archive appends an IndexEntry per scan, sorted by sensor and timestamp, and a Footer.
+namespace ScanArchiveFormat
+{
+    const char MAGIC[8] = { 'P', 'K', 'S', 'C', 'A', 'N', 'A', 'R' };
+    const char FOOTER_MAGIC[8] = { 'P', 'K', 'S', 'C', 'I', 'N', 'D', 'X' };
+    const std::uint32_t VERSION = 1;
+    const std::uint32_t ALIGNMENT = 8;
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+    };
+
+    struct ScanHeader
+    {
+        std::uint32_t sensorId;
+        std::uint32_t pointCount;
+        std::int64_t timestamp_ns;
+    };
+
+    struct IndexEntry
+    {
+        std::int64_t timestamp_ns;
+        std::uint32_t sensorId;
+        std::uint32_t pointCount;
+        std::uint64_t offset;
+    };
+
+    struct Footer
+    {
+        std::uint64_t indexOffset;
+        std::uint64_t entryCount;
+        char magic[8];
+    };
+
+    inline std::uint64_t scanLength(std::uint32_t pointCount)
+    {
+        std::uint64_t length = sizeof(ScanHeader) + static_cast<std::uint64_t>(pointCount) * (sizeof(float) + sizeof(float) + sizeof(std::uint16_t));
+        return (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+}
+}
+}
+}
+
+#endif
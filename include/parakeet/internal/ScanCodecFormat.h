@@ -0,0 +1,35 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANCODECFORMAT_H
+#define PARAKEET_SCANCODECFORMAT_H
+
+#include <cstdint>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief The layout of a scan encoded by ScanEncoder:
+/// version byte, flags byte, varint point count, varint zigzag timestamp in nanoseconds (a delta to the previous scan
+/// when INTER_SCAN_DELTA is set), then the packed residuals of the ranges, angles and intensities.
+namespace ScanCodecFormat
+{
+    const std::uint8_t VERSION = 1;
+
+    enum Flags : std::uint8_t
+    {
+        INTER_SCAN_DELTA = 0x1
+    };
+
+    const double RANGE_UNITS_PER_MM = 1;
+    const double ANGLE_UNITS_PER_DEGREE = 1000;
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANDATA_H
+#define PARAKEET_SCANDATA_H
+
+#include <chrono>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief A single decoded sector of points, as handed from a sensor parser to the Driver
+struct ScanData
+{
+    static const int MAX_NUMBER_OF_POINTS_FROM_SENSOR = 1000;          // Arbitrary size
+
+    ScanData()
+    {
+        this->timestamp = std::chrono::system_clock::now();
+    }
+
+    ScanData(const std::chrono::system_clock::time_point& timestamp)
+    {
+        this->timestamp = timestamp;
+    }
+
+    double startAngle_deg;
+    double endAngle_deg;
+    unsigned short count;
+    unsigned short reserved;
+    unsigned short dist_mm[MAX_NUMBER_OF_POINTS_FROM_SENSOR];
+    unsigned char intensity[MAX_NUMBER_OF_POINTS_FROM_SENSOR];
+
+    std::chrono::system_clock::time_point timestamp;
+};
+}
+}
+}
+
+#endif
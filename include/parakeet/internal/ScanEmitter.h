@@ -0,0 +1,375 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_SCANEMITTER_H
+#define PARAKEET_SCANEMITTER_H
+
+#include <parakeet/BasicScanData.h>
+#include <parakeet/CompactScanData.h>
+#include <parakeet/DerivedScanStream.h>
+#include <parakeet/GridScanData.h>
+#include <parakeet/ProtectiveFieldMonitor.h>
+#include <parakeet/RangeIndex.h>
+#include <parakeet/RollingScan.h>
+#include <parakeet/SectorView.h>
+#include <parakeet/internal/GridResampler.h>
+#include <parakeet/internal/ScanData.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Builds revolutions of one point type out of the sectors handed to the Driver, so the Driver can publish scans
+/// of any point type without knowing the type
+class ScanEmitter
+{
+    public:
+        virtual ~ScanEmitter() = default;
+
+        /// \returns The point type the scans are built from (or the scan type, ie: CompactScanData), a Driver keeps one emitter per point type
+        virtual std::type_index getPointType() const = 0;
+
+        /// \brief Add a sector's points to the revolution being built
+        virtual void addSector(const ScanData& scanData) = 0;
+
+        /// \brief Publish the revolution built so far, and start the next one
+        virtual void publish() = 0;
+};
+
+template <typename Point>
+class BasicScanEmitter : public ScanEmitter
+{
+    public:
+        BasicScanEmitter(std::function<void(const BasicScanData<Point>&)> callback) : callback(callback)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(Point));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            if (points.empty())
+            {
+                if (revolutionStarted)
+                {
+                    revolutionPeriod = scanData.timestamp - timestampOfFirstPoint;
+                }
+
+                timestampOfFirstPoint = scanData.timestamp;
+                revolutionStarted = true;
+            }
+
+            double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+            std::chrono::system_clock::duration sectorOffset = scanData.timestamp - timestampOfFirstPoint;
+
+            for (int i = 0; i < scanData.count; i++)
+            {
+                // Built in place, the points are written once
+                points.emplace_back(scanData.dist_mm[i], scanData.startAngle_deg + (anglePerPoint_deg * i), scanData.intensity[i]);
+
+                if (Point::hasTimestamp)
+                {
+                    // Points are spread across the sector at the speed of the previous revolution
+                    std::chrono::duration<double> pointOffset = revolutionPeriod * (anglePerPoint_deg * i / 360);
+                    points.back().setTimeOffset(std::chrono::duration_cast<std::chrono::microseconds>(sectorOffset + std::chrono::duration_cast<std::chrono::system_clock::duration>(pointOffset)));
+                }
+            }
+        }
+
+        void publish() override
+        {
+            BasicScanData<Point> scanData(std::move(points), timestampOfFirstPoint);
+
+            if (callback != nullptr)
+            {
+                callback(scanData);
+            }
+
+            // Keep the capacity for the next revolution
+            points = std::move(scanData.getPoints());
+            points.clear();
+        }
+
+    private:
+        std::function<void(const BasicScanData<Point>&)> callback;
+        std::vector<Point> points;
+
+        bool revolutionStarted = false;
+        std::chrono::system_clock::time_point timestampOfFirstPoint;
+        std::chrono::system_clock::duration revolutionPeriod = std::chrono::system_clock::duration::zero();
+};
+
+/// \brief Builds CompactScanData revolutions, the sensor's ranges and intensities are copied without widening
+class CompactScanEmitter : public ScanEmitter
+{
+    public:
+        CompactScanEmitter(std::function<void(const CompactScanData&)> callback) : callback(callback)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(CompactScanData));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            if (scan.empty())
+            {
+                scan.setTimestamp(scanData.timestamp);
+            }
+
+            double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+            double startAngle_cdeg = scanData.startAngle_deg * 100 + 0.5;
+            double endAngle_cdeg = scanData.endAngle_deg * 100 + 0.5;
+
+            if (startAngle_cdeg >= 0 && endAngle_cdeg < 2 * CompactScanData::CENTIDEGREES_PER_REVOLUTION)
+            {
+                // A sector which at most crosses 360 degrees once, rounded without branches so the loop is vectorized
+                double anglePerPoint_cdeg = anglePerPoint_deg * 100;
+
+                for (int i = 0; i < scanData.count; i++)
+                {
+                    int angle_cdeg = static_cast<int>(startAngle_cdeg + (anglePerPoint_cdeg * i));
+                    angles_cdeg[i] = static_cast<std::uint16_t>(angle_cdeg >= CompactScanData::CENTIDEGREES_PER_REVOLUTION ? angle_cdeg - CompactScanData::CENTIDEGREES_PER_REVOLUTION : angle_cdeg);
+                }
+            }
+            else
+            {
+                for (int i = 0; i < scanData.count; i++)
+                {
+                    angles_cdeg[i] = CompactScanData::toCentidegrees(scanData.startAngle_deg + (anglePerPoint_deg * i));
+                }
+            }
+
+            // Ranges and intensities are already in the sensor's units, and are copied as they are
+            scan.addPoints(scanData.count, scanData.dist_mm, angles_cdeg, scanData.intensity);
+        }
+
+        void publish() override
+        {
+            if (callback != nullptr)
+            {
+                callback(scan);
+            }
+
+            // Keep the capacity for the next revolution
+            scan.clear();
+        }
+
+    private:
+        std::function<void(const CompactScanData&)> callback;
+        CompactScanData scan;
+        std::uint16_t angles_cdeg[ScanData::MAX_NUMBER_OF_POINTS_FROM_SENSOR];
+};
+
+/// \brief Builds GridScanData revolutions, resampling each revolution onto the same grid
+class GridScanEmitter : public ScanEmitter
+{
+    public:
+        GridScanEmitter(std::function<void(const GridScanData&)> callback, const GridScanData::Settings& settings) :
+            callback(callback),
+            scan(settings)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(GridScanData));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            if (resampler.empty())
+            {
+                scan.setTimestamp(scanData.timestamp);
+            }
+
+            resampler.addSector(scanData.count, scanData.startAngle_deg, scanData.endAngle_deg, scanData.dist_mm);
+        }
+
+        void publish() override
+        {
+            resampler.resample(scan);
+
+            if (callback != nullptr)
+            {
+                callback(scan);
+            }
+        }
+
+    private:
+        std::function<void(const GridScanData&)> callback;
+        GridScanData scan;
+        GridResampler resampler;
+};
+
+/// \brief Builds a RangeIndex over each revolution, from the CompactScanData revolutions of an inner emitter
+class RangeIndexEmitter : public ScanEmitter
+{
+    public:
+        RangeIndexEmitter(std::function<void(const RangeIndex&)> callback) :
+            callback(callback),
+            compactScanEmitter([this](const CompactScanData& scan) { publishRangeIndex(scan); })
+        {
+        }
+
+        RangeIndexEmitter(const RangeIndexEmitter&) = delete;
+        RangeIndexEmitter& operator=(const RangeIndexEmitter&) = delete;
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(RangeIndex));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            compactScanEmitter.addSector(scanData);
+        }
+
+        void publish() override
+        {
+            compactScanEmitter.publish();
+        }
+
+    private:
+        void publishRangeIndex(const CompactScanData& scan)
+        {
+            // Rebuilt in place, the index keeps its memory for the next revolution
+            rangeIndex.build(scan);
+
+            if (callback != nullptr)
+            {
+                callback(rangeIndex);
+            }
+        }
+
+        std::function<void(const RangeIndex&)> callback;
+        RangeIndex rangeIndex;
+        CompactScanEmitter compactScanEmitter;
+};
+
+/// \brief Ends a ProtectiveFieldMonitor's revolution when the revolution is published. The Driver checks each sector with
+/// checkSector() as it is decoded, ahead of the region of interest and the filters, so the zones see every return the sensor
+/// measured rather than the points left to publish.
+class ProtectiveFieldEmitter : public ScanEmitter
+{
+    public:
+        ProtectiveFieldEmitter(const ProtectiveFieldMonitor::Settings& settings, std::function<void(const ProtectiveFieldMonitor::Event&)> callback) :
+            monitor(settings, callback)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(ProtectiveFieldMonitor));
+        }
+
+        void checkSector(const ScanData& scanData)
+        {
+            double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+            monitor.checkSector(scanData.count, scanData.startAngle_deg, anglePerPoint_deg, scanData.dist_mm, scanData.timestamp);
+            timestampOfLastSector = scanData.timestamp;
+        }
+
+        void addSector(const ScanData&) override
+        {
+        }
+
+        void publish() override
+        {
+            monitor.endRevolution(timestampOfLastSector);
+        }
+
+    private:
+        ProtectiveFieldMonitor monitor;
+        std::chrono::system_clock::time_point timestampOfLastSector;
+};
+
+/// \brief Adds each sector to a RollingScan, and publishes the window on every sector rather than once per revolution
+class RollingScanEmitter : public ScanEmitter
+{
+    public:
+        RollingScanEmitter(std::function<void(const RollingScan&)> callback) : callback(callback)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(RollingScan));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            rollingScan.addSector(SectorView(scanData.timestamp, scanData.startAngle_deg, scanData.endAngle_deg, scanData.count, scanData.dist_mm, scanData.intensity, false));
+
+            if (callback != nullptr)
+            {
+                callback(rollingScan);
+            }
+        }
+
+        void publish() override
+        {
+        }
+
+    private:
+        std::function<void(const RollingScan&)> callback;
+        RollingScan rollingScan;
+};
+
+/// \brief Hands each sector to every DerivedScanStream, which are shared with the emitter they replace so a stream keeps its
+/// state as streams are added and removed
+class DerivedScanEmitter : public ScanEmitter
+{
+    public:
+        DerivedScanEmitter(const std::vector<std::shared_ptr<DerivedScanStream>>& streams) : streams(streams)
+        {
+        }
+
+        std::type_index getPointType() const override
+        {
+            return std::type_index(typeid(DerivedScanStream));
+        }
+
+        void addSector(const ScanData& scanData) override
+        {
+            double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+            for (const std::shared_ptr<DerivedScanStream>& stream : streams)
+            {
+                stream->addSector(scanData.count, scanData.startAngle_deg, anglePerPoint_deg, scanData.dist_mm, scanData.intensity, scanData.timestamp);
+            }
+        }
+
+        void publish() override
+        {
+            for (const std::shared_ptr<DerivedScanStream>& stream : streams)
+            {
+                stream->endRevolution();
+            }
+        }
+
+    private:
+        std::vector<std::shared_ptr<DerivedScanStream>> streams;
+};
+}
+}
+}
+
+#endif
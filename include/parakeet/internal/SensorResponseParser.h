@@ -18,6 +18,7 @@ class SensorResponseParser
     public:
         SensorResponseParser();
         SensorResponse getSensorResponseFromMessage(const std::string& message);
+        std::vector<SensorResponse> getSensorResponsesFromMessage(const std::string& message);
 
     private:
         bool doesMessageMatchResponse(const std::string& message, const SensorResponse& response);
@@ -19,6 +19,11 @@ class SerialPortHelper
         /// \param[in] fileDescriptor - The file descriptor for the serial port
         /// \param[in] baudRate - The baud rate the serial port should be connected with
         static void setCustomBaudRate(int fileDescriptor, int baudRate);
+
+        /// \brief Gets the baud rate a Linux serial port is set to, including custom baud rates
+        /// \param[in] fileDescriptor - The file descriptor for the serial port
+        /// \returns The output baud rate of the serial port, or 0 if it can not be read
+        static int getCustomBaudRate(int fileDescriptor);
 };
 }
 }
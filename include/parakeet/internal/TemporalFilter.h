@@ -0,0 +1,63 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#ifndef PARAKEET_TEMPORALFILTER_H
+#define PARAKEET_TEMPORALFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+/// \brief Filters the range of each bearing over consecutive revolutions. Bearings are grouped into bins of a fixed angular
+/// width, and the state of every bin is kept in contiguous columns, so a sector's points walk each column in order.
+class TemporalFilter
+{
+    public:
+        /// \brief The size of the median's sorting network
+        static const int MAX_REVOLUTION_COUNT = 7;
+
+        /// \brief Set the bins and how many revolutions are kept, which forgets every bin if either has changed
+        /// \param[in] binWidth_deg - The angular width of a bin
+        /// \param[in] revolutionCount - How many revolutions the median is taken over, from 1 to MAX_REVOLUTION_COUNT
+        void configure(double binWidth_deg, int revolutionCount);
+
+        /// \brief Replace each range by the exponential moving average of its bin
+        /// \param[in] smoothingFactor - The weight of the newest range, from 0 to 1
+        /// \param[in] resetDistance_mm - A range further than this from the average restarts the average, as the scene has moved
+        void applyExponential(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm,
+            float smoothingFactor, std::uint16_t resetDistance_mm);
+
+        /// \brief Replace each range by the median of its bin's ranges over the last revolutions
+        /// \param[in] resetDistance_mm - A range further than this from the bin's last range restarts the bin, as the scene has moved
+        void applyMedian(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm,
+            std::uint16_t resetDistance_mm);
+
+    private:
+        void findBins(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg);
+
+        double binWidth_deg = 0;
+        int revolutionCount = 0;
+        std::size_t binCount = 0;
+
+        // One entry per bin
+        std::vector<float> averages_mm;
+        std::vector<std::uint8_t> historyCounts;
+        std::vector<std::uint8_t> nextSlots;
+
+        // revolutionCount rows of one entry per bin, a row per revolution
+        std::vector<std::uint16_t> history_mm;
+
+        std::vector<std::uint32_t> bins;
+};
+}
+}
+}
+
+#endif
@@ -5,10 +5,14 @@
 #ifndef PARAKEET_UTIL_H
 #define PARAKEET_UTIL_H
 
+#include "BasicScanData.h"
+#include "CompactScanData.h"
 #include "ScanDataPolar.h"
 #include "ScanDataXY.h"
 
+#include <cmath>
 #include <string>
+#include <utility>
 #include <math.h>
 
 #if !defined(M_PI)
@@ -27,6 +31,11 @@ class util
         /// \returns A ScanDataXY object containing a list of PointXY's which were obtained by converting the PointPolars from the param
         static ScanDataXY transform(const ScanDataPolar& polarScanData);
 
+        /// \brief Translates a CompactScanData into a ScanDataXY, without widening it into a ScanDataPolar first
+        /// \param[in] compactScanData - A CompactScanData object to be converted
+        /// \returns A ScanDataXY object containing a PointXY for every point of the param
+        static ScanDataXY transform(const CompactScanData& compactScanData);
+
         /// \brief Translates a PointPolar into a PointXY
         /// \param[in] polarPoint - A PointPolar object to be converted
         /// \returns A PointXY object which holds the same position as the PointPolar param
@@ -42,6 +51,121 @@ class util
         /// \returns A PointPolar object which holds the same position as the PointXY param
         static PointPolar transform(const PointXY& cartesianPoint);
 
+        /// \brief Translates a BasicPointPolar into a BasicPointXY of the same precision, calculated in ScalarTraits<Scalar>::Compute
+        template <typename Scalar, bool HasIntensity, bool HasTimestamp>
+        static BasicPointXY<Scalar, HasIntensity, HasTimestamp> transform(const BasicPointPolar<Scalar, HasIntensity, HasTimestamp>& polarPoint)
+        {
+            typedef typename ScalarTraits<Scalar>::Compute Compute;
+
+            Compute range_mm = static_cast<Compute>(polarPoint.getRange_mm());
+            Compute angle_rad = static_cast<Compute>(degreesToRadians(polarPoint.getAngle_deg()));
+
+            BasicPointXY<Scalar, HasIntensity, HasTimestamp> cartesianPoint(range_mm * std::cos(angle_rad), range_mm * std::sin(angle_rad));
+            copyFields(polarPoint, cartesianPoint);
+
+            return cartesianPoint;
+        }
+
+        /// \brief Translates a BasicPointXY into a BasicPointPolar of the same precision, calculated in ScalarTraits<Scalar>::Compute
+        template <typename Scalar, bool HasIntensity, bool HasTimestamp>
+        static BasicPointPolar<Scalar, HasIntensity, HasTimestamp> transform(const BasicPointXY<Scalar, HasIntensity, HasTimestamp>& cartesianPoint)
+        {
+            typedef typename ScalarTraits<Scalar>::Compute Compute;
+
+            Compute x_mm = static_cast<Compute>(cartesianPoint.getX_mm());
+            Compute y_mm = static_cast<Compute>(cartesianPoint.getY_mm());
+
+            BasicPointPolar<Scalar, HasIntensity, HasTimestamp> polarPoint(std::hypot(x_mm, y_mm), radiansToDegrees0To360(std::atan2(y_mm, x_mm)));
+            copyFields(cartesianPoint, polarPoint);
+
+            return polarPoint;
+        }
+
+        /// \brief Translates every point of a BasicScanData, ie: from BasicPointPolar<float> to BasicPointXY<float>
+        template <typename Point>
+        static auto transform(const BasicScanData<Point>& scanData) -> BasicScanData<decltype(transform(std::declval<Point>()))>
+        {
+            typedef decltype(transform(std::declval<Point>())) TransformedPoint;
+
+            std::vector<TransformedPoint> transformedPoints;
+            transformedPoints.reserve(scanData.getPoints().size());
+
+            for (const Point& point : scanData.getPoints())
+            {
+                transformedPoints.push_back(transform(point));
+            }
+
+            return BasicScanData<TransformedPoint>(std::move(transformedPoints), scanData.getTimestamp());
+        }
+
+        /// \brief Converts a point to another precision or set of fields, ie: convert<BasicPointPolar<Fixed16, false>>(pointPolar).
+        /// Fields missing from the source point are left as zero.
+        template <typename To, typename Scalar, bool HasIntensity, bool HasTimestamp>
+        static To convert(const BasicPointPolar<Scalar, HasIntensity, HasTimestamp>& polarPoint)
+        {
+            To converted(polarPoint.getRange_mm(), polarPoint.getAngle_deg());
+            copyFields(polarPoint, converted);
+
+            return converted;
+        }
+
+        template <typename To, typename Scalar, bool HasIntensity, bool HasTimestamp>
+        static To convert(const BasicPointXY<Scalar, HasIntensity, HasTimestamp>& cartesianPoint)
+        {
+            To converted(cartesianPoint.getX_mm(), cartesianPoint.getY_mm());
+            copyFields(cartesianPoint, converted);
+
+            return converted;
+        }
+
+        template <typename To>
+        static To convert(const PointPolar& polarPoint)
+        {
+            To converted(polarPoint.getRange_mm(), polarPoint.getAngle_deg());
+            converted.setIntensity(static_cast<typename To::Traits::Intensity>(polarPoint.getIntensity()));
+
+            return converted;
+        }
+
+        template <typename To>
+        static To convert(const PointXY& cartesianPoint)
+        {
+            To converted(cartesianPoint.getX_mm(), cartesianPoint.getY_mm());
+            converted.setIntensity(static_cast<typename To::Traits::Intensity>(cartesianPoint.getIntensity()));
+
+            return converted;
+        }
+
+        /// \brief Converts every point of a scan to another point type, ie: convert<BasicPointPolar<float, false>>(scanDataPolar)
+        template <typename To, typename ScanData>
+        static BasicScanData<To> convert(const ScanData& scanData)
+        {
+            std::vector<To> convertedPoints;
+            convertedPoints.reserve(scanData.getPoints().size());
+
+            for (const auto& point : scanData.getPoints())
+            {
+                convertedPoints.push_back(convert<To>(point));
+            }
+
+            return BasicScanData<To>(std::move(convertedPoints), scanData.getTimestamp());
+        }
+
+        /// \brief Converts every point of a CompactScanData to another point type, ie: convert<BasicPointPolar<float>>(compactScanData)
+        template <typename To>
+        static BasicScanData<To> convert(const CompactScanData& compactScanData)
+        {
+            std::vector<To> convertedPoints;
+            convertedPoints.reserve(compactScanData.getPointCount());
+
+            for (std::size_t i = 0; i < compactScanData.getPointCount(); i++)
+            {
+                convertedPoints.emplace_back(compactScanData.getRange_mm(i), compactScanData.getAngle_deg(i), compactScanData.getIntensity(i));
+            }
+
+            return BasicScanData<To>(std::move(convertedPoints), compactScanData.getTimestamp());
+        }
+
         /// \brief Divide a string into an array of substrings, delimited by a character
         /// \param[in] string - The string which will be divided up
         /// \param[in] delimiter - The character which marks the seperation of substrings
@@ -71,6 +195,13 @@ class util
         {
             return (radiansToDegrees(radians)) + (radians > 0 ? 0 : 360);
         }
+
+        template <typename From, typename To>
+        static void copyFields(const From& from, To& to)
+        {
+            to.setIntensity(static_cast<typename To::Traits::Intensity>(from.getIntensity()));
+            to.setTimeOffset(from.getTimeOffset());
+        }
 };
 }
 }
@@ -0,0 +1,50 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/CachedScan.h>
+#include <parakeet/util.h>
+
+#include <utility>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    CachedScan::CachedScan(ScanDataPolar&& polarScanData) :
+        polarScanData(std::move(polarScanData))
+    {
+    }
+
+    CachedScan::CachedScan(const ScanDataPolar& polarScanData) :
+        polarScanData(polarScanData)
+    {
+    }
+
+    const ScanDataPolar& CachedScan::getPolar() const
+    {
+        return polarScanData;
+    }
+
+    const ScanDataXY& CachedScan::getXY() const
+    {
+        std::call_once(transformFlag, [this]()
+        {
+            xyScanData.reset(new ScanDataXY(util::transform(polarScanData)));
+            transformed = true;
+        });
+
+        return *xyScanData;
+    }
+
+    bool CachedScan::hasXY() const
+    {
+        return transformed;
+    }
+
+    const std::chrono::time_point<std::chrono::system_clock>& CachedScan::getTimestamp() const
+    {
+        return polarScanData.getTimestamp();
+    }
+}
+}
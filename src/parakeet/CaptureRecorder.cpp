@@ -0,0 +1,475 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/CaptureRecorder.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <parakeet/exceptions/UnableToOpenFileException.h>
+#include <parakeet/internal/CaptureFormat.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    using namespace internal;
+
+    const std::chrono::milliseconds WRITER_POLL_INTERVAL(10);
+
+    const std::uint32_t PCAP_NANOSECOND_MAGIC = 0xa1b23c4d;
+    const std::uint32_t PCAP_LINKTYPE_RAW = 101;
+    const std::uint32_t PCAP_SNAPLEN = 65535;
+    const std::size_t PCAP_FILE_HEADER_SIZE = 24;
+    const std::size_t PCAP_RECORD_HEADER_SIZE = 16;
+    const std::size_t IPV4_HEADER_SIZE = 20;
+    const std::size_t UDP_HEADER_SIZE = 8;
+    const std::size_t MAX_UDP_PAYLOAD = 65535 - IPV4_HEADER_SIZE - UDP_HEADER_SIZE;
+
+    static std::uint32_t parseIPv4Address(const std::string& address)
+    {
+        unsigned int octets[4];
+        if (std::sscanf(address.c_str(), "%u.%u.%u.%u", &octets[0], &octets[1], &octets[2], &octets[3]) != 4)
+        {
+            return 0;
+        }
+
+        return ((octets[0] & 0xFF) << 24) | ((octets[1] & 0xFF) << 16) | ((octets[2] & 0xFF) << 8) | (octets[3] & 0xFF);
+    }
+
+    static void writeBigEndian16(unsigned char* destination, std::uint16_t value)
+    {
+        destination[0] = static_cast<unsigned char>(value >> 8);
+        destination[1] = static_cast<unsigned char>(value);
+    }
+
+    static void writeBigEndian32(unsigned char* destination, std::uint32_t value)
+    {
+        writeBigEndian16(destination, static_cast<std::uint16_t>(value >> 16));
+        writeBigEndian16(destination + 2, static_cast<std::uint16_t>(value));
+    }
+
+    static std::uint16_t calculateIPv4HeaderChecksum(const unsigned char* header)
+    {
+        std::uint32_t sum = 0;
+        for (std::size_t i = 0; i < IPV4_HEADER_SIZE; i += 2)
+        {
+            sum += (header[i] << 8) | header[i + 1];
+        }
+
+        while (sum >> 16)
+        {
+            sum = (sum & 0xFFFF) + (sum >> 16);
+        }
+
+        return static_cast<std::uint16_t>(~sum);
+    }
+
+    static std::int64_t toNanoseconds(const std::chrono::system_clock::time_point& timestamp)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    }
+
+    CaptureRecorder::CaptureRecorder(const std::string& basePath, Format format, std::size_t segmentSize_bytes, std::size_t bufferSize_bytes) :
+        basePath(basePath),
+        format(format),
+        segmentSize(segmentSize_bytes),
+        ring(bufferSize_bytes)
+    {
+        startSegment(0);
+
+        runWriterThread = true;
+        writerThread = std::thread(&CaptureRecorder::writerThreadMainLoop, this);
+    }
+
+    CaptureRecorder::~CaptureRecorder()
+    {
+        close();
+    }
+
+    int CaptureRecorder::openStream(const StreamInfo& streamInfo)
+    {
+        if (format == Pcap && streamInfo.streamType != UdpDatagrams)
+        {
+            return INVALID_STREAM_ID;
+        }
+
+        int streamId;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+
+            // The lengths are stored as 16 bit values in the stream info record
+            std::size_t maximumLength = MAX_STREAM_INFO_STRING_LENGTH;
+
+            Stream stream;
+            stream.streamInfo = streamInfo;
+            stream.streamInfo.sourceAddress.resize(std::min(stream.streamInfo.sourceAddress.size(), maximumLength));
+            stream.streamInfo.description.resize(std::min(stream.streamInfo.description.size(), maximumLength));
+            stream.sourceAddress = parseIPv4Address(streamInfo.sourceAddress);
+
+            streamId = static_cast<int>(streams.size());
+            streams.push_back(stream);
+        }
+
+        // Queued through the ring so the writer announces the stream before any of its data
+        CaptureFormat::RecordHeader header = {};
+        header.type = CaptureFormat::STREAM_INFO;
+        header.streamId = static_cast<std::uint16_t>(streamId);
+
+        std::unique_lock<std::mutex> lock(ringMutex);
+        while (ring.size() - ringUsed < sizeof(header))
+        {
+            // The announcement must not be dropped, so wait for the writer to make room
+            lock.unlock();
+            std::this_thread::sleep_for(WRITER_POLL_INTERVAL);
+            lock.lock();
+        }
+
+        writeToRing(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+
+        return streamId;
+    }
+
+    bool CaptureRecorder::record(int streamId, const unsigned char* data, unsigned int length, const std::chrono::system_clock::time_point& timestamp, bool kernelTimestamp)
+    {
+        if (streamId < 0 || !runWriterThread)
+        {
+            return false;
+        }
+
+        CaptureFormat::RecordHeader header = {};
+        header.type = CaptureFormat::DATA;
+        header.streamId = static_cast<std::uint16_t>(streamId);
+        header.flags = kernelTimestamp ? CaptureFormat::KERNEL_TIMESTAMP : 0;
+        header.payloadLength = length;
+        header.timestamp_ns = toNanoseconds(timestamp);
+
+        std::size_t recordLength = sizeof(header) + length;
+
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (ring.size() - ringUsed < recordLength)
+        {
+            droppedCount++;
+            return false;
+        }
+
+        writeToRing(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+        writeToRing(data, length);
+
+        return true;
+    }
+
+    void CaptureRecorder::close()
+    {
+        if (writerThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                runWriterThread = false;
+            }
+            writerWakeup.notify_all();
+            writerThread.join();
+        }
+
+        finishSegment();
+    }
+
+    std::uint64_t CaptureRecorder::getRecordedCount() const
+    {
+        return recordedCount;
+    }
+
+    std::uint64_t CaptureRecorder::getDroppedCount() const
+    {
+        return droppedCount;
+    }
+
+    std::uint64_t CaptureRecorder::getFailedSegmentCount() const
+    {
+        return failedSegmentCount;
+    }
+
+    std::vector<std::string> CaptureRecorder::getSegmentPaths()
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        return segmentPaths;
+    }
+
+    void CaptureRecorder::writerThreadMainLoop()
+    {
+        while (runWriterThread)
+        {
+            writePendingRecords();
+
+            std::unique_lock<std::mutex> lock(writerMutex);
+            writerWakeup.wait_for(lock, WRITER_POLL_INTERVAL, [this]() { return !runWriterThread; });
+        }
+
+        writePendingRecords();
+    }
+
+    void CaptureRecorder::writePendingRecords()
+    {
+        while (true)
+        {
+            CaptureFormat::RecordHeader header;
+            {
+                std::lock_guard<std::mutex> lock(ringMutex);
+                if (ringUsed == 0)
+                {
+                    return;
+                }
+
+                copyFromRing(ringTail, reinterpret_cast<unsigned char*>(&header), sizeof(header));
+                recordScratch.resize(header.payloadLength);
+                copyFromRing((ringTail + sizeof(header)) % ring.size(), recordScratch.data(), header.payloadLength);
+
+                std::size_t recordLength = sizeof(header) + header.payloadLength;
+                ringTail = (ringTail + recordLength) % ring.size();
+                ringUsed -= recordLength;
+            }
+
+            if (header.type == CaptureFormat::STREAM_INFO)
+            {
+                writeStreamInfoRecord(header.streamId);
+            }
+            else if (writeRecord(reinterpret_cast<const unsigned char*>(&header), recordScratch.data(), header.payloadLength))
+            {
+                recordedCount++;
+            }
+            else
+            {
+                droppedCount++;
+            }
+        }
+    }
+
+    void CaptureRecorder::writeToRing(const unsigned char* source, std::size_t length)
+    {
+        std::size_t firstPart = std::min(length, ring.size() - ringHead);
+        std::memcpy(&ring[ringHead], source, firstPart);
+        std::memcpy(&ring[0], source + firstPart, length - firstPart);
+        ringHead = (ringHead + length) % ring.size();
+        ringUsed += length;
+    }
+
+    void CaptureRecorder::copyFromRing(std::size_t offset, unsigned char* destination, std::size_t length)
+    {
+        std::size_t firstPart = std::min(length, ring.size() - offset);
+        std::memcpy(destination, &ring[offset], firstPart);
+        std::memcpy(destination + firstPart, &ring[0], length - firstPart);
+    }
+
+    bool CaptureRecorder::writeRecord(const unsigned char* headerBytes, const unsigned char* payload, std::uint32_t payloadLength)
+    {
+        CaptureFormat::RecordHeader header;
+        std::memcpy(&header, headerBytes, sizeof(header));
+
+        if (format == Native)
+        {
+            std::size_t recordLength = sizeof(header) + CaptureFormat::alignedLength(payloadLength);
+            if (!reserveSegmentSpace(recordLength))
+            {
+                return false;
+            }
+
+            unsigned char* destination = segment.data() + segmentUsed;
+            std::memcpy(destination, &header, sizeof(header));
+            std::memcpy(destination + sizeof(header), payload, payloadLength);
+            segmentUsed += recordLength;
+            return true;
+        }
+
+        Stream stream;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            stream = streams[header.streamId];
+        }
+
+        std::uint32_t capturedLength = static_cast<std::uint32_t>(std::min<std::size_t>(payloadLength, MAX_UDP_PAYLOAD));
+        std::size_t packetLength = IPV4_HEADER_SIZE + UDP_HEADER_SIZE + capturedLength;
+        if (!reserveSegmentSpace(PCAP_RECORD_HEADER_SIZE + packetLength))
+        {
+            return false;
+        }
+
+        unsigned char* destination = segment.data() + segmentUsed;
+
+        std::uint32_t recordHeader[4];
+        recordHeader[0] = static_cast<std::uint32_t>(header.timestamp_ns / 1000000000);
+        recordHeader[1] = static_cast<std::uint32_t>(header.timestamp_ns % 1000000000);
+        recordHeader[2] = static_cast<std::uint32_t>(packetLength);
+        recordHeader[3] = static_cast<std::uint32_t>(packetLength);
+        std::memcpy(destination, recordHeader, PCAP_RECORD_HEADER_SIZE);
+        destination += PCAP_RECORD_HEADER_SIZE;
+
+        // Synthesized headers, as if the datagram had been sniffed on its way from the sensor to this host
+        unsigned char* ipHeader = destination;
+        std::memset(ipHeader, 0, IPV4_HEADER_SIZE);
+        ipHeader[0] = 0x45;
+        writeBigEndian16(ipHeader + 2, static_cast<std::uint16_t>(packetLength));
+        ipHeader[8] = 64;
+        ipHeader[9] = 17;
+        writeBigEndian32(ipHeader + 12, stream.sourceAddress);
+        writeBigEndian16(ipHeader + 10, calculateIPv4HeaderChecksum(ipHeader));
+
+        unsigned char* udpHeader = ipHeader + IPV4_HEADER_SIZE;
+        writeBigEndian16(udpHeader, stream.streamInfo.sourcePort);
+        writeBigEndian16(udpHeader + 2, stream.streamInfo.destinationPort);
+        writeBigEndian16(udpHeader + 4, static_cast<std::uint16_t>(UDP_HEADER_SIZE + capturedLength));
+        writeBigEndian16(udpHeader + 6, 0);
+
+        std::memcpy(udpHeader + UDP_HEADER_SIZE, payload, capturedLength);
+        segmentUsed += PCAP_RECORD_HEADER_SIZE + packetLength;
+        return true;
+    }
+
+    void CaptureRecorder::writeStreamInfoRecord(int streamId)
+    {
+        if (format != Native)
+        {
+            return;
+        }
+
+        StreamInfo streamInfo;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            streamInfo = streams[streamId].streamInfo;
+        }
+
+        CaptureFormat::StreamInfoPayload payload = {};
+        payload.streamType = static_cast<std::uint16_t>(streamInfo.streamType);
+        payload.sourcePort = streamInfo.sourcePort;
+        payload.destinationPort = streamInfo.destinationPort;
+        payload.sourceAddressLength = static_cast<std::uint16_t>(streamInfo.sourceAddress.size());
+        payload.descriptionLength = static_cast<std::uint16_t>(streamInfo.description.size());
+
+        std::vector<unsigned char> payloadBytes(sizeof(payload) + payload.sourceAddressLength + payload.descriptionLength);
+        std::memcpy(payloadBytes.data(), &payload, sizeof(payload));
+        std::memcpy(payloadBytes.data() + sizeof(payload), streamInfo.sourceAddress.data(), payload.sourceAddressLength);
+        std::memcpy(payloadBytes.data() + sizeof(payload) + payload.sourceAddressLength, streamInfo.description.data(), payload.descriptionLength);
+
+        CaptureFormat::RecordHeader header = {};
+        header.type = CaptureFormat::STREAM_INFO;
+        header.streamId = static_cast<std::uint16_t>(streamId);
+        header.payloadLength = static_cast<std::uint32_t>(payloadBytes.size());
+        header.timestamp_ns = toNanoseconds(std::chrono::system_clock::now());
+
+        if (!writeRecord(reinterpret_cast<const unsigned char*>(&header), payloadBytes.data(), header.payloadLength))
+        {
+            return;
+        }
+
+        if (streamId >= announcedStreamCount)
+        {
+            announcedStreamCount = streamId + 1;
+        }
+    }
+
+    std::size_t CaptureRecorder::getStreamInfoRecordLength(int streamId)
+    {
+        if (format != Native)
+        {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock(streamMutex);
+        const StreamInfo& streamInfo = streams[streamId].streamInfo;
+
+        return sizeof(CaptureFormat::RecordHeader) + CaptureFormat::alignedLength(static_cast<std::uint32_t>(sizeof(CaptureFormat::StreamInfoPayload) + streamInfo.sourceAddress.size() + streamInfo.description.size()));
+    }
+
+    bool CaptureRecorder::reserveSegmentSpace(std::size_t length)
+    {
+        if (segment.isOpen() && segmentUsed + length <= segment.size())
+        {
+            return true;
+        }
+
+        finishSegment();
+
+        try
+        {
+            startSegment(length);
+        }
+        catch (const exceptions::UnableToOpenFileException&)
+        {
+            failedSegmentCount++;
+            return false;
+        }
+
+        return segmentUsed + length <= segment.size();
+    }
+
+    void CaptureRecorder::startSegment(std::size_t minimumFreeSpace)
+    {
+        char index[16];
+        std::snprintf(index, sizeof(index), ".%06u", segmentIndex);
+
+        std::string path = basePath + index + (format == Native ? CaptureFormat::SEGMENT_EXTENSION : CaptureFormat::PCAP_SEGMENT_EXTENSION);
+
+        // Leave room for the file header and every stream announcement on top of the record which did not fit,
+        // writing an announcement must never need another segment
+        std::size_t streamInfoLength = 0;
+        for (int streamId = 0; streamId < announcedStreamCount; streamId++)
+        {
+            streamInfoLength += getStreamInfoRecordLength(streamId);
+        }
+
+        std::size_t size = std::max(segmentSize, minimumFreeSpace + 4096 + streamInfoLength);
+        if (!segment.create(path, size))
+        {
+            throw exceptions::UnableToOpenFileException(path);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            segmentPaths.push_back(path);
+        }
+
+        if (format == Native)
+        {
+            CaptureFormat::FileHeader header = {};
+            std::memcpy(header.magic, CaptureFormat::MAGIC, sizeof(header.magic));
+            header.version = CaptureFormat::VERSION;
+            header.segmentIndex = segmentIndex;
+            header.creationTime_ns = toNanoseconds(std::chrono::system_clock::now());
+
+            std::memcpy(segment.data(), &header, sizeof(header));
+            segmentUsed = sizeof(header);
+        }
+        else
+        {
+            std::uint32_t header[6];
+            header[0] = PCAP_NANOSECOND_MAGIC;
+            header[1] = (4 << 16) | 2;
+            header[2] = 0;
+            header[3] = 0;
+            header[4] = PCAP_SNAPLEN;
+            header[5] = PCAP_LINKTYPE_RAW;
+
+            std::memcpy(segment.data(), header, PCAP_FILE_HEADER_SIZE);
+            segmentUsed = PCAP_FILE_HEADER_SIZE;
+        }
+
+        segmentIndex++;
+
+        // Every segment describes its streams, so it can be read without the segments before it
+        for (int streamId = 0; streamId < announcedStreamCount; streamId++)
+        {
+            writeStreamInfoRecord(streamId);
+        }
+    }
+
+    void CaptureRecorder::finishSegment()
+    {
+        if (segment.isOpen() && !segment.close(segmentUsed))
+        {
+            failedSegmentCount++;
+        }
+        segmentUsed = 0;
+    }
+}
+}
@@ -0,0 +1,141 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/CompactScanData.h>
+#include <parakeet/BasicPoint.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const std::uint16_t CompactScanData::CENTIDEGREES_PER_REVOLUTION;
+
+    CompactScanData::CompactScanData(const std::chrono::system_clock::time_point& timestampOfFirstPoint) :
+        timestampOfFirstPoint(timestampOfFirstPoint)
+    {
+    }
+
+    CompactScanData::CompactScanData(const ScanDataPolar& polarScanData) :
+        timestampOfFirstPoint(polarScanData.getTimestamp())
+    {
+        reserve(polarScanData.getPoints().size());
+
+        for (const PointPolar& point : polarScanData.getPoints())
+        {
+            addPoint(point.getRange_mm(), point.getAngle_deg(), static_cast<std::uint8_t>(point.getIntensity()));
+        }
+    }
+
+    const std::chrono::system_clock::time_point& CompactScanData::getTimestamp() const
+    {
+        return timestampOfFirstPoint;
+    }
+
+    void CompactScanData::setTimestamp(const std::chrono::system_clock::time_point& timestampOfFirstPoint)
+    {
+        this->timestampOfFirstPoint = timestampOfFirstPoint;
+    }
+
+    std::size_t CompactScanData::getPointCount() const
+    {
+        return ranges_mm.size();
+    }
+
+    bool CompactScanData::empty() const
+    {
+        return ranges_mm.empty();
+    }
+
+    double CompactScanData::getRange_mm(std::size_t index) const
+    {
+        return ranges_mm[index];
+    }
+
+    double CompactScanData::getAngle_deg(std::size_t index) const
+    {
+        return ScalarTraits<Fixed16>::fromAngle(angles_cdeg[index]);
+    }
+
+    std::uint8_t CompactScanData::getIntensity(std::size_t index) const
+    {
+        return intensities[index];
+    }
+
+    PointPolar CompactScanData::getPoint(std::size_t index) const
+    {
+        return PointPolar(getRange_mm(index), getAngle_deg(index), getIntensity(index));
+    }
+
+    const std::uint16_t* CompactScanData::getRanges_mm() const
+    {
+        return ranges_mm.data();
+    }
+
+    const std::uint16_t* CompactScanData::getAngles_cdeg() const
+    {
+        return angles_cdeg.data();
+    }
+
+    const std::uint8_t* CompactScanData::getIntensities() const
+    {
+        return intensities.data();
+    }
+
+    void CompactScanData::addPoint(std::uint16_t range_mm, std::uint16_t angle_cdeg, std::uint8_t intensity)
+    {
+        ranges_mm.push_back(range_mm);
+        angles_cdeg.push_back(angle_cdeg);
+        intensities.push_back(intensity);
+    }
+
+    void CompactScanData::addPoint(double range_mm, double angle_deg, std::uint8_t intensity)
+    {
+        addPoint(ScalarTraits<Fixed16>::toRange(range_mm), toCentidegrees(angle_deg), intensity);
+    }
+
+    void CompactScanData::addPoints(std::size_t pointCount, const std::uint16_t* ranges_mm, const std::uint16_t* angles_cdeg, const std::uint8_t* intensities)
+    {
+        this->ranges_mm.insert(this->ranges_mm.end(), ranges_mm, ranges_mm + pointCount);
+        this->angles_cdeg.insert(this->angles_cdeg.end(), angles_cdeg, angles_cdeg + pointCount);
+        this->intensities.insert(this->intensities.end(), intensities, intensities + pointCount);
+    }
+
+    void CompactScanData::reserve(std::size_t pointCount)
+    {
+        ranges_mm.reserve(pointCount);
+        angles_cdeg.reserve(pointCount);
+        intensities.reserve(pointCount);
+    }
+
+    void CompactScanData::clear()
+    {
+        ranges_mm.clear();
+        angles_cdeg.clear();
+        intensities.clear();
+    }
+
+    ScanDataPolar CompactScanData::toScanDataPolar() const
+    {
+        std::vector<PointPolar> points;
+        points.reserve(getPointCount());
+
+        for (std::size_t i = 0; i < getPointCount(); i++)
+        {
+            points.push_back(getPoint(i));
+        }
+
+        return ScanDataPolar(points, timestampOfFirstPoint);
+    }
+
+    std::size_t CompactScanData::getMemoryUsage() const
+    {
+        return ranges_mm.capacity() * sizeof(std::uint16_t) + angles_cdeg.capacity() * sizeof(std::uint16_t) + intensities.capacity() * sizeof(std::uint8_t);
+    }
+
+    std::uint16_t CompactScanData::toCentidegrees(double angle_deg)
+    {
+        return ScalarTraits<Fixed16>::toAngle(angle_deg);
+    }
+}
+}
@@ -0,0 +1,148 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/DerivedScanStream.h>
+
+#include <algorithm>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    DerivedScanStream::DerivedScanStream(const Settings& settings, std::function<void(const CompactScanData&)> callback) :
+        settings(settings),
+        callback(callback)
+    {
+        this->settings.revolutionInterval = std::max(this->settings.revolutionInterval, 1);
+        this->settings.decimation = std::max(this->settings.decimation, 1);
+    }
+
+    const DerivedScanStream::Settings& DerivedScanStream::getSettings() const
+    {
+        return settings;
+    }
+
+    bool DerivedScanStream::isDue(const std::chrono::system_clock::time_point& timestamp) const
+    {
+        if (revolutionCount % settings.revolutionInterval != 0)
+        {
+            return false;
+        }
+
+        return !published || timestamp - timestampOfLastPublished >= settings.minimumPeriod;
+    }
+
+    void DerivedScanStream::addSector(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, const std::uint16_t* ranges_mm,
+        const std::uint8_t* intensities, const std::chrono::system_clock::time_point& timestamp)
+    {
+        if (waitingForNextRevolution)
+        {
+            return;
+        }
+
+        if (!revolutionStarted)
+        {
+            revolutionStarted = true;
+            publishing = isDue(timestamp);
+
+            if (publishing)
+            {
+                scan.setTimestamp(timestamp);
+            }
+        }
+
+        if (!publishing || pointCount == 0)
+        {
+            return;
+        }
+
+        std::size_t decimation = static_cast<std::size_t>(settings.decimation);
+        std::size_t groupCount = (pointCount + decimation - 1) / decimation;
+
+        this->ranges_mm.resize(groupCount);
+        this->angles_cdeg.resize(groupCount);
+        this->intensities.resize(groupCount);
+
+        for (std::size_t group = 0; group < groupCount; group++)
+        {
+            std::size_t firstIndex = group * decimation;
+            std::size_t keptIndex = firstIndex;
+
+            if (settings.decimationMode == MinimumRangeDecimation)
+            {
+                std::size_t endIndex = std::min(firstIndex + decimation, pointCount);
+
+                // Ranges are compared less one, so a point without a return wraps round to the largest value and is only
+                // kept when no point of the group has a return
+                std::uint16_t closestRange_mm = static_cast<std::uint16_t>(ranges_mm[firstIndex] - 1);
+
+                for (std::size_t i = firstIndex + 1; i < endIndex; i++)
+                {
+                    std::uint16_t range_mm = static_cast<std::uint16_t>(ranges_mm[i] - 1);
+
+                    if (range_mm < closestRange_mm)
+                    {
+                        closestRange_mm = range_mm;
+                        keptIndex = i;
+                    }
+                }
+            }
+
+            // Each kept point keeps its own angle
+            this->ranges_mm[group] = ranges_mm[keptIndex];
+            this->angles_cdeg[group] = CompactScanData::toCentidegrees(startAngle_deg + (anglePerPoint_deg * keptIndex));
+            this->intensities[group] = intensities[keptIndex];
+        }
+
+        scan.addPoints(groupCount, this->ranges_mm.data(), this->angles_cdeg.data(), this->intensities.data());
+    }
+
+    void DerivedScanStream::endRevolution()
+    {
+        if (waitingForNextRevolution)
+        {
+            waitingForNextRevolution = false;
+            return;
+        }
+
+        if (publishing)
+        {
+            published = true;
+            timestampOfLastPublished = scan.getTimestamp();
+            publishedRevolutionCount++;
+
+            if (callback != nullptr)
+            {
+                callback(scan);
+            }
+
+            // Keep the capacity for the next published revolution
+            scan.clear();
+        }
+
+        revolutionStarted = false;
+        publishing = false;
+        revolutionCount++;
+    }
+
+    void DerivedScanStream::waitForNextRevolution()
+    {
+        waitingForNextRevolution = true;
+
+        revolutionStarted = false;
+        publishing = false;
+        scan.clear();
+    }
+
+    std::uint64_t DerivedScanStream::getPublishedRevolutionCount() const
+    {
+        return publishedRevolutionCount;
+    }
+
+    std::uint64_t DerivedScanStream::getSkippedRevolutionCount() const
+    {
+        return revolutionCount - publishedRevolutionCount;
+    }
+}
+}
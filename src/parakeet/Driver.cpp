@@ -5,12 +5,16 @@
 #include <parakeet/Driver.h>
 #include <parakeet/exceptions/NotConnectedToSensorException.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace mechaspin
 {
 namespace parakeet
 {
+    const std::chrono::milliseconds WATCHDOG_POLL_INTERVAL(10);
+
 	void Driver::stop()
 	{
         runUpdateThread = false;
@@ -19,6 +23,13 @@ namespace parakeet
         {
             updateThread.join();
         }
+
+        if(watchdogThread.joinable())
+        {
+            watchdogThread.join();
+        }
+
+        setConnectionState(Stopped);
 	}
 
 	void Driver::close()
@@ -37,6 +48,17 @@ namespace parakeet
         updateThreadStartTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
         updateThreadFrameCount = 0;
         updateThread = std::thread([&] { this->updateThreadMainLoop(); });
+
+        linkErrorOccurred = false;
+        revolutionReceivedSinceReconnect = true;
+        timeOfLastRevolution = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        setConnectionState(Running);
+
+        if(reconnectPolicy.enabled)
+        {
+            watchdogThread = std::thread([&] { this->watchdogThreadMainLoop(); });
+        }
     }
 
 	void Driver::updateThreadMainLoop()
@@ -50,6 +72,165 @@ namespace parakeet
 		}
 	}
 
+    void Driver::watchdogThreadMainLoop()
+    {
+        while (runUpdateThread)
+        {
+            std::this_thread::sleep_for(WATCHDOG_POLL_INTERVAL);
+
+            if (!isStreamStalled())
+            {
+                continue;
+            }
+
+            setConnectionState(Stalled);
+
+            // A sensor which stalled again before producing a revolution may have lost its settings, ie: after a power cycle
+            bool warmRestart = revolutionReceivedSinceReconnect;
+            std::chrono::milliseconds backoff = reconnectPolicy.initialBackoff;
+
+            while (runUpdateThread)
+            {
+                setConnectionState(Reconnecting);
+
+                linkErrorOccurred = false;
+
+                if (reconnect(warmRestart))
+                {
+                    revolutionReceivedSinceReconnect = false;
+                    timeOfLastRevolution = std::chrono::steady_clock::now().time_since_epoch().count();
+
+                    setConnectionState(Running);
+                    break;
+                }
+
+                warmRestart = false;
+
+                if (!waitForBackoff(backoff))
+                {
+                    break;
+                }
+
+                backoff = std::min(backoff * 2, reconnectPolicy.maximumBackoff);
+            }
+        }
+    }
+
+    bool Driver::isStreamStalled()
+    {
+        if (linkErrorOccurred)
+        {
+            return true;
+        }
+
+        std::chrono::milliseconds stallTimeout = reconnectPolicy.minimumStallTimeout;
+
+        try
+        {
+            std::chrono::milliseconds revolutionPeriod(1000 / getScanningFrequency_Hz());
+
+            stallTimeout = std::max(stallTimeout, revolutionPeriod * reconnectPolicy.missedRevolutionsBeforeStall);
+        }
+        catch (const exceptions::NotConnectedToSensorException&)
+        {
+            return true;
+        }
+
+        std::chrono::steady_clock::time_point lastRevolution{ std::chrono::steady_clock::duration(timeOfLastRevolution.load()) };
+
+        return std::chrono::steady_clock::now() - lastRevolution > stallTimeout;
+    }
+
+    bool Driver::waitForBackoff(std::chrono::milliseconds backoff)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        while (runUpdateThread && std::chrono::steady_clock::now() - startTime < backoff)
+        {
+            std::this_thread::sleep_for(WATCHDOG_POLL_INTERVAL);
+        }
+
+        return runUpdateThread;
+    }
+
+    bool Driver::reconnect(bool /*warmRestart*/)
+    {
+        return false;
+    }
+
+    void Driver::onLinkError()
+    {
+        linkErrorOccurred = true;
+    }
+
+    void Driver::setReconnectPolicy(const ReconnectPolicy& reconnectPolicy)
+    {
+        this->reconnectPolicy = reconnectPolicy;
+    }
+
+    Driver::ConnectionState Driver::getConnectionState()
+    {
+        return connectionState;
+    }
+
+    void Driver::registerConnectionStateCallback(std::function<void(ConnectionState)> callback)
+    {
+        std::lock_guard<std::mutex> lock(connectionStateCallbackMutex);
+
+        connectionStateCallbackFunction = callback;
+    }
+
+    void Driver::setConnectionState(ConnectionState connectionState)
+    {
+        if (this->connectionState.exchange(connectionState) == connectionState)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(connectionStateCallbackMutex);
+
+        if (connectionStateCallbackFunction != nullptr)
+        {
+            connectionStateCallbackFunction(connectionState);
+        }
+    }
+
+    bool Driver::setCaptureRecorder(std::shared_ptr<CaptureRecorder> captureRecorder)
+    {
+        std::shared_ptr<CaptureTarget> target = nullptr;
+
+        if (captureRecorder != nullptr)
+        {
+            int streamId = captureRecorder->openStream(getCaptureStreamInfo());
+            if (streamId == CaptureRecorder::INVALID_STREAM_ID)
+            {
+                return false;
+            }
+
+            target = std::make_shared<CaptureTarget>();
+            target->captureRecorder = captureRecorder;
+            target->streamId = streamId;
+        }
+
+        std::atomic_store(&captureTarget, std::shared_ptr<const CaptureTarget>(target));
+        return true;
+    }
+
+    CaptureRecorder::StreamInfo Driver::getCaptureStreamInfo()
+    {
+        return CaptureRecorder::StreamInfo();
+    }
+
+    void Driver::captureRawData(const unsigned char* data, unsigned int length, const std::chrono::system_clock::time_point& timestamp, bool kernelTimestamp)
+    {
+        std::shared_ptr<const CaptureTarget> target = std::atomic_load(&captureTarget);
+
+        if (target != nullptr)
+        {
+            target->captureRecorder->record(target->streamId, data, length, timestamp, kernelTimestamp);
+        }
+    }
+
 	void Driver::assertIsConnected()
 	{
         if(!isConnected())
@@ -78,41 +259,454 @@ namespace parakeet
         return updateThreadFrameCount / (ms / 1000.0);
     }
 
+    std::chrono::milliseconds Driver::getStartupDuration()
+    {
+        return startupDuration;
+    }
+
+    void Driver::setStartupDuration(std::chrono::steady_clock::duration duration)
+    {
+        startupDuration = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+    }
+
     void Driver::registerScanCallback(std::function<void(const ScanDataPolar&)> callback)
     {
         scanCallbackFunction = callback;
     }
 
+    void Driver::registerCachedScanCallback(std::function<void(const std::shared_ptr<const CachedScan>&)> callback, bool transformEagerly)
+    {
+        std::shared_ptr<CachedScanTarget> target = nullptr;
+
+        if (callback != nullptr)
+        {
+            target = std::make_shared<CachedScanTarget>();
+            target->callback = callback;
+
+            if (transformEagerly)
+            {
+                target->cartesianWorker = std::make_shared<internal::CartesianWorker>();
+            }
+        }
+
+        std::atomic_store(&cachedScanTarget, std::shared_ptr<const CachedScanTarget>(target));
+    }
+
+    void Driver::registerCompactScanCallback(std::function<void(const CompactScanData&)> callback)
+    {
+        std::shared_ptr<internal::ScanEmitter> scanEmitter;
+        if (callback != nullptr)
+        {
+            scanEmitter.reset(new internal::CompactScanEmitter(callback));
+        }
+
+        setScanEmitter(std::type_index(typeid(CompactScanData)), scanEmitter);
+    }
+
+    void Driver::registerGridScanCallback(std::function<void(const GridScanData&)> callback, const GridScanData::Settings& settings)
+    {
+        std::shared_ptr<internal::ScanEmitter> scanEmitter;
+        if (callback != nullptr)
+        {
+            scanEmitter.reset(new internal::GridScanEmitter(callback, settings));
+        }
+
+        setScanEmitter(std::type_index(typeid(GridScanData)), scanEmitter);
+    }
+
+    void Driver::registerRangeIndexCallback(std::function<void(const RangeIndex&)> callback)
+    {
+        std::shared_ptr<internal::ScanEmitter> scanEmitter;
+        if (callback != nullptr)
+        {
+            scanEmitter.reset(new internal::RangeIndexEmitter(callback));
+        }
+
+        setScanEmitter(std::type_index(typeid(RangeIndex)), scanEmitter);
+    }
+
+    void Driver::registerProtectiveFieldCallback(const ProtectiveFieldMonitor::Settings& settings, std::function<void(const ProtectiveFieldMonitor::Event&)> callback)
+    {
+        std::shared_ptr<internal::ProtectiveFieldEmitter> scanEmitter;
+        if (callback != nullptr)
+        {
+            scanEmitter.reset(new internal::ProtectiveFieldEmitter(settings, callback));
+        }
+
+        std::atomic_store(&protectiveFieldEmitter, scanEmitter);
+
+        // Ahead of the other emitters, so no scan is built before the revolution's zones are settled
+        setScanEmitter(std::type_index(typeid(ProtectiveFieldMonitor)), scanEmitter, true);
+    }
+
+    void Driver::registerSectorCallback(std::function<void(const SectorView&)> callback)
+    {
+        std::shared_ptr<const SectorCallback> newSectorCallback;
+        if (callback != nullptr)
+        {
+            newSectorCallback = std::make_shared<const SectorCallback>(callback);
+        }
+
+        std::atomic_store(&sectorCallback, newSectorCallback);
+    }
+
+    void Driver::registerRollingScanCallback(std::function<void(const RollingScan&)> callback)
+    {
+        std::shared_ptr<internal::ScanEmitter> scanEmitter;
+        if (callback != nullptr)
+        {
+            scanEmitter.reset(new internal::RollingScanEmitter(callback));
+        }
+
+        setScanEmitter(std::type_index(typeid(RollingScan)), scanEmitter);
+    }
+
+    void Driver::setSeamAngle_deg(double seamAngle_deg)
+    {
+        seamAngle_deg = std::fmod(seamAngle_deg, 360.0);
+
+        this->seamAngle_deg = seamAngle_deg < 0 ? seamAngle_deg + 360 : seamAngle_deg;
+    }
+
+    double Driver::getSeamAngle_deg()
+    {
+        return seamAngle_deg;
+    }
+
     void Driver::registerUpdateThreadCallback(std::function<void()> callback)
     {
         updateThreadCallbackFunction = callback;
     }
     
+    void Driver::setScanEmitter(std::type_index pointType, std::shared_ptr<internal::ScanEmitter> scanEmitter, bool first)
+    {
+        std::lock_guard<std::mutex> lock(scanEmitterMutex);
+
+        // Copied on write, so the update thread never waits on a registration
+        std::shared_ptr<ScanEmitterList> newScanEmitters(new ScanEmitterList());
+
+        std::shared_ptr<const ScanEmitterList> currentScanEmitters = std::atomic_load(&scanEmitters);
+        if (currentScanEmitters)
+        {
+            for (const std::shared_ptr<internal::ScanEmitter>& currentScanEmitter : *currentScanEmitters)
+            {
+                if (currentScanEmitter->getPointType() != pointType)
+                {
+                    newScanEmitters->push_back(currentScanEmitter);
+                }
+            }
+        }
+
+        if (scanEmitter)
+        {
+            newScanEmitters->insert(first ? newScanEmitters->begin() : newScanEmitters->end(), scanEmitter);
+        }
+
+        std::atomic_store(&scanEmitters, std::shared_ptr<const ScanEmitterList>(newScanEmitters));
+    }
+
+    int Driver::addDerivedScanStream(const DerivedScanStream::Settings& settings, std::function<void(const CompactScanData&)> callback)
+    {
+        std::lock_guard<std::mutex> lock(derivedScanStreamMutex);
+
+        // Sectors may already be arriving, so the stream starts with the next whole revolution
+        std::shared_ptr<DerivedScanStream> stream = std::make_shared<DerivedScanStream>(settings, callback);
+        stream->waitForNextRevolution();
+
+        int streamId = nextDerivedScanStreamId++;
+        derivedScanStreams.push_back(std::make_pair(streamId, stream));
+
+        updateDerivedScanEmitter();
+
+        return streamId;
+    }
+
+    void Driver::removeDerivedScanStream(int streamId)
+    {
+        std::lock_guard<std::mutex> lock(derivedScanStreamMutex);
+
+        derivedScanStreams.erase(std::remove_if(derivedScanStreams.begin(), derivedScanStreams.end(),
+            [streamId](const std::pair<int, std::shared_ptr<DerivedScanStream>>& stream) { return stream.first == streamId; }),
+            derivedScanStreams.end());
+
+        updateDerivedScanEmitter();
+    }
+
+    void Driver::updateDerivedScanEmitter()
+    {
+        std::vector<std::shared_ptr<DerivedScanStream>> streams;
+        for (const std::pair<int, std::shared_ptr<DerivedScanStream>>& stream : derivedScanStreams)
+        {
+            streams.push_back(stream.second);
+        }
+
+        std::shared_ptr<internal::ScanEmitter> scanEmitter;
+        if (!streams.empty())
+        {
+            scanEmitter.reset(new internal::DerivedScanEmitter(streams));
+        }
+
+        // One emitter for every stream, replaced with one sharing the same streams
+        setScanEmitter(std::type_index(typeid(DerivedScanStream)), scanEmitter);
+    }
+
+    void Driver::setRegionOfInterest(const RegionOfInterest& regionOfInterest)
+    {
+        std::shared_ptr<const RegionOfInterest> newRegionOfInterest;
+        if (!regionOfInterest.isWholeRevolution())
+        {
+            newRegionOfInterest = std::make_shared<const RegionOfInterest>(regionOfInterest);
+        }
+
+        std::atomic_store(&this->regionOfInterest, newRegionOfInterest);
+    }
+
+    RegionOfInterest Driver::getRegionOfInterest()
+    {
+        std::shared_ptr<const RegionOfInterest> currentRegionOfInterest = std::atomic_load(&regionOfInterest);
+
+        return currentRegionOfInterest != nullptr ? *currentRegionOfInterest : RegionOfInterest();
+    }
+
+    void Driver::setFilterSettings(const FilterPipeline::Settings& settings)
+    {
+        filterPipeline.setSettings(settings);
+    }
+
+    FilterPipeline::Settings Driver::getFilterSettings()
+    {
+        return filterPipeline.getSettings();
+    }
+
+    FilterPipeline::Statistics Driver::getFilterStatistics()
+    {
+        return filterPipeline.getStatistics();
+    }
+
     void Driver::onScanDataReceived(const ScanData& scanData)
     {
+        // The zones are checked against the sector as it was received, before any point is dropped or filtered
+        std::shared_ptr<internal::ProtectiveFieldEmitter> currentProtectiveFieldEmitter = std::atomic_load(&protectiveFieldEmitter);
+        if (currentProtectiveFieldEmitter != nullptr)
+        {
+            currentProtectiveFieldEmitter->checkSector(scanData);
+        }
+
+        SectorRuns runs;
+        findRuns(scanData, runs);
+
+        if (!filterPipeline.isEnabled() || runs.count == 0)
+        {
+            publishScanData(scanData, runs);
+            return;
+        }
+
+        // Filtered in a copy of the points only, so the filters never touch a parser's buffers. Only the points from the
+        // first run to the last are copied and filtered, the rest are never published.
+        std::size_t firstIndex = runs.firstIndices[0];
+        std::size_t endIndex = runs.endIndices[runs.count - 1];
+
+        filteredScanData.startAngle_deg = scanData.startAngle_deg;
+        filteredScanData.endAngle_deg = scanData.endAngle_deg;
+        filteredScanData.count = scanData.count;
+        filteredScanData.timestamp = scanData.timestamp;
+        std::copy(scanData.dist_mm + firstIndex, scanData.dist_mm + endIndex, filteredScanData.dist_mm + firstIndex);
+        std::copy(scanData.intensity + firstIndex, scanData.intensity + endIndex, filteredScanData.intensity + firstIndex);
+
         double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+        filterPipeline.apply(endIndex - firstIndex, scanData.startAngle_deg + (anglePerPoint_deg * firstIndex), anglePerPoint_deg,
+            filteredScanData.dist_mm + firstIndex, filteredScanData.intensity + firstIndex);
+
+        publishScanData(filteredScanData, runs);
+    }
+
+    void Driver::onPartialSectorReceived(const ScanData& partialSector)
+    {
+        partialSectorsReceived = true;
+
+        SectorRuns runs;
+        findRuns(partialSector, runs);
+
+        publishSector(partialSector, runs, true);
+    }
+
+    void Driver::findRuns(const ScanData& scanData, SectorRuns& runs)
+    {
+        std::shared_ptr<const RegionOfInterest> currentRegionOfInterest = std::atomic_load(&regionOfInterest);
+
+        if (currentRegionOfInterest == nullptr)
+        {
+            runs.firstIndices[0] = 0;
+            runs.endIndices[0] = scanData.count;
+            runs.count = scanData.count > 0 ? 1 : 0;
+            return;
+        }
+
+        double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+        runs.count = currentRegionOfInterest->findRuns(scanData.count, scanData.startAngle_deg, anglePerPoint_deg, runs.firstIndices, runs.endIndices);
+    }
+
+    void Driver::publishSector(const ScanData& scanData, const SectorRuns& runs, bool partial)
+    {
+        std::shared_ptr<const SectorCallback> currentSectorCallback = std::atomic_load(&sectorCallback);
+
+        if (currentSectorCallback == nullptr)
+        {
+            return;
+        }
+
+        double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+        // Each run is viewed in place
+        for (int run = 0; run < runs.count; run++)
+        {
+            std::size_t firstIndex = runs.firstIndices[run];
+            std::size_t endIndex = runs.endIndices[run];
+
+            SectorView sectorView(scanData.timestamp, scanData.startAngle_deg + (anglePerPoint_deg * firstIndex), scanData.startAngle_deg + (anglePerPoint_deg * endIndex),
+                endIndex - firstIndex, scanData.dist_mm + firstIndex, scanData.intensity + firstIndex, partial);
+
+            (*currentSectorCallback)(sectorView);
+        }
+    }
+
+    void Driver::publishScanData(const ScanData& scanData, const SectorRuns& runs)
+    {
+        // A sensor which hands over each datagram of a sector has delivered this sector already
+        if (!partialSectorsReceived)
+        {
+            publishSector(scanData, runs, false);
+        }
+
         double deviationFrom360_deg = 1;
+        double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+        // The sector's angles counted from the seam, a sector which starts just short of the seam starts the revolution
+        double startAngle_deg = std::fmod(scanData.startAngle_deg - seamAngle_deg, 360.0);
+        startAngle_deg = startAngle_deg < 0 ? startAngle_deg + 360 : startAngle_deg;
+        startAngle_deg = startAngle_deg + deviationFrom360_deg >= 360 ? startAngle_deg - 360 : startAngle_deg;
 
-        //Create PointPolar for each data point
-        for(int i = 0; i < scanData.count; i++)
+        double endAngle_deg = startAngle_deg + (scanData.endAngle_deg - scanData.startAngle_deg);
+
+        if (endAngle_deg + deviationFrom360_deg < 360)
         {
-            PointPolar pointPolar(scanData.dist_mm[i], scanData.startAngle_deg + (anglePerPoint_deg * i), scanData.intensity[i]);
+            addToRevolution(scanData, runs, 0, scanData.count);
+            return;
+        }
+
+        // The points from the seam on start the next revolution
+        int seamIndex = anglePerPoint_deg > 0 ? static_cast<int>(std::ceil((360 - startAngle_deg) / anglePerPoint_deg - 1e-6)) : scanData.count;
 
-            pointHoldingList.push_back(pointPolar);
+        if (seamIndex <= 0 || seamIndex >= scanData.count)
+        {
+            addToRevolution(scanData, runs, 0, scanData.count);
+            publishRevolution(scanData.timestamp);
+            return;
         }
 
-        if(scanData.endAngle_deg + deviationFrom360_deg >= 360)
+        addToRevolution(scanData, runs, 0, seamIndex);
+        publishRevolution(scanData.timestamp);
+        addToRevolution(scanData, runs, seamIndex, scanData.count);
+    }
+
+    void Driver::addToRevolution(const ScanData& scanData, const SectorRuns& runs, std::size_t firstIndex, std::size_t endIndex)
+    {
+        double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+        for (int run = 0; run < runs.count; run++)
         {
-            updateThreadFrameCount++;
+            std::size_t runFirstIndex = std::max(runs.firstIndices[run], firstIndex);
+            std::size_t runEndIndex = std::min(runs.endIndices[run], endIndex);
 
-            ScanDataPolar scanDataPolar(pointHoldingList, scanData.timestamp);
+            if (runFirstIndex >= runEndIndex)
+            {
+                continue;
+            }
+
+            if (runFirstIndex == 0 && runEndIndex == scanData.count)
+            {
+                addSectorToRevolution(scanData);
+                continue;
+            }
+
+            // Part of a sector, split at the seam or the region of interest, is added as a sector of its own
+            pieceScanData.timestamp = scanData.timestamp;
+            pieceScanData.startAngle_deg = scanData.startAngle_deg + (anglePerPoint_deg * runFirstIndex);
+            pieceScanData.endAngle_deg = scanData.startAngle_deg + (anglePerPoint_deg * runEndIndex);
+            pieceScanData.count = static_cast<unsigned short>(runEndIndex - runFirstIndex);
+            std::copy(scanData.dist_mm + runFirstIndex, scanData.dist_mm + runEndIndex, pieceScanData.dist_mm);
+            std::copy(scanData.intensity + runFirstIndex, scanData.intensity + runEndIndex, pieceScanData.intensity);
+
+            addSectorToRevolution(pieceScanData);
+        }
+    }
+
+    void Driver::addSectorToRevolution(const ScanData& scanData)
+    {
+        std::shared_ptr<const ScanEmitterList> currentScanEmitters = std::atomic_load(&scanEmitters);
+        if (currentScanEmitters)
+        {
+            for (const std::shared_ptr<internal::ScanEmitter>& scanEmitter : *currentScanEmitters)
+            {
+                scanEmitter->addSector(scanData);
+            }
+        }
+
+        double anglePerPoint_deg = (scanData.endAngle_deg - scanData.startAngle_deg) / scanData.count;
+
+        //Create PointPolar for each data point, unless only BasicScanData callbacks are registered
+        if (scanCallbackFunction != nullptr || std::atomic_load(&cachedScanTarget) != nullptr)
+        {
+            for(int i = 0; i < scanData.count; i++)
+            {
+                PointPolar pointPolar(scanData.dist_mm[i], scanData.startAngle_deg + (anglePerPoint_deg * i), scanData.intensity[i]);
+
+                pointHoldingList.push_back(pointPolar);
+            }
+        }
+    }
+
+    void Driver::publishRevolution(const std::chrono::system_clock::time_point& timestamp)
+    {
+        updateThreadFrameCount++;
+
+        revolutionReceivedSinceReconnect = true;
+        timeOfLastRevolution = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        std::shared_ptr<const CachedScanTarget> currentCachedScanTarget = std::atomic_load(&cachedScanTarget);
+
+        if (currentCachedScanTarget != nullptr)
+        {
+            std::shared_ptr<const CachedScan> cachedScan = std::make_shared<const CachedScan>(ScanDataPolar(pointHoldingList, timestamp));
+
+            if (currentCachedScanTarget->cartesianWorker != nullptr)
+            {
+                currentCachedScanTarget->cartesianWorker->post(cachedScan);
+            }
 
             if (scanCallbackFunction != nullptr)
             {
-                scanCallbackFunction(scanDataPolar);
+                scanCallbackFunction(cachedScan->getPolar());
             }
 
-            pointHoldingList.clear();
+            currentCachedScanTarget->callback(cachedScan);
+        }
+        else if (scanCallbackFunction != nullptr)
+        {
+            ScanDataPolar scanDataPolar(pointHoldingList, timestamp);
+
+            scanCallbackFunction(scanDataPolar);
+        }
+
+        pointHoldingList.clear();
+
+        std::shared_ptr<const ScanEmitterList> currentScanEmitters = std::atomic_load(&scanEmitters);
+        if (currentScanEmitters)
+        {
+            for (const std::shared_ptr<internal::ScanEmitter>& scanEmitter : *currentScanEmitters)
+            {
+                scanEmitter->publish();
+            }
         }
     }
 }
@@ -0,0 +1,413 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/FilterPipeline.h>
+#include <parakeet/util.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    // The kernels below are written as branch free loops over whole columns, which the compiler vectorizes
+
+    const int FilterPipeline::MAX_ANGLE_MASK_COUNT;
+    const int FilterPipeline::MAX_SMOOTHING_RADIUS;
+    const int FilterPipeline::MAX_ISOLATION_RADIUS;
+    const int FilterPipeline::MAX_VEILING_RADIUS;
+
+    static double normalizeAngle_deg(double angle_deg)
+    {
+        angle_deg = std::fmod(angle_deg, 360.0);
+
+        return angle_deg < 0 ? angle_deg + 360 : angle_deg;
+    }
+
+    // Taken and returned by value, so min and max compile to selects rather than branches
+    template <typename T>
+    static T minimum(T a, T b)
+    {
+        return a < b ? a : b;
+    }
+
+    template <typename T>
+    static T maximum(T a, T b)
+    {
+        return a < b ? b : a;
+    }
+
+    static std::uint16_t median3(std::uint16_t a, std::uint16_t b, std::uint16_t c)
+    {
+        return maximum(minimum(a, b), minimum(maximum(a, b), c));
+    }
+
+    void FilterPipeline::setSettings(const Settings& settings)
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+
+        this->settings = settings;
+        this->settings.angleMaskCount = std::min(std::max(settings.angleMaskCount, 0), MAX_ANGLE_MASK_COUNT);
+        this->settings.isolationRadius = std::min(std::max(settings.isolationRadius, 1), MAX_ISOLATION_RADIUS);
+        this->settings.veilingRadius = std::min(std::max(settings.veilingRadius, 1), MAX_VEILING_RADIUS);
+        this->settings.smoothingRadius = std::min(std::max(settings.smoothingRadius, 1), MAX_SMOOTHING_RADIUS);
+
+        enabled = isEnabled(this->settings);
+    }
+
+    FilterPipeline::Settings FilterPipeline::getSettings()
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+
+        return settings;
+    }
+
+    bool FilterPipeline::isEnabled() const
+    {
+        return enabled;
+    }
+
+    FilterPipeline::Statistics FilterPipeline::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.veilingPointsRemoved = veilingPointsRemoved;
+        statistics.pointsRemoved = pointsRemoved;
+
+        return statistics;
+    }
+
+    bool FilterPipeline::isEnabled(const Settings& settings)
+    {
+        return settings.rangeMaskEnabled || settings.angleMaskCount > 0 || settings.minimumIntensity > 0 ||
+            settings.veilingPointRemovalEnabled || settings.isolatedPointRemovalEnabled || settings.temporalFiltering != NoTemporalFiltering ||
+            settings.smoothing != NoSmoothing;
+    }
+
+    static std::size_t countReturns(std::size_t pointCount, const std::uint16_t* ranges_mm)
+    {
+        // Counted in 32 bits, which keeps more counts in each vector than a size_t would
+        std::uint32_t returnCount = 0;
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            returnCount += ranges_mm[i] != 0 ? 1 : 0;
+        }
+
+        return returnCount;
+    }
+
+    std::size_t FilterPipeline::apply(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm, std::uint8_t* intensities)
+    {
+        Settings currentSettings;
+
+        {
+            std::lock_guard<std::mutex> lock(settingsMutex);
+            currentSettings = settings;
+        }
+
+        std::size_t returnCount = countReturns(pointCount, ranges_mm);
+
+        if (currentSettings.rangeMaskEnabled)
+        {
+            applyRangeMask(currentSettings, pointCount, ranges_mm);
+        }
+
+        if (currentSettings.angleMaskCount > 0)
+        {
+            applyAngleMasks(currentSettings, pointCount, startAngle_deg, anglePerPoint_deg, ranges_mm);
+        }
+
+        if (currentSettings.minimumIntensity > 0)
+        {
+            applyIntensityThreshold(currentSettings, pointCount, ranges_mm, intensities);
+        }
+
+        if (currentSettings.veilingPointRemovalEnabled)
+        {
+            veilingPointsRemoved += removeVeilingPoints(currentSettings, pointCount, anglePerPoint_deg, ranges_mm);
+        }
+
+        if (currentSettings.isolatedPointRemovalEnabled)
+        {
+            removeIsolatedPoints(currentSettings, pointCount, ranges_mm);
+        }
+
+        if (currentSettings.temporalFiltering != NoTemporalFiltering)
+        {
+            temporalFilter.configure(currentSettings.temporalBinWidth_deg, currentSettings.temporalRevolutionCount);
+
+            if (currentSettings.temporalFiltering == ExponentialTemporalFiltering)
+            {
+                float smoothingFactor = static_cast<float>(std::min(std::max(currentSettings.temporalSmoothingFactor, 0.0), 1.0));
+                temporalFilter.applyExponential(pointCount, startAngle_deg, anglePerPoint_deg, ranges_mm, smoothingFactor, currentSettings.temporalResetDistance_mm);
+            }
+            else
+            {
+                temporalFilter.applyMedian(pointCount, startAngle_deg, anglePerPoint_deg, ranges_mm, currentSettings.temporalResetDistance_mm);
+            }
+        }
+
+        if (currentSettings.smoothing == MedianSmoothing)
+        {
+            applyMedian(currentSettings.smoothingRadius, pointCount, ranges_mm);
+        }
+        else if (currentSettings.smoothing == BilateralSmoothing)
+        {
+            applyBilateral(currentSettings, pointCount, ranges_mm);
+        }
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            intensities[i] = ranges_mm[i] == 0 ? 0 : intensities[i];
+        }
+
+        std::size_t removedCount = returnCount - countReturns(pointCount, ranges_mm);
+        pointsRemoved += removedCount;
+
+        return removedCount;
+    }
+
+    void FilterPipeline::applyRangeMask(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm)
+    {
+        std::uint16_t minimumRange_mm = settings.minimumRange_mm;
+        std::uint16_t maximumRange_mm = settings.maximumRange_mm;
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = (ranges_mm[i] < minimumRange_mm || ranges_mm[i] > maximumRange_mm) ? 0 : ranges_mm[i];
+        }
+    }
+
+    void FilterPipeline::applyAngleMasks(const Settings& settings, std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm)
+    {
+        angles_deg.resize(pointCount);
+
+        float firstAngle_deg = static_cast<float>(normalizeAngle_deg(startAngle_deg));
+        float step_deg = static_cast<float>(anglePerPoint_deg);
+
+        // The kernels write through plain pointers, as stores through a vector may alias the vector itself
+        float* angles = angles_deg.data();
+
+        // A sector is less than a revolution, so its angles cross 360 degrees at most once
+        for (int i = 0; i < static_cast<int>(pointCount); i++)
+        {
+            float angle_deg = firstAngle_deg + step_deg * i;
+            angles[i] = angle_deg - 360.0f * static_cast<float>(static_cast<int>(angle_deg / 360.0f));
+        }
+
+        for (int mask = 0; mask < settings.angleMaskCount; mask++)
+        {
+            float maskStart_deg = static_cast<float>(normalizeAngle_deg(settings.angleMasks[mask].startAngle_deg));
+            float maskEnd_deg = static_cast<float>(normalizeAngle_deg(settings.angleMasks[mask].endAngle_deg));
+
+            if (maskStart_deg <= maskEnd_deg)
+            {
+                for (std::size_t i = 0; i < pointCount; i++)
+                {
+                    bool masked = (angles[i] >= maskStart_deg) & (angles[i] < maskEnd_deg);
+                    ranges_mm[i] = masked ? 0 : ranges_mm[i];
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < pointCount; i++)
+                {
+                    bool masked = (angles[i] >= maskStart_deg) | (angles[i] < maskEnd_deg);
+                    ranges_mm[i] = masked ? 0 : ranges_mm[i];
+                }
+            }
+        }
+    }
+
+    void FilterPipeline::applyIntensityThreshold(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm, const std::uint8_t* intensities)
+    {
+        std::uint8_t minimumIntensity = settings.minimumIntensity;
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = intensities[i] < minimumIntensity ? 0 : ranges_mm[i];
+        }
+    }
+
+    std::size_t FilterPipeline::removeVeilingPoints(const Settings& settings, std::size_t pointCount, double anglePerPoint_deg, std::uint16_t* ranges_mm)
+    {
+        int radius = settings.veilingRadius;
+        float minimumDiscontinuity_mm = settings.veilingMinimumDiscontinuity_mm;
+        float tanMinimumAngle = static_cast<float>(std::tan(util::degreesToRadians(settings.veilingMinimumAngle_deg)));
+
+        paddedRanges.assign(pointCount + 2 * radius, 0);
+        std::copy(ranges_mm, ranges_mm + pointCount, paddedRanges.begin() + radius);
+
+        const std::uint16_t* padded = paddedRanges.data() + radius;
+
+        flags.assign(pointCount, 0);
+        std::uint8_t* veiling = flags.data();
+
+        for (int offset = -radius; offset <= radius; offset++)
+        {
+            if (offset == 0)
+            {
+                continue;
+            }
+
+            const std::uint16_t* neighbors = padded + offset;
+
+            double angleBetween_rad = util::degreesToRadians(std::fabs(offset * anglePerPoint_deg));
+            float sinAngle = static_cast<float>(std::sin(angleBetween_rad));
+            float cosAngle = static_cast<float>(std::cos(angleBetween_rad));
+
+            // The line from a point to a nearer neighbor meets the point's beam at an angle whose tangent is
+            // neighbor * sin(angleBetween) / (range - neighbor * cos(angleBetween)), compared without dividing
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                float range_mm = padded[i];
+                float neighbor_mm = neighbors[i];
+
+                bool discontinuous = (neighbors[i] != 0) & (range_mm - neighbor_mm > minimumDiscontinuity_mm);
+                bool grazing = neighbor_mm * sinAngle < tanMinimumAngle * (range_mm - neighbor_mm * cosAngle);
+
+                veiling[i] |= static_cast<std::uint8_t>(discontinuous & grazing);
+            }
+        }
+
+        std::size_t removedCount = 0;
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            removedCount += veiling[i];
+            ranges_mm[i] = veiling[i] ? 0 : ranges_mm[i];
+        }
+
+        return removedCount;
+    }
+
+    void FilterPipeline::removeIsolatedPoints(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm)
+    {
+        int radius = settings.isolationRadius;
+        int isolationDistance_mm = settings.isolationDistance_mm;
+
+        // Padded with points without a return, so the points at the edges have fewer neighbors rather than copies of themselves
+        paddedRanges.assign(pointCount + 2 * radius, 0);
+        std::copy(ranges_mm, ranges_mm + pointCount, paddedRanges.begin() + radius);
+
+        const std::uint16_t* padded = paddedRanges.data() + radius;
+
+        flags.assign(pointCount, 0);
+        std::uint8_t* supportedPoints = flags.data();
+
+        for (int offset = -radius; offset <= radius; offset++)
+        {
+            if (offset == 0)
+            {
+                continue;
+            }
+
+            const std::uint16_t* neighbors = padded + offset;
+
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                int difference_mm = static_cast<int>(neighbors[i]) - static_cast<int>(padded[i]);
+                supportedPoints[i] |= static_cast<std::uint8_t>((neighbors[i] != 0) & (std::abs(difference_mm) <= isolationDistance_mm));
+            }
+        }
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = supportedPoints[i] ? ranges_mm[i] : 0;
+        }
+    }
+
+    void FilterPipeline::applyMedian(int radius, std::size_t pointCount, std::uint16_t* ranges_mm)
+    {
+        const std::uint16_t* padded = pad(radius, pointCount, ranges_mm);
+
+        if (radius == 1)
+        {
+            const std::uint16_t* previous = padded - 1;
+            const std::uint16_t* next = padded + 1;
+
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                std::uint16_t median = median3(previous[i], padded[i], next[i]);
+                ranges_mm[i] = padded[i] == 0 ? 0 : (median == 0 ? padded[i] : median);
+            }
+        }
+        else
+        {
+            const std::uint16_t* a = padded - 2;
+            const std::uint16_t* b = padded - 1;
+            const std::uint16_t* c = padded + 1;
+            const std::uint16_t* d = padded + 2;
+
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                // The median of five is the median of the middle point and the two middle values of the outer pairs
+                std::uint16_t median = median3(padded[i], maximum(minimum(a[i], b[i]), minimum(c[i], d[i])), minimum(maximum(a[i], b[i]), maximum(c[i], d[i])));
+                ranges_mm[i] = padded[i] == 0 ? 0 : (median == 0 ? padded[i] : median);
+            }
+        }
+    }
+
+    void FilterPipeline::applyBilateral(const Settings& settings, std::size_t pointCount, std::uint16_t* ranges_mm)
+    {
+        int radius = settings.smoothingRadius;
+        int rangeSigma_mm = settings.bilateralRangeSigma_mm;
+
+        if (rangeSigma_mm == 0)
+        {
+            return;
+        }
+
+        paddedRanges.assign(pointCount + 2 * radius, 0);
+        std::copy(ranges_mm, ranges_mm + pointCount, paddedRanges.begin() + radius);
+
+        const std::uint16_t* padded = paddedRanges.data() + radius;
+
+        weightedSums.assign(pointCount, 0);
+        weights.assign(pointCount, 0);
+
+        float* sums = weightedSums.data();
+        std::int32_t* totalWeights = weights.data();
+
+        // Tent shaped weights in both angle and range, calculated in integers, which need no exponential
+        for (int offset = -radius; offset <= radius; offset++)
+        {
+            const std::uint16_t* neighbors = padded + offset;
+            int spatialWeight = radius + 1 - std::abs(offset);
+
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                int difference_mm = static_cast<int>(neighbors[i]) - static_cast<int>(padded[i]);
+                int weight = spatialWeight * maximum(rangeSigma_mm - std::abs(difference_mm), 0) * (neighbors[i] != 0);
+
+                sums[i] += static_cast<float>(weight) * neighbors[i];
+                totalWeights[i] += weight;
+            }
+        }
+
+        // A point with a return always weighs itself, a point without one stays without one
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            int smoothed_mm = static_cast<int>(sums[i] / static_cast<float>(maximum(totalWeights[i], 1)) + 0.5f);
+            ranges_mm[i] = static_cast<std::uint16_t>(smoothed_mm * (padded[i] != 0));
+        }
+    }
+
+    const std::uint16_t* FilterPipeline::pad(int radius, std::size_t pointCount, const std::uint16_t* ranges_mm)
+    {
+        paddedRanges.resize(pointCount + 2 * radius);
+        std::copy(ranges_mm, ranges_mm + pointCount, paddedRanges.begin() + radius);
+
+        std::uint16_t first = pointCount > 0 ? ranges_mm[0] : 0;
+        std::uint16_t last = pointCount > 0 ? ranges_mm[pointCount - 1] : 0;
+
+        std::fill(paddedRanges.begin(), paddedRanges.begin() + radius, first);
+        std::fill(paddedRanges.end() - radius, paddedRanges.end(), last);
+
+        return paddedRanges.data() + radius;
+    }
+}
+}
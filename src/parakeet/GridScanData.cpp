@@ -0,0 +1,102 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/GridScanData.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const int GridScanData::MAX_CELL_COUNT;
+
+    GridScanData::GridScanData() :
+        GridScanData(Settings())
+    {
+    }
+
+    GridScanData::GridScanData(const Settings& settings) :
+        settings(settings)
+    {
+        double cellCount = std::round(360 / std::max(settings.resolution_deg, 360.0 / MAX_CELL_COUNT));
+        cellCount = std::max(cellCount, 1.0);
+
+        this->settings.resolution_deg = 360 / cellCount;
+        cellsPerDegree = cellCount / 360;
+        ranges_mm.assign(static_cast<std::size_t>(cellCount), settings.invalidRange_mm);
+    }
+
+    const GridScanData::Settings& GridScanData::getSettings() const
+    {
+        return settings;
+    }
+
+    const std::chrono::system_clock::time_point& GridScanData::getTimestamp() const
+    {
+        return timestampOfFirstPoint;
+    }
+
+    void GridScanData::setTimestamp(const std::chrono::system_clock::time_point& timestampOfFirstPoint)
+    {
+        this->timestampOfFirstPoint = timestampOfFirstPoint;
+    }
+
+    std::size_t GridScanData::getCellCount() const
+    {
+        return ranges_mm.size();
+    }
+
+    double GridScanData::getResolution_deg() const
+    {
+        return settings.resolution_deg;
+    }
+
+    double GridScanData::getAngle_deg(std::size_t cell) const
+    {
+        return cell * settings.resolution_deg;
+    }
+
+    std::size_t GridScanData::getCell(double angle_deg) const
+    {
+        double cell = angle_deg * cellsPerDegree + 0.5;
+        double cellCount = static_cast<double>(ranges_mm.size());
+
+        // Bearings within a revolution only need truncating, without the division
+        if (cell >= 0 && cell < cellCount)
+        {
+            return static_cast<std::size_t>(cell);
+        }
+
+        cell = std::fmod(std::floor(cell), cellCount);
+        return static_cast<std::size_t>(cell < 0 ? cell + cellCount : cell);
+    }
+
+    std::uint16_t GridScanData::getRange_mm(std::size_t cell) const
+    {
+        return ranges_mm[cell];
+    }
+
+    std::uint16_t GridScanData::getRangeAt_mm(double angle_deg) const
+    {
+        return ranges_mm[getCell(angle_deg)];
+    }
+
+    bool GridScanData::isValid(std::size_t cell) const
+    {
+        return ranges_mm[cell] != settings.invalidRange_mm;
+    }
+
+    const std::uint16_t* GridScanData::getRanges_mm() const
+    {
+        return ranges_mm.data();
+    }
+
+    std::uint16_t* GridScanData::getRanges_mm()
+    {
+        return ranges_mm.data();
+    }
+}
+}
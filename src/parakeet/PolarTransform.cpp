@@ -0,0 +1,275 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/PolarTransform.h>
+#include <parakeet/util.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    template <typename T>
+    const std::size_t PolarTransform<T>::DEFAULT_MAXIMUM_LAYOUT_COUNT;
+
+    template <typename T>
+    const std::size_t PolarTransform<T>::DEFAULT_MAXIMUM_POOLED_BUFFER_COUNT;
+
+    template <typename T>
+    PolarTransform<T>::PolarTransform(std::size_t maximumLayoutCount, std::size_t maximumPooledBufferCount) :
+        maximumLayoutCount(std::max<std::size_t>(maximumLayoutCount, 1)),
+        pool(new Pool())
+    {
+        pool->maximumBufferCount = maximumPooledBufferCount;
+    }
+
+    template <typename T>
+    const typename PolarTransform<T>::Layout& PolarTransform<T>::findLayout(std::size_t pointCount, const T* angles_deg)
+    {
+        useCount++;
+
+        // Layouts are compared bit for bit, which stops at the first differing angle
+        for (Layout& layout : layouts)
+        {
+            if (layout.angles_deg.size() == pointCount && std::memcmp(layout.angles_deg.data(), angles_deg, pointCount * sizeof(T)) == 0)
+            {
+                layout.lastUsed = useCount;
+                return layout;
+            }
+        }
+
+        Layout* layout;
+        if (layouts.size() < maximumLayoutCount)
+        {
+            layouts.push_back(Layout());
+            layout = &layouts.back();
+        }
+        else
+        {
+            layout = &*std::min_element(layouts.begin(), layouts.end(), [](const Layout& a, const Layout& b)
+            {
+                return a.lastUsed < b.lastUsed;
+            });
+        }
+
+        layout->angles_deg.assign(angles_deg, angles_deg + pointCount);
+        layout->cosines.resize(pointCount);
+        layout->sines.resize(pointCount);
+        layout->lastUsed = useCount;
+
+        // Built in double precision, so the double tables match util::transform(const PointPolar&) exactly
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            double angle_rad = util::degreesToRadians(static_cast<double>(angles_deg[i]));
+
+            layout->cosines[i] = static_cast<T>(cos(angle_rad));
+            layout->sines[i] = static_cast<T>(sin(angle_rad));
+        }
+
+        layoutBuildCount++;
+
+        return *layout;
+    }
+
+    template <typename T>
+    void PolarTransform<T>::transform(std::size_t pointCount, const T* ranges_mm, const T* angles_deg, T* x_mm, T* y_mm)
+    {
+        const Layout& layout = findLayout(pointCount, angles_deg);
+
+        const T* cosines = layout.cosines.data();
+        const T* sines = layout.sines.data();
+
+        // Multiplications only, which the compiler vectorizes
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            x_mm[i] = ranges_mm[i] * cosines[i];
+        }
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            y_mm[i] = ranges_mm[i] * sines[i];
+        }
+    }
+
+    template <typename T>
+    void PolarTransform<T>::gather(const ScanDataPolar& polarScanData, Columns& output)
+    {
+        const std::vector<PointPolar>& points = polarScanData.getPoints();
+        std::size_t pointCount = points.size();
+
+        ranges_mm.resize(pointCount);
+        angles_deg.resize(pointCount);
+        output.intensities.resize(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = static_cast<T>(points[i].getRange_mm());
+            angles_deg[i] = static_cast<T>(points[i].getAngle_deg());
+            output.intensities[i] = points[i].getIntensity();
+        }
+
+        output.timestamp = polarScanData.getTimestamp();
+    }
+
+    template <typename T>
+    void PolarTransform<T>::transform(const ScanDataPolar& polarScanData, Columns& output)
+    {
+        gather(polarScanData, output);
+
+        output.x_mm.resize(ranges_mm.size());
+        output.y_mm.resize(ranges_mm.size());
+
+        transform(ranges_mm.size(), ranges_mm.data(), angles_deg.data(), output.x_mm.data(), output.y_mm.data());
+    }
+
+    template <typename T>
+    void PolarTransform<T>::transform(const ScanView& scanView, Columns& output)
+    {
+        std::size_t pointCount = scanView.getPointCount();
+
+        ranges_mm.assign(scanView.getRanges_mm(), scanView.getRanges_mm() + pointCount);
+        angles_deg.assign(scanView.getAngles_deg(), scanView.getAngles_deg() + pointCount);
+        output.intensities.assign(scanView.getIntensities(), scanView.getIntensities() + pointCount);
+        output.timestamp = scanView.getTimestamp();
+
+        output.x_mm.resize(pointCount);
+        output.y_mm.resize(pointCount);
+
+        transform(pointCount, ranges_mm.data(), angles_deg.data(), output.x_mm.data(), output.y_mm.data());
+    }
+
+    template <typename T>
+    void PolarTransform<T>::transform(const CompactScanData& compactScanData, Columns& output)
+    {
+        std::size_t pointCount = compactScanData.getPointCount();
+        const std::uint16_t* ranges = compactScanData.getRanges_mm();
+        const std::uint16_t* angles = compactScanData.getAngles_cdeg();
+
+        ranges_mm.resize(pointCount);
+        angles_deg.resize(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = static_cast<T>(ranges[i]);
+            angles_deg[i] = static_cast<T>(angles[i] / 100.0);
+        }
+
+        output.intensities.assign(compactScanData.getIntensities(), compactScanData.getIntensities() + pointCount);
+        output.timestamp = compactScanData.getTimestamp();
+
+        output.x_mm.resize(pointCount);
+        output.y_mm.resize(pointCount);
+
+        transform(pointCount, ranges_mm.data(), angles_deg.data(), output.x_mm.data(), output.y_mm.data());
+    }
+
+    template <typename T>
+    void PolarTransform<T>::transform(const ScanDataPolar& polarScanData, std::vector<PointXY>& output)
+    {
+        const std::vector<PointPolar>& points = polarScanData.getPoints();
+        std::size_t pointCount = points.size();
+
+        ranges_mm.resize(pointCount);
+        angles_deg.resize(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = static_cast<T>(points[i].getRange_mm());
+            angles_deg[i] = static_cast<T>(points[i].getAngle_deg());
+        }
+
+        const Layout& layout = findLayout(pointCount, angles_deg.data());
+
+        output.clear();
+        output.reserve(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            output.push_back(PointXY(ranges_mm[i] * layout.cosines[i], ranges_mm[i] * layout.sines[i], points[i].getIntensity()));
+        }
+    }
+
+    template <typename T>
+    std::shared_ptr<const typename PolarTransform<T>::Columns> PolarTransform<T>::transform(const ScanDataPolar& polarScanData)
+    {
+        std::unique_ptr<Columns> columns = takePooledColumns();
+        transform(polarScanData, *columns);
+
+        return sharePooledColumns(std::move(columns));
+    }
+
+    template <typename T>
+    std::shared_ptr<const typename PolarTransform<T>::Columns> PolarTransform<T>::transform(const CompactScanData& compactScanData)
+    {
+        std::unique_ptr<Columns> columns = takePooledColumns();
+        transform(compactScanData, *columns);
+
+        return sharePooledColumns(std::move(columns));
+    }
+
+    template <typename T>
+    std::unique_ptr<typename PolarTransform<T>::Columns> PolarTransform<T>::takePooledColumns()
+    {
+        std::unique_ptr<Columns> columns;
+
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+
+            if (!pool->buffers.empty())
+            {
+                columns = std::move(pool->buffers.back());
+                pool->buffers.pop_back();
+            }
+        }
+
+        if (!columns)
+        {
+            columns.reset(new Columns());
+        }
+
+        return columns;
+    }
+
+    template <typename T>
+    std::shared_ptr<const typename PolarTransform<T>::Columns> PolarTransform<T>::sharePooledColumns(std::unique_ptr<Columns> columns)
+    {
+        // The Columns may be released on another thread, and after this transform is gone
+        std::weak_ptr<Pool> weakPool = pool;
+
+        return std::shared_ptr<const Columns>(columns.release(), [weakPool](const Columns* released)
+        {
+            std::unique_ptr<Columns> buffer(const_cast<Columns*>(released));
+            std::shared_ptr<Pool> pool = weakPool.lock();
+
+            if (pool)
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+
+                if (pool->buffers.size() < pool->maximumBufferCount)
+                {
+                    pool->buffers.push_back(std::move(buffer));
+                }
+            }
+        });
+    }
+
+    template <typename T>
+    std::uint64_t PolarTransform<T>::getLayoutBuildCount() const
+    {
+        return layoutBuildCount;
+    }
+
+    template <typename T>
+    void PolarTransform<T>::clearLayouts()
+    {
+        layouts.clear();
+    }
+
+    template class PolarTransform<float>;
+    template class PolarTransform<double>;
+}
+}
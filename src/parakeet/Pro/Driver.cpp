@@ -3,6 +3,8 @@
 */
 
 #include <parakeet/Pro/Driver.h>
+#include <parakeet/Pro/internal/BaudRateDetector.h>
+#include <parakeet/Pro/internal/Protocol.h>
 
 #include <parakeet/exceptions/UnableToDetermineBaudRateException.h>
 #include <parakeet/exceptions/UnableToOpenPortException.h>
@@ -15,12 +17,6 @@ namespace parakeet
 {
 namespace Pro
 {
-    struct Driver::MessageData
-    {
-        int len;
-        unsigned char body[SERIAL_MESSAGE_DATA_BUFFER_SIZE];
-    };
-
     const std::string CW_STOP_ROTATING = "LSTOPH";
     const std::string CW_START_NORMALLY = "LSTARH";
     const std::string CW_STOP_ROTATING_FIX_DIST = "LMEASH";
@@ -35,32 +31,19 @@ namespace Pro
     const std::string SW_START_WITH_INTENSITY = "LOCONH";
     const std::string SW_START_WITHOUT_INTENSITY = "LNCONH";
 
-    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
-    const std::string SW_SET_SPEED_POSTFIX = "H";
-
-    const std::string SW_SET_BIAS_PREFIX = "LSERR:";
-    const std::string SW_SET_BIAS_POSTFIX = "H";
-
-    const std::string SW_SET_BAUD_RATE_PREFIX = "LSBPS:";
-    const std::string SW_SET_BAUD_RATE_POSTFIX = "H";
+    const std::chrono::milliseconds START_TIMEOUT(1000);
+    const std::chrono::milliseconds SETTING_TIMEOUT(250);
+    const std::chrono::milliseconds READ_ERROR_BACKOFF(10);
     
-    const std::string SW_SET_SPEED(int speed)
+    Driver::Driver() : parser(std::bind(&Driver::onScanDataReceived, this, std::placeholders::_1),
+        std::bind(&Driver::onResponseMessageReceived, this, std::placeholders::_1),
+        std::bind(&Driver::onChecksumFailure, this))
     {
-        return SW_SET_SPEED_PREFIX + std::to_string(speed) + SW_SET_SPEED_POSTFIX;
-    }
+        for (std::atomic<bool>& messageState : sensorReturnMessageState)
+        {
+            messageState = false;
+        }
 
-    const std::string SW_SET_BAUD_RATE(int baudRate)
-    {
-        return SW_SET_BAUD_RATE_PREFIX + std::to_string(baudRate) + SW_SET_BAUD_RATE_POSTFIX;
-    }
-    
-    const std::string SW_SET_BIAS(int bias)
-    {
-        return SW_SET_BIAS_PREFIX + std::to_string(bias) + SW_SET_BIAS_POSTFIX;
-    }
-    
-    Driver::Driver()
-    {
         this->registerUpdateThreadCallback(std::bind(&Driver::serialUpdateThreadFunction, this));
     }
 
@@ -85,6 +68,8 @@ namespace Pro
     {
         if (serialPort.open(sensorConfiguration.comPort.c_str(), sensorConfiguration.baudRate))
         {
+            invalidateAcknowledgedSettings();
+
             serialPort.write(CW_STOP_ROTATING);
         }
         else
@@ -95,45 +80,126 @@ namespace Pro
 
     void Driver::autoFindBaudRate()
     {
-        // Loop through all accepted baud rates
-        for (BaudRate baudRate : BaudRates::All)
+        BaudRate detectedBaudRate = BaudRates::Auto;
+
+        if (!internal::BaudRateDetector(serialPort).detect(sensorConfiguration.comPort, BaudRates::All, detectedBaudRate))
         {
-            //Attempt connecting to the port
-            this->sensorConfiguration.baudRate = baudRate;
-            
-            open();
+            throw exceptions::UnableToDetermineBaudRateException();
+        }
 
-            //start parsing data from the sensor
-            isAutoConnecting = true;
-            start();
+        this->sensorConfiguration.baudRate = detectedBaudRate;
+    }
 
-            bool state = sendMessageWaitForResponseOrTimeout(internal::SensorResponse::STOP, CW_STOP_ROTATING, std::chrono::milliseconds(500));
+    void Driver::start()
+    {
+        auto startupBeginTime = std::chrono::steady_clock::now();
 
-            stop();
-            close();
-            isAutoConnecting = false;
+        serialPortDataBufferLength = 0;
 
-            if(state)
-            {
-                return;
-            }
-        }
+        mechaspin::parakeet::Driver::start();
+
+        sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::START, CW_START_NORMALLY, START_TIMEOUT);
 
-        throw exceptions::UnableToDetermineBaudRateException();
+        applySensorConfiguration();
+
+        setStartupDuration(std::chrono::steady_clock::now() - startupBeginTime);
     }
 
-    void Driver::start()
+    bool Driver::reconnect(bool warmRestart)
     {
+        serialPortMutex.lock();
+
+        serialPort.close();
+        bool opened = serialPort.open(sensorConfiguration.comPort.c_str(), sensorConfiguration.baudRate);
         serialPortDataBufferLength = 0;
 
-        mechaspin::parakeet::Driver::start();
+        serialPortMutex.unlock();
+
+        if (!opened)
+        {
+            return false;
+        }
+
+        if (!warmRestart)
+        {
+            invalidateAcknowledgedSettings();
+        }
+
+        if (!sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::START, CW_START_NORMALLY, START_TIMEOUT))
+        {
+            return false;
+        }
+
+        applySensorConfiguration();
+
+        return true;
+    }
+
+    void Driver::applySensorConfiguration()
+    {
+        std::vector<PendingMessage> pendingMessages;
+
+        if (!acknowledgedIntensity.matches(sensorConfiguration.intensity))
+        {
+            pendingMessages.push_back({ mechaspin::parakeet::internal::SensorResponse::INTENSITY, sensorConfiguration.intensity ? SW_START_WITH_INTENSITY : SW_START_WITHOUT_INTENSITY });
+        }
+
+        if (!acknowledgedDataSmoothing.matches(sensorConfiguration.dataSmoothing))
+        {
+            pendingMessages.push_back({ mechaspin::parakeet::internal::SensorResponse::DATASMOOTHING, sensorConfiguration.dataSmoothing ? CW_ENABLE_DATA_SMOOTHING : CW_DISABLE_DATA_SMOOTHING });
+        }
+
+        if (!acknowledgedDragPointRemoval.matches(sensorConfiguration.dragPointRemoval))
+        {
+            pendingMessages.push_back({ mechaspin::parakeet::internal::SensorResponse::DRAGPOINTREMOVAL, sensorConfiguration.dragPointRemoval ? CW_ENABLE_DRAG_POINT_REMOVAL : CW_DISABLE_DRAG_POINT_REMOVAL });
+        }
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::START, CW_START_NORMALLY, std::chrono::milliseconds(1000));
+        if (!acknowledgedScanningFrequency.matches(sensorConfiguration.scanningFrequency_Hz))
+        {
+            pendingMessages.push_back({ mechaspin::parakeet::internal::SensorResponse::SPEED, internal::SW_SET_SPEED(sensorConfiguration.scanningFrequency_Hz * 60) });
+        }
+
+        if (pendingMessages.empty())
+        {
+            return;
+        }
 
-        enableIntensityData(sensorConfiguration.intensity);
-        enableDataSmoothing(sensorConfiguration.dataSmoothing);
-        enableRemoveDragPoint(sensorConfiguration.dragPointRemoval);
-        setScanningFrequency_Hz(sensorConfiguration.scanningFrequency_Hz);
+        // Every setting has its own response, so all of them can be in flight at once
+        sendMessagesWaitForResponsesOrTimeout(pendingMessages, SETTING_TIMEOUT);
+
+        for (const PendingMessage& pendingMessage : pendingMessages)
+        {
+            if (!sensorReturnMessageState[pendingMessage.messageType])
+            {
+                continue;
+            }
+
+            switch (pendingMessage.messageType)
+            {
+            case mechaspin::parakeet::internal::SensorResponse::INTENSITY:
+                acknowledgedIntensity.acknowledge(sensorConfiguration.intensity);
+                break;
+            case mechaspin::parakeet::internal::SensorResponse::DATASMOOTHING:
+                acknowledgedDataSmoothing.acknowledge(sensorConfiguration.dataSmoothing);
+                break;
+            case mechaspin::parakeet::internal::SensorResponse::DRAGPOINTREMOVAL:
+                acknowledgedDragPointRemoval.acknowledge(sensorConfiguration.dragPointRemoval);
+                break;
+            case mechaspin::parakeet::internal::SensorResponse::SPEED:
+                acknowledgedScanningFrequency.acknowledge(sensorConfiguration.scanningFrequency_Hz);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    void Driver::invalidateAcknowledgedSettings()
+    {
+        acknowledgedIntensity.invalidate();
+        acknowledgedDataSmoothing.invalidate();
+        acknowledgedDragPointRemoval.invalidate();
+        acknowledgedScanningFrequency.invalidate();
     }
 
     void Driver::stop()
@@ -154,7 +220,10 @@ namespace Pro
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::DATASMOOTHING, enable ? CW_ENABLE_DATA_SMOOTHING : CW_DISABLE_DATA_SMOOTHING, std::chrono::milliseconds(250));
+        if (sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::DATASMOOTHING, enable ? CW_ENABLE_DATA_SMOOTHING : CW_DISABLE_DATA_SMOOTHING, SETTING_TIMEOUT))
+        {
+            acknowledgedDataSmoothing.acknowledge(enable);
+        }
 
         sensorConfiguration.dataSmoothing = enable;
     }
@@ -163,7 +232,10 @@ namespace Pro
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::DRAGPOINTREMOVAL, enable ? CW_ENABLE_DRAG_POINT_REMOVAL : CW_DISABLE_DRAG_POINT_REMOVAL, std::chrono::milliseconds(250));
+        if (sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::DRAGPOINTREMOVAL, enable ? CW_ENABLE_DRAG_POINT_REMOVAL : CW_DISABLE_DRAG_POINT_REMOVAL, SETTING_TIMEOUT))
+        {
+            acknowledgedDragPointRemoval.acknowledge(enable);
+        }
 
         sensorConfiguration.dragPointRemoval = enable;
     }
@@ -172,7 +244,10 @@ namespace Pro
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::INTENSITY, enable ? SW_START_WITH_INTENSITY : SW_START_WITHOUT_INTENSITY, std::chrono::milliseconds(250));
+        if (sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::INTENSITY, enable ? SW_START_WITH_INTENSITY : SW_START_WITHOUT_INTENSITY, SETTING_TIMEOUT))
+        {
+            acknowledgedIntensity.acknowledge(enable);
+        }
 
         sensorConfiguration.intensity = enable;
     }
@@ -181,7 +256,10 @@ namespace Pro
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::SPEED, SW_SET_SPEED(Hz * 60), std::chrono::milliseconds(250));
+        if (sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::SPEED, internal::SW_SET_SPEED(Hz * 60), SETTING_TIMEOUT))
+        {
+            acknowledgedScanningFrequency.acknowledge(Hz);
+        }
 
         sensorConfiguration.scanningFrequency_Hz = Hz;
     }
@@ -195,9 +273,9 @@ namespace Pro
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::STOP, CW_STOP_ROTATING, std::chrono::milliseconds(200));
+        sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::STOP, CW_STOP_ROTATING, std::chrono::milliseconds(200));
 
-        sendMessageWaitForResponseOrTimeout(internal::SensorResponse::BAUDRATE, SW_SET_BAUD_RATE(baudRate.getValue()), std::chrono::milliseconds(0));
+        sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::BAUDRATE, internal::SW_SET_BAUD_RATE(baudRate.getValue()), std::chrono::milliseconds(0));
 
         if(isRunning())
         {
@@ -213,6 +291,13 @@ namespace Pro
         }
 
         sensorConfiguration.baudRate = baudRate;
+
+        internal::BaudRateDetector::rememberBaudRate(sensorConfiguration.comPort, baudRate);
+    }
+
+    std::uint64_t Driver::getChecksumFailureCount()
+    {
+        return checksumFailureCount;
     }
 
     bool Driver::isDataSmoothingEnabled()
@@ -245,6 +330,8 @@ namespace Pro
 
     void Driver::serialUpdateThreadFunction()
     {
+        std::lock_guard<std::mutex> lock(serialPortMutex);
+
         // modifying the baud rate of serial port can cause the connected state to be off for a brief moment
         if (!serialPort.isConnected())
         {
@@ -253,11 +340,21 @@ namespace Pro
 
         int charsRead = serialPort.read(serialPortDataBuffer, serialPortDataBufferLength, SERIAL_MESSAGE_DATA_BUFFER_SIZE);
 
+        if (serialPort.hasReadError())
+        {
+            onLinkError();
+
+            std::this_thread::sleep_for(READ_ERROR_BACKOFF);
+            return;
+        }
+
         if (charsRead == 0)
         {
             return;
         }
 
+        captureRawData(serialPortDataBuffer + serialPortDataBufferLength, charsRead, std::chrono::system_clock::now(), false);
+
         serialPortDataBufferLength += charsRead;
 
         unsigned int bytesParsed = parseSensorDataFromBuffer(serialPortDataBufferLength, serialPortDataBuffer);
@@ -269,176 +366,28 @@ namespace Pro
         serialPortDataBufferLength -= bytesParsed;
     }
 
-    void Driver::onMessageDataReceived(MessageData* message)
+    void Driver::onResponseMessageReceived(const std::string& message)
     {
-        std::string messageAsString(reinterpret_cast<char*>(message->body), message->len);
-
-        internal::SensorResponse sensorResponse = sensorResponseParser.getSensorResponseFromMessage(messageAsString);
-
-        if(sensorResponse.getMessageType() != internal::SensorResponse::NA)
+        // Pipelined commands can have several responses arrive in the same message
+        for(const mechaspin::parakeet::internal::SensorResponse& sensorResponse : sensorResponseParser.getSensorResponsesFromMessage(message))
         {
             sensorReturnMessageState[sensorResponse.getMessageType()] = true;
         }
+    }
 
-        delete message;
+    void Driver::onChecksumFailure()
+    {
+        checksumFailureCount++;
     }
 
     int Driver::parseSensorDataFromBuffer(int length, unsigned char* buf)
     {
-        int idx = 0, found = 0;
-        while (idx + 8 < length)
-        {
-            if (buf[idx] == 'S' && buf[idx + 1] == 'T' && buf[idx + 6] == 'E' && buf[idx + 7] == 'D')
-            {
-                idx += 8;
-            }
-            if (buf[idx] == 0xce && buf[idx + 1] == 0xfa)
-            {
-                found = 1;
-                break;
-            }
-            idx++;
-        }
-
-        if (idx > 0)// && found == 0)
-        {
-            MessageData* cmd = new MessageData;
-            if (found)
-            {
-                cmd->len = idx;
-            }
-            else
-            {
-                cmd->len = length;
-            }
-            memcpy(cmd->body, buf, cmd->len);
-
-            onMessageDataReceived(cmd);
-        }
-
-        while (found)
-        {
-            unsigned short start, cnt;
-
-            memcpy(&cnt, buf + idx + 2, 2);
-            memcpy(&start, buf + idx + 4, 2);
-
-            if (!sensorConfiguration.intensity)
-            {
-                //2 Byte
-                if (idx + 8 + cnt * 2 > length)
-                {
-                    break;
-                }
-
-                ScanData data;
-                data.startAngle_deg = start / 10.0;
-                data.endAngle_deg = data.startAngle_deg + 36;
-
-                data.count = cnt;
-
-                unsigned short sum = start + cnt;
-                unsigned char* pdata = buf + idx + 6;
-                for (int i = 0; i < cnt; i++)
-                {
-                    unsigned short lo_byte = pdata[i * 2];
-                    unsigned short hi_byte = pdata[i * 2 + 1];
-
-                    unsigned short val = (hi_byte << 8) + lo_byte;
-
-                    sum += val;
-
-                    if (sensorConfiguration.intensity)
-                    {
-                        data.dist_mm[i] = val & 0x1FFF;
-                        data.intensity[i] = val >> 13;
-                    }
-                    else
-                    {
-                        data.dist_mm[i] = val;
-                        data.intensity[i] = 0;
-                    }
-                }
-
-                unsigned short lo = pdata[cnt * 2];
-                unsigned short hi = pdata[cnt * 2+1];
-                unsigned short chk = lo | (hi << 8);
-                if (chk == sum)
-                {
-                    onScanDataReceived(data);
-                }
-                else if(!isAutoConnecting)
-                {
-                    printf("Checksum check failed\n");
-                }
-
-                idx += 8 + cnt * 2;
-            }
-            else
-            {
-                //3 Byte
-                if (idx + 8 + cnt * 3 > length)
-                {
-                    break;
-                }
-
-                ScanData data;
-                data.startAngle_deg = start / 10.0;
-                data.endAngle_deg = data.startAngle_deg + 36;
-
-                data.count = cnt;
-
-                unsigned short sum = start + cnt;
-                unsigned char* pdata = buf + idx + 6;
-                for (int i = 0; i < cnt; i++)
-                {
-                    data.intensity[i] = pdata[i * 3];
-
-                    sum += pdata[i * 3];
-
-                    unsigned short lo_byte = pdata[i * 3 + 1];
-                    unsigned short hi_byte = pdata[i * 3 + 2];
-
-                    unsigned short val = (hi_byte << 8) + lo_byte;
-
-                    sum += val;
-
-                    data.dist_mm[i] = val;
-                }
-
-                idx += 8 + cnt * 3;
+        parser.setIntensityDataEnabled(sensorConfiguration.intensity);
 
-                unsigned short lo = pdata[cnt * 3];
-                unsigned short hi = pdata[cnt * 3+1];
-                if (((hi<<8) | lo) == sum)
-                {
-                    onScanDataReceived(data);
-                }
-                else if(!isAutoConnecting)
-                {
-                    printf("Checksum check failed\n");
-                }
-            }
-
-            if (idx + 8 > length)
-            {
-                break;
-            }
-
-            if (buf[idx] == 0xce && buf[idx + 1] == 0xfa)
-            {
-                found = 1;
-            }
-            else
-            {
-                found = 0;
-            }
-        }
-
-        return idx;
+        return parser.parse(mechaspin::parakeet::internal::BufferData(buf, length));
     }
 
-    bool Driver::sendMessageWaitForResponseOrTimeout(internal::SensorResponse::MessageType messageType, const std::string& message, std::chrono::milliseconds timeout)
+    bool Driver::sendMessageWaitForResponseOrTimeout(mechaspin::parakeet::internal::SensorResponse::MessageType messageType, const std::string& message, std::chrono::milliseconds timeout)
     {
         auto startTime = std::chrono::system_clock::now();
 
@@ -462,10 +411,63 @@ namespace Pro
         return sensorReturnMessageState[messageType];
     }
 
+    bool Driver::sendMessagesWaitForResponsesOrTimeout(const std::vector<PendingMessage>& messages, std::chrono::milliseconds timeout)
+    {
+        auto startTime = std::chrono::system_clock::now();
+
+        for (const PendingMessage& pendingMessage : messages)
+        {
+            sensorReturnMessageState[pendingMessage.messageType] = false;
+        }
+
+        for (const PendingMessage& pendingMessage : messages)
+        {
+            serialPort.write(pendingMessage.message);
+        }
+
+        int msCount = 0;
+        bool allMessagesAcknowledged = false;
+        while (!allMessagesAcknowledged
+            && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime).count() < timeout.count())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            msCount++;
+
+            allMessagesAcknowledged = true;
+            for (const PendingMessage& pendingMessage : messages)
+            {
+                if (sensorReturnMessageState[pendingMessage.messageType])
+                {
+                    continue;
+                }
+
+                allMessagesAcknowledged = false;
+
+                // Only resend the commands which have gone unanswered, the rest are already applied
+                if (msCount % 10 == 0)
+                {
+                    serialPort.write(pendingMessage.message);
+                }
+            }
+        }
+
+        return allMessagesAcknowledged;
+    }
+
     bool Driver::isConnected()
     {
         return serialPort.isConnected();
     }
+
+    CaptureRecorder::StreamInfo Driver::getCaptureStreamInfo()
+    {
+        CaptureRecorder::StreamInfo streamInfo;
+        streamInfo.streamType = CaptureRecorder::SerialByteStream;
+        streamInfo.sourceAddress = sensorConfiguration.comPort;
+        streamInfo.description = "Pro";
+
+        return streamInfo;
+    }
 }
 }
 }
\ No newline at end of file
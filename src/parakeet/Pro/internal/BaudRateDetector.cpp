@@ -0,0 +1,226 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/Pro/internal/BaudRateDetector.h>
+
+#include <parakeet/Pro/internal/Parser.h>
+#include <parakeet/exceptions/UnableToOpenPortException.h>
+#include <parakeet/internal/SensorResponseParser.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+    const std::string CW_STOP_ROTATING = "LSTOPH";
+
+    const std::chrono::milliseconds PASSIVE_LISTEN_WINDOW(40);
+    const std::chrono::milliseconds CONFIRMATION_TIMEOUT(150);
+
+    const int DETECTION_BUFFER_SIZE = 8192;
+
+    const int VALID_SECTOR_SCORE = 4;
+    const int RESPONSE_MESSAGE_SCORE = 8;
+    const int CHECKSUM_FAILURE_SCORE = -1;
+
+    static std::mutex rememberedBaudRatesMutex;
+    static std::map<std::string, int> rememberedBaudRates;
+
+    BaudRateDetector::BaudRateDetector(SerialPort& serialPort) : serialPort(serialPort)
+    {
+    }
+
+    void BaudRateDetector::rememberBaudRate(const std::string& comPort, const BaudRate& baudRate)
+    {
+        std::lock_guard<std::mutex> lock(rememberedBaudRatesMutex);
+
+        rememberedBaudRates[comPort] = baudRate.getValue();
+    }
+
+    bool BaudRateDetector::findRememberedBaudRate(const std::string& comPort, BaudRate& baudRate)
+    {
+        std::lock_guard<std::mutex> lock(rememberedBaudRatesMutex);
+
+        auto rememberedBaudRate = rememberedBaudRates.find(comPort);
+        if (rememberedBaudRate == rememberedBaudRates.end())
+        {
+            return false;
+        }
+
+        baudRate = BaudRate(rememberedBaudRate->second);
+        return true;
+    }
+
+    bool BaudRateDetector::detect(const std::string& comPort, const std::vector<BaudRate>& candidates, BaudRate& detectedBaudRate)
+    {
+        bool portOpened = false;
+
+        // A device which was connected before is most likely still at the same baud rate, ie: after a USB hiccup
+        BaudRate rememberedBaudRate = BaudRates::Auto;
+        bool hasRememberedBaudRate = findRememberedBaudRate(comPort, rememberedBaudRate);
+
+        if (hasRememberedBaudRate && open(comPort, rememberedBaudRate))
+        {
+            portOpened = true;
+
+            bool confirmed = confirm(CONFIRMATION_TIMEOUT);
+            serialPort.close();
+
+            if (confirmed)
+            {
+                detectedBaudRate = rememberedBaudRate;
+                return true;
+            }
+        }
+
+        // Listen to whatever the sensor is already sending at each baud rate, without disturbing it
+        std::vector<Candidate> rankedCandidates;
+        for (const BaudRate& baudRate : candidates)
+        {
+            if (hasRememberedBaudRate && baudRate == rememberedBaudRate)
+            {
+                continue;
+            }
+
+            if (!open(comPort, baudRate))
+            {
+                continue;
+            }
+
+            portOpened = true;
+
+            rankedCandidates.push_back({ baudRate, listen(PASSIVE_LISTEN_WINDOW) });
+            serialPort.close();
+        }
+
+        if (!portOpened)
+        {
+            throw exceptions::UnableToOpenPortException();
+        }
+
+        // Equal scores keep the order of the candidates, so officially supported baud rates are confirmed first
+        std::stable_sort(rankedCandidates.begin(), rankedCandidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            return a.score > b.score;
+        });
+
+        for (const Candidate& candidate : rankedCandidates)
+        {
+            if (!open(comPort, candidate.baudRate))
+            {
+                continue;
+            }
+
+            bool confirmed = confirm(CONFIRMATION_TIMEOUT);
+            serialPort.close();
+
+            if (confirmed)
+            {
+                rememberBaudRate(comPort, candidate.baudRate);
+
+                detectedBaudRate = candidate.baudRate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool BaudRateDetector::open(const std::string& comPort, const BaudRate& baudRate)
+    {
+        return serialPort.open(comPort.c_str(), baudRate);
+    }
+
+    int BaudRateDetector::listen(std::chrono::milliseconds window)
+    {
+        unsigned char buffer[DETECTION_BUFFER_SIZE];
+        int bufferLength = 0;
+
+        auto startTime = std::chrono::steady_clock::now();
+        while (bufferLength < DETECTION_BUFFER_SIZE && std::chrono::steady_clock::now() - startTime < window)
+        {
+            bufferLength += serialPort.read(buffer, bufferLength, DETECTION_BUFFER_SIZE);
+        }
+
+        mechaspin::parakeet::internal::SensorResponseParser sensorResponseParser;
+
+        // The intensity setting of the sensor is unknown, so score the capture against both sector layouts
+        int bestScore = 0;
+        for (bool intensityDataEnabled : { false, true })
+        {
+            int responseMessageCount = 0;
+
+            MessageParser parser(nullptr, [&](const std::string& message)
+            {
+                responseMessageCount += static_cast<int>(sensorResponseParser.getSensorResponsesFromMessage(message).size());
+            });
+            parser.setIntensityDataEnabled(intensityDataEnabled);
+            parser.parse(mechaspin::parakeet::internal::BufferData(buffer, bufferLength));
+
+            int score = parser.getValidSectorCount() * VALID_SECTOR_SCORE
+                + parser.getChecksumFailureCount() * CHECKSUM_FAILURE_SCORE
+                + responseMessageCount * RESPONSE_MESSAGE_SCORE;
+
+            bestScore = std::max(bestScore, score);
+        }
+
+        return bestScore;
+    }
+
+    bool BaudRateDetector::confirm(std::chrono::milliseconds timeout)
+    {
+        unsigned char buffer[DETECTION_BUFFER_SIZE];
+        int bufferLength = 0;
+
+        bool stopAcknowledged = false;
+        mechaspin::parakeet::internal::SensorResponseParser sensorResponseParser;
+
+        MessageParser parser(nullptr, [&](const std::string& message)
+        {
+            for (const mechaspin::parakeet::internal::SensorResponse& response : sensorResponseParser.getSensorResponsesFromMessage(message))
+            {
+                stopAcknowledged |= response.getMessageType() == mechaspin::parakeet::internal::SensorResponse::STOP;
+            }
+        });
+
+        serialPort.write(CW_STOP_ROTATING);
+
+        auto startTime = std::chrono::steady_clock::now();
+        while (!stopAcknowledged && std::chrono::steady_clock::now() - startTime < timeout)
+        {
+            int charsRead = serialPort.read(buffer, bufferLength, DETECTION_BUFFER_SIZE);
+
+            if (charsRead == 0)
+            {
+                serialPort.write(CW_STOP_ROTATING);
+                continue;
+            }
+
+            bufferLength += charsRead;
+
+            int bytesParsed = parser.parse(mechaspin::parakeet::internal::BufferData(buffer, bufferLength));
+
+            memmove(buffer, buffer + bytesParsed, bufferLength - bytesParsed);
+            bufferLength -= bytesParsed;
+
+            if (bufferLength == DETECTION_BUFFER_SIZE)
+            {
+                bufferLength = 0;
+            }
+        }
+
+        return stopAcknowledged;
+    }
+}
+}
+}
+}
@@ -0,0 +1,195 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/Pro/internal/Parser.h>
+#include <parakeet/Pro/internal/Protocol.h>
+
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+    MessageParser::MessageParser(std::function<void(const mechaspin::parakeet::internal::ScanData&)> onScanDataCallback,
+        std::function<void(const std::string&)> onResponseMessageCallback,
+        std::function<void()> onChecksumFailureCallback) :
+        onScanDataCallback(onScanDataCallback),
+        onResponseMessageCallback(onResponseMessageCallback),
+        onChecksumFailureCallback(onChecksumFailureCallback),
+        clock(std::chrono::system_clock::now)
+    {
+    }
+
+    void MessageParser::setIntensityDataEnabled(bool enable)
+    {
+        intensityDataEnabled = enable;
+    }
+
+    int MessageParser::getValidSectorCount() const
+    {
+        return validSectorCount;
+    }
+
+    int MessageParser::getChecksumFailureCount() const
+    {
+        return checksumFailureCount;
+    }
+
+    void MessageParser::resetStatistics()
+    {
+        validSectorCount = 0;
+        checksumFailureCount = 0;
+    }
+
+    void MessageParser::setClock(std::function<std::chrono::system_clock::time_point()> clock)
+    {
+        this->clock = clock;
+    }
+
+    int MessageParser::parse(const mechaspin::parakeet::internal::BufferData& bufferData)
+    {
+        const unsigned char* buf = bufferData.buffer;
+        int length = static_cast<int>(bufferData.length);
+
+        int idx = 0, found = 0;
+        while (idx + SECTOR_OVERHEAD_SIZE < length)
+        {
+            if (buf[idx] == 'S' && buf[idx + 1] == 'T' && buf[idx + 6] == 'E' && buf[idx + 7] == 'D')
+            {
+                idx += 8;
+                continue;
+            }
+            if (buf[idx] == SECTOR_SYNC_FIRST_BYTE && buf[idx + 1] == SECTOR_SYNC_SECOND_BYTE)
+            {
+                found = 1;
+                break;
+            }
+            idx++;
+        }
+
+        if (idx > 0 && onResponseMessageCallback)
+        {
+            onResponseMessageCallback(std::string(reinterpret_cast<const char*>(buf), found ? idx : length));
+        }
+
+        while (found)
+        {
+            int sectorEnd = parseSector(buf, idx, length);
+
+            if (sectorEnd < 0)
+            {
+                break;
+            }
+
+            idx = sectorEnd;
+
+            if (idx + SECTOR_OVERHEAD_SIZE > length)
+            {
+                break;
+            }
+
+            found = buf[idx] == SECTOR_SYNC_FIRST_BYTE && buf[idx + 1] == SECTOR_SYNC_SECOND_BYTE;
+        }
+
+        return idx;
+    }
+
+    int MessageParser::parseSector(const unsigned char* buf, int idx, int length)
+    {
+        unsigned short start, cnt;
+
+        memcpy(&cnt, buf + idx + 2, 2);
+        memcpy(&start, buf + idx + 4, 2);
+
+        // A sync pattern followed by an impossible point count is noise (ie: the wrong baud rate), not a sector
+        if (cnt > mechaspin::parakeet::internal::ScanData::MAX_NUMBER_OF_POINTS_FROM_SENSOR)
+        {
+            return idx + 2;
+        }
+
+        int bytesPerPoint = intensityDataEnabled ? BYTES_PER_POINT_WITH_INTENSITY : BYTES_PER_POINT_WITHOUT_INTENSITY;
+
+        if (idx + SECTOR_OVERHEAD_SIZE + cnt * bytesPerPoint > length)
+        {
+            return -1;
+        }
+
+        mechaspin::parakeet::internal::ScanData data(clock());
+        data.startAngle_deg = start / 10.0;
+        data.endAngle_deg = data.startAngle_deg + SECTOR_SIZE_DEG;
+
+        data.count = cnt;
+
+        unsigned short sum = start + cnt;
+        const unsigned char* pdata = buf + idx + SECTOR_HEADER_SIZE;
+
+        if (!intensityDataEnabled)
+        {
+            //2 Byte
+            for (int i = 0; i < cnt; i++)
+            {
+                unsigned short lo_byte = pdata[i * 2];
+                unsigned short hi_byte = pdata[i * 2 + 1];
+
+                unsigned short val = (hi_byte << 8) + lo_byte;
+
+                sum += val;
+
+                data.dist_mm[i] = val;
+                data.intensity[i] = 0;
+            }
+        }
+        else
+        {
+            //3 Byte
+            for (int i = 0; i < cnt; i++)
+            {
+                data.intensity[i] = pdata[i * 3];
+
+                sum += pdata[i * 3];
+
+                unsigned short lo_byte = pdata[i * 3 + 1];
+                unsigned short hi_byte = pdata[i * 3 + 2];
+
+                unsigned short val = (hi_byte << 8) + lo_byte;
+
+                sum += val;
+
+                data.dist_mm[i] = val;
+            }
+        }
+
+        unsigned short lo = pdata[cnt * bytesPerPoint];
+        unsigned short hi = pdata[cnt * bytesPerPoint + 1];
+        unsigned short chk = lo | (hi << 8);
+
+        if (chk == sum)
+        {
+            validSectorCount++;
+
+            if (onScanDataCallback)
+            {
+                onScanDataCallback(data);
+            }
+        }
+        else
+        {
+            checksumFailureCount++;
+
+            if (onChecksumFailureCallback)
+            {
+                onChecksumFailureCallback();
+            }
+        }
+
+        return idx + SECTOR_OVERHEAD_SIZE + cnt * bytesPerPoint;
+    }
+}
+}
+}
+}
@@ -0,0 +1,80 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/Pro/internal/Protocol.h>
+
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Pro
+{
+namespace internal
+{
+    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
+    const std::string SW_SET_SPEED_POSTFIX = "H";
+
+    const std::string SW_SET_BIAS_PREFIX = "LSERR:";
+    const std::string SW_SET_BIAS_POSTFIX = "H";
+
+    const std::string SW_SET_BAUD_RATE_PREFIX = "LSBPS:";
+    const std::string SW_SET_BAUD_RATE_POSTFIX = "H";
+
+    const std::string SW_SET_SPEED(int speed)
+    {
+        return SW_SET_SPEED_PREFIX + std::to_string(speed) + SW_SET_SPEED_POSTFIX;
+    }
+
+    const std::string SW_SET_BAUD_RATE(int baudRate)
+    {
+        return SW_SET_BAUD_RATE_PREFIX + std::to_string(baudRate) + SW_SET_BAUD_RATE_POSTFIX;
+    }
+
+    const std::string SW_SET_BIAS(int bias)
+    {
+        return SW_SET_BIAS_PREFIX + std::to_string(bias) + SW_SET_BIAS_POSTFIX;
+    }
+
+    int getSectorLength(unsigned short pointCount, bool intensity)
+    {
+        return SECTOR_OVERHEAD_SIZE + pointCount * (intensity ? BYTES_PER_POINT_WITH_INTENSITY : BYTES_PER_POINT_WITHOUT_INTENSITY);
+    }
+
+    int buildSector(unsigned short startAngle, unsigned short pointCount, const unsigned short* distances, const unsigned char* intensities, unsigned char* buffer)
+    {
+        buffer[0] = SECTOR_SYNC_FIRST_BYTE;
+        buffer[1] = SECTOR_SYNC_SECOND_BYTE;
+        memcpy(buffer + 2, &pointCount, 2);
+        memcpy(buffer + 4, &startAngle, 2);
+
+        unsigned short sum = startAngle + pointCount;
+        unsigned char* pdata = buffer + SECTOR_HEADER_SIZE;
+
+        for (int i = 0; i < pointCount; i++)
+        {
+            if (intensities != nullptr)
+            {
+                //3 Byte
+                pdata[0] = intensities[i];
+                sum += intensities[i];
+                pdata++;
+            }
+
+            pdata[0] = distances[i] & 0xff;
+            pdata[1] = distances[i] >> 8;
+            sum += distances[i];
+            pdata += 2;
+        }
+
+        pdata[0] = sum & 0xff;
+        pdata[1] = sum >> 8;
+
+        return static_cast<int>(pdata + SECTOR_CHECKSUM_SIZE - buffer);
+    }
+}
+}
+}
+}
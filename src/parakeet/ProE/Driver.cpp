@@ -3,6 +3,7 @@
 */
 
 #include <parakeet/ProE/Driver.h>
+#include <parakeet/ProE/internal/Protocol.h>
 
 #include <algorithm>
 
@@ -19,15 +20,11 @@ namespace ProE
     const int MESSAGE_TIMEOUT_MS = 2000;
     const int STOP_TIMEOUT_MS = 1000;
 
-    const int IP_ADDRESS_ARRAY_SIZE = 4;
-    const int SUBNET_MASK_ARRAY_SIZE = 4;
-    const int GATEWAY_ARRAY_SIZE = 4;
-    const int IP_ADDRESS_STRING_LENGTH = 3;
-    const int PORT_STRING_LENGTH = 5;
+    const int COMMAND_BUFFER_SIZE = 2048;
+
+    const std::chrono::milliseconds READ_ERROR_BACKOFF(10);
 
-    const unsigned short UDP_MESSAGE_SIGN = 0x484C;
-    const unsigned short UDP_MESSAGE_CMD = 0x0043;
-    const unsigned short UDP_MESSAGE_SET_PROPERTIES_CMD = 0x0053;
+    const int IP_ADDRESS_ARRAY_SIZE = 4;
 
     const std::string CW_STOP_ROTATING = "LSTOPH";
     const std::string CW_START_NORMALLY = "LSTARH";
@@ -43,182 +40,147 @@ namespace ProE
 
     const std::string CW_DATA_UNIT_ACQUISITION = "LSMMDH";
 
-    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
-    const std::string SW_SET_BIAS_PREFIX = "LSERR:";
-    const std::string SW_SET_SRC_IPV4_PROPERTIES_PREFIX = "LSUDP:";
-    const std::string SW_SET_DST_IPV4_PROPERTIES_PREFIX = "LSDST:";
-    const std::string SW_SET_OUTPUT_UNIT_OF_MEASURE_PREFIX = "LSMMU:";
-
-    const std::string SW_SET_DATA_SMOOTHING_PREFIX = "LSSS";
-    const std::string SW_SET_DRAG_POINT_REMOVAL_PREFIX = "LFFF";
-    const std::string SW_SET_SMOOTH_PREFIX = "LFFF";
-    const std::string SW_SET_RESAMPLE_FILTER_PREFIX = "LSRES:00";
-
-    const std::string SW_POSTFIX = "H";
-
-    const char SW_SET_LIDAR_PROPERTIES_DELIMITER = ' ';
-
-    const std::string SW_SET_SPEED(int speed)
-    {
-        return SW_SET_SPEED_PREFIX + std::to_string(speed) + SW_POSTFIX;
-    }
-
-    const std::string SW_SET_BIAS(int bias)
+    Driver::Driver() : parser(std::bind(&Driver::onCompleteLidarMessage, this, std::placeholders::_1))
     {
-        return SW_SET_BIAS_PREFIX + std::to_string(bias) + SW_POSTFIX;
-    }
+        parser.registerPartialSectorCallback(std::bind(&Driver::onPartialSector, this, std::placeholders::_1));
+        this->registerUpdateThreadCallback(std::bind(&Driver::ethernetUpdateThreadFunction, this));
 
-    const std::string SW_SET_DATA_SMOOTHING(bool enable)
-    {
-        return SW_SET_DATA_SMOOTHING_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+        bufferData.buffer = ethernetPortDataBuffer;
     }
 
-    const std::string SW_SET_DRAG_POINT_REMOVAL(bool enable)
+    Driver::~Driver()
     {
-        return SW_SET_DRAG_POINT_REMOVAL_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+        close();
     }
 
-    const std::string SW_SET_OUTPUT_UNIT_OF_MEASURE(bool mm)
+    void Driver::connect(const SensorConfiguration& sensorConfiguration)
     {
-        return SW_SET_OUTPUT_UNIT_OF_MEASURE_PREFIX + std::to_string((int)mm) + SW_POSTFIX;
-    }
+        this->sensorConfiguration = sensorConfiguration;
 
-    const std::string SW_SET_SMOOTH(bool enable)
-    {
-        return SW_SET_SMOOTH_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+        open();
     }
 
-    const std::string SW_SET_RESAMPLE_FILTER(bool enable)
+    void Driver::open()
     {
-        return SW_SET_RESAMPLE_FILTER_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
-    }
+        if (ethernetPort.open(sensorConfiguration.srcPort))
+        {
+            invalidateAcknowledgedSettings();
 
-    std::string numberToFixedSizeString(unsigned int value, int size)
-    {
-        unsigned int uvalue = value;
-        
-        std::string result;
-        while (size-- > 0)
+            sendMessageWaitForResponseOrTimeout(CW_STOP_ROTATING, STOP_TIMEOUT_MS);
+        }
+        else
         {
-            result += ('0' + uvalue % 10);
-            uvalue /= 10;
+            throw exceptions::UnableToOpenPortException();
         }
-
-        std::reverse(result.begin(), result.end());
-        return result;
     }
 
-    std::string unsignedCharArrayToString(const unsigned char* charArray, int size)
+    void Driver::close()
     {
-        std::string result;
-
-        for (int i = 0; i < size; i++)
-        {
-            result += numberToFixedSizeString(charArray[i], 3);
-
-            if (i != size - 1)
-            {
-                result += '.';
-            }
-        }
+        mechaspin::parakeet::Driver::close();
 
-        return result;
+        ethernetPort.close();
     }
 
-    const std::string SW_SET_SRC_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned char* subnetMask, const unsigned char* gateway, const unsigned short port)
+    void Driver::start()
     {
-        std::string result;
+        auto startupBeginTime = std::chrono::steady_clock::now();
+
+        bufferData.length = 0;
 
-        result += SW_SET_SRC_IPV4_PROPERTIES_PREFIX;
+        parser.reset();
 
-        result += unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
-        result += unsignedCharArrayToString(subnetMask, SUBNET_MASK_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
-        result += unsignedCharArrayToString(gateway, GATEWAY_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
-        result += numberToFixedSizeString(port, PORT_STRING_LENGTH);
+        applySensorConfiguration();
 
-        result += SW_POSTFIX;
+        if (!sendMessageWaitForResponseOrTimeout(CW_START_NORMALLY, START_TIMEOUT_MS))
+        {
+            throw exceptions::NoResponseFromSensorException();
+        }
 
-        return result;
+        mechaspin::parakeet::Driver::start();
+
+        setStartupDuration(std::chrono::steady_clock::now() - startupBeginTime);
     }
 
-    const std::string SW_SET_DST_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned short port)
+    bool Driver::reconnect(bool warmRestart)
     {
-        std::string result;
+        readWriteMutex.lock();
 
-        result += SW_SET_DST_IPV4_PROPERTIES_PREFIX;
+        ethernetPort.close();
+        bool opened = ethernetPort.open(sensorConfiguration.srcPort);
 
-        result += unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
-        result += numberToFixedSizeString(port, PORT_STRING_LENGTH);
+        // Any partial message buffered from before the link was lost will never be completed
+        parserResetRequested = true;
 
-        result += SW_POSTFIX;
+        readWriteMutex.unlock();
 
-        return result;
-    }
+        if (!opened)
+        {
+            return false;
+        }
 
-    struct CmdHeader
-    {
-        unsigned short sign;
-        unsigned short cmd;
-        unsigned short sn;
-        unsigned short len;
-    }; 
-    
-    Driver::Driver() : parser(std::bind(&Driver::onCompleteLidarMessage, this, std::placeholders::_1))
-    {
-        this->registerUpdateThreadCallback(std::bind(&Driver::ethernetUpdateThreadFunction, this));
+        if (!warmRestart)
+        {
+            invalidateAcknowledgedSettings();
+        }
 
-        bufferData.buffer = ethernetPortDataBuffer;
-    }
+        applySensorConfiguration();
 
-    Driver::~Driver()
-    {
-        close();
+        return sendMessageWaitForResponseOrTimeout(CW_START_NORMALLY, START_TIMEOUT_MS);
     }
 
-    void Driver::connect(const SensorConfiguration& sensorConfiguration)
+    void Driver::applySensorConfiguration()
     {
-        this->sensorConfiguration = sensorConfiguration;
+        assertIsConnected();
 
-        open();
-    }
+        std::vector<std::string> pendingMessages;
+        std::vector<std::function<void()>> onAcknowledged;
 
-    void Driver::open()
-    {
-        if (ethernetPort.open(sensorConfiguration.srcPort))
+        if (!acknowledgedDataSmoothing.matches(sensorConfiguration.dataSmoothing))
         {
-            sendMessageWaitForResponseOrTimeout(CW_STOP_ROTATING, STOP_TIMEOUT_MS);
+            pendingMessages.push_back(internal::SW_SET_DATA_SMOOTHING(sensorConfiguration.dataSmoothing));
+            onAcknowledged.push_back([&] { acknowledgedDataSmoothing.acknowledge(sensorConfiguration.dataSmoothing); });
         }
-        else
+
+        if (!acknowledgedDragPointRemoval.matches(sensorConfiguration.dragPointRemoval))
         {
-            throw exceptions::UnableToOpenPortException();
+            pendingMessages.push_back(internal::SW_SET_DRAG_POINT_REMOVAL(sensorConfiguration.dragPointRemoval));
+            onAcknowledged.push_back([&] { acknowledgedDragPointRemoval.acknowledge(sensorConfiguration.dragPointRemoval); });
         }
-    }
 
-    void Driver::close()
-    {
-        mechaspin::parakeet::Driver::close();
-
-        ethernetPort.close();
-    }
+        if (!acknowledgedScanningFrequency.matches(sensorConfiguration.scanningFrequency_Hz))
+        {
+            pendingMessages.push_back(internal::SW_SET_SPEED(sensorConfiguration.scanningFrequency_Hz * 60));
+            onAcknowledged.push_back([&] { acknowledgedScanningFrequency.acknowledge(sensorConfiguration.scanningFrequency_Hz); });
+        }
 
-    void Driver::start()
-    {
-        bufferData.length = 0;
+        if (!acknowledgedResampleFilter.matches(sensorConfiguration.resampleFilter))
+        {
+            pendingMessages.push_back(internal::SW_SET_RESAMPLE_FILTER(sensorConfiguration.resampleFilter));
+            onAcknowledged.push_back([&] { acknowledgedResampleFilter.acknowledge(sensorConfiguration.resampleFilter); });
+        }
 
-        parser.reset();
+        if (pendingMessages.empty())
+        {
+            return;
+        }
 
-        enableIntensityData(sensorConfiguration.intensity);
-        enableDataSmoothing(sensorConfiguration.dataSmoothing);
-        enableRemoveDragPoint(sensorConfiguration.dragPointRemoval);
-        setScanningFrequency_Hz(sensorConfiguration.scanningFrequency_Hz);
-        enableResampleFilter(sensorConfiguration.resampleFilter);
+        std::vector<bool> acknowledgements = sendMessagesWaitForResponsesOrTimeout(pendingMessages, MESSAGE_TIMEOUT_MS);
 
-        if (!sendMessageWaitForResponseOrTimeout(CW_START_NORMALLY, START_TIMEOUT_MS))
+        for (size_t i = 0; i < acknowledgements.size(); i++)
         {
-            throw exceptions::NoResponseFromSensorException();
+            if (acknowledgements[i])
+            {
+                onAcknowledged[i]();
+            }
         }
+    }
 
-        mechaspin::parakeet::Driver::start();
+    void Driver::invalidateAcknowledgedSettings()
+    {
+        acknowledgedDataSmoothing.invalidate();
+        acknowledgedDragPointRemoval.invalidate();
+        acknowledgedResampleFilter.invalidate();
+        acknowledgedScanningFrequency.invalidate();
     }
 
     void Driver::stop()
@@ -232,7 +194,10 @@ namespace ProE
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_DATA_SMOOTHING(enable), MESSAGE_TIMEOUT_MS);
+        if (sendMessageWaitForResponseOrTimeout(internal::SW_SET_DATA_SMOOTHING(enable), MESSAGE_TIMEOUT_MS))
+        {
+            acknowledgedDataSmoothing.acknowledge(enable);
+        }
 
         sensorConfiguration.dataSmoothing = enable;
     }
@@ -241,7 +206,10 @@ namespace ProE
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_DRAG_POINT_REMOVAL(enable), MESSAGE_TIMEOUT_MS);
+        if (sendMessageWaitForResponseOrTimeout(internal::SW_SET_DRAG_POINT_REMOVAL(enable), MESSAGE_TIMEOUT_MS))
+        {
+            acknowledgedDragPointRemoval.acknowledge(enable);
+        }
 
         sensorConfiguration.dragPointRemoval = enable;
     }
@@ -255,7 +223,10 @@ namespace ProE
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_RESAMPLE_FILTER(enable), MESSAGE_TIMEOUT_MS);
+        if (sendMessageWaitForResponseOrTimeout(internal::SW_SET_RESAMPLE_FILTER(enable), MESSAGE_TIMEOUT_MS))
+        {
+            acknowledgedResampleFilter.acknowledge(enable);
+        }
 
         sensorConfiguration.resampleFilter = enable;
     }
@@ -264,7 +235,10 @@ namespace ProE
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_SPEED(Hz * 60), MESSAGE_TIMEOUT_MS);
+        if (sendMessageWaitForResponseOrTimeout(internal::SW_SET_SPEED(Hz * 60), MESSAGE_TIMEOUT_MS))
+        {
+            acknowledgedScanningFrequency.acknowledge(Hz);
+        }
 
         sensorConfiguration.scanningFrequency_Hz = Hz;
     }
@@ -273,17 +247,17 @@ namespace ProE
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_SRC_IPV4_PROPERTIES(ipAddress, subnetMask, gateway, port), MESSAGE_TIMEOUT_MS, UDP_MESSAGE_SET_PROPERTIES_CMD);
+        sendMessageWaitForResponseOrTimeout(internal::SW_SET_SRC_IPV4_PROPERTIES(ipAddress, subnetMask, gateway, port), MESSAGE_TIMEOUT_MS, internal::UDP_MESSAGE_SET_PROPERTIES_CMD);
 
         sensorConfiguration.dstPort = port;
-        sensorConfiguration.ipAddress = unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE);
+        sensorConfiguration.ipAddress = internal::unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE);
     }
 
     void Driver::setSensorDestinationIPv4Settings(const std::uint8_t ipAddress[], const unsigned short port)
     {
         assertIsConnected();
 
-        sendMessageWaitForResponseOrTimeout(SW_SET_DST_IPV4_PROPERTIES(ipAddress, port), MESSAGE_TIMEOUT_MS, UDP_MESSAGE_SET_PROPERTIES_CMD);
+        sendMessageWaitForResponseOrTimeout(internal::SW_SET_DST_IPV4_PROPERTIES(ipAddress, port), MESSAGE_TIMEOUT_MS, internal::UDP_MESSAGE_SET_PROPERTIES_CMD);
 
         sensorConfiguration.srcPort = port;
     }
@@ -330,15 +304,36 @@ namespace ProE
 
         readWriteMutex.lock();
 
+        if (parserResetRequested)
+        {
+            bufferData.length = 0;
+            parser.reset();
+            parserResetRequested = false;
+        }
+
         int charsRead = ethernetPort.read(bufferData, ETHERNET_MESSAGE_DATA_BUFFER_SIZE);
 
+        bool readError = ethernetPort.hasReadError();
+        std::chrono::system_clock::time_point readTimestamp = ethernetPort.getLastReadTimestamp();
+        bool readTimestampFromKernel = ethernetPort.isLastReadTimestampFromKernel();
+
         readWriteMutex.unlock();
-        
+
+        if (readError)
+        {
+            onLinkError();
+
+            std::this_thread::sleep_for(READ_ERROR_BACKOFF);
+            return;
+        }
+
         if (charsRead == 0)
         {
             return;
         }
 
+        captureRawData(ethernetPortDataBuffer + bufferData.length, charsRead, readTimestamp, readTimestampFromKernel);
+
         bufferData.length += charsRead;
 
         unsigned int bytesParsed = parser.parse(bufferData);
@@ -355,6 +350,18 @@ namespace ProE
         return ethernetPort.isConnected();
     }
 
+    CaptureRecorder::StreamInfo Driver::getCaptureStreamInfo()
+    {
+        CaptureRecorder::StreamInfo streamInfo;
+        streamInfo.streamType = CaptureRecorder::UdpDatagrams;
+        streamInfo.sourceAddress = sensorConfiguration.ipAddress;
+        streamInfo.sourcePort = static_cast<unsigned short>(sensorConfiguration.dstPort);
+        streamInfo.destinationPort = static_cast<unsigned short>(sensorConfiguration.srcPort);
+        streamInfo.description = "ProE";
+
+        return streamInfo;
+    }
+
     void Driver::onCompleteLidarMessage(const internal::MessageParser::CompleteLidarMessage& lidarMessage)
     {
         ScanData scanData(lidarMessage.timestamp);
@@ -371,6 +378,27 @@ namespace ProE
         onScanDataReceived(scanData);
     }
 
+    void Driver::onPartialSector(const internal::MessageParser::PartialSector& partialSector)
+    {
+        int maximumPointCount = MAX_NUMBER_OF_POINTS_FROM_SENSOR;
+
+        ScanData scanData(partialSector.timestamp);
+        scanData.count = std::min<int>(partialSector.numPoints, maximumPointCount);
+
+        // The points keep the angles they will have in the complete sector
+        double anglePerPoint_deg = (static_cast<double>(partialSector.endAngle) - partialSector.startAngle) / partialSector.numPointsInSector;
+        scanData.startAngle_deg = partialSector.startAngle + (anglePerPoint_deg * partialSector.sectorDataOffset);
+        scanData.endAngle_deg = scanData.startAngle_deg + (anglePerPoint_deg * partialSector.numPoints);
+
+        for (int i = 0; i < scanData.count; i++)
+        {
+            scanData.dist_mm[i] = partialSector.lidarPoints[i].distance;
+            scanData.intensity[i] = partialSector.lidarPoints[i].intensity;
+        }
+
+        onPartialSectorReceived(scanData);
+    }
+
     bool Driver::sendMessageWaitForResponseOrTimeout(const std::string& message, int millisecondsTilTimeout, unsigned short cmd)
     {
         readWriteMutex.lock();
@@ -384,57 +412,131 @@ namespace ProE
 
     bool Driver::sendMessageWaitForResponseOrTimeout(const std::string& message, int millisecondsTilTimeout)
     {
-        return sendMessageWaitForResponseOrTimeout(message, millisecondsTilTimeout, UDP_MESSAGE_CMD);
+        return sendMessageWaitForResponseOrTimeout(message, millisecondsTilTimeout, internal::UDP_MESSAGE_CMD);
     }
 
     bool Driver::sendUdpMessageWaitForResponseOrTimeout(const std::string& message, const std::string& response, std::chrono::milliseconds timeout, unsigned short cmd)
     {
-        unsigned char buffer[2048] = { 0 };
-        CmdHeader* hdr = (CmdHeader*)buffer;
-        hdr->sign = UDP_MESSAGE_SIGN;
-        hdr->cmd = cmd;
-        hdr->sn = rand();
-
-        hdr->len = ((static_cast<short>(message.length()) + 3) >> 2) * 4;
+        unsigned char buffer[COMMAND_BUFFER_SIZE] = { 0 };
 
-        memcpy(buffer + sizeof(CmdHeader), message.c_str(), message.length());
-
-        unsigned int* pcrc = (unsigned int*)(buffer + sizeof(CmdHeader) + hdr->len);
-        pcrc[0] = calculateEndOfMessageCRC((unsigned int*)(buffer), hdr->len / 4 + 2);
+        unsigned int length = internal::buildCommandMessage(message, cmd, takeSequenceNumber(), buffer);
 
         return ethernetPort.sendMessageWaitForResponseOrTimeout(
             mechaspin::parakeet::internal::InetAddress(sensorConfiguration.ipAddress, sensorConfiguration.dstPort),
-            mechaspin::parakeet::internal::BufferData(buffer, sizeof(CmdHeader) + sizeof(pcrc[0]) + hdr->len),
+            mechaspin::parakeet::internal::BufferData(buffer, length),
             response, timeout);
     }
 
-    unsigned int Driver::calculateEndOfMessageCRC(unsigned int* ptr, unsigned int len)
+    std::vector<bool> Driver::sendMessagesWaitForResponsesOrTimeout(const std::vector<std::string>& messages, int millisecondsTilTimeout)
     {
-        unsigned int xbit, data;
-        unsigned int crc32 = 0xFFFFFFFF;
-        const unsigned int polynomial = 0x04c11db7;
+        std::vector<bool> acknowledgements(messages.size(), false);
+
+        if (!ethernetPort.isConnected())
+        {
+            return acknowledgements;
+        }
+
+        mechaspin::parakeet::internal::InetAddress destinationAddress(sensorConfiguration.ipAddress, sensorConfiguration.dstPort);
+
+        std::vector<std::vector<unsigned char>> commandBuffers;
+        std::vector<unsigned short> sequenceNumbers;
+
+        readWriteMutex.lock();
+
+        // Send every command up front, the sensor answers each one with its own "OK"
+        for (const std::string& message : messages)
+        {
+            std::vector<unsigned char> commandBuffer(COMMAND_BUFFER_SIZE, 0);
+            unsigned short sn = takeSequenceNumber();
+
+            commandBuffer.resize(internal::buildCommandMessage(message, internal::UDP_MESSAGE_CMD, sn, commandBuffer.data()));
+
+            ethernetPort.write(destinationAddress, mechaspin::parakeet::internal::BufferData(commandBuffer.data(), static_cast<unsigned int>(commandBuffer.size())));
+
+            commandBuffers.push_back(commandBuffer);
+            sequenceNumbers.push_back(sn);
+        }
+
+        auto startTime = std::chrono::system_clock::now();
+        long long secondsPast = 0;
+        size_t numUnacknowledged = messages.size();
 
-        for (unsigned int i = 0; i < len; i++)
+        while (numUnacknowledged > 0
+            && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime).count() < millisecondsTilTimeout)
         {
-            xbit = 1 << 31;
-            data = ptr[i];
-            for (unsigned int bits = 0; bits < 32; bits++)
+            auto totalSecondsPast = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - startTime).count();
+            if (totalSecondsPast != secondsPast)
             {
-                if (crc32 & 0x80000000)
+                secondsPast = totalSecondsPast;
+
+                for (size_t i = 0; i < commandBuffers.size(); i++)
                 {
-                    crc32 <<= 1;
-                    crc32 ^= polynomial;
+                    if (!acknowledgements[i])
+                    {
+                        ethernetPort.write(destinationAddress, mechaspin::parakeet::internal::BufferData(commandBuffers[i].data(), static_cast<unsigned int>(commandBuffers[i].size())));
+                    }
                 }
-                else
-                    crc32 <<= 1;
+            }
 
-                if (data & xbit)
-                    crc32 ^= polynomial;
+            unsigned char buffer[COMMAND_BUFFER_SIZE];
+            int charsRead = ethernetPort.read(mechaspin::parakeet::internal::BufferData(buffer, 0), COMMAND_BUFFER_SIZE);
+
+            if (charsRead != 0 && std::string((char*)buffer, charsRead).rfind("OK") != std::string::npos)
+            {
+                // Match the response to its command through the echoed sequence number. A retransmitted command can be answered
+                // more than once, so a reply for a command already acknowledged, or for none of them, is ignored. Only a reply
+                // without a header is taken to answer the commands in the order they were sent.
+                size_t acknowledgedIndex = messages.size();
+
+                internal::CmdHeader responseHeader;
+                bool hasHeader = false;
+                if (charsRead >= static_cast<int>(sizeof(internal::CmdHeader)))
+                {
+                    memcpy(&responseHeader, buffer, sizeof(internal::CmdHeader));
+                    hasHeader = responseHeader.sign == internal::UDP_MESSAGE_SIGN;
+                }
+
+                if (hasHeader)
+                {
+                    for (size_t i = 0; i < sequenceNumbers.size(); i++)
+                    {
+                        if (sequenceNumbers[i] == responseHeader.sn)
+                        {
+                            acknowledgedIndex = acknowledgements[i] ? messages.size() : i;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < acknowledgements.size(); i++)
+                    {
+                        if (!acknowledgements[i])
+                        {
+                            acknowledgedIndex = i;
+                            break;
+                        }
+                    }
+                }
 
-                xbit >>= 1;
+                if (acknowledgedIndex != messages.size())
+                {
+                    acknowledgements[acknowledgedIndex] = true;
+                    numUnacknowledged--;
+                }
             }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        return crc32;
+
+        readWriteMutex.unlock();
+
+        return acknowledgements;
+    }
+
+    unsigned short Driver::takeSequenceNumber()
+    {
+        return nextSequenceNumber++;
     }
 }
 }
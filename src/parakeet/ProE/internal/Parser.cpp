@@ -3,6 +3,7 @@
 */
 
 #include <parakeet/ProE/internal/Parser.h>
+#include <parakeet/ProE/internal/Protocol.h>
 
 #include <cstring>
 #include <cstdint>
@@ -22,31 +23,21 @@ namespace internal
     const uint32_t FIRST_TIMESTAMP_NULL_VALUE = -1;
     const uint32_t TIMESTAMP_RESET_VALUE = 25565;
 
-    uint16_t LIDAR_MESSAGE_HEADER = 0xFAC7;
-    uint16_t LIDAR_RESPONSE_HEADER = 0x484C;
-    uint16_t ALARM_MESSAGE_HEADER = 0xCECE;
-
-    uint8_t BUFFER_POS_HEADER = 0;
-    uint8_t BUFFER_POS_TOTAL_POINTS = 2;
-    uint8_t BUFFER_POS_NUM_POINTS_IN_SECTOR = 4;
-    uint8_t BUFFER_POS_SECTOR_DATA_OFFSET = 6;
-    uint8_t BUFFER_POS_START_ANGLE = 8;
-    uint8_t BUFFER_POS_END_ANGLE = 12;
-    uint8_t BUFFER_POS_PROPERTY_FLAGS = 16;
-    uint8_t BUFFER_POS_TIMESTAMP = 20;
-    uint8_t BUFFER_POS_DEVICE_NUMBER = 24;
-    uint8_t BUFFER_POS_POINT_DATA = 28;
-
-    uint8_t SIZE_OF_DISTANCE = 2;
-    uint8_t SIZE_OF_RELATIVE_START_ANGLE = 2;
-    uint8_t SIZE_OF_INTENSITY = 1;
-    uint8_t SIZE_OF_LIDAR_POINT = SIZE_OF_DISTANCE + SIZE_OF_RELATIVE_START_ANGLE + SIZE_OF_INTENSITY;
-
-    MessageParser::MessageParser(std::function<void(const CompleteLidarMessage&)> onCompleteLidarMessageCallback) : onCompleteLidarMessageCallback(onCompleteLidarMessageCallback)
+    MessageParser::MessageParser(std::function<void(const CompleteLidarMessage&)> onCompleteLidarMessageCallback) : onCompleteLidarMessageCallback(onCompleteLidarMessageCallback), clock(std::chrono::system_clock::now)
     {
         reset();
     }
 
+    void MessageParser::setClock(std::function<std::chrono::system_clock::time_point()> clock)
+    {
+        this->clock = clock;
+    }
+
+    void MessageParser::registerPartialSectorCallback(std::function<void(const PartialSector&)> callback)
+    {
+        onPartialSectorCallback = callback;
+    }
+
     void MessageParser::reset()
     {
         lastGeneratedTimestamp.validTimestamp = false;
@@ -60,7 +51,7 @@ namespace internal
         }
 
         lastGeneratedTimestamp.validTimestamp = true;
-        lastGeneratedTimestamp.timestamp = std::chrono::system_clock::now();
+        lastGeneratedTimestamp.timestamp = clock();
     }
 
     void MessageParser::parseHeader()
@@ -119,7 +110,7 @@ namespace internal
         uint16_t BUFFER_POS_RELATIVE_START_ANGLES = BUFFER_POS_DISTANCES + (currentLidarMessage->numPoints * SIZE_OF_DISTANCE);
         uint16_t BUFFER_POS_INTENSITY = BUFFER_POS_RELATIVE_START_ANGLES + (currentLidarMessage->numPoints * SIZE_OF_RELATIVE_START_ANGLE);
 
-        for (uint8_t i = 0; i < currentLidarMessage->numPoints; i++)
+        for (uint16_t i = 0; i < currentLidarMessage->numPoints; i++)
         {
             LidarPoint lidarPoint;
 
@@ -272,12 +263,39 @@ namespace internal
         partialSectorScanDataList.clear();
     }
 
+    void MessageParser::publishPartialSector()
+    {
+        // Only points which belong to the sector the datagram claims, from a datagram timestamped like a complete sector
+        if (!currentLidarMessage->generatedTimestamp.validTimestamp || !doesChecksumMatch() ||
+            currentLidarMessage->sectorDataOffset + currentLidarMessage->numPoints > currentLidarMessage->numPointsInSector)
+        {
+            return;
+        }
+
+        PartialSector partialSector;
+        partialSector.sectorDataOffset = currentLidarMessage->sectorDataOffset;
+        partialSector.numPointsInSector = currentLidarMessage->numPointsInSector;
+        partialSector.startAngle = currentLidarMessage->startAngle / 1000;
+        partialSector.endAngle = currentLidarMessage->endAngle / 1000;
+        partialSector.timestamp = currentLidarMessage->generatedTimestamp.timestamp;
+        partialSector.deviceNumber = currentLidarMessage->deviceNumber;
+        partialSector.numPoints = currentLidarMessage->numPoints;
+        partialSector.lidarPoints = currentLidarMessage->lidarPoints.data();
+
+        onPartialSectorCallback(partialSector);
+    }
+
     int MessageParser::parseLidarDataFromBuffer()
     {
         currentLidarMessage = std::make_shared<PartialLidarMessage>();
 
         parsePartialScan();
 
+        if (onPartialSectorCallback != nullptr)
+        {
+            publishPartialSector();
+        }
+
         partialSectorScanDataList.push_back(currentLidarMessage);
         
         if(isScanCorrupt())
@@ -299,6 +317,19 @@ namespace internal
         return header == LIDAR_MESSAGE_HEADER;
     }
 
+    bool MessageParser::isLidarMessageComplete()
+    {
+        if (bufferData.length < BUFFER_POS_POINT_DATA)
+        {
+            return false;
+        }
+
+        uint16_t numPoints;
+        memcpy(&numPoints, bufferData.buffer + BUFFER_POS_TOTAL_POINTS, sizeof(numPoints));
+
+        return bufferData.length >= BUFFER_POS_POINT_DATA + (SIZE_OF_LIDAR_POINT * numPoints) + sizeof(uint16_t);
+    }
+
     bool MessageParser::isLidarResponse()
     {
         return header == LIDAR_RESPONSE_HEADER;
@@ -317,6 +348,12 @@ namespace internal
 
         if (isLidarMessage())
         {
+            // A truncated datagram can not be parsed without reading past its end
+            if (!isLidarMessageComplete())
+            {
+                return bufferData.length;
+            }
+
             return parseLidarDataFromBuffer();
         }
         else if (isLidarResponse())
@@ -0,0 +1,281 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ProE/internal/Protocol.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace ProE
+{
+namespace internal
+{
+    const int IP_ADDRESS_ARRAY_SIZE = 4;
+    const int SUBNET_MASK_ARRAY_SIZE = 4;
+    const int GATEWAY_ARRAY_SIZE = 4;
+    const int PORT_STRING_LENGTH = 5;
+
+    const std::string SW_SET_SPEED_PREFIX = "LSRPM:";
+    const std::string SW_SET_BIAS_PREFIX = "LSERR:";
+    const std::string SW_SET_SRC_IPV4_PROPERTIES_PREFIX = "LSUDP:";
+    const std::string SW_SET_DST_IPV4_PROPERTIES_PREFIX = "LSDST:";
+    const std::string SW_SET_OUTPUT_UNIT_OF_MEASURE_PREFIX = "LSMMU:";
+
+    const std::string SW_SET_DATA_SMOOTHING_PREFIX = "LSSS";
+    const std::string SW_SET_DRAG_POINT_REMOVAL_PREFIX = "LFFF";
+    const std::string SW_SET_SMOOTH_PREFIX = "LFFF";
+    const std::string SW_SET_RESAMPLE_FILTER_PREFIX = "LSRES:00";
+
+    const std::string SW_POSTFIX = "H";
+
+    const char SW_SET_LIDAR_PROPERTIES_DELIMITER = ' ';
+
+    const std::string SW_SET_SPEED(int speed)
+    {
+        return SW_SET_SPEED_PREFIX + std::to_string(speed) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_BIAS(int bias)
+    {
+        return SW_SET_BIAS_PREFIX + std::to_string(bias) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_DATA_SMOOTHING(bool enable)
+    {
+        return SW_SET_DATA_SMOOTHING_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_DRAG_POINT_REMOVAL(bool enable)
+    {
+        return SW_SET_DRAG_POINT_REMOVAL_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_OUTPUT_UNIT_OF_MEASURE(bool mm)
+    {
+        return SW_SET_OUTPUT_UNIT_OF_MEASURE_PREFIX + std::to_string((int)mm) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_SMOOTH(bool enable)
+    {
+        return SW_SET_SMOOTH_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+    }
+
+    const std::string SW_SET_RESAMPLE_FILTER(bool enable)
+    {
+        return SW_SET_RESAMPLE_FILTER_PREFIX + std::to_string((int)enable) + SW_POSTFIX;
+    }
+
+    std::string numberToFixedSizeString(unsigned int value, int size)
+    {
+        unsigned int uvalue = value;
+        
+        std::string result;
+        while (size-- > 0)
+        {
+            result += ('0' + uvalue % 10);
+            uvalue /= 10;
+        }
+
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    std::string unsignedCharArrayToString(const unsigned char* charArray, int size)
+    {
+        std::string result;
+
+        for (int i = 0; i < size; i++)
+        {
+            result += numberToFixedSizeString(charArray[i], 3);
+
+            if (i != size - 1)
+            {
+                result += '.';
+            }
+        }
+
+        return result;
+    }
+
+    const std::string SW_SET_SRC_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned char* subnetMask, const unsigned char* gateway, const unsigned short port)
+    {
+        std::string result;
+
+        result += SW_SET_SRC_IPV4_PROPERTIES_PREFIX;
+
+        result += unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
+        result += unsignedCharArrayToString(subnetMask, SUBNET_MASK_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
+        result += unsignedCharArrayToString(gateway, GATEWAY_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
+        result += numberToFixedSizeString(port, PORT_STRING_LENGTH);
+
+        result += SW_POSTFIX;
+
+        return result;
+    }
+
+    const std::string SW_SET_DST_IPV4_PROPERTIES(const unsigned char* ipAddress, const unsigned short port)
+    {
+        std::string result;
+
+        result += SW_SET_DST_IPV4_PROPERTIES_PREFIX;
+
+        result += unsignedCharArrayToString(ipAddress, IP_ADDRESS_ARRAY_SIZE) + SW_SET_LIDAR_PROPERTIES_DELIMITER;
+        result += numberToFixedSizeString(port, PORT_STRING_LENGTH);
+
+        result += SW_POSTFIX;
+
+        return result;
+    }
+
+    unsigned int calculateEndOfMessageCRC(const unsigned int* ptr, unsigned int len)
+    {
+        unsigned int xbit, data;
+        unsigned int crc32 = 0xFFFFFFFF;
+        const unsigned int polynomial = 0x04c11db7;
+
+        for (unsigned int i = 0; i < len; i++)
+        {
+            xbit = 1 << 31;
+            data = ptr[i];
+            for (unsigned int bits = 0; bits < 32; bits++)
+            {
+                if (crc32 & 0x80000000)
+                {
+                    crc32 <<= 1;
+                    crc32 ^= polynomial;
+                }
+                else
+                    crc32 <<= 1;
+
+                if (data & xbit)
+                    crc32 ^= polynomial;
+
+                xbit >>= 1;
+            }
+        }
+        return crc32;
+    }
+
+    unsigned int buildCommandMessage(const std::string& message, unsigned short cmd, unsigned short sn, unsigned char* buffer)
+    {
+        CmdHeader* hdr = (CmdHeader*)buffer;
+        hdr->sign = UDP_MESSAGE_SIGN;
+        hdr->cmd = cmd;
+        hdr->sn = sn;
+
+        hdr->len = ((static_cast<short>(message.length()) + 3) >> 2) * 4;
+
+        memcpy(buffer + sizeof(CmdHeader), message.c_str(), message.length());
+        memset(buffer + sizeof(CmdHeader) + message.length(), 0, hdr->len - message.length());
+
+        unsigned int* pcrc = (unsigned int*)(buffer + sizeof(CmdHeader) + hdr->len);
+        pcrc[0] = calculateEndOfMessageCRC((unsigned int*)(buffer), hdr->len / 4 + 2);
+
+        return sizeof(CmdHeader) + sizeof(pcrc[0]) + hdr->len;
+    }
+
+    bool parseCommandMessage(const unsigned char* buffer, unsigned int length, CmdHeader& header, std::string& message)
+    {
+        if (length < sizeof(CmdHeader) + sizeof(unsigned int))
+        {
+            return false;
+        }
+
+        memcpy(&header, buffer, sizeof(CmdHeader));
+
+        if (header.sign != UDP_MESSAGE_SIGN || header.len % 4 != 0 || length < sizeof(CmdHeader) + header.len + sizeof(unsigned int))
+        {
+            return false;
+        }
+
+        // Copied into words, as the received buffer need not be aligned
+        unsigned int words[(sizeof(CmdHeader) + 0xFFFF) / 4];
+        memcpy(words, buffer, sizeof(CmdHeader) + header.len);
+
+        unsigned int crc;
+        memcpy(&crc, buffer + sizeof(CmdHeader) + header.len, sizeof(crc));
+
+        if (crc != calculateEndOfMessageCRC(words, header.len / 4 + 2))
+        {
+            return false;
+        }
+
+        const char* text = reinterpret_cast<const char*>(buffer + sizeof(CmdHeader));
+        message.assign(text, strnlen(text, header.len));
+
+        return true;
+    }
+
+    std::uint16_t calculateLidarMessageChecksum(const LidarMessage& lidarMessage)
+    {
+        std::uint16_t checksum = 0;
+
+        checksum += lidarMessage.numPoints;
+        checksum += lidarMessage.numPointsInSector;
+        checksum += lidarMessage.sectorDataOffset;
+
+        checksum += lidarMessage.startAngle >> 16;
+        checksum += lidarMessage.startAngle & 0xFFFF;
+
+        checksum += lidarMessage.endAngle >> 16;
+        checksum += lidarMessage.endAngle & 0xFFFF;
+
+        checksum += lidarMessage.propertyFlags >> 16;
+        checksum += lidarMessage.propertyFlags & 0xFFFF;
+
+        checksum += lidarMessage.timestamp >> 16;
+        checksum += lidarMessage.timestamp & 0xFFFF;
+
+        checksum += lidarMessage.deviceNumber >> 16;
+        checksum += lidarMessage.deviceNumber & 0xFFFF;
+
+        for (std::uint16_t i = 0; i < lidarMessage.numPoints; i++)
+        {
+            checksum += lidarMessage.distances[i];
+            checksum += lidarMessage.relativeStartAngles[i];
+            checksum += lidarMessage.intensities[i];
+        }
+
+        return checksum;
+    }
+
+    unsigned int getLidarMessageLength(std::uint16_t numPoints)
+    {
+        return BUFFER_POS_POINT_DATA + (SIZE_OF_LIDAR_POINT * numPoints) + SIZE_OF_CHECKSUM;
+    }
+
+    unsigned int buildLidarMessage(const LidarMessage& lidarMessage, unsigned char* buffer)
+    {
+        memcpy(buffer + BUFFER_POS_HEADER, &LIDAR_MESSAGE_HEADER, sizeof(LIDAR_MESSAGE_HEADER));
+        memcpy(buffer + BUFFER_POS_TOTAL_POINTS, &lidarMessage.numPoints, sizeof(lidarMessage.numPoints));
+        memcpy(buffer + BUFFER_POS_NUM_POINTS_IN_SECTOR, &lidarMessage.numPointsInSector, sizeof(lidarMessage.numPointsInSector));
+        memcpy(buffer + BUFFER_POS_SECTOR_DATA_OFFSET, &lidarMessage.sectorDataOffset, sizeof(lidarMessage.sectorDataOffset));
+        memcpy(buffer + BUFFER_POS_START_ANGLE, &lidarMessage.startAngle, sizeof(lidarMessage.startAngle));
+        memcpy(buffer + BUFFER_POS_END_ANGLE, &lidarMessage.endAngle, sizeof(lidarMessage.endAngle));
+        memcpy(buffer + BUFFER_POS_PROPERTY_FLAGS, &lidarMessage.propertyFlags, sizeof(lidarMessage.propertyFlags));
+        memcpy(buffer + BUFFER_POS_TIMESTAMP, &lidarMessage.timestamp, sizeof(lidarMessage.timestamp));
+        memcpy(buffer + BUFFER_POS_DEVICE_NUMBER, &lidarMessage.deviceNumber, sizeof(lidarMessage.deviceNumber));
+
+        unsigned int distancesPos = BUFFER_POS_POINT_DATA;
+        unsigned int relativeStartAnglesPos = distancesPos + (lidarMessage.numPoints * SIZE_OF_DISTANCE);
+        unsigned int intensitiesPos = relativeStartAnglesPos + (lidarMessage.numPoints * SIZE_OF_RELATIVE_START_ANGLE);
+        unsigned int checksumPos = intensitiesPos + (lidarMessage.numPoints * SIZE_OF_INTENSITY);
+
+        memcpy(buffer + distancesPos, lidarMessage.distances, lidarMessage.numPoints * SIZE_OF_DISTANCE);
+        memcpy(buffer + relativeStartAnglesPos, lidarMessage.relativeStartAngles, lidarMessage.numPoints * SIZE_OF_RELATIVE_START_ANGLE);
+        memcpy(buffer + intensitiesPos, lidarMessage.intensities, lidarMessage.numPoints * SIZE_OF_INTENSITY);
+
+        std::uint16_t checksum = calculateLidarMessageChecksum(lidarMessage);
+        memcpy(buffer + checksumPos, &checksum, sizeof(checksum));
+
+        return checksumPos + SIZE_OF_CHECKSUM;
+    }
+}
+}
+}
+}
@@ -0,0 +1,307 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ProtectiveFieldMonitor.h>
+#include <parakeet/util.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const std::size_t ProtectiveFieldMonitor::DEFAULT_MAXIMUM_LAYOUT_COUNT;
+
+    static const double MAXIMUM_RANGE_MM = 65535;
+
+    ProtectiveFieldMonitor::ProtectiveFieldMonitor(const Settings& settings, std::function<void(const Event&)> callback) :
+        settings(settings),
+        callback(callback)
+    {
+        double bearingCount = std::round(360 / std::max(this->settings.resolution_deg, 0.01));
+        this->bearingCount = static_cast<std::size_t>(std::max(bearingCount, 1.0));
+        this->settings.resolution_deg = 360.0 / this->bearingCount;
+        this->settings.maximumLayoutCount = std::max<std::size_t>(this->settings.maximumLayoutCount, 1);
+
+        // A zone with no points in it is never intruded
+        for (Zone& zone : this->settings.zones)
+        {
+            zone.minimumPointCount = std::max(zone.minimumPointCount, 1);
+        }
+
+        std::size_t zoneCount = this->settings.zones.size();
+        nearestRanges_mm.resize(zoneCount * this->bearingCount);
+        farthestRanges_mm.resize(zoneCount * this->bearingCount);
+        zoneStates.resize(zoneCount);
+
+        for (std::size_t zoneIndex = 0; zoneIndex < zoneCount; zoneIndex++)
+        {
+            compileZone(this->settings.zones[zoneIndex], &nearestRanges_mm[zoneIndex * this->bearingCount], &farthestRanges_mm[zoneIndex * this->bearingCount]);
+        }
+    }
+
+    void ProtectiveFieldMonitor::compileZone(const Zone& zone, std::uint16_t* nearestRanges_mm, std::uint16_t* farthestRanges_mm)
+    {
+        const std::vector<PointXY>& vertices = zone.vertices;
+
+        for (std::size_t bearing = 0; bearing < bearingCount; bearing++)
+        {
+            double angle_rad = util::degreesToRadians(bearing * settings.resolution_deg);
+            double directionX = std::cos(angle_rad);
+            double directionY = std::sin(angle_rad);
+
+            double nearest_mm = MAXIMUM_RANGE_MM;
+            double farthest_mm = 0;
+            int crossingCount = 0;
+
+            for (std::size_t i = 0; i < vertices.size() && vertices.size() >= 3; i++)
+            {
+                const PointXY& from = vertices[i];
+                const PointXY& to = vertices[(i + 1) % vertices.size()];
+
+                // Which side of the bearing's line each end of the edge lies on. Taking a vertex on the line as being on
+                // one side, as a shared corner is tested the same way for both of its edges, means a bearing through a
+                // corner crosses exactly one of them, or neither where it only touches the zone.
+                bool fromAbove = directionX * from.getY_mm() - directionY * from.getX_mm() > 0;
+                bool toAbove = directionX * to.getY_mm() - directionY * to.getX_mm() > 0;
+                if (fromAbove == toAbove)
+                {
+                    continue;
+                }
+
+                double edgeX = to.getX_mm() - from.getX_mm();
+                double edgeY = to.getY_mm() - from.getY_mm();
+
+                // The distance along the bearing at which it crosses the edge's line
+                double denominator = directionX * edgeY - directionY * edgeX;
+                double distance_mm = (from.getX_mm() * edgeY - from.getY_mm() * edgeX) / denominator;
+
+                if (distance_mm >= 0)
+                {
+                    crossingCount++;
+                    nearest_mm = std::min(nearest_mm, distance_mm);
+                    farthest_mm = std::max(farthest_mm, distance_mm);
+                }
+            }
+
+            // An odd number of crossings means the sensor is inside the zone, which then starts at the sensor. Otherwise the
+            // bearing is covered from where it first enters the zone to where it last leaves it, which also covers any gap a
+            // concave zone leaves between, as a protective field should err towards stopping.
+            if (crossingCount % 2 == 1)
+            {
+                nearest_mm = 0;
+            }
+
+            if (crossingCount == 0)
+            {
+                nearestRanges_mm[bearing] = 65535;
+                farthestRanges_mm[bearing] = 0;
+            }
+            else
+            {
+                nearestRanges_mm[bearing] = static_cast<std::uint16_t>(std::floor(std::min(nearest_mm, MAXIMUM_RANGE_MM)));
+                farthestRanges_mm[bearing] = static_cast<std::uint16_t>(std::ceil(std::min(farthest_mm, MAXIMUM_RANGE_MM)));
+            }
+        }
+    }
+
+    std::size_t ProtectiveFieldMonitor::findBearing(double angle_deg) const
+    {
+        double bearing = angle_deg / settings.resolution_deg + 0.5;
+
+        // Angles within a revolution only need truncating, without the division
+        if (bearing >= 0 && bearing < bearingCount)
+        {
+            return static_cast<std::size_t>(bearing);
+        }
+
+        bearing = std::fmod(std::floor(bearing), static_cast<double>(bearingCount));
+        return static_cast<std::size_t>(bearing < 0 ? bearing + bearingCount : bearing);
+    }
+
+    const ProtectiveFieldMonitor::Layout& ProtectiveFieldMonitor::findLayout(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg)
+    {
+        useCount++;
+
+        for (Layout& layout : layouts)
+        {
+            if (layout.pointCount == pointCount && layout.startAngle_deg == startAngle_deg && layout.anglePerPoint_deg == anglePerPoint_deg)
+            {
+                layout.lastUsed = useCount;
+                return layout;
+            }
+        }
+
+        Layout* layout;
+        if (layouts.size() < settings.maximumLayoutCount)
+        {
+            layouts.push_back(Layout());
+            layout = &layouts.back();
+        }
+        else
+        {
+            layout = &*std::min_element(layouts.begin(), layouts.end(), [](const Layout& a, const Layout& b)
+            {
+                return a.lastUsed < b.lastUsed;
+            });
+        }
+
+        std::size_t zoneCount = zoneStates.size();
+
+        layout->startAngle_deg = startAngle_deg;
+        layout->anglePerPoint_deg = anglePerPoint_deg;
+        layout->pointCount = pointCount;
+        layout->nearestRanges_mm.resize(zoneCount * pointCount);
+        layout->farthestRanges_mm.resize(zoneCount * pointCount);
+        layout->lastUsed = useCount;
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            std::size_t bearing = findBearing(startAngle_deg + anglePerPoint_deg * i);
+
+            for (std::size_t zoneIndex = 0; zoneIndex < zoneCount; zoneIndex++)
+            {
+                layout->nearestRanges_mm[zoneIndex * pointCount + i] = nearestRanges_mm[zoneIndex * bearingCount + bearing];
+                layout->farthestRanges_mm[zoneIndex * pointCount + i] = farthestRanges_mm[zoneIndex * bearingCount + bearing];
+            }
+        }
+
+        layoutBuildCount++;
+
+        return *layout;
+    }
+
+    void ProtectiveFieldMonitor::checkSector(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg,
+        const std::uint16_t* ranges_mm, const std::chrono::system_clock::time_point& timestamp)
+    {
+        if (pointCount == 0 || zoneStates.empty())
+        {
+            return;
+        }
+
+        const Layout& layout = findLayout(pointCount, startAngle_deg, anglePerPoint_deg);
+
+        for (std::size_t zoneIndex = 0; zoneIndex < zoneStates.size(); zoneIndex++)
+        {
+            const std::uint16_t* nearestRanges_mm = &layout.nearestRanges_mm[zoneIndex * pointCount];
+            const std::uint16_t* farthestRanges_mm = &layout.farthestRanges_mm[zoneIndex * pointCount];
+
+            // Compares only, which the compiler vectorizes
+            int intrudingPointCount = 0;
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                intrudingPointCount += (ranges_mm[i] != 0) & (ranges_mm[i] >= nearestRanges_mm[i]) & (ranges_mm[i] <= farthestRanges_mm[i]);
+            }
+
+            ZoneState& zoneState = zoneStates[zoneIndex];
+            zoneState.pointCount += intrudingPointCount;
+
+            if (zoneState.intrudedThisRevolution || zoneState.pointCount < settings.zones[zoneIndex].minimumPointCount)
+            {
+                continue;
+            }
+
+            zoneState.intrudedThisRevolution = true;
+
+            if (!zoneState.intruded && zoneState.intrudedRevolutionCount + 1 >= settings.intrusionRevolutionCount)
+            {
+                zoneState.intruded = true;
+                reportIntrusion(zoneIndex, pointCount, startAngle_deg, anglePerPoint_deg, ranges_mm, layout, timestamp);
+            }
+        }
+    }
+
+    void ProtectiveFieldMonitor::reportIntrusion(std::size_t zoneIndex, std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg,
+        const std::uint16_t* ranges_mm, const Layout& layout, const std::chrono::system_clock::time_point& timestamp)
+    {
+        const std::uint16_t* nearestRanges_mm = &layout.nearestRanges_mm[zoneIndex * pointCount];
+        const std::uint16_t* farthestRanges_mm = &layout.farthestRanges_mm[zoneIndex * pointCount];
+
+        Event event;
+        event.zoneIndex = zoneIndex;
+        event.intruded = true;
+        event.timestamp = timestamp;
+
+        // The intrusion may have been completed by an earlier sector's points, in which case no point of this one is reported
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            bool inside = ranges_mm[i] != 0 && ranges_mm[i] >= nearestRanges_mm[i] && ranges_mm[i] <= farthestRanges_mm[i];
+
+            if (inside && (event.range_mm == 0 || ranges_mm[i] < event.range_mm))
+            {
+                event.range_mm = ranges_mm[i];
+                event.angle_deg = std::fmod(startAngle_deg + anglePerPoint_deg * i, 360.0);
+            }
+        }
+
+        if (callback != nullptr)
+        {
+            callback(event);
+        }
+    }
+
+    void ProtectiveFieldMonitor::endRevolution(const std::chrono::system_clock::time_point& timestamp)
+    {
+        for (std::size_t zoneIndex = 0; zoneIndex < zoneStates.size(); zoneIndex++)
+        {
+            ZoneState& zoneState = zoneStates[zoneIndex];
+
+            if (zoneState.intrudedThisRevolution)
+            {
+                zoneState.intrudedRevolutionCount++;
+                zoneState.clearRevolutionCount = 0;
+            }
+            else
+            {
+                zoneState.intrudedRevolutionCount = 0;
+                zoneState.clearRevolutionCount++;
+            }
+
+            zoneState.pointCount = 0;
+            zoneState.intrudedThisRevolution = false;
+
+            if (zoneState.intruded && zoneState.clearRevolutionCount >= settings.clearRevolutionCount)
+            {
+                zoneState.intruded = false;
+
+                Event event;
+                event.zoneIndex = zoneIndex;
+                event.intruded = false;
+                event.timestamp = timestamp;
+
+                if (callback != nullptr)
+                {
+                    callback(event);
+                }
+            }
+        }
+    }
+
+    bool ProtectiveFieldMonitor::isIntruded(std::size_t zoneIndex) const
+    {
+        return zoneStates[zoneIndex].intruded;
+    }
+
+    std::size_t ProtectiveFieldMonitor::getZoneCount() const
+    {
+        return zoneStates.size();
+    }
+
+    std::uint16_t ProtectiveFieldMonitor::getNearestRange_mm(std::size_t zoneIndex, double angle_deg) const
+    {
+        return nearestRanges_mm[zoneIndex * bearingCount + findBearing(angle_deg)];
+    }
+
+    std::uint16_t ProtectiveFieldMonitor::getFarthestRange_mm(std::size_t zoneIndex, double angle_deg) const
+    {
+        return farthestRanges_mm[zoneIndex * bearingCount + findBearing(angle_deg)];
+    }
+
+    std::uint64_t ProtectiveFieldMonitor::getLayoutBuildCount() const
+    {
+        return layoutBuildCount;
+    }
+}
+}
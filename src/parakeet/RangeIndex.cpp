@@ -0,0 +1,255 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/RangeIndex.h>
+
+#include <algorithm>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const std::size_t RangeIndex::NO_POINT;
+    const std::size_t RangeIndex::MAX_POINT_COUNT;
+
+    // Small enough that a partial block is searched in a few instructions, large enough that the sparse table stays in cache
+    static const std::size_t BLOCK_SIZE = 16;
+
+    // Taken and returned by value, so min compiles to a select rather than a branch
+    template <typename T>
+    static T minimum(T a, T b)
+    {
+        return a < b ? a : b;
+    }
+
+    RangeIndex::RangeIndex(const CompactScanData& scan)
+    {
+        build(scan);
+    }
+
+    void RangeIndex::build(const CompactScanData& scan)
+    {
+        std::size_t pointCount = std::min(scan.getPointCount(), MAX_POINT_COUNT);
+        const std::uint16_t* angles_cdeg = scan.getAngles_cdeg();
+
+        // The revolution is rotated to start at its smallest angle, so the angles can be searched
+        std::size_t firstIndex = 0;
+        for (std::size_t i = 1; i < pointCount; i++)
+        {
+            if (angles_cdeg[i] < angles_cdeg[i - 1])
+            {
+                firstIndex = i;
+                break;
+            }
+        }
+
+        this->scan.clear();
+        this->scan.setTimestamp(scan.getTimestamp());
+        this->scan.reserve(pointCount);
+        this->scan.addPoints(pointCount - firstIndex, scan.getRanges_mm() + firstIndex, angles_cdeg + firstIndex, scan.getIntensities() + firstIndex);
+        this->scan.addPoints(firstIndex, scan.getRanges_mm(), angles_cdeg, scan.getIntensities());
+
+        this->pointCount = pointCount;
+        blockCount = (pointCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        levelCount = 0;
+        while ((static_cast<std::size_t>(1) << levelCount) <= blockCount)
+        {
+            levelCount++;
+        }
+
+        levels.resize(blockCount + 1);
+        for (std::size_t length = 2; length <= blockCount; length++)
+        {
+            levels[length] = static_cast<std::uint8_t>(levels[length / 2] + 1);
+        }
+
+        closestTable.keys.resize(pointCount);
+        farthestTable.keys.resize(pointCount);
+
+        const std::uint16_t* ranges_mm = this->scan.getRanges_mm();
+        std::uint32_t* closest = closestTable.keys.data();
+        std::uint32_t* farthest = farthestTable.keys.data();
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            // A point without a return wraps round to the largest range, and is never the closest or farthest
+            std::uint32_t closestRange_mm = static_cast<std::uint16_t>(ranges_mm[i] - 1);
+            std::uint32_t farthestRange_mm = static_cast<std::uint16_t>(65535 - ranges_mm[i]);
+
+            closest[i] = (closestRange_mm << 16) | static_cast<std::uint32_t>(i);
+            farthest[i] = (farthestRange_mm << 16) | static_cast<std::uint32_t>(i);
+        }
+
+        buildTable(closestTable);
+        buildTable(farthestTable);
+    }
+
+    void RangeIndex::buildTable(Table& table)
+    {
+        table.blockKeys.resize(levelCount * blockCount);
+
+        const std::uint32_t* keys = table.keys.data();
+        std::uint32_t* blockKeys = table.blockKeys.data();
+
+        for (std::size_t block = 0; block < blockCount; block++)
+        {
+            std::size_t firstIndex = block * BLOCK_SIZE;
+            std::size_t endIndex = std::min(firstIndex + BLOCK_SIZE, pointCount);
+
+            std::uint32_t key = 0xFFFFFFFF;
+            for (std::size_t i = firstIndex; i < endIndex; i++)
+            {
+                key = minimum(key, keys[i]);
+            }
+
+            blockKeys[block] = key;
+        }
+
+        for (int level = 1; level < levelCount; level++)
+        {
+            const std::uint32_t* previousRow = blockKeys + (level - 1) * blockCount;
+            std::uint32_t* row = blockKeys + level * blockCount;
+
+            std::size_t halfLength = static_cast<std::size_t>(1) << (level - 1);
+            std::size_t runCount = blockCount - (halfLength * 2) + 1;
+
+            for (std::size_t i = 0; i < runCount; i++)
+            {
+                row[i] = minimum(previousRow[i], previousRow[i + halfLength]);
+            }
+        }
+    }
+
+    const CompactScanData& RangeIndex::getScan() const
+    {
+        return scan;
+    }
+
+    int RangeIndex::findRuns(double startAngle_deg, double endAngle_deg, std::size_t* firstIndices, std::size_t* endIndices) const
+    {
+        // Checked before the bearings are quantized, which would wrap 360 degrees round to 0
+        if (endAngle_deg - startAngle_deg >= 360)
+        {
+            firstIndices[0] = 0;
+            endIndices[0] = pointCount;
+            return pointCount > 0 ? 1 : 0;
+        }
+
+        const std::uint16_t* angles_cdeg = scan.getAngles_cdeg();
+        const std::uint16_t* end = angles_cdeg + pointCount;
+
+        std::uint16_t startAngle_cdeg = CompactScanData::toCentidegrees(startAngle_deg);
+        std::uint16_t endAngle_cdeg = CompactScanData::toCentidegrees(endAngle_deg);
+
+        std::size_t firstIndex = std::lower_bound(angles_cdeg, end, startAngle_cdeg) - angles_cdeg;
+        std::size_t endIndex = std::upper_bound(angles_cdeg, end, endAngle_cdeg) - angles_cdeg;
+
+        int runCount = 0;
+
+        if (startAngle_cdeg <= endAngle_cdeg)
+        {
+            firstIndices[runCount] = firstIndex;
+            endIndices[runCount] = endIndex;
+            runCount += firstIndex < endIndex;
+        }
+        else
+        {
+            // The arc crosses 0 degrees, and is split at the end of the revolution
+            firstIndices[runCount] = firstIndex;
+            endIndices[runCount] = pointCount;
+            runCount += firstIndex < pointCount;
+
+            firstIndices[runCount] = 0;
+            endIndices[runCount] = endIndex;
+            runCount += endIndex > 0;
+        }
+
+        return runCount;
+    }
+
+    std::uint32_t RangeIndex::findMinimumKey(const Table& table, std::size_t firstIndex, std::size_t endIndex) const
+    {
+        const std::uint32_t* keys = table.keys.data();
+
+        std::size_t firstBlock = (firstIndex + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::size_t endBlock = endIndex / BLOCK_SIZE;
+
+        std::uint32_t key = 0xFFFFFFFF;
+
+        if (firstBlock >= endBlock)
+        {
+            // The run has no whole block
+            for (std::size_t i = firstIndex; i < endIndex; i++)
+            {
+                key = minimum(key, keys[i]);
+            }
+
+            return key;
+        }
+
+        for (std::size_t i = firstIndex; i < firstBlock * BLOCK_SIZE; i++)
+        {
+            key = minimum(key, keys[i]);
+        }
+
+        for (std::size_t i = endBlock * BLOCK_SIZE; i < endIndex; i++)
+        {
+            key = minimum(key, keys[i]);
+        }
+
+        int level = levels[endBlock - firstBlock];
+        const std::uint32_t* row = table.blockKeys.data() + level * blockCount;
+
+        return minimum(key, minimum(row[firstBlock], row[endBlock - (static_cast<std::size_t>(1) << level)]));
+    }
+
+    std::size_t RangeIndex::find(const Table& table, double startAngle_deg, double endAngle_deg) const
+    {
+        std::size_t firstIndices[2];
+        std::size_t endIndices[2];
+        int runCount = findRuns(startAngle_deg, endAngle_deg, firstIndices, endIndices);
+
+        if (runCount == 0)
+        {
+            return NO_POINT;
+        }
+
+        std::uint32_t key = findMinimumKey(table, firstIndices[0], endIndices[0]);
+        if (runCount == 2)
+        {
+            key = minimum(key, findMinimumKey(table, firstIndices[1], endIndices[1]));
+        }
+
+        return toPoint(key);
+    }
+
+    std::size_t RangeIndex::toPoint(std::uint32_t key) const
+    {
+        // A run of points without a return finds one of them
+        std::size_t index = key & 0xFFFF;
+        return scan.getRanges_mm()[index] != 0 ? index : NO_POINT;
+    }
+
+    std::size_t RangeIndex::findClosest(double startAngle_deg, double endAngle_deg) const
+    {
+        return find(closestTable, startAngle_deg, endAngle_deg);
+    }
+
+    std::size_t RangeIndex::findFarthest(double startAngle_deg, double endAngle_deg) const
+    {
+        return find(farthestTable, startAngle_deg, endAngle_deg);
+    }
+
+    std::size_t RangeIndex::findClosest() const
+    {
+        return pointCount > 0 ? toPoint(findMinimumKey(closestTable, 0, pointCount)) : NO_POINT;
+    }
+
+    std::size_t RangeIndex::findFarthest() const
+    {
+        return pointCount > 0 ? toPoint(findMinimumKey(farthestTable, 0, pointCount)) : NO_POINT;
+    }
+}
+}
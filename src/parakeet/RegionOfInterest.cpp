@@ -0,0 +1,144 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/RegionOfInterest.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const int RegionOfInterest::MAX_ARC_COUNT;
+    const int RegionOfInterest::MAX_RUN_COUNT;
+
+    // Points which fall on the edge of an arc, give or take rounding, are counted as being on it
+    static const double EDGE_TOLERANCE = 1e-9;
+
+    static double normalizeAngle_deg(double angle_deg)
+    {
+        angle_deg = std::fmod(angle_deg, 360.0);
+        return angle_deg < 0 ? angle_deg + 360 : angle_deg;
+    }
+
+    // The number of points before an angle counted from the start of the sector, ie: the first point at or past it
+    static std::size_t findIndex(double angle_deg, double anglePerPoint_deg, std::size_t pointCount)
+    {
+        double index = std::ceil(angle_deg / anglePerPoint_deg - EDGE_TOLERANCE);
+        return static_cast<std::size_t>(std::min(std::max(index, 0.0), static_cast<double>(pointCount)));
+    }
+
+    bool RegionOfInterest::addArc(double startAngle_deg, double endAngle_deg)
+    {
+        if (arcCount >= MAX_ARC_COUNT)
+        {
+            return false;
+        }
+
+        arcs[arcCount].startAngle_deg = startAngle_deg;
+        arcs[arcCount].endAngle_deg = endAngle_deg;
+        arcCount++;
+
+        // Its length is a whole number of revolutions, which would otherwise measure as no length at all
+        hasWholeRevolutionArc |= normalizeAngle_deg(endAngle_deg - startAngle_deg) == 0;
+
+        return true;
+    }
+
+    int RegionOfInterest::getArcCount() const
+    {
+        return arcCount;
+    }
+
+    const RegionOfInterest::Arc& RegionOfInterest::getArc(int index) const
+    {
+        return arcs[index];
+    }
+
+    bool RegionOfInterest::isWholeRevolution() const
+    {
+        return arcCount == 0 || hasWholeRevolutionArc;
+    }
+
+    bool RegionOfInterest::contains(double angle_deg) const
+    {
+        if (isWholeRevolution())
+        {
+            return true;
+        }
+
+        for (int arc = 0; arc < arcCount; arc++)
+        {
+            // Measured from the start of the arc, so an arc which crosses 0 degrees needs no special case
+            double offset_deg = normalizeAngle_deg(angle_deg - arcs[arc].startAngle_deg);
+
+            if (offset_deg < normalizeAngle_deg(arcs[arc].endAngle_deg - arcs[arc].startAngle_deg))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    int RegionOfInterest::findRuns(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::size_t* firstIndices, std::size_t* endIndices) const
+    {
+        if (isWholeRevolution() || !(anglePerPoint_deg > 0))
+        {
+            firstIndices[0] = 0;
+            endIndices[0] = pointCount;
+            return pointCount > 0 ? 1 : 0;
+        }
+
+        int runCount = 0;
+
+        for (int arc = 0; arc < arcCount; arc++)
+        {
+            // The arc measured from the sector's first point, the points are less than a revolution from it
+            double arcStart_deg = normalizeAngle_deg(arcs[arc].startAngle_deg - startAngle_deg);
+            double arcEnd_deg = arcStart_deg + normalizeAngle_deg(arcs[arc].endAngle_deg - arcs[arc].startAngle_deg);
+
+            firstIndices[runCount] = findIndex(arcStart_deg, anglePerPoint_deg, pointCount);
+            endIndices[runCount] = findIndex(arcEnd_deg, anglePerPoint_deg, pointCount);
+            runCount += firstIndices[runCount] < endIndices[runCount];
+
+            // An arc which runs past a revolution from the first point wraps round to cover the start of the sector
+            if (arcEnd_deg > 360)
+            {
+                firstIndices[runCount] = 0;
+                endIndices[runCount] = findIndex(arcEnd_deg - 360, anglePerPoint_deg, pointCount);
+                runCount += endIndices[runCount] > 0;
+            }
+        }
+
+        // Sorted by their first point, then merged where arcs overlap or meet
+        for (int run = 1; run < runCount; run++)
+        {
+            for (int i = run; i > 0 && firstIndices[i] < firstIndices[i - 1]; i--)
+            {
+                std::swap(firstIndices[i], firstIndices[i - 1]);
+                std::swap(endIndices[i], endIndices[i - 1]);
+            }
+        }
+
+        int mergedRunCount = 0;
+
+        for (int run = 0; run < runCount; run++)
+        {
+            if (mergedRunCount > 0 && firstIndices[run] <= endIndices[mergedRunCount - 1])
+            {
+                endIndices[mergedRunCount - 1] = std::max(endIndices[mergedRunCount - 1], endIndices[run]);
+                continue;
+            }
+
+            firstIndices[mergedRunCount] = firstIndices[run];
+            endIndices[mergedRunCount] = endIndices[run];
+            mergedRunCount++;
+        }
+
+        return mergedRunCount;
+    }
+}
+}
@@ -0,0 +1,390 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/Replay/Driver.h>
+
+#include <parakeet/exceptions/UnableToOpenFileException.h>
+
+#include <algorithm>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace Replay
+{
+    const std::chrono::milliseconds MAX_PACING_SLEEP(10);
+    const std::chrono::milliseconds END_OF_CAPTURE_SLEEP(10);
+
+    // Enough Parakeet Pro data to hold several revolutions, used to tell the 2 and 3 byte point layouts apart
+    const std::size_t INTENSITY_DETECTION_BYTES = 64 * 1024;
+
+    Driver::Driver() :
+        proParser(std::bind(&Driver::onScanDataReceived, this, std::placeholders::_1), nullptr),
+        proEParser(std::bind(&Driver::onCompleteLidarMessage, this, std::placeholders::_1))
+    {
+        std::function<std::chrono::system_clock::time_point()> virtualClock = std::bind(&Driver::getVirtualTime, this);
+
+        proParser.setClock(virtualClock);
+        proEParser.setClock(virtualClock);
+        proEParser.registerPartialSectorCallback(std::bind(&Driver::onPartialSector, this, std::placeholders::_1));
+
+        this->registerUpdateThreadCallback(std::bind(&Driver::replayUpdateThreadFunction, this));
+    }
+
+    Driver::~Driver()
+    {
+        close();
+    }
+
+    void Driver::connect(const SensorConfiguration& sensorConfiguration)
+    {
+        this->sensorConfiguration = sensorConfiguration;
+
+        // Dividing the recorded gaps by a speed which is not positive has no meaningful duration
+        if (sensorConfiguration.pacing == Scaled && !(sensorConfiguration.speed > 0))
+        {
+            this->sensorConfiguration.pacing = AsFastAsPossible;
+        }
+
+        if (!captureReader.open(sensorConfiguration.capturePath))
+        {
+            throw exceptions::UnableToOpenFileException(sensorConfiguration.capturePath);
+        }
+
+        selectStream();
+
+        if (streamInfo.streamType == CaptureRecorder::SerialByteStream)
+        {
+            detectIntensityLayout();
+        }
+
+        resetPlayback();
+    }
+
+    void Driver::selectStream()
+    {
+        streamId = sensorConfiguration.streamId;
+
+        internal::CaptureReader::Record record;
+        while (captureReader.next(record))
+        {
+            if (streamId < 0 || record.streamId == streamId)
+            {
+                streamId = record.streamId;
+                break;
+            }
+        }
+
+        const CaptureRecorder::StreamInfo* recordedStreamInfo = captureReader.getStreamInfo(streamId);
+        if (recordedStreamInfo == nullptr)
+        {
+            throw exceptions::UnableToOpenFileException(sensorConfiguration.capturePath);
+        }
+
+        streamInfo = *recordedStreamInfo;
+        captureReader.rewind();
+    }
+
+    void Driver::detectIntensityLayout()
+    {
+        // The capture does not say which layout the sensor was sending, so parse the start of the stream both ways
+        std::vector<unsigned char> streamStart;
+
+        internal::CaptureReader::Record record;
+        while (streamStart.size() < INTENSITY_DETECTION_BYTES && captureReader.next(record))
+        {
+            if (record.streamId == streamId)
+            {
+                streamStart.insert(streamStart.end(), record.data, record.data + record.length);
+            }
+        }
+
+        int validSectorCount[2];
+        for (int withIntensity = 0; withIntensity < 2; withIntensity++)
+        {
+            Pro::internal::MessageParser layoutParser(nullptr, nullptr);
+            layoutParser.setIntensityDataEnabled(withIntensity == 1);
+
+            std::size_t offset = 0;
+            while (offset < streamStart.size())
+            {
+                int bytesParsed = layoutParser.parse(internal::BufferData(streamStart.data() + offset, static_cast<unsigned int>(streamStart.size() - offset)));
+                if (bytesParsed <= 0)
+                {
+                    break;
+                }
+                offset += bytesParsed;
+            }
+
+            validSectorCount[withIntensity] = layoutParser.getValidSectorCount();
+        }
+
+        intensity = validSectorCount[1] > validSectorCount[0];
+        proParser.setIntensityDataEnabled(intensity);
+
+        captureReader.rewind();
+    }
+
+    void Driver::resetPlayback()
+    {
+        captureReader.rewind();
+
+        proBuffer.clear();
+        proEParser.reset();
+
+        hasPendingRecord = false;
+        playbackStarted = false;
+
+        setEndOfCapture(false);
+    }
+
+    void Driver::start()
+    {
+        assertIsConnected();
+
+        replayedRecordCount = 0;
+
+        if (isEndOfCapture())
+        {
+            resetPlayback();
+        }
+
+        // Pacing restarts from the next record, rather than catching up on the time spent stopped
+        playbackStarted = false;
+
+        mechaspin::parakeet::Driver::start();
+    }
+
+    void Driver::stop()
+    {
+        mechaspin::parakeet::Driver::stop();
+
+        // Wake anyone waiting for the end of the capture, so they can see the Driver stopped
+        std::lock_guard<std::mutex> lock(endOfCaptureMutex);
+        endOfCaptureCondition.notify_all();
+    }
+
+    void Driver::close()
+    {
+        mechaspin::parakeet::Driver::close();
+
+        if (!captureReader.close())
+        {
+            closeError = true;
+        }
+    }
+
+    void Driver::replayUpdateThreadFunction()
+    {
+        if (!hasPendingRecord)
+        {
+            while (true)
+            {
+                if (!captureReader.next(pendingRecord))
+                {
+                    if (!sensorConfiguration.loop)
+                    {
+                        setEndOfCapture(true);
+
+                        std::this_thread::sleep_for(END_OF_CAPTURE_SLEEP);
+                        return;
+                    }
+
+                    resetPlayback();
+                    continue;
+                }
+
+                if (pendingRecord.streamId == streamId)
+                {
+                    break;
+                }
+            }
+
+            hasPendingRecord = true;
+        }
+
+        if (!playbackStarted)
+        {
+            firstRecordTime = pendingRecord.timestamp;
+            playbackStartTime = std::chrono::steady_clock::now();
+            playbackStarted = true;
+        }
+
+        if (sensorConfiguration.pacing != AsFastAsPossible)
+        {
+            double speed = sensorConfiguration.pacing == Scaled ? sensorConfiguration.speed : 1;
+
+            std::chrono::duration<double> recordedOffset = pendingRecord.timestamp - firstRecordTime;
+            std::chrono::steady_clock::duration playbackOffset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(recordedOffset / speed);
+
+            std::chrono::steady_clock::duration remaining = playbackStartTime + playbackOffset - std::chrono::steady_clock::now();
+            if (remaining > std::chrono::steady_clock::duration::zero())
+            {
+                // Sleep in short steps, so stop() is not held up by long gaps in the recording
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(remaining, MAX_PACING_SLEEP));
+                return;
+            }
+        }
+
+        replayRecord(pendingRecord);
+        hasPendingRecord = false;
+    }
+
+    void Driver::replayRecord(const internal::CaptureReader::Record& record)
+    {
+        virtualTime = record.timestamp.time_since_epoch().count();
+        replayedRecordCount++;
+
+        // The parsers only read from the buffer, so the recorded data is handed to them in place
+        unsigned char* data = const_cast<unsigned char*>(record.data);
+
+        if (streamInfo.streamType == CaptureRecorder::UdpDatagrams)
+        {
+            proEParser.parse(internal::BufferData(data, record.length));
+            return;
+        }
+
+        if (proBuffer.empty())
+        {
+            int bytesParsed = proParser.parse(internal::BufferData(data, record.length));
+            proBuffer.assign(record.data + bytesParsed, record.data + record.length);
+            return;
+        }
+
+        // Part of a sector was left over from the previous record
+        proBuffer.insert(proBuffer.end(), record.data, record.data + record.length);
+
+        int bytesParsed = proParser.parse(internal::BufferData(proBuffer.data(), static_cast<unsigned int>(proBuffer.size())));
+        proBuffer.erase(proBuffer.begin(), proBuffer.begin() + bytesParsed);
+    }
+
+    void Driver::onCompleteLidarMessage(const ProE::internal::MessageParser::CompleteLidarMessage& lidarMessage)
+    {
+        int maximumPointCount = MAX_NUMBER_OF_POINTS_FROM_SENSOR;
+
+        ScanData scanData(lidarMessage.timestamp);
+        scanData.count = std::min(static_cast<int>(lidarMessage.lidarPoints.size()), maximumPointCount);
+        scanData.startAngle_deg = lidarMessage.startAngle;
+        scanData.endAngle_deg = lidarMessage.endAngle;
+
+        for (int i = 0; i < scanData.count; i++)
+        {
+            scanData.dist_mm[i] = lidarMessage.lidarPoints[i].distance;
+            scanData.intensity[i] = lidarMessage.lidarPoints[i].intensity;
+        }
+
+        onScanDataReceived(scanData);
+    }
+
+    void Driver::onPartialSector(const ProE::internal::MessageParser::PartialSector& partialSector)
+    {
+        int maximumPointCount = MAX_NUMBER_OF_POINTS_FROM_SENSOR;
+
+        ScanData scanData(partialSector.timestamp);
+        scanData.count = std::min<int>(partialSector.numPoints, maximumPointCount);
+
+        // The points keep the angles they will have in the complete sector
+        double anglePerPoint_deg = (static_cast<double>(partialSector.endAngle) - partialSector.startAngle) / partialSector.numPointsInSector;
+        scanData.startAngle_deg = partialSector.startAngle + (anglePerPoint_deg * partialSector.sectorDataOffset);
+        scanData.endAngle_deg = scanData.startAngle_deg + (anglePerPoint_deg * partialSector.numPoints);
+
+        for (int i = 0; i < scanData.count; i++)
+        {
+            scanData.dist_mm[i] = partialSector.lidarPoints[i].distance;
+            scanData.intensity[i] = partialSector.lidarPoints[i].intensity;
+        }
+
+        onPartialSectorReceived(scanData);
+    }
+
+    void Driver::setEndOfCapture(bool endOfCapture)
+    {
+        std::lock_guard<std::mutex> lock(endOfCaptureMutex);
+
+        this->endOfCapture = endOfCapture;
+        endOfCaptureCondition.notify_all();
+    }
+
+    bool Driver::isEndOfCapture()
+    {
+        std::lock_guard<std::mutex> lock(endOfCaptureMutex);
+
+        return endOfCapture;
+    }
+
+    void Driver::waitForEndOfCapture()
+    {
+        std::unique_lock<std::mutex> lock(endOfCaptureMutex);
+
+        endOfCaptureCondition.wait(lock, [this]() { return endOfCapture || !isRunning(); });
+    }
+
+    std::uint64_t Driver::getReplayedRecordCount()
+    {
+        return replayedRecordCount;
+    }
+
+    bool Driver::hasCloseError()
+    {
+        return closeError;
+    }
+
+    std::chrono::system_clock::time_point Driver::getVirtualTime()
+    {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(virtualTime.load()));
+    }
+
+    void Driver::setScanningFrequency_Hz(ScanningFrequency Hz)
+    {
+        scanningFrequency_Hz = Hz;
+    }
+
+    Driver::ScanningFrequency Driver::getScanningFrequency_Hz()
+    {
+        return scanningFrequency_Hz;
+    }
+
+    void Driver::enableIntensityData(bool enable)
+    {
+        intensity = enable;
+    }
+
+    bool Driver::isIntensityDataEnabled()
+    {
+        return intensity;
+    }
+
+    void Driver::enableDataSmoothing(bool enable)
+    {
+        dataSmoothing = enable;
+    }
+
+    bool Driver::isDataSmoothingEnabled()
+    {
+        return dataSmoothing;
+    }
+
+    void Driver::enableRemoveDragPoint(bool enable)
+    {
+        dragPointRemoval = enable;
+    }
+
+    bool Driver::isDragPointRemovalEnabled()
+    {
+        return dragPointRemoval;
+    }
+
+    CaptureRecorder::StreamInfo Driver::getCaptureStreamInfo()
+    {
+        return streamInfo;
+    }
+
+    bool Driver::isConnected()
+    {
+        return captureReader.isOpen();
+    }
+}
+}
+}
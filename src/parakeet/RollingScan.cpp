@@ -0,0 +1,165 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/RollingScan.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    const std::size_t RollingScan::MAX_SECTOR_COUNT;
+
+    // As the Driver ends a revolution, a window this close to 360 degrees covers the revolution
+    static const double DEVIATION_FROM_360_DEG = 1;
+
+    // What an empty window's timestamps are
+    static const std::chrono::system_clock::time_point NO_TIMESTAMP;
+
+    void RollingScan::addSector(const SectorView& sectorView)
+    {
+        if (sectorView.getPointCount() == 0)
+        {
+            return;
+        }
+
+        double unwrappedStartAngle_deg = sectorView.getStartAngle_deg();
+
+        if (sectorCount > 0)
+        {
+            // Sectors arrive in order round the revolution, so the newest sector starts ahead of the one before it
+            const Slot& newest = getSlot(sectorCount - 1);
+
+            double step_deg = std::fmod(sectorView.getStartAngle_deg() - newest.startAngle_deg, 360.0);
+            unwrappedStartAngle_deg = newest.unwrappedStartAngle_deg + (step_deg < 0 ? step_deg + 360 : step_deg);
+        }
+
+        if (sectorCount == slots.size())
+        {
+            if (slots.size() < MAX_SECTOR_COUNT)
+            {
+                // Unrolled so the ring can grow at its end
+                std::rotate(slots.begin(), slots.begin() + firstSlot, slots.end());
+                firstSlot = 0;
+                slots.push_back(Slot());
+            }
+            else
+            {
+                pointCount -= slots[firstSlot].ranges_mm.size();
+                firstSlot = (firstSlot + 1) % slots.size();
+                sectorCount--;
+            }
+        }
+
+        Slot& slot = slots[(firstSlot + sectorCount) % slots.size()];
+        slot.timestamp = sectorView.getTimestamp();
+        slot.startAngle_deg = sectorView.getStartAngle_deg();
+        slot.endAngle_deg = sectorView.getEndAngle_deg();
+        slot.partial = sectorView.isPartial();
+        slot.unwrappedStartAngle_deg = unwrappedStartAngle_deg;
+
+        // The only copy of the points, the slot's memory is reused once the ring has grown
+        slot.ranges_mm.assign(sectorView.getRanges_mm(), sectorView.getRanges_mm() + sectorView.getPointCount());
+        slot.intensities.assign(sectorView.getIntensities(), sectorView.getIntensities() + sectorView.getPointCount());
+
+        sectorCount++;
+        pointCount += sectorView.getPointCount();
+
+        // Drop the oldest sectors while the sectors after them still cover the revolution
+        double newestEndAngle_deg = getUnwrappedEndAngle_deg(slot);
+
+        while (sectorCount > 1 && newestEndAngle_deg - getSlot(1).unwrappedStartAngle_deg + DEVIATION_FROM_360_DEG >= 360)
+        {
+            pointCount -= slots[firstSlot].ranges_mm.size();
+            firstSlot = (firstSlot + 1) % slots.size();
+            sectorCount--;
+        }
+
+        // Keep the unwrapped angles small, so they stay exact
+        double rebase_deg = 360 * std::floor(getSlot(0).unwrappedStartAngle_deg / 360);
+
+        if (rebase_deg > 0)
+        {
+            for (std::size_t i = 0; i < sectorCount; i++)
+            {
+                slots[(firstSlot + i) % slots.size()].unwrappedStartAngle_deg -= rebase_deg;
+            }
+        }
+    }
+
+    void RollingScan::clear()
+    {
+        firstSlot = 0;
+        sectorCount = 0;
+        pointCount = 0;
+    }
+
+    std::size_t RollingScan::getSectorCount() const
+    {
+        return sectorCount;
+    }
+
+    const RollingScan::Slot& RollingScan::getSlot(std::size_t index) const
+    {
+        return slots[(firstSlot + index) % slots.size()];
+    }
+
+    double RollingScan::getUnwrappedEndAngle_deg(const Slot& slot) const
+    {
+        return slot.unwrappedStartAngle_deg + (slot.endAngle_deg - slot.startAngle_deg);
+    }
+
+    SectorView RollingScan::getSector(std::size_t index) const
+    {
+        const Slot& slot = getSlot(index);
+
+        return SectorView(slot.timestamp, slot.startAngle_deg, slot.endAngle_deg, slot.ranges_mm.size(), slot.ranges_mm.data(), slot.intensities.data(), slot.partial);
+    }
+
+    std::size_t RollingScan::getPointCount() const
+    {
+        return pointCount;
+    }
+
+    double RollingScan::getSpan_deg() const
+    {
+        if (sectorCount == 0)
+        {
+            return 0;
+        }
+
+        return getUnwrappedEndAngle_deg(getSlot(sectorCount - 1)) - getSlot(0).unwrappedStartAngle_deg;
+    }
+
+    const std::chrono::system_clock::time_point& RollingScan::getTimestamp() const
+    {
+        return sectorCount > 0 ? getSlot(0).timestamp : NO_TIMESTAMP;
+    }
+
+    const std::chrono::system_clock::time_point& RollingScan::getNewestTimestamp() const
+    {
+        return sectorCount > 0 ? getSlot(sectorCount - 1).timestamp : NO_TIMESTAMP;
+    }
+
+    ScanDataPolar RollingScan::toScanDataPolar() const
+    {
+        std::vector<PointPolar> points;
+        points.reserve(pointCount);
+
+        for (std::size_t index = 0; index < sectorCount; index++)
+        {
+            SectorView sectorView = getSector(index);
+
+            for (std::size_t i = 0; i < sectorView.getPointCount(); i++)
+            {
+                points.emplace_back(sectorView.getRange_mm(i), sectorView.getAngle_deg(i), sectorView.getIntensity(i));
+            }
+        }
+
+        return ScanDataPolar(points, getTimestamp());
+    }
+}
+}
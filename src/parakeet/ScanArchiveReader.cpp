@@ -0,0 +1,220 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ScanArchiveReader.h>
+
+#include <parakeet/exceptions/UnableToOpenFileException.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    using namespace internal;
+
+    static std::int64_t toNanoseconds(const std::chrono::system_clock::time_point& timestamp)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    }
+
+    static bool isBefore(const ScanArchiveFormat::IndexEntry& entry, std::uint32_t sensorId, std::int64_t timestamp_ns)
+    {
+        return entry.sensorId != sensorId ? entry.sensorId < sensorId : entry.timestamp_ns < timestamp_ns;
+    }
+
+    ScanArchiveReader::ScanArchiveReader(const std::string& path)
+    {
+        if (!file.openReadOnly(path) || file.size() < sizeof(ScanArchiveFormat::FileHeader))
+        {
+            throw exceptions::UnableToOpenFileException(path);
+        }
+
+        ScanArchiveFormat::FileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, ScanArchiveFormat::MAGIC, sizeof(header.magic)) != 0 || header.version != ScanArchiveFormat::VERSION)
+        {
+            throw exceptions::UnableToOpenFileException(path);
+        }
+
+        loadIndex();
+    }
+
+    void ScanArchiveReader::loadIndex()
+    {
+        std::size_t size = file.size();
+        std::uint64_t scansEnd = size;
+
+        if (size >= sizeof(ScanArchiveFormat::FileHeader) + sizeof(ScanArchiveFormat::Footer))
+        {
+            ScanArchiveFormat::Footer footer;
+            std::memcpy(&footer, file.data() + size - sizeof(footer), sizeof(footer));
+
+            // Checked term by term, so a corrupt count or offset cannot overflow its way to the right total
+            std::uint64_t spaceBeforeFooter = size - sizeof(footer);
+            bool footerValid = std::memcmp(footer.magic, ScanArchiveFormat::FOOTER_MAGIC, sizeof(footer.magic)) == 0 &&
+                footer.indexOffset >= sizeof(ScanArchiveFormat::FileHeader) && footer.indexOffset <= spaceBeforeFooter &&
+                footer.indexOffset % ScanArchiveFormat::ALIGNMENT == 0 &&
+                footer.entryCount == (spaceBeforeFooter - footer.indexOffset) / sizeof(ScanArchiveFormat::IndexEntry) &&
+                (spaceBeforeFooter - footer.indexOffset) % sizeof(ScanArchiveFormat::IndexEntry) == 0;
+
+            if (footerValid)
+            {
+                index = reinterpret_cast<const ScanArchiveFormat::IndexEntry*>(file.data() + footer.indexOffset);
+                indexSize = static_cast<std::size_t>(footer.entryCount);
+
+                if (isIndexValid(footer.indexOffset))
+                {
+                    return;
+                }
+
+                scansEnd = footer.indexOffset;
+            }
+        }
+
+        // Scanned through instead, which only finds scans lying wholly before the index, or within the file
+        rebuildIndex(static_cast<std::size_t>(scansEnd));
+    }
+
+    bool ScanArchiveReader::isIndexValid(std::uint64_t indexOffset) const
+    {
+        for (std::size_t position = 0; position < indexSize; position++)
+        {
+            const ScanArchiveFormat::IndexEntry& entry = index[position];
+
+            // Every scan lies between the file header and the index, aligned for its columns
+            bool inBounds = entry.offset >= sizeof(ScanArchiveFormat::FileHeader) && entry.offset <= indexOffset &&
+                ScanArchiveFormat::scanLength(entry.pointCount) <= indexOffset - entry.offset &&
+                entry.offset % ScanArchiveFormat::ALIGNMENT == 0;
+
+            // And the entries are in the order they are searched in
+            bool inOrder = position == 0 || !isBefore(entry, index[position - 1].sensorId, index[position - 1].timestamp_ns);
+
+            if (!inBounds || !inOrder)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void ScanArchiveReader::rebuildIndex(std::size_t scansEnd)
+    {
+        std::size_t offset = sizeof(ScanArchiveFormat::FileHeader);
+
+        while (offset + sizeof(ScanArchiveFormat::ScanHeader) <= scansEnd)
+        {
+            ScanArchiveFormat::ScanHeader header;
+            std::memcpy(&header, file.data() + offset, sizeof(header));
+
+            std::uint64_t length = ScanArchiveFormat::scanLength(header.pointCount);
+            if (length > scansEnd - offset)
+            {
+                // The last scan was only partly written
+                break;
+            }
+
+            ScanArchiveFormat::IndexEntry entry;
+            entry.timestamp_ns = header.timestamp_ns;
+            entry.sensorId = header.sensorId;
+            entry.pointCount = header.pointCount;
+            entry.offset = offset;
+            rebuiltIndex.push_back(entry);
+
+            offset += static_cast<std::size_t>(length);
+        }
+
+        std::stable_sort(rebuiltIndex.begin(), rebuiltIndex.end(), [](const ScanArchiveFormat::IndexEntry& a, const ScanArchiveFormat::IndexEntry& b)
+        {
+            return isBefore(a, b.sensorId, b.timestamp_ns);
+        });
+
+        index = rebuiltIndex.data();
+        indexSize = rebuiltIndex.size();
+    }
+
+    std::size_t ScanArchiveReader::getScanCount() const
+    {
+        return indexSize;
+    }
+
+    std::vector<std::uint32_t> ScanArchiveReader::getSensorIds() const
+    {
+        std::vector<std::uint32_t> sensorIds;
+
+        std::size_t position = 0;
+        while (position < indexSize)
+        {
+            std::uint32_t sensorId = index[position].sensorId;
+            sensorIds.push_back(sensorId);
+
+            if (sensorId == UINT32_MAX)
+            {
+                break;
+            }
+
+            position = lowerBound(sensorId + 1, INT64_MIN);
+        }
+
+        return sensorIds;
+    }
+
+    ScanView ScanArchiveReader::getScan(std::size_t position) const
+    {
+        const ScanArchiveFormat::IndexEntry& entry = index[position];
+
+        const unsigned char* scan = file.data() + entry.offset + sizeof(ScanArchiveFormat::ScanHeader);
+        const float* ranges_mm = reinterpret_cast<const float*>(scan);
+        const float* angles_deg = ranges_mm + entry.pointCount;
+        const std::uint16_t* intensities = reinterpret_cast<const std::uint16_t*>(angles_deg + entry.pointCount);
+
+        std::chrono::system_clock::time_point timestamp(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(entry.timestamp_ns)));
+
+        return ScanView(entry.sensorId, timestamp, entry.pointCount, ranges_mm, angles_deg, intensities);
+    }
+
+    std::size_t ScanArchiveReader::lowerBound(std::uint32_t sensorId, std::int64_t timestamp_ns) const
+    {
+        const ScanArchiveFormat::IndexEntry* position = std::lower_bound(index, index + indexSize, 0,
+            [sensorId, timestamp_ns](const ScanArchiveFormat::IndexEntry& entry, int)
+        {
+            return isBefore(entry, sensorId, timestamp_ns);
+        });
+
+        return static_cast<std::size_t>(position - index);
+    }
+
+    bool ScanArchiveReader::findScan(std::uint32_t sensorId, const std::chrono::system_clock::time_point& timestamp, ScanView& scanView) const
+    {
+        std::int64_t timestamp_ns = toNanoseconds(timestamp);
+
+        // The first scan starting after the timestamp, the one before it is the scan being received at that moment
+        std::size_t position = timestamp_ns == INT64_MAX ? lowerBound(sensorId + 1, INT64_MIN) : lowerBound(sensorId, timestamp_ns + 1);
+
+        if (position == 0 || index[position - 1].sensorId != sensorId)
+        {
+            return false;
+        }
+
+        scanView = getScan(position - 1);
+        return true;
+    }
+
+    std::vector<ScanView> ScanArchiveReader::findScans(std::uint32_t sensorId, const std::chrono::system_clock::time_point& from, const std::chrono::system_clock::time_point& to) const
+    {
+        std::vector<ScanView> scanViews;
+
+        std::size_t end = lowerBound(sensorId, toNanoseconds(to));
+        for (std::size_t position = lowerBound(sensorId, toNanoseconds(from)); position < end; position++)
+        {
+            scanViews.push_back(getScan(position));
+        }
+
+        return scanViews;
+    }
+}
+}
@@ -0,0 +1,149 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ScanArchiveWriter.h>
+
+#include <parakeet/exceptions/UnableToOpenFileException.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    using namespace internal;
+
+    ScanArchiveWriter::ScanArchiveWriter(const std::string& path)
+    {
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw exceptions::UnableToOpenFileException(path);
+        }
+
+        ScanArchiveFormat::FileHeader header = {};
+        std::memcpy(header.magic, ScanArchiveFormat::MAGIC, sizeof(header.magic));
+        header.version = ScanArchiveFormat::VERSION;
+
+        if (std::fwrite(&header, sizeof(header), 1, file) != 1)
+        {
+            std::fclose(file);
+            file = nullptr;
+            throw exceptions::UnableToOpenFileException(path);
+        }
+
+        offset = sizeof(header);
+    }
+
+    ScanArchiveWriter::~ScanArchiveWriter()
+    {
+        close();
+    }
+
+    bool ScanArchiveWriter::write(const ScanDataPolar& scanDataPolar, std::uint32_t sensorId)
+    {
+        if (file == nullptr || writeError)
+        {
+            return false;
+        }
+
+        const std::vector<PointPolar>& points = scanDataPolar.getPoints();
+        std::uint32_t pointCount = static_cast<std::uint32_t>(points.size());
+
+        ScanArchiveFormat::ScanHeader header;
+        header.sensorId = sensorId;
+        header.pointCount = pointCount;
+        header.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(scanDataPolar.getTimestamp().time_since_epoch()).count();
+
+        scanBuffer.assign(static_cast<std::size_t>(ScanArchiveFormat::scanLength(pointCount)), 0);
+        std::memcpy(scanBuffer.data(), &header, sizeof(header));
+
+        float* ranges_mm = reinterpret_cast<float*>(scanBuffer.data() + sizeof(header));
+        float* angles_deg = ranges_mm + pointCount;
+        std::uint16_t* intensities = reinterpret_cast<std::uint16_t*>(angles_deg + pointCount);
+
+        for (std::uint32_t i = 0; i < pointCount; i++)
+        {
+            ranges_mm[i] = static_cast<float>(points[i].getRange_mm());
+            angles_deg[i] = static_cast<float>(points[i].getAngle_deg());
+            intensities[i] = points[i].getIntensity();
+        }
+
+        if (std::fwrite(scanBuffer.data(), scanBuffer.size(), 1, file) != 1)
+        {
+            // The scan may be partly written, so no later scan could be found where the index would say it is
+            writeError = true;
+            return false;
+        }
+
+        ScanArchiveFormat::IndexEntry entry;
+        entry.timestamp_ns = header.timestamp_ns;
+        entry.sensorId = sensorId;
+        entry.pointCount = pointCount;
+        entry.offset = offset;
+        index.push_back(entry);
+
+        offset += scanBuffer.size();
+
+        return true;
+    }
+
+    bool ScanArchiveWriter::close()
+    {
+        if (file == nullptr)
+        {
+            return !writeError;
+        }
+
+        // Without an index the reader scans through the file, and finds every scan which was written whole
+        if (writeError)
+        {
+            std::fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        std::stable_sort(index.begin(), index.end(), [](const ScanArchiveFormat::IndexEntry& a, const ScanArchiveFormat::IndexEntry& b)
+        {
+            return a.sensorId != b.sensorId ? a.sensorId < b.sensorId : a.timestamp_ns < b.timestamp_ns;
+        });
+
+        if (!index.empty() && std::fwrite(index.data(), sizeof(ScanArchiveFormat::IndexEntry), index.size(), file) != index.size())
+        {
+            writeError = true;
+        }
+
+        ScanArchiveFormat::Footer footer;
+        footer.indexOffset = offset;
+        footer.entryCount = index.size();
+        std::memcpy(footer.magic, ScanArchiveFormat::FOOTER_MAGIC, sizeof(footer.magic));
+
+        if (!writeError && std::fwrite(&footer, sizeof(footer), 1, file) != 1)
+        {
+            writeError = true;
+        }
+
+        // Buffered writes may only fail as they are flushed
+        if (std::fclose(file) != 0)
+        {
+            writeError = true;
+        }
+
+        file = nullptr;
+
+        return !writeError;
+    }
+
+    std::size_t ScanArchiveWriter::getScanCount() const
+    {
+        return index.size();
+    }
+
+    bool ScanArchiveWriter::hasWriteError() const
+    {
+        return writeError;
+    }
+}
+}
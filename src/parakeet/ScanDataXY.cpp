@@ -4,6 +4,8 @@
 
 #include <parakeet/ScanDataXY.h>
 
+#include <utility>
+
 namespace mechaspin
 {
 namespace parakeet
@@ -14,6 +16,12 @@ namespace parakeet
         this->vectorOfCartesianPoints = pointXYList;
     }
 
+    ScanDataXY::ScanDataXY(std::vector<PointXY>&& pointXYList, const std::chrono::time_point<std::chrono::system_clock>& timestampOfFirstPoint) :
+        vectorOfCartesianPoints(std::move(pointXYList)),
+        timestampOfFirstPoint(timestampOfFirstPoint)
+    {
+    }
+
     const std::chrono::time_point<std::chrono::system_clock>& ScanDataXY::getTimestamp() const
     {
         return timestampOfFirstPoint;
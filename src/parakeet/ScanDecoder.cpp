@@ -0,0 +1,145 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ScanDecoder.h>
+
+#include <parakeet/internal/BitPacking.h>
+#include <parakeet/internal/ScanCodecFormat.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    using namespace internal;
+
+    // Guards against allocating for a corrupt point count
+    const std::uint64_t MAX_POINT_COUNT = 1 << 20;
+
+    void ScanDecoder::reset()
+    {
+        hasPreviousScan = false;
+    }
+
+    std::size_t ScanDecoder::decode(const unsigned char* data, std::size_t length, std::vector<PointPolar>& points, std::chrono::system_clock::time_point& timestamp)
+    {
+        if (length < 2 || data[0] != ScanCodecFormat::VERSION)
+        {
+            return 0;
+        }
+
+        bool useInterScanDelta = (data[1] & ScanCodecFormat::INTER_SCAN_DELTA) != 0;
+        std::size_t offset = 2;
+
+        std::uint64_t pointCount;
+        std::size_t read = BitPacking::readVarint(data + offset, length - offset, pointCount);
+        if (read == 0 || pointCount > MAX_POINT_COUNT)
+        {
+            return 0;
+        }
+        offset += read;
+
+        std::uint64_t codedTimestamp;
+        read = BitPacking::readVarint(data + offset, length - offset, codedTimestamp);
+        if (read == 0)
+        {
+            return 0;
+        }
+        offset += read;
+
+        if (useInterScanDelta && (!hasPreviousScan || previousRanges.size() != pointCount))
+        {
+            return 0;
+        }
+
+        std::int64_t timestamp_ns = BitPacking::zigzagDecode64(codedTimestamp);
+        if (useInterScanDelta)
+        {
+            timestamp_ns += previousTimestamp_ns;
+        }
+
+        std::size_t count = static_cast<std::size_t>(pointCount);
+
+        read = decodeChannel(data + offset, length - offset, count, ranges, previousRanges, useInterScanDelta, false);
+        if (read == 0 && count > 0)
+        {
+            return 0;
+        }
+        offset += read;
+
+        read = decodeChannel(data + offset, length - offset, count, angles, previousAngles, useInterScanDelta, true);
+        if (read == 0 && count > 0)
+        {
+            return 0;
+        }
+        offset += read;
+
+        read = decodeChannel(data + offset, length - offset, count, intensities, previousIntensities, useInterScanDelta, false);
+        if (read == 0 && count > 0)
+        {
+            return 0;
+        }
+        offset += read;
+
+        points.clear();
+        points.reserve(count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            points.push_back(PointPolar(ranges[i] / ScanCodecFormat::RANGE_UNITS_PER_MM, angles[i] / ScanCodecFormat::ANGLE_UNITS_PER_DEGREE, static_cast<std::uint16_t>(intensities[i])));
+        }
+
+        timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+
+        ranges.swap(previousRanges);
+        angles.swap(previousAngles);
+        intensities.swap(previousIntensities);
+        previousTimestamp_ns = timestamp_ns;
+        hasPreviousScan = true;
+
+        return offset;
+    }
+
+    std::size_t ScanDecoder::decodeChannel(const unsigned char* data, std::size_t length, std::size_t count, std::vector<std::int32_t>& values, std::vector<std::int32_t>& previousValues, bool useInterScanDelta, bool secondOrder)
+    {
+        residuals.resize(count);
+        values.resize(count);
+
+        std::size_t read = BitPacking::unpack(data, length, residuals.data(), count);
+        if (read == 0)
+        {
+            return 0;
+        }
+
+        if (useInterScanDelta)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                values[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(previousValues[i]) + static_cast<std::uint32_t>(BitPacking::zigzagDecode(residuals[i])));
+            }
+        }
+        else if (secondOrder)
+        {
+            std::uint32_t previous = 0;
+            std::uint32_t step = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                step += static_cast<std::uint32_t>(BitPacking::zigzagDecode(residuals[i]));
+                previous += step;
+                values[i] = static_cast<std::int32_t>(previous);
+            }
+        }
+        else
+        {
+            std::uint32_t previous = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                previous += static_cast<std::uint32_t>(BitPacking::zigzagDecode(residuals[i]));
+                values[i] = static_cast<std::int32_t>(previous);
+            }
+        }
+
+        return read;
+    }
+}
+}
@@ -0,0 +1,109 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ScanEncoder.h>
+
+#include <parakeet/internal/BitPacking.h>
+#include <parakeet/internal/ScanCodecFormat.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    using namespace internal;
+
+    // Round half away from zero, like std::lround, but cheap enough to run per point
+    static std::int32_t roundToInt32(double value)
+    {
+        return static_cast<std::int32_t>(value + (value >= 0 ? 0.5 : -0.5));
+    }
+
+    ScanEncoder::ScanEncoder(bool interScanDelta) : interScanDelta(interScanDelta)
+    {
+    }
+
+    void ScanEncoder::reset()
+    {
+        hasPreviousScan = false;
+    }
+
+    void ScanEncoder::encode(const ScanDataPolar& scanDataPolar, std::vector<unsigned char>& output)
+    {
+        const std::vector<PointPolar>& points = scanDataPolar.getPoints();
+        std::size_t pointCount = points.size();
+
+        ranges.resize(pointCount);
+        angles.resize(pointCount);
+        intensities.resize(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            ranges[i] = roundToInt32(points[i].getRange_mm() * ScanCodecFormat::RANGE_UNITS_PER_MM);
+            angles[i] = roundToInt32(points[i].getAngle_deg() * ScanCodecFormat::ANGLE_UNITS_PER_DEGREE);
+            intensities[i] = points[i].getIntensity();
+        }
+
+        std::int64_t timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(scanDataPolar.getTimestamp().time_since_epoch()).count();
+
+        // Points can only be paired with the previous scan's when both have the same layout
+        bool useInterScanDelta = interScanDelta && hasPreviousScan && previousRanges.size() == pointCount;
+
+        output.push_back(ScanCodecFormat::VERSION);
+        output.push_back(useInterScanDelta ? ScanCodecFormat::INTER_SCAN_DELTA : 0);
+
+        BitPacking::writeVarint(pointCount, output);
+        BitPacking::writeVarint(BitPacking::zigzagEncode64(useInterScanDelta ? timestamp_ns - previousTimestamp_ns : timestamp_ns), output);
+
+        encodeChannel(ranges, previousRanges, useInterScanDelta, false, output);
+        encodeChannel(angles, previousAngles, useInterScanDelta, true, output);
+        encodeChannel(intensities, previousIntensities, useInterScanDelta, false, output);
+
+        ranges.swap(previousRanges);
+        angles.swap(previousAngles);
+        intensities.swap(previousIntensities);
+        previousTimestamp_ns = timestamp_ns;
+        hasPreviousScan = true;
+    }
+
+    void ScanEncoder::encodeChannel(const std::vector<std::int32_t>& values, const std::vector<std::int32_t>& previousValues, bool useInterScanDelta, bool secondOrder, std::vector<unsigned char>& output)
+    {
+        std::size_t count = values.size();
+        residuals.resize(count);
+
+        // Differences are taken as unsigned values, so extreme inputs wrap rather than overflow
+        if (useInterScanDelta)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                residuals[i] = BitPacking::zigzagEncode(static_cast<std::int32_t>(static_cast<std::uint32_t>(values[i]) - static_cast<std::uint32_t>(previousValues[i])));
+            }
+        }
+        else if (secondOrder)
+        {
+            // Angles step evenly within a sector, so the change in the step is usually zero
+            std::uint32_t previous = 0;
+            std::uint32_t previousStep = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                std::uint32_t step = static_cast<std::uint32_t>(values[i]) - previous;
+                residuals[i] = BitPacking::zigzagEncode(static_cast<std::int32_t>(step - previousStep));
+
+                previous = static_cast<std::uint32_t>(values[i]);
+                previousStep = step;
+            }
+        }
+        else
+        {
+            std::uint32_t previous = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                residuals[i] = BitPacking::zigzagEncode(static_cast<std::int32_t>(static_cast<std::uint32_t>(values[i]) - previous));
+                previous = static_cast<std::uint32_t>(values[i]);
+            }
+        }
+
+        BitPacking::pack(residuals.data(), count, output);
+    }
+}
+}
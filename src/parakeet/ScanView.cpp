@@ -0,0 +1,80 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/ScanView.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    ScanView::ScanView(std::uint32_t sensorId, const std::chrono::system_clock::time_point& timestamp, std::size_t pointCount,
+        const float* ranges_mm, const float* angles_deg, const std::uint16_t* intensities) :
+        sensorId(sensorId),
+        timestamp(timestamp),
+        pointCount(pointCount),
+        ranges_mm(ranges_mm),
+        angles_deg(angles_deg),
+        intensities(intensities)
+    {
+    }
+
+    std::uint32_t ScanView::getSensorId() const
+    {
+        return sensorId;
+    }
+
+    const std::chrono::system_clock::time_point& ScanView::getTimestamp() const
+    {
+        return timestamp;
+    }
+
+    std::size_t ScanView::getPointCount() const
+    {
+        return pointCount;
+    }
+
+    float ScanView::getRange_mm(std::size_t index) const
+    {
+        return ranges_mm[index];
+    }
+
+    float ScanView::getAngle_deg(std::size_t index) const
+    {
+        return angles_deg[index];
+    }
+
+    std::uint16_t ScanView::getIntensity(std::size_t index) const
+    {
+        return intensities[index];
+    }
+
+    const float* ScanView::getRanges_mm() const
+    {
+        return ranges_mm;
+    }
+
+    const float* ScanView::getAngles_deg() const
+    {
+        return angles_deg;
+    }
+
+    const std::uint16_t* ScanView::getIntensities() const
+    {
+        return intensities;
+    }
+
+    ScanDataPolar ScanView::toScanDataPolar() const
+    {
+        std::vector<PointPolar> points;
+        points.reserve(pointCount);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            points.push_back(PointPolar(ranges_mm[i], angles_deg[i], intensities[i]));
+        }
+
+        return ScanDataPolar(points, timestamp);
+    }
+}
+}
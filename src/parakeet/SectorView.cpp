@@ -0,0 +1,84 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/SectorView.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+    SectorView::SectorView(const std::chrono::system_clock::time_point& timestamp, double startAngle_deg, double endAngle_deg, std::size_t pointCount,
+        const std::uint16_t* ranges_mm, const std::uint8_t* intensities, bool partial) :
+        timestamp(timestamp),
+        startAngle_deg(startAngle_deg),
+        endAngle_deg(endAngle_deg),
+        pointCount(pointCount),
+        ranges_mm(ranges_mm),
+        intensities(intensities),
+        partial(partial)
+    {
+    }
+
+    const std::chrono::system_clock::time_point& SectorView::getTimestamp() const
+    {
+        return timestamp;
+    }
+
+    double SectorView::getStartAngle_deg() const
+    {
+        return startAngle_deg;
+    }
+
+    double SectorView::getEndAngle_deg() const
+    {
+        return endAngle_deg;
+    }
+
+    double SectorView::getAnglePerPoint_deg() const
+    {
+        return pointCount > 0 ? (endAngle_deg - startAngle_deg) / pointCount : 0;
+    }
+
+    std::size_t SectorView::getPointCount() const
+    {
+        return pointCount;
+    }
+
+    std::uint16_t SectorView::getRange_mm(std::size_t index) const
+    {
+        return ranges_mm[index];
+    }
+
+    double SectorView::getAngle_deg(std::size_t index) const
+    {
+        return startAngle_deg + (getAnglePerPoint_deg() * index);
+    }
+
+    std::uint8_t SectorView::getIntensity(std::size_t index) const
+    {
+        return intensities[index];
+    }
+
+    const std::uint16_t* SectorView::getRanges_mm() const
+    {
+        return ranges_mm;
+    }
+
+    const std::uint8_t* SectorView::getIntensities() const
+    {
+        return intensities;
+    }
+
+    bool SectorView::isPartial() const
+    {
+        return partial;
+    }
+
+    bool SectorView::isLastOfRevolution() const
+    {
+        // The same test the Driver uses to end a revolution
+        return endAngle_deg + 1 >= 360;
+    }
+}
+}
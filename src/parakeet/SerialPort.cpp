@@ -22,17 +22,16 @@ namespace mechaspin
 {
 namespace parakeet
 {
-    #if defined(_WIN32)
-        HANDLE hPort = 0;
-    #elif defined(__linux) || defined(linux) || defined(__linux__)
-        int hPort = 0;
-    #endif
-
     bool SerialPort::isConnected() const
     {
         return hPort != 0;
     }
 
+    bool SerialPort::hasReadError() const
+    {
+        return readError;
+    }
+
     void SerialPort::close()
     {
         if (!isConnected())
@@ -168,10 +167,13 @@ namespace parakeet
     {
         DWORD dw = 0;
 
+        readError = false;
+
         if (isConnected())
         {
             if (!ReadFile(hPort, line + length, bufferSize - length, &dw, NULL))
             {
+                readError = true;
                 dw = 0;
             }
         }
@@ -228,9 +230,10 @@ namespace parakeet
 
         int readChars = ::read(hPort, line + length, bufferSize - length);
 
-        if (readChars < 0)
+        readError = readChars < 0;
+
+        if (readError)
         {
-            printf("Error %i from read: %s\n", errno, strerror(errno));
             return 0;
         }
 
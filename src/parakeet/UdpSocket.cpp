@@ -54,6 +54,12 @@ namespace parakeet
 			return false;
 		}
 
+		#if defined(__linux) || defined(linux) || defined(__linux__)
+			// Have the kernel timestamp datagrams on arrival, so recordings are not skewed by scheduling delays
+			int enableTimestamps = 1;
+			setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enableTimestamps, sizeof(enableTimestamps));
+		#endif
+
 		return true;
 	}
 
@@ -73,40 +79,76 @@ namespace parakeet
 
 	int UdpSocket::read(const mechaspin::parakeet::internal::BufferData& bufferData, int bufferMaxSize)
 	{
+		readError = false;
+
 		if (isConnected())
 		{
 			fd_set fds;
 			FD_ZERO(&fds);
 			FD_SET(socket, &fds);
 
-			struct timeval to = { 1, 0 };
+			struct timeval to;
+			to.tv_sec = static_cast<long>(readTimeout.count() / 1000);
+			to.tv_usec = static_cast<long>((readTimeout.count() % 1000) * 1000);
 			int ret = select(static_cast<int>(socket) + 1, &fds, NULL, NULL, &to);
 
+			if (ret < 0)
+			{
+				readError = true;
+				return 0;
+			}
+
 			if (ret > 0 && FD_ISSET(socket, &fds))
 			{
 				sockaddr_in addr;
 
 				#if defined(_WIN32)
 					int size = sizeof(addr);
+
+					int charsRead = recvfrom(socket, 
+						(char*)bufferData.buffer + bufferData.length, 
+						bufferMaxSize - bufferData.length, 0,
+						(struct sockaddr*)&addr, &size);
+
+					lastReadTimestamp = std::chrono::system_clock::now();
+					lastReadTimestampFromKernel = false;
 				#elif defined(__linux) || defined(linux) || defined(__linux__)
-					socklen_t size = sizeof(addr);
+					iovec data;
+					data.iov_base = bufferData.buffer + bufferData.length;
+					data.iov_len = bufferMaxSize - bufferData.length;
+
+					char control[CMSG_SPACE(sizeof(timespec))];
+
+					msghdr message = {};
+					message.msg_name = &addr;
+					message.msg_namelen = sizeof(addr);
+					message.msg_iov = &data;
+					message.msg_iovlen = 1;
+					message.msg_control = control;
+					message.msg_controllen = sizeof(control);
+
+					int charsRead = static_cast<int>(recvmsg(socket, &message, 0));
+
+					lastReadTimestamp = std::chrono::system_clock::now();
+					lastReadTimestampFromKernel = false;
+
+					for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message, header))
+					{
+						if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS)
+						{
+							timespec kernelTimestamp;
+							std::memcpy(&kernelTimestamp, CMSG_DATA(header), sizeof(kernelTimestamp));
+
+							lastReadTimestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+								std::chrono::seconds(kernelTimestamp.tv_sec) + std::chrono::nanoseconds(kernelTimestamp.tv_nsec)));
+							lastReadTimestampFromKernel = true;
+						}
+					}
 				#endif
 
-				int charsRead = recvfrom(socket, 
-					(char*)bufferData.buffer + bufferData.length, 
-					bufferMaxSize - bufferData.length, 0,
-					(struct sockaddr*)&addr, &size);
-
 				if (charsRead == -1)
 				{
-					/*
-					#if defined(_WIN32)
-						auto lastError = WSAGetLastError();
-                        std::cout << "Oh dear, something went wrong with read()! " << lastError << strerror(lastError) << std::endl;
-					#elif defined(__linux) || defined(linux) || defined(__linux__)
-						std::cout << "Oh dear, something went wrong with read()!" << strerror(errno) << std::endl;
-					#endif
-					*/
+					readError = true;
 					return 0;
 				}
 				else
@@ -176,5 +218,25 @@ namespace parakeet
 	{
 		return socket != 0;
 	}
+
+	bool UdpSocket::hasReadError() const
+	{
+		return readError;
+	}
+
+	std::chrono::system_clock::time_point UdpSocket::getLastReadTimestamp() const
+	{
+		return lastReadTimestamp;
+	}
+
+	bool UdpSocket::isLastReadTimestampFromKernel() const
+	{
+		return lastReadTimestampFromKernel;
+	}
+
+	void UdpSocket::setReadTimeout(std::chrono::milliseconds timeout)
+	{
+		readTimeout = timeout;
+	}
 }
 }
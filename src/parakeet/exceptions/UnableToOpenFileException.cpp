@@ -0,0 +1,19 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/exceptions/UnableToOpenFileException.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace exceptions
+{
+    UnableToOpenFileException::UnableToOpenFileException(const std::string& path) : std::runtime_error("Unable to open file: " + path)
+    {
+
+    }
+}
+}
+}
@@ -0,0 +1,174 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/BitPacking.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+namespace BitPacking
+{
+    const std::size_t MAX_VARINT_LENGTH = 10;
+
+    static unsigned int bitWidth(std::uint32_t value)
+    {
+        unsigned int width = 0;
+        while (value != 0)
+        {
+            width++;
+            value >>= 1;
+        }
+        return width;
+    }
+
+    void writeVarint(std::uint64_t value, std::vector<unsigned char>& output)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<unsigned char>(value));
+    }
+
+    std::size_t readVarint(const unsigned char* data, std::size_t length, std::uint64_t& value)
+    {
+        value = 0;
+
+        for (std::size_t i = 0; i < length && i < MAX_VARINT_LENGTH; i++)
+        {
+            value |= static_cast<std::uint64_t>(data[i] & 0x7F) << (7 * i);
+
+            if ((data[i] & 0x80) == 0)
+            {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    void pack(const std::uint32_t* values, std::size_t count, std::vector<unsigned char>& output)
+    {
+        for (std::size_t blockStart = 0; blockStart < count; blockStart += BLOCK_SIZE)
+        {
+            std::size_t blockCount = std::min(BLOCK_SIZE, count - blockStart);
+            const std::uint32_t* block = values + blockStart;
+
+            // OR-ing the block gives the width of its largest value, and vectorizes well
+            std::uint32_t combined = 0;
+            for (std::size_t i = 0; i < blockCount; i++)
+            {
+                combined |= block[i];
+            }
+
+            unsigned int width = bitWidth(combined);
+            output.push_back(static_cast<unsigned char>(width));
+
+            if (width == 0)
+            {
+                continue;
+            }
+
+            std::size_t packedLength = (blockCount * width + 7) / 8;
+            std::size_t start = output.size();
+            output.resize(start + packedLength + sizeof(std::uint32_t));
+
+            unsigned char* destination = output.data() + start;
+            std::uint64_t accumulator = 0;
+            unsigned int accumulatedBits = 0;
+
+            for (std::size_t i = 0; i < blockCount; i++)
+            {
+                accumulator |= static_cast<std::uint64_t>(block[i]) << accumulatedBits;
+                accumulatedBits += width;
+
+                if (accumulatedBits >= 32)
+                {
+                    std::uint32_t word = static_cast<std::uint32_t>(accumulator);
+                    std::memcpy(destination, &word, sizeof(word));
+                    destination += sizeof(word);
+
+                    accumulator >>= 32;
+                    accumulatedBits -= 32;
+                }
+            }
+
+            // The spare word reserved above lets the final partial word be written whole
+            std::uint32_t word = static_cast<std::uint32_t>(accumulator);
+            std::memcpy(destination, &word, sizeof(word));
+
+            output.resize(start + packedLength);
+        }
+    }
+
+    std::size_t unpack(const unsigned char* data, std::size_t length, std::uint32_t* values, std::size_t count)
+    {
+        std::size_t offset = 0;
+
+        for (std::size_t blockStart = 0; blockStart < count; blockStart += BLOCK_SIZE)
+        {
+            std::size_t blockCount = std::min(BLOCK_SIZE, count - blockStart);
+            std::uint32_t* block = values + blockStart;
+
+            if (offset >= length)
+            {
+                return 0;
+            }
+
+            unsigned int width = data[offset++];
+            if (width > 32)
+            {
+                return 0;
+            }
+
+            if (width == 0)
+            {
+                std::fill(block, block + blockCount, 0);
+                continue;
+            }
+
+            std::size_t packedLength = (blockCount * width + 7) / 8;
+            if (offset + packedLength > length)
+            {
+                return 0;
+            }
+
+            const unsigned char* source = data + offset;
+            std::uint64_t mask = (static_cast<std::uint64_t>(1) << width) - 1;
+
+            for (std::size_t i = 0; i < blockCount; i++)
+            {
+                std::size_t bitPosition = i * width;
+                std::size_t bytePosition = bitPosition / 8;
+
+                // Read a 64 bit window where the data allows it, and byte by byte at the very end
+                std::uint64_t window = 0;
+                if (bytePosition + sizeof(window) <= packedLength)
+                {
+                    std::memcpy(&window, source + bytePosition, sizeof(window));
+                }
+                else
+                {
+                    std::memcpy(&window, source + bytePosition, packedLength - bytePosition);
+                }
+
+                block[i] = static_cast<std::uint32_t>((window >> (bitPosition % 8)) & mask);
+            }
+
+            offset += packedLength;
+        }
+
+        return offset;
+    }
+}
+}
+}
+}
@@ -0,0 +1,420 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/CaptureReader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <parakeet/internal/CaptureFormat.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+    const std::uint32_t PCAP_MICROSECOND_MAGIC = 0xa1b2c3d4;
+    const std::uint32_t PCAP_NANOSECOND_MAGIC = 0xa1b23c4d;
+    const std::size_t PCAP_FILE_HEADER_SIZE = 24;
+    const std::size_t PCAP_RECORD_HEADER_SIZE = 16;
+
+    const std::uint32_t LINKTYPE_ETHERNET = 1;
+    const std::uint32_t LINKTYPE_RAW = 101;
+    const std::uint32_t LINKTYPE_IPV4 = 228;
+
+    const std::size_t ETHERNET_HEADER_SIZE = 14;
+    const std::size_t VLAN_TAG_SIZE = 4;
+    const std::uint16_t ETHERTYPE_IPV4 = 0x0800;
+    const std::uint16_t ETHERTYPE_VLAN = 0x8100;
+    const std::uint8_t IP_PROTOCOL_UDP = 17;
+    const std::size_t UDP_HEADER_SIZE = 8;
+
+    static bool fileExists(const std::string& path)
+    {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        return file.good();
+    }
+
+    static std::uint16_t readBigEndian16(const unsigned char* data)
+    {
+        return static_cast<std::uint16_t>((data[0] << 8) | data[1]);
+    }
+
+    static std::uint32_t byteSwap32(std::uint32_t value)
+    {
+        return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value >> 8) & 0xFF00) | (value >> 24);
+    }
+
+    static std::string formatIPv4Address(std::uint32_t address)
+    {
+        char text[16];
+        std::snprintf(text, sizeof(text), "%u.%u.%u.%u", (address >> 24) & 0xFF, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF);
+        return text;
+    }
+
+    bool CaptureReader::open(const std::string& path)
+    {
+        close();
+
+        if (fileExists(path))
+        {
+            segmentPaths.push_back(path);
+        }
+        else
+        {
+            const char* extensions[] = { CaptureFormat::SEGMENT_EXTENSION, CaptureFormat::PCAP_SEGMENT_EXTENSION };
+            for (const char* extension : extensions)
+            {
+                for (unsigned int index = 0; ; index++)
+                {
+                    char suffix[16];
+                    std::snprintf(suffix, sizeof(suffix), ".%06u", index);
+
+                    std::string segmentPath = path + suffix + extension;
+                    if (!fileExists(segmentPath))
+                    {
+                        break;
+                    }
+
+                    segmentPaths.push_back(segmentPath);
+                }
+
+                if (!segmentPaths.empty())
+                {
+                    break;
+                }
+            }
+        }
+
+        if (segmentPaths.empty() || !openSegment(0))
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool CaptureReader::close()
+    {
+        closeSegment();
+        bool success = !closeError;
+        closeError = false;
+
+        segmentPaths.clear();
+        segmentIndex = 0;
+        offset = 0;
+        udpStreamKeys.clear();
+        streams.clear();
+        streamDescribed.clear();
+
+        return success;
+    }
+
+    void CaptureReader::closeSegment()
+    {
+        if (segment.isOpen() && !segment.close())
+        {
+            closeError = true;
+        }
+    }
+
+    bool CaptureReader::isOpen() const
+    {
+        return !segmentPaths.empty();
+    }
+
+    void CaptureReader::rewind()
+    {
+        if (!segmentPaths.empty())
+        {
+            openSegment(0);
+        }
+    }
+
+    const CaptureRecorder::StreamInfo* CaptureReader::getStreamInfo(int streamId) const
+    {
+        if (streamId < 0 || streamId >= static_cast<int>(streams.size()) || !streamDescribed[streamId])
+        {
+            return nullptr;
+        }
+
+        return &streams[streamId];
+    }
+
+    bool CaptureReader::openSegment(std::size_t index)
+    {
+        closeSegment();
+        segmentIndex = index;
+
+        if (!segment.openReadOnly(segmentPaths[index]))
+        {
+            return false;
+        }
+
+        const unsigned char* data = segment.data();
+
+        if (segment.size() >= sizeof(CaptureFormat::FileHeader) && std::memcmp(data, CaptureFormat::MAGIC, sizeof(CaptureFormat::MAGIC)) == 0)
+        {
+            CaptureFormat::FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+
+            if (header.version != CaptureFormat::VERSION)
+            {
+                closeSegment();
+                return false;
+            }
+
+            segmentFormat = Native;
+            offset = sizeof(header);
+            return true;
+        }
+
+        if (segment.size() >= PCAP_FILE_HEADER_SIZE)
+        {
+            std::uint32_t magic;
+            std::memcpy(&magic, data, sizeof(magic));
+
+            pcapSwapped = magic == byteSwap32(PCAP_MICROSECOND_MAGIC) || magic == byteSwap32(PCAP_NANOSECOND_MAGIC);
+            if (pcapSwapped)
+            {
+                magic = byteSwap32(magic);
+            }
+
+            if (magic == PCAP_MICROSECOND_MAGIC || magic == PCAP_NANOSECOND_MAGIC)
+            {
+                segmentFormat = Pcap;
+                pcapNanosecond = magic == PCAP_NANOSECOND_MAGIC;
+                pcapLinkType = readPcap32(data + 20) & 0xFFFF;
+                offset = PCAP_FILE_HEADER_SIZE;
+                return true;
+            }
+        }
+
+        closeSegment();
+        return false;
+    }
+
+    bool CaptureReader::next(Record& record)
+    {
+        while (segment.isOpen())
+        {
+            bool found = segmentFormat == Native ? nextNativeRecord(record) : nextPcapRecord(record);
+            if (found)
+            {
+                return true;
+            }
+
+            if (segmentIndex + 1 >= segmentPaths.size() || !openSegment(segmentIndex + 1))
+            {
+                closeSegment();
+            }
+        }
+
+        return false;
+    }
+
+    bool CaptureReader::nextNativeRecord(Record& record)
+    {
+        const unsigned char* data = segment.data();
+
+        while (offset + sizeof(CaptureFormat::RecordHeader) <= segment.size())
+        {
+            CaptureFormat::RecordHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+
+            // The zero filled tail of a segment which was not closed cleanly reads as the end of the data
+            if (header.type == CaptureFormat::END_OF_DATA)
+            {
+                return false;
+            }
+
+            std::size_t payloadOffset = offset + sizeof(header);
+            if (payloadOffset + header.payloadLength > segment.size())
+            {
+                return false;
+            }
+
+            offset = payloadOffset + CaptureFormat::alignedLength(header.payloadLength);
+
+            if (header.type == CaptureFormat::STREAM_INFO && header.payloadLength >= sizeof(CaptureFormat::StreamInfoPayload))
+            {
+                CaptureFormat::StreamInfoPayload payload;
+                std::memcpy(&payload, data + payloadOffset, sizeof(payload));
+
+                if (sizeof(payload) + payload.sourceAddressLength + payload.descriptionLength > header.payloadLength)
+                {
+                    continue;
+                }
+
+                if (header.streamId >= streams.size())
+                {
+                    streams.resize(header.streamId + 1);
+                    streamDescribed.resize(header.streamId + 1, false);
+                }
+
+                const char* text = reinterpret_cast<const char*>(data + payloadOffset + sizeof(payload));
+
+                CaptureRecorder::StreamInfo& streamInfo = streams[header.streamId];
+                streamInfo.streamType = static_cast<CaptureRecorder::StreamType>(payload.streamType);
+                streamInfo.sourcePort = payload.sourcePort;
+                streamInfo.destinationPort = payload.destinationPort;
+                streamInfo.sourceAddress.assign(text, payload.sourceAddressLength);
+                streamInfo.description.assign(text + payload.sourceAddressLength, payload.descriptionLength);
+                streamDescribed[header.streamId] = true;
+            }
+            else if (header.type == CaptureFormat::DATA)
+            {
+                record.streamId = header.streamId;
+                record.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(header.timestamp_ns)));
+                record.kernelTimestamp = (header.flags & CaptureFormat::KERNEL_TIMESTAMP) != 0;
+                record.data = data + payloadOffset;
+                record.length = header.payloadLength;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::uint32_t CaptureReader::readPcap32(const unsigned char* data) const
+    {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+
+        return pcapSwapped ? byteSwap32(value) : value;
+    }
+
+    bool CaptureReader::nextPcapRecord(Record& record)
+    {
+        const unsigned char* data = segment.data();
+
+        while (offset + PCAP_RECORD_HEADER_SIZE <= segment.size())
+        {
+            std::uint32_t seconds = readPcap32(data + offset);
+            std::uint32_t fraction = readPcap32(data + offset + 4);
+            std::uint32_t capturedLength = readPcap32(data + offset + 8);
+
+            std::size_t packetOffset = offset + PCAP_RECORD_HEADER_SIZE;
+            if (capturedLength == 0 || packetOffset + capturedLength > segment.size())
+            {
+                return false;
+            }
+
+            offset = packetOffset + capturedLength;
+
+            if (!parseUdpDatagram(data + packetOffset, capturedLength, record))
+            {
+                continue;
+            }
+
+            std::chrono::nanoseconds timestamp = std::chrono::seconds(seconds) + (pcapNanosecond ? std::chrono::nanoseconds(fraction) : std::chrono::microseconds(fraction));
+
+            record.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(timestamp));
+            record.kernelTimestamp = true;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool CaptureReader::parseUdpDatagram(const unsigned char* packet, std::size_t length, Record& record)
+    {
+        if (pcapLinkType == LINKTYPE_ETHERNET)
+        {
+            if (length < ETHERNET_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            std::uint16_t etherType = readBigEndian16(packet + 12);
+            std::size_t headerSize = ETHERNET_HEADER_SIZE;
+
+            if (etherType == ETHERTYPE_VLAN && length >= ETHERNET_HEADER_SIZE + VLAN_TAG_SIZE)
+            {
+                etherType = readBigEndian16(packet + 16);
+                headerSize += VLAN_TAG_SIZE;
+            }
+
+            if (etherType != ETHERTYPE_IPV4)
+            {
+                return false;
+            }
+
+            packet += headerSize;
+            length -= headerSize;
+        }
+        else if (pcapLinkType != LINKTYPE_RAW && pcapLinkType != LINKTYPE_IPV4)
+        {
+            return false;
+        }
+
+        if (length < 20 || (packet[0] >> 4) != 4 || packet[9] != IP_PROTOCOL_UDP)
+        {
+            return false;
+        }
+
+        // Only the first fragment carries the UDP header
+        if ((readBigEndian16(packet + 6) & 0x1FFF) != 0)
+        {
+            return false;
+        }
+
+        std::size_t ipHeaderSize = (packet[0] & 0x0F) * 4;
+        if (length < ipHeaderSize + UDP_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        UdpStreamKey key;
+        key.sourceAddress = (static_cast<std::uint32_t>(readBigEndian16(packet + 12)) << 16) | readBigEndian16(packet + 14);
+
+        const unsigned char* udpHeader = packet + ipHeaderSize;
+        key.sourcePort = readBigEndian16(udpHeader);
+        key.destinationPort = readBigEndian16(udpHeader + 2);
+
+        std::size_t udpLength = readBigEndian16(udpHeader + 4);
+        std::size_t payloadLength = length - ipHeaderSize - UDP_HEADER_SIZE;
+        if (udpLength >= UDP_HEADER_SIZE && udpLength - UDP_HEADER_SIZE < payloadLength)
+        {
+            payloadLength = udpLength - UDP_HEADER_SIZE;
+        }
+
+        // Every distinct sender and port pair is its own stream
+        int streamId = -1;
+        for (std::size_t i = 0; i < udpStreamKeys.size(); i++)
+        {
+            const UdpStreamKey& existing = udpStreamKeys[i];
+            if (existing.sourceAddress == key.sourceAddress && existing.sourcePort == key.sourcePort && existing.destinationPort == key.destinationPort)
+            {
+                streamId = static_cast<int>(i);
+                break;
+            }
+        }
+
+        if (streamId < 0)
+        {
+            streamId = static_cast<int>(udpStreamKeys.size());
+            udpStreamKeys.push_back(key);
+
+            CaptureRecorder::StreamInfo streamInfo;
+            streamInfo.streamType = CaptureRecorder::UdpDatagrams;
+            streamInfo.sourceAddress = formatIPv4Address(key.sourceAddress);
+            streamInfo.sourcePort = key.sourcePort;
+            streamInfo.destinationPort = key.destinationPort;
+
+            streams.push_back(streamInfo);
+            streamDescribed.push_back(true);
+        }
+
+        record.streamId = streamId;
+        record.data = udpHeader + UDP_HEADER_SIZE;
+        record.length = static_cast<unsigned int>(payloadLength);
+        return true;
+    }
+}
+}
+}
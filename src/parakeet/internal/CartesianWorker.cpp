@@ -0,0 +1,62 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/CartesianWorker.h>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+    CartesianWorker::CartesianWorker()
+    {
+        thread = std::thread([this] { this->threadMainLoop(); });
+    }
+
+    CartesianWorker::~CartesianWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+
+        condition.notify_one();
+        thread.join();
+    }
+
+    void CartesianWorker::post(const std::shared_ptr<const CachedScan>& cachedScan)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingScan = cachedScan;
+        }
+
+        condition.notify_one();
+    }
+
+    void CartesianWorker::threadMainLoop()
+    {
+        while (true)
+        {
+            std::shared_ptr<const CachedScan> cachedScan;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return !running || pendingScan != nullptr; });
+
+                if (!running)
+                {
+                    return;
+                }
+
+                cachedScan.swap(pendingScan);
+            }
+
+            cachedScan->getXY();
+        }
+    }
+}
+}
+}
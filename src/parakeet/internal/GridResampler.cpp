@@ -0,0 +1,238 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/GridResampler.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+    // Where a run of cells falls among a sector's points
+    struct CellLayout
+    {
+        const std::uint16_t* ranges_mm;
+
+        // The position, in points from the start of the sector, of the first cell and the distance between cells
+        float firstPosition;
+        float positionPerCell;
+
+        // The last point of the sector, and the last point a cell may take the range of, which is the first point of the next
+        // sector when the sectors meet
+        int lastIndex;
+        int upperIndex;
+
+        // Cells further than this into the sector are past its last point, in a gap before the next sector
+        float validPositionLimit;
+    };
+
+    // Taken and returned by value, so min and max compile to selects rather than branches
+    template <typename T>
+    static T minimum(T a, T b)
+    {
+        return a < b ? a : b;
+    }
+
+    static void resampleNearest(const CellLayout& layout, std::size_t cellCount, std::uint16_t invalidRange_mm, std::uint16_t* cells)
+    {
+        for (std::size_t cell = 0; cell < cellCount; cell++)
+        {
+            float position = layout.firstPosition + layout.positionPerCell * static_cast<float>(cell);
+            int lowerIndex = minimum(static_cast<int>(position), layout.lastIndex);
+            int higherIndex = minimum(lowerIndex + 1, layout.upperIndex);
+            float weight = position - static_cast<float>(lowerIndex);
+
+            // Indexed rather than chosen between two loads, so the loop has no branches
+            int nearestIndex = minimum(lowerIndex + static_cast<int>(weight >= 0.5f), higherIndex);
+            int range_mm = layout.ranges_mm[nearestIndex];
+            bool valid = (position <= layout.validPositionLimit) & (range_mm != 0);
+
+            cells[cell] = valid ? static_cast<std::uint16_t>(range_mm) : invalidRange_mm;
+        }
+    }
+
+    static void resampleInterpolated(const CellLayout& layout, std::size_t cellCount, std::uint16_t invalidRange_mm,
+        std::uint16_t maximumStep_mm, std::uint16_t* cells)
+    {
+        for (std::size_t cell = 0; cell < cellCount; cell++)
+        {
+            float position = layout.firstPosition + layout.positionPerCell * static_cast<float>(cell);
+            int lowerIndex = minimum(static_cast<int>(position), layout.lastIndex);
+            int higherIndex = minimum(lowerIndex + 1, layout.upperIndex);
+            float weight = minimum(position - static_cast<float>(lowerIndex), 1.0f);
+
+            int lower_mm = layout.ranges_mm[lowerIndex];
+            int higher_mm = layout.ranges_mm[higherIndex];
+            int step_mm = higher_mm - lower_mm;
+
+            // Only points on the same surface are interpolated between, otherwise the nearest point is taken
+            bool blend = (lower_mm != 0) & (higher_mm != 0) & (static_cast<unsigned>(step_mm + maximumStep_mm) <= 2u * maximumStep_mm);
+
+            // Without blending, the weight is rounded to the nearest point
+            float nearestWeight = static_cast<float>(weight >= 0.5f);
+            weight = blend ? weight : nearestWeight;
+
+            int range_mm = static_cast<int>(static_cast<float>(lower_mm) + weight * static_cast<float>(step_mm) + 0.5f);
+            bool valid = (position <= layout.validPositionLimit) & (range_mm != 0);
+
+            cells[cell] = valid ? static_cast<std::uint16_t>(range_mm) : invalidRange_mm;
+        }
+    }
+
+    static void resampleCells(const CellLayout& layout, bool interpolated, const GridScanData::Settings& settings, std::size_t cellCount, std::uint16_t* cells)
+    {
+        if (interpolated)
+        {
+            resampleInterpolated(layout, cellCount, settings.invalidRange_mm, settings.maximumInterpolationStep_mm, cells);
+        }
+        else
+        {
+            resampleNearest(layout, cellCount, settings.invalidRange_mm, cells);
+        }
+    }
+
+    void GridResampler::addSector(std::size_t pointCount, double startAngle_deg, double endAngle_deg, const std::uint16_t* ranges_mm)
+    {
+        double anglePerPoint_deg = (endAngle_deg - startAngle_deg) / pointCount;
+
+        if (pointCount == 0 || !(anglePerPoint_deg > 0))
+        {
+            return;
+        }
+
+        startAngle_deg = std::fmod(startAngle_deg, 360.0);
+
+        Sector sector;
+        sector.startAngle_deg = startAngle_deg < 0 ? startAngle_deg + 360 : startAngle_deg;
+        sector.anglePerPoint_deg = anglePerPoint_deg;
+        sector.offset = this->ranges_mm.size();
+        sector.pointCount = pointCount;
+
+        sectors.push_back(sector);
+        this->ranges_mm.insert(this->ranges_mm.end(), ranges_mm, ranges_mm + pointCount);
+    }
+
+    bool GridResampler::empty() const
+    {
+        return sectors.empty();
+    }
+
+    void GridResampler::resample(GridScanData& grid)
+    {
+        const GridScanData::Settings& settings = grid.getSettings();
+
+        if (sectors.empty())
+        {
+            std::fill(grid.getRanges_mm(), grid.getRanges_mm() + grid.getCellCount(), settings.invalidRange_mm);
+        }
+        else if (settings.resampling == GridScanData::MinimumResampling)
+        {
+            resampleMinimum(grid);
+        }
+        else
+        {
+            std::fill(grid.getRanges_mm(), grid.getRanges_mm() + grid.getCellCount(), settings.invalidRange_mm);
+
+            // The point after the last sector is the first point of the revolution
+            ranges_mm.push_back(ranges_mm.front());
+
+            for (std::size_t sectorIndex = 0; sectorIndex < sectors.size(); sectorIndex++)
+            {
+                resampleSector(grid, sectorIndex);
+            }
+        }
+
+        sectors.clear();
+        ranges_mm.clear();
+    }
+
+    void GridResampler::resampleMinimum(GridScanData& grid)
+    {
+        int cellCount = static_cast<int>(grid.getCellCount());
+        double cellsPerDegree = cellCount / 360.0;
+        std::uint16_t* cells = grid.getRanges_mm();
+
+        // Ranges are kept less one, so a point without a return wraps round to the largest value and loses every comparison
+        std::fill(cells, cells + cellCount, 65535);
+
+        for (const Sector& sector : sectors)
+        {
+            const std::uint16_t* sectorRanges_mm = &ranges_mm[sector.offset];
+            double firstCell = sector.startAngle_deg * cellsPerDegree + 0.5;
+            double cellsPerPoint = sector.anglePerPoint_deg * cellsPerDegree;
+
+            for (std::size_t i = 0; i < sector.pointCount; i++)
+            {
+                int cell = static_cast<int>(firstCell + cellsPerPoint * i);
+                cell = cell >= cellCount ? cell - cellCount : cell;
+                cell = cell >= cellCount ? cell - cellCount : cell;
+
+                std::uint16_t range_mm = static_cast<std::uint16_t>(sectorRanges_mm[i] - 1);
+                cells[cell] = minimum(cells[cell], range_mm);
+            }
+        }
+
+        std::uint16_t invalidRange_mm = grid.getSettings().invalidRange_mm;
+
+        for (int cell = 0; cell < cellCount; cell++)
+        {
+            std::uint16_t range_mm = static_cast<std::uint16_t>(cells[cell] + 1);
+            cells[cell] = range_mm == 0 ? invalidRange_mm : range_mm;
+        }
+    }
+
+    void GridResampler::resampleSector(GridScanData& grid, std::size_t sectorIndex)
+    {
+        const Sector& sector = sectors[sectorIndex];
+        const GridScanData::Settings& settings = grid.getSettings();
+        long cellCount = static_cast<long>(grid.getCellCount());
+        double cellsPerDegree = cellCount / 360.0;
+
+        // A sector's cells run from its first point up to the first point of the next sector, round the revolution
+        double nextStartAngle_deg = sectors[(sectorIndex + 1) % sectors.size()].startAngle_deg;
+        while (nextStartAngle_deg <= sector.startAngle_deg)
+        {
+            nextStartAngle_deg += 360;
+        }
+
+        double endAngle_deg = sector.startAngle_deg + sector.anglePerPoint_deg * sector.pointCount;
+        bool continuous = std::fabs(nextStartAngle_deg - endAngle_deg) <= sector.anglePerPoint_deg / 2;
+
+        long firstCell = static_cast<long>(std::ceil(sector.startAngle_deg * cellsPerDegree));
+        long endCell = std::min(static_cast<long>(std::ceil(nextStartAngle_deg * cellsPerDegree)), firstCell + cellCount);
+
+        CellLayout layout;
+        layout.ranges_mm = &ranges_mm[sector.offset];
+        layout.firstPosition = static_cast<float>((firstCell / cellsPerDegree - sector.startAngle_deg) / sector.anglePerPoint_deg);
+        layout.positionPerCell = static_cast<float>(1 / (cellsPerDegree * sector.anglePerPoint_deg));
+        layout.lastIndex = static_cast<int>(sector.pointCount) - 1;
+        layout.upperIndex = continuous ? layout.lastIndex + 1 : layout.lastIndex;
+        layout.validPositionLimit = continuous ? sector.pointCount + 0.5f : sector.pointCount - 0.5f;
+
+        // Cells past 360 degrees wrap round to the start of the grid
+        long unwrappedEndCell = std::min(endCell, cellCount);
+        std::size_t unwrappedCellCount = static_cast<std::size_t>(std::max(unwrappedEndCell - firstCell, 0L));
+        std::size_t wrappedCellCount = static_cast<std::size_t>(endCell - firstCell) - unwrappedCellCount;
+
+        std::uint16_t* cells = grid.getRanges_mm();
+        bool interpolated = settings.resampling == GridScanData::InterpolatedResampling;
+
+        if (unwrappedCellCount > 0)
+        {
+            resampleCells(layout, interpolated, settings, unwrappedCellCount, cells + firstCell);
+        }
+
+        if (wrappedCellCount > 0)
+        {
+            layout.firstPosition += layout.positionPerCell * unwrappedCellCount;
+            resampleCells(layout, interpolated, settings, wrappedCellCount, cells + (firstCell + static_cast<long>(unwrappedCellCount) - cellCount));
+        }
+    }
+}
+}
+}
@@ -0,0 +1,262 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/MappedFile.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux) || defined(linux) || defined(__linux__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    unsigned char* MappedFile::data() const
+    {
+        return mapping;
+    }
+
+    std::size_t MappedFile::size() const
+    {
+        return mappingSize;
+    }
+
+    bool MappedFile::isOpen() const
+    {
+        return mapping != nullptr;
+    }
+
+    bool MappedFile::close()
+    {
+        return close(mappingSize);
+    }
+
+#if defined(_WIN32)
+    static bool setFileSize(HANDLE fileHandle, std::size_t size)
+    {
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(size);
+
+        return SetFilePointerEx(fileHandle, fileSize, NULL, FILE_BEGIN) && SetEndOfFile(fileHandle);
+    }
+
+    bool MappedFile::create(const std::string& path, std::size_t size)
+    {
+        close();
+
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            fileHandle = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER mappingLength;
+        mappingLength.QuadPart = static_cast<LONGLONG>(size);
+
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READWRITE, mappingLength.HighPart, mappingLength.LowPart, NULL);
+        if (mappingHandle == NULL)
+        {
+            CloseHandle(fileHandle);
+            fileHandle = nullptr;
+            mappingHandle = nullptr;
+            return false;
+        }
+
+        mapping = static_cast<unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, size));
+        if (mapping == NULL)
+        {
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            mapping = nullptr;
+            fileHandle = nullptr;
+            mappingHandle = nullptr;
+            return false;
+        }
+
+        mappingSize = size;
+        writable = true;
+
+        return true;
+    }
+
+    bool MappedFile::openReadOnly(const std::string& path)
+    {
+        close();
+
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            fileHandle = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(fileHandle);
+            fileHandle = nullptr;
+            return false;
+        }
+
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mappingHandle == NULL)
+        {
+            CloseHandle(fileHandle);
+            fileHandle = nullptr;
+            mappingHandle = nullptr;
+            return false;
+        }
+
+        mapping = static_cast<unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (mapping == NULL)
+        {
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            mapping = nullptr;
+            fileHandle = nullptr;
+            mappingHandle = nullptr;
+            return false;
+        }
+
+        mappingSize = static_cast<std::size_t>(fileSize.QuadPart);
+        writable = false;
+
+        return true;
+    }
+
+    bool MappedFile::close(std::size_t usedSize)
+    {
+        if (!isOpen())
+        {
+            return true;
+        }
+
+        // Every step is still taken after one fails, so the handles are never leaked
+        bool success = UnmapViewOfFile(mapping) != 0;
+        success &= CloseHandle(mappingHandle) != 0;
+
+        if (writable)
+        {
+            success &= setFileSize(fileHandle, usedSize);
+        }
+
+        success &= CloseHandle(fileHandle) != 0;
+
+        mapping = nullptr;
+        mappingSize = 0;
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+
+        return success;
+    }
+
+#elif defined(__linux) || defined(linux) || defined(__linux__)
+    bool MappedFile::create(const std::string& path, std::size_t size)
+    {
+        close();
+
+        fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor < 0)
+        {
+            return false;
+        }
+
+        // Allocate the blocks up front, writing to a hole in a sparse file through the mapping raises SIGBUS once the disk is full
+        if (::posix_fallocate(fileDescriptor, 0, static_cast<off_t>(size)) != 0)
+        {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+            ::unlink(path.c_str());
+            return false;
+        }
+
+        void* result = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+        if (result == MAP_FAILED)
+        {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+            return false;
+        }
+
+        mapping = static_cast<unsigned char*>(result);
+        mappingSize = size;
+        writable = true;
+
+        return true;
+    }
+
+    bool MappedFile::openReadOnly(const std::string& path)
+    {
+        close();
+
+        fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStatus;
+        if (::fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+        {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+            return false;
+        }
+
+        void* result = ::mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        if (result == MAP_FAILED)
+        {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+            return false;
+        }
+
+        mapping = static_cast<unsigned char*>(result);
+        mappingSize = static_cast<std::size_t>(fileStatus.st_size);
+        writable = false;
+
+        return true;
+    }
+
+    bool MappedFile::close(std::size_t usedSize)
+    {
+        if (!isOpen())
+        {
+            return true;
+        }
+
+        // Every step is still taken after one fails, so the descriptor is never leaked. A file which cannot be truncated
+        // keeps its reserved, zero filled, size which readers treat as the end of the data.
+        bool success = ::munmap(mapping, mappingSize) == 0;
+
+        if (writable)
+        {
+            success &= ::ftruncate(fileDescriptor, static_cast<off_t>(usedSize)) == 0;
+        }
+
+        success &= ::close(fileDescriptor) == 0;
+
+        mapping = nullptr;
+        mappingSize = 0;
+        fileDescriptor = -1;
+
+        return success;
+    }
+#endif
+}
+}
+}
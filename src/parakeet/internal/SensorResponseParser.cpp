@@ -44,6 +44,20 @@ namespace internal
         return SensorResponse(SensorResponse::NA, "");
     }
 
+    std::vector<SensorResponse> SensorResponseParser::getSensorResponsesFromMessage(const std::string& message)
+    {
+        std::vector<SensorResponse> matchingResponses;
+
+        for(const SensorResponse& response : allResponses)
+        {
+            if(doesMessageMatchResponse(message, response))
+            {
+                matchingResponses.push_back(response);
+            }
+        }
+        return matchingResponses;
+    }
+
     bool SensorResponseParser::doesMessageMatchResponse(const std::string& message, const SensorResponse& response)
     {
         for(auto responseMessage : response.getResponses())
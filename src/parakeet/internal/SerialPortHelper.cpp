@@ -30,6 +30,18 @@ void SerialPortHelper::setCustomBaudRate(int fileDescriptor, int baudRate)
 
     ioctl::ioctl(fileDescriptor, TCSETS2, &tty2);
 }
+
+int SerialPortHelper::getCustomBaudRate(int fileDescriptor)
+{
+    struct termios2::termios2 tty2;
+
+    if (ioctl::ioctl(fileDescriptor, TCGETS2, &tty2) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<int>(tty2.c_ospeed);
+}
 }
 }
 }
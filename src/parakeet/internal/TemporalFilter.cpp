@@ -0,0 +1,157 @@
+/*
+	Copyright 2021 OpenJAUS, LLC (dba MechaSpin). Subject to the MIT license.
+*/
+
+#include <parakeet/internal/TemporalFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace mechaspin
+{
+namespace parakeet
+{
+namespace internal
+{
+    const int TemporalFilter::MAX_REVOLUTION_COUNT;
+
+    struct Comparator
+    {
+        int first;
+        int second;
+    };
+
+    // A 16 comparator network which sorts 7 values
+    static const Comparator SORTING_NETWORK[] =
+    {
+        {0, 6}, {2, 3}, {4, 5},
+        {0, 2}, {1, 4}, {3, 6},
+        {0, 1}, {2, 5}, {3, 4},
+        {1, 2}, {4, 6},
+        {2, 3}, {4, 5},
+        {1, 2}, {3, 4}, {5, 6}
+    };
+
+    void TemporalFilter::configure(double binWidth_deg, int revolutionCount)
+    {
+        binWidth_deg = std::max(binWidth_deg, 0.01);
+        revolutionCount = std::min(std::max(revolutionCount, 1), MAX_REVOLUTION_COUNT);
+
+        if (binWidth_deg == this->binWidth_deg && revolutionCount == this->revolutionCount)
+        {
+            return;
+        }
+
+        this->binWidth_deg = binWidth_deg;
+        this->revolutionCount = revolutionCount;
+        binCount = static_cast<std::size_t>(std::ceil(360 / binWidth_deg));
+
+        averages_mm.assign(binCount, 0);
+        historyCounts.assign(binCount, 0);
+        nextSlots.assign(binCount, 0);
+        history_mm.assign(binCount * revolutionCount, 0);
+    }
+
+    void TemporalFilter::findBins(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg)
+    {
+        bins.resize(pointCount);
+
+        double firstBin = std::fmod(startAngle_deg, 360.0) / binWidth_deg;
+        if (firstBin < 0)
+        {
+            firstBin += binCount;
+        }
+
+        double binsPerPoint = anglePerPoint_deg / binWidth_deg;
+        int wrapBin = static_cast<int>(binCount);
+
+        // A sector is less than a revolution, so its bins wrap past the last bin at most once
+        for (int i = 0; i < static_cast<int>(pointCount); i++)
+        {
+            int bin = static_cast<int>(firstBin + binsPerPoint * i + 0.5);
+            bins[i] = static_cast<std::uint32_t>(bin - (bin >= wrapBin ? wrapBin : 0));
+        }
+    }
+
+    void TemporalFilter::applyExponential(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm,
+        float smoothingFactor, std::uint16_t resetDistance_mm)
+    {
+        findBins(pointCount, startAngle_deg, anglePerPoint_deg);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            if (ranges_mm[i] == 0)
+            {
+                continue;
+            }
+
+            std::uint32_t bin = bins[i];
+            float range_mm = ranges_mm[i];
+
+            if (historyCounts[bin] == 0 || std::fabs(range_mm - averages_mm[bin]) > resetDistance_mm)
+            {
+                averages_mm[bin] = range_mm;
+                historyCounts[bin] = 1;
+            }
+            else
+            {
+                averages_mm[bin] += smoothingFactor * (range_mm - averages_mm[bin]);
+            }
+
+            ranges_mm[i] = static_cast<std::uint16_t>(averages_mm[bin] + 0.5f);
+        }
+    }
+
+    void TemporalFilter::applyMedian(std::size_t pointCount, double startAngle_deg, double anglePerPoint_deg, std::uint16_t* ranges_mm,
+        std::uint16_t resetDistance_mm)
+    {
+        findBins(pointCount, startAngle_deg, anglePerPoint_deg);
+
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            if (ranges_mm[i] == 0)
+            {
+                continue;
+            }
+
+            std::uint32_t bin = bins[i];
+            int range_mm = ranges_mm[i];
+            int lastSlot = (nextSlots[bin] + revolutionCount - 1) % revolutionCount;
+
+            if (historyCounts[bin] == 0 || std::abs(range_mm - history_mm[lastSlot * binCount + bin]) > resetDistance_mm)
+            {
+                historyCounts[bin] = 0;
+                nextSlots[bin] = 0;
+            }
+
+            history_mm[nextSlots[bin] * binCount + bin] = static_cast<std::uint16_t>(range_mm);
+            nextSlots[bin] = static_cast<std::uint8_t>((nextSlots[bin] + 1) % revolutionCount);
+            historyCounts[bin] = static_cast<std::uint8_t>(std::min<int>(historyCounts[bin] + 1, revolutionCount));
+
+            // Sorted by a fixed network, padded with the largest range so the unused slots sort last
+            std::uint16_t values[MAX_REVOLUTION_COUNT];
+            int valueCount = historyCounts[bin];
+
+            for (int slot = 0; slot < MAX_REVOLUTION_COUNT; slot++)
+            {
+                values[slot] = slot < valueCount ? history_mm[slot * binCount + bin] : 65535;
+            }
+
+            for (const Comparator& comparator : SORTING_NETWORK)
+            {
+                std::uint16_t first = values[comparator.first];
+                std::uint16_t second = values[comparator.second];
+
+                values[comparator.first] = first < second ? first : second;
+                values[comparator.second] = first < second ? second : first;
+            }
+
+            std::uint16_t median_mm = values[valueCount / 2];
+
+            ranges_mm[i] = median_mm;
+        }
+    }
+}
+}
+}
@@ -3,11 +3,13 @@
 */
 
 #include <parakeet/util.h>
+#include <parakeet/PolarTransform.h>
 
 #include <vector>
 #include <algorithm>
 #include <sstream>
 #include <cstring>
+#include <utility>
 
 namespace mechaspin
 {
@@ -17,13 +19,31 @@ namespace parakeet
 
     ScanDataXY util::transform(const ScanDataPolar& polarScanData)
     {
+        // Each thread keeps the sine and cosine tables of the scans it has transformed
+        static thread_local PolarTransform<double> polarTransform;
+
         std::vector<PointXY> pointXYvector;
+        polarTransform.transform(polarScanData, pointXYvector);
+
+        return ScanDataXY(std::move(pointXYvector), polarScanData.getTimestamp());
+    }
+
+    ScanDataXY util::transform(const CompactScanData& compactScanData)
+    {
+        static thread_local PolarTransform<double> polarTransform;
+        static thread_local PolarTransform<double>::Columns columns;
 
-        for(auto point : polarScanData.getPoints())
+        polarTransform.transform(compactScanData, columns);
+
+        std::vector<PointXY> pointXYvector;
+        pointXYvector.reserve(columns.x_mm.size());
+
+        for (std::size_t i = 0; i < columns.x_mm.size(); i++)
         {
-            pointXYvector.push_back(transform(point));
+            pointXYvector.push_back(PointXY(columns.x_mm[i], columns.y_mm[i], columns.intensities[i]));
         }
-        return ScanDataXY(pointXYvector, polarScanData.getTimestamp());
+
+        return ScanDataXY(std::move(pointXYvector), compactScanData.getTimestamp());
     }
 
     PointXY util::transform(const PointPolar& polarPoint)
@@ -37,6 +57,7 @@ namespace parakeet
     ScanDataPolar util::transform(const ScanDataXY& xyScanData)
     {
         std::vector<PointPolar> pointPolarVector;
+        pointPolarVector.reserve(xyScanData.getPoints().size());
 
         for(auto point : xyScanData.getPoints())
         {